@@ -0,0 +1,628 @@
+/*
+ * Copyright (c) 2020, RudyLo <luhuadong@163.com>
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ *
+ * Change Logs:
+ * Date           Author       Notes
+ * 2026-10-19     luhuadong    the first version
+ */
+
+/*
+ * Parser and pipeline micro-benchmarks over fixed, generated corpora:
+ *
+ *   gps      GPS-only L76 default output, RMC VTG GGA GSA 3xGSV GLL
+ *   multi    GPS + GLONASS + BeiDou, 3xGSA and 11 GSV per epoch
+ *   corrupt  multi with flipped bits, truncated and over-long lines and
+ *            line noise between sentences
+ *
+ * Every call is timed with gps_cycles_get(), which counts nanoseconds on
+ * Linux, core cycles on Cortex-M3/M4 and microseconds elsewhere. Results are CSV, one row per stage;
+ * lines starting with '#' are comments.
+ */
+
+#include <rtthread.h>
+#include <stdlib.h>
+#include "gps_nmea.h"
+#if defined(PKG_USING_GPS_PROJ) || defined(PKG_USING_GPS_FILTER)
+#include "gps_proj.h"
+#endif
+#ifdef PKG_USING_GPS_FILTER
+#include "gps_filter.h"
+#endif
+
+#ifndef GPS_BENCH_EPOCHS
+#define GPS_BENCH_EPOCHS     30        /* epochs per corpus */
+#endif
+#ifndef GPS_BENCH_SAMPLES
+#define GPS_BENCH_SAMPLES    4096      /* latest calls kept for percentiles */
+#endif
+#ifndef GPS_BENCH_CLOCK_HZ
+#define GPS_BENCH_CLOCK_HZ   ((rt_uint64_t)GPS_CYCLES_HZ)
+#endif
+
+#define BENCH_EPOCH_BYTES    2048      /* corpus space per epoch */
+
+enum bench_corpus_id
+{
+    BENCH_GPS = 0,
+    BENCH_MULTI,
+    BENCH_CORRUPT,
+    BENCH_CORPUS_NUM,
+};
+
+static const char *const bench_corpus_name[BENCH_CORPUS_NUM] = { "gps", "multi", "corrupt" };
+
+struct bench_corpus
+{
+    const char *name;
+    char       *data;
+    rt_size_t   size;
+    rt_size_t   cap;
+
+    /* injected faults */
+    rt_uint32_t flipped;
+    rt_uint32_t truncated;
+    rt_uint32_t overlong;
+    rt_uint32_t noise;
+};
+
+struct bench_stat
+{
+    const char  *name;
+    rt_uint32_t  calls;
+    rt_uint32_t  bytes;
+    rt_uint64_t  total;            /* cycles */
+    rt_uint32_t  max;
+    rt_uint32_t  allocs;
+    rt_uint32_t *sample;
+};
+
+static rt_uint32_t bench_seed = 1;
+static rt_uint32_t bench_overhead;
+static rt_uint32_t *bench_sample;
+
+static struct gps_device bench_dev;
+static char bench_dev_line[GPS_NMEA_LINE_SIZE];
+static struct gps_epoch bench_epoch;
+static gps_fix_t bench_fix[GPS_BENCH_EPOCHS];
+static rt_uint32_t bench_fix_num;
+#ifdef PKG_USING_GPS_FILTER
+static struct gps_filter bench_filter;
+#endif
+
+static rt_uint32_t bench_rand(void)
+{
+    /* xorshift32, reproducible across targets */
+    bench_seed ^= bench_seed << 13;
+    bench_seed ^= bench_seed >> 17;
+    bench_seed ^= bench_seed << 5;
+
+    return bench_seed;
+}
+
+#ifdef RT_USING_HOOK
+static volatile rt_uint32_t bench_allocs;
+
+static void bench_malloc_hook(void *ptr, rt_size_t size)
+{
+    bench_allocs++;
+}
+#endif
+
+/* -------------------------------------------------------------------------- */
+/* corpora */
+
+static void bench_put(struct bench_corpus *c, const char *cmd, rt_bool_t corrupt)
+{
+    char line[GPS_NMEA_LINE_SIZE + 8];
+    rt_size_t len = gps_nmea_build(line, sizeof(line), cmd);
+    rt_uint32_t r, i;
+
+    if (len == 0 || c->size + len + 160 > c->cap)
+        return;
+
+    if (corrupt)
+    {
+        r = bench_rand() % 1000;
+        if (r < 50)
+        {
+            /* one bit of the payload, the checksum catches it */
+            line[1 + bench_rand() % (len - 6)] ^= 0x01;
+            c->flipped++;
+        }
+        else if (r < 80)
+        {
+            /* cut off, the next '$' restarts the scanner */
+            len = 2 + bench_rand() % (len - 4);
+            c->truncated++;
+        }
+        else if (r < 100)
+        {
+            /* line noise, no '$' */
+            for (i = 1 + bench_rand() % 16; i > 0; i--)
+            {
+                char ch = (char)(0x20 + bench_rand() % 0x5F);
+                c->data[c->size++] = (ch == '$') ? '#' : ch;
+            }
+            c->noise++;
+        }
+        else if (r < 110)
+        {
+            /* longer than any sentence, overflows the line buffer */
+            c->data[c->size++] = '$';
+            for (i = 0; i < 120; i++)
+                c->data[c->size++] = (char)('A' + bench_rand() % 26);
+            c->data[c->size++] = '\r';
+            c->data[c->size++] = '\n';
+            c->overlong++;
+        }
+    }
+
+    rt_memcpy(c->data + c->size, line, len);
+    c->size += len;
+}
+
+/* ddmm.mmmm or dddmm.mmmm, without floating point printf */
+static void bench_ddmm(char *buf, rt_size_t size, double deg, int width)
+{
+    int d = (int)deg;
+    rt_int32_t m = (rt_int32_t)((deg - d) * 600000 + 0.5);
+
+    rt_snprintf(buf, size, "%0*d%02d.%04d", width, d, (int)(m / 10000), (int)(m % 10000));
+}
+
+/* up to 16 satellites of one constellation, 4 per GSV sentence */
+static void bench_gsv(struct bench_corpus *c, const char *talker, int first_prn, int num,
+                      rt_uint32_t k, rt_bool_t corrupt)
+{
+    char cmd[GPS_NMEA_LINE_SIZE];
+    int msgs = (num + 3) / 4;
+    int m, i, n;
+
+    for (m = 0; m < msgs; m++)
+    {
+        n = rt_snprintf(cmd, sizeof(cmd), "$%sGSV,%d,%d,%02d", talker, msgs, m + 1, num);
+        for (i = m * 4; i < num && i < m * 4 + 4; i++)
+        {
+            n += rt_snprintf(cmd + n, sizeof(cmd) - n, ",%02d,%02d,%03d,%02d",
+                             first_prn + i, (int)((i * 7 + k / 10) % 90),
+                             (int)((i * 37 + k) % 360), (int)(20 + (i * 13 + k) % 30));
+        }
+        bench_put(c, cmd, corrupt);
+    }
+}
+
+static void bench_gsa(struct bench_corpus *c, const char *talker, int first_prn, int num,
+                      rt_bool_t corrupt)
+{
+    char cmd[GPS_NMEA_LINE_SIZE];
+    int i, n;
+
+    n = rt_snprintf(cmd, sizeof(cmd), "$%sGSA,A,3", talker);
+    for (i = 0; i < 12; i++)
+    {
+        if (i < num)
+            n += rt_snprintf(cmd + n, sizeof(cmd) - n, ",%02d", first_prn + i);
+        else
+            n += rt_snprintf(cmd + n, sizeof(cmd) - n, ",");
+    }
+    rt_snprintf(cmd + n, sizeof(cmd) - n, ",1.40,0.80,1.15");
+    bench_put(c, cmd, corrupt);
+}
+
+/* one 1 Hz epoch of a car at 10 m/s heading north-east from Shanghai */
+static void bench_epoch_put(struct bench_corpus *c, rt_uint32_t k, rt_bool_t multi, rt_bool_t corrupt)
+{
+    const char *talker = multi ? "GN" : "GP";
+    double lat = 31.2304 + k * 6.35e-5;
+    double lon = 121.4737 + k * 7.43e-5;
+    rt_uint32_t sec = 12 * 3600 + k;
+    char cmd[GPS_NMEA_LINE_SIZE * 2];   /* gps_nmea_build() drops what doesn't fit */
+    char utc[16], la[32], lo[32];
+
+    rt_snprintf(utc, sizeof(utc), "%02d%02d%02d.000",
+                (int)(sec / 3600), (int)(sec / 60 % 60), (int)(sec % 60));
+    bench_ddmm(la, sizeof(la), lat, 2);
+    bench_ddmm(lo, sizeof(lo), lon, 3);
+
+    rt_snprintf(cmd, sizeof(cmd), "$%sRMC,%s,A,%s,N,%s,E,19.44,45.00,191026,,,A",
+                talker, utc, la, lo);
+    bench_put(c, cmd, corrupt);
+    rt_snprintf(cmd, sizeof(cmd), "$%sVTG,45.00,T,,M,19.44,N,36.00,K,A", talker);
+    bench_put(c, cmd, corrupt);
+    rt_snprintf(cmd, sizeof(cmd), "$%sGGA,%s,%s,N,%s,E,1,%02d,0.80,%d.%d,M,7.0,M,,",
+                talker, utc, la, lo, multi ? 24 : 10, (int)(12 + k % 5), (int)(k % 10));
+    bench_put(c, cmd, corrupt);
+
+    if (multi)
+    {
+        bench_gsa(c, "GN", 1, 10, corrupt);
+        bench_gsa(c, "GN", 65, 7, corrupt);
+        bench_gsa(c, "GN", 201, 7, corrupt);
+        bench_gsv(c, "GP", 1, 16, k, corrupt);
+        bench_gsv(c, "GL", 65, 12, k, corrupt);
+        bench_gsv(c, "BD", 1, 16, k, corrupt);
+    }
+    else
+    {
+        bench_gsa(c, "GP", 1, 10, corrupt);
+        bench_gsv(c, "GP", 1, 12, k, corrupt);
+    }
+
+    rt_snprintf(cmd, sizeof(cmd), "$%sGLL,%s,N,%s,E,%s,A,A", talker, la, lo, utc);
+    bench_put(c, cmd, corrupt);
+}
+
+static rt_err_t bench_corpus_make(struct bench_corpus *c, enum bench_corpus_id id)
+{
+    rt_uint32_t k;
+
+    rt_memset(c, 0, sizeof(struct bench_corpus));
+    c->name = bench_corpus_name[id];
+    c->cap = (rt_size_t)GPS_BENCH_EPOCHS * BENCH_EPOCH_BYTES;
+    c->data = rt_malloc(c->cap);
+    if (c->data == RT_NULL)
+        return -RT_ENOMEM;
+
+    bench_seed = 1;
+    for (k = 0; k < GPS_BENCH_EPOCHS; k++)
+        bench_epoch_put(c, k, id != BENCH_GPS, id == BENCH_CORRUPT);
+
+    return RT_EOK;
+}
+
+/* the next line the scanner passes on: from its last '$' up to '\n' */
+static const char *bench_line(const char **pos, const char *end, rt_size_t *len)
+{
+    const char *p = *pos;
+
+    while (p < end)
+    {
+        const char *nl = memchr(p, '\n', end - p);
+        const char *s;
+
+        if (nl == RT_NULL)
+            break;
+
+        for (s = nl; s > p && *s != '$'; s--);
+        p = nl + 1;
+        if (*s == '$' && nl - s <= GPS_NMEA_LINE_SIZE)
+        {
+            *pos = p;
+            *len = nl - s;
+            return s;
+        }
+    }
+
+    *pos = end;
+    return RT_NULL;
+}
+
+/* -------------------------------------------------------------------------- */
+/* statistics */
+
+static int bench_cmp(const void *a, const void *b)
+{
+    rt_uint32_t x = *(const rt_uint32_t *)a, y = *(const rt_uint32_t *)b;
+
+    return (x > y) - (x < y);
+}
+
+static void bench_begin(struct bench_stat *st, const char *name)
+{
+    rt_memset(st, 0, sizeof(struct bench_stat));
+    st->name = name;
+    st->sample = bench_sample;
+#ifdef RT_USING_HOOK
+    st->allocs = bench_allocs;
+#endif
+}
+
+static void bench_record(struct bench_stat *st, rt_uint32_t cycles, rt_size_t bytes)
+{
+    cycles = (cycles > bench_overhead) ? cycles - bench_overhead : 0;
+
+    st->sample[st->calls % GPS_BENCH_SAMPLES] = cycles;
+    st->calls++;
+    st->bytes += bytes;
+    st->total += cycles;
+    if (cycles > st->max)
+        st->max = cycles;
+}
+
+#define BENCH_TIME(st, bytes, call)                                  \
+    do                                                               \
+    {                                                                \
+        rt_uint32_t __t0 = gps_cycles_get();                         \
+        call;                                                        \
+        bench_record(st, gps_cycles_get() - __t0, bytes);            \
+    } while (0)
+
+static void bench_end(struct bench_stat *st, const struct bench_corpus *c)
+{
+    rt_uint32_t num = (st->calls < GPS_BENCH_SAMPLES) ? st->calls : GPS_BENCH_SAMPLES;
+    rt_uint64_t total = st->total ? st->total : 1;
+    char allocs[12] = "-";
+
+    if (st->calls == 0)
+        return;
+
+#ifdef RT_USING_HOOK
+    rt_snprintf(allocs, sizeof(allocs), "%u", (unsigned int)(bench_allocs - st->allocs));
+#endif
+
+    qsort(st->sample, num, sizeof(rt_uint32_t), bench_cmp);
+
+    /* corpus,stage,calls,bytes,mean,p50,p90,p99,max,calls_per_s,kb_per_s,allocs */
+    rt_kprintf("%s,%s,%u,%u,%u,%u,%u,%u,%u,%u,%u,%s\n", c->name, st->name,
+               (unsigned int)st->calls, (unsigned int)st->bytes,
+               (unsigned int)(st->total / st->calls),
+               (unsigned int)st->sample[num * 50 / 100], (unsigned int)st->sample[num * 90 / 100],
+               (unsigned int)st->sample[num * 99 / 100], (unsigned int)st->max,
+               (unsigned int)(st->calls * GPS_BENCH_CLOCK_HZ / total),
+               (unsigned int)(st->bytes * GPS_BENCH_CLOCK_HZ / total / 1024), allocs);
+}
+
+/* the cost of the two gps_cycles_get() calls around each measurement */
+static void bench_calibrate(void)
+{
+    rt_uint32_t i, t0, dt;
+
+    bench_overhead = (rt_uint32_t)-1;
+    for (i = 0; i < 1000; i++)
+    {
+        t0 = gps_cycles_get();
+        dt = gps_cycles_get() - t0;
+        if (dt < bench_overhead)
+            bench_overhead = dt;
+    }
+}
+
+/* -------------------------------------------------------------------------- */
+/* stages */
+
+static void bench_collect(gps_epoch_t epoch, gps_fix_t *fix, void *user_data)
+{
+    if (bench_fix_num < GPS_BENCH_EPOCHS)
+        bench_fix[bench_fix_num++] = *fix;
+}
+
+static void bench_discard(gps_epoch_t epoch, gps_fix_t *fix, void *user_data)
+{
+}
+
+/* scanner, checksum, tokenizer, assembler and publish, one call per line */
+static void bench_feed(const struct bench_corpus *c, rt_uint32_t iterations)
+{
+    gps_device_t dev = &bench_dev;
+    struct bench_stat st;
+    rt_uint32_t n;
+
+    bench_begin(&st, "feed");
+    for (n = 0; n < iterations; n++)
+    {
+        const char *p = c->data, *end = c->data + c->size;
+
+        rt_memset(dev, 0, sizeof(struct gps_device));
+        dev->line = bench_dev_line;
+        dev->epoch = &bench_epoch;
+        dev->ack_cmd = -1;
+        bench_fix_num = 0;
+        gps_epoch_init(&bench_epoch, bench_collect, dev);
+
+        while (p < end)
+        {
+            const char *nl = memchr(p, '\n', end - p);
+            rt_size_t len = nl ? (rt_size_t)(nl + 1 - p) : (rt_size_t)(end - p);
+
+            BENCH_TIME(&st, len, gps_feed(dev, p, len));
+            p += len;
+        }
+    }
+    bench_end(&st, c);
+
+    rt_kprintf("# %s: %u bytes, %u sentences, %u bad checksum, %u overflow, %u epochs\n",
+               c->name, (unsigned int)c->size, (unsigned int)dev->sentences,
+               (unsigned int)dev->bad_checksum, (unsigned int)dev->overflow,
+               (unsigned int)bench_epoch.epochs);
+}
+
+static void bench_parse(const struct bench_corpus *c, rt_uint32_t iterations)
+{
+    static const char *const apply_name[] =
+    {
+        RT_NULL, "apply_rmc", "apply_gga", "apply_gsa", "apply_gsv", "apply_vtg", "apply_gll",
+    };
+    struct gps_nmea_token tok;
+    struct bench_stat st;
+    gps_fix_t fix;
+    const char *pos, *s, *end = c->data + c->size;
+    rt_size_t len;
+    rt_bool_t ok;
+    rt_uint32_t n;
+    int type;
+
+    bench_begin(&st, "check");
+    for (n = 0; n < iterations; n++)
+        for (pos = c->data; (s = bench_line(&pos, end, &len)) != RT_NULL;)
+            BENCH_TIME(&st, len, ok = gps_nmea_check(s, len));
+    bench_end(&st, c);
+
+    bench_begin(&st, "tokenize");
+    for (n = 0; n < iterations; n++)
+        for (pos = c->data; (s = bench_line(&pos, end, &len)) != RT_NULL;)
+            if (gps_nmea_check(s, len))
+                BENCH_TIME(&st, len, gps_nmea_tokenize(s, len, &tok));
+    bench_end(&st, c);
+
+    for (type = GPS_NMEA_RMC; type <= GPS_NMEA_GLL; type++)
+    {
+        rt_memset(&fix, 0, sizeof(fix));
+        bench_begin(&st, apply_name[type]);
+        for (n = 0; n < iterations; n++)
+        {
+            for (pos = c->data; (s = bench_line(&pos, end, &len)) != RT_NULL;)
+            {
+                ok = gps_nmea_check(s, len) && gps_nmea_tokenize(s, len, &tok) == RT_EOK;
+                if (ok && tok.type == (enum gps_nmea_type)type)
+                    BENCH_TIME(&st, len, gps_nmea_apply(&tok, &fix));
+            }
+        }
+        bench_end(&st, c);
+    }
+
+    bench_begin(&st, "epoch");
+    for (n = 0; n < iterations; n++)
+    {
+        gps_epoch_init(&bench_epoch, bench_discard, RT_NULL);
+        for (pos = c->data; (s = bench_line(&pos, end, &len)) != RT_NULL;)
+            if (gps_nmea_check(s, len) && gps_nmea_tokenize(s, len, &tok) == RT_EOK)
+                BENCH_TIME(&st, len, gps_epoch_feed(&bench_epoch, &tok));
+    }
+    bench_end(&st, c);
+}
+
+/* per-fix processing of the fixes the feed stage assembled */
+static void bench_fixes(const struct bench_corpus *c, rt_uint32_t iterations)
+{
+#if defined(PKG_USING_GPS_PROJ) || defined(PKG_USING_GPS_FILTER)
+    struct bench_stat st;
+    struct gps_proj proj;
+    struct gps_enu enu;
+    struct gps_utm utm;
+    coord_t geo;
+    rt_uint32_t n, i;
+
+    if (bench_fix_num == 0)
+        return;
+
+#ifdef PKG_USING_GPS_FILTER
+    bench_begin(&st, "filter_cv");
+    for (n = 0; n < iterations; n++)
+    {
+        gps_filter_init(&bench_filter, GPS_FILTER_CV, 1.0f);
+        for (i = 0; i < bench_fix_num; i++)
+        {
+            gps_fix_t fix = bench_fix[i];
+
+            BENCH_TIME(&st, 0, gps_filter_update(&bench_filter, &fix));
+        }
+    }
+    bench_end(&st, c);
+
+    bench_begin(&st, "filter_ca");
+    for (n = 0; n < iterations; n++)
+    {
+        gps_filter_init(&bench_filter, GPS_FILTER_CA, 1.0f);
+        for (i = 0; i < bench_fix_num; i++)
+        {
+            gps_fix_t fix = bench_fix[i];
+
+            BENCH_TIME(&st, 0, gps_filter_update(&bench_filter, &fix));
+        }
+    }
+    bench_end(&st, c);
+#endif
+
+    geo.lat = bench_fix[0].lat;
+    geo.lon = bench_fix[0].lon;
+    gps_proj_set_origin(&proj, &geo, bench_fix[0].alt);
+
+    bench_begin(&st, "geo2enu");
+    for (n = 0; n < iterations; n++)
+    {
+        for (i = 0; i < bench_fix_num; i++)
+        {
+            geo.lat = bench_fix[i].lat;
+            geo.lon = bench_fix[i].lon;
+            BENCH_TIME(&st, 0, gps_proj_geo2enu(&proj, &geo, bench_fix[i].alt, &enu));
+        }
+    }
+    bench_end(&st, c);
+
+    bench_begin(&st, "geo2enu_fast");
+    for (n = 0; n < iterations; n++)
+    {
+        for (i = 0; i < bench_fix_num; i++)
+        {
+            geo.lat = bench_fix[i].lat;
+            geo.lon = bench_fix[i].lon;
+            BENCH_TIME(&st, 0, gps_proj_geo2enu_fast(&proj, &geo, bench_fix[i].alt, &enu));
+        }
+    }
+    bench_end(&st, c);
+
+    bench_begin(&st, "geo2utm");
+    for (n = 0; n < iterations; n++)
+    {
+        for (i = 0; i < bench_fix_num; i++)
+        {
+            geo.lat = bench_fix[i].lat;
+            geo.lon = bench_fix[i].lon;
+            BENCH_TIME(&st, 0, gps_geo2utm(&geo, &utm));
+        }
+    }
+    bench_end(&st, c);
+#endif
+}
+
+/* gps_bench [gps|multi|corrupt|all] [iterations] */
+static void gps_bench(int argc, char **argv)
+{
+    const char *which = (argc > 1) ? argv[1] : "all";
+    rt_uint32_t iterations = (argc > 2) ? atoi(argv[2]) : 20;
+    struct bench_corpus c;
+    int id;
+
+    if (iterations == 0)
+        iterations = 1;
+
+    bench_sample = rt_malloc(GPS_BENCH_SAMPLES * sizeof(rt_uint32_t));
+    if (bench_sample == RT_NULL)
+    {
+        rt_kprintf("No memory for %d samples\n", GPS_BENCH_SAMPLES);
+        return;
+    }
+
+    bench_calibrate();
+    rt_kprintf("# gps_bench: %d epochs x %u iterations, clock %u Hz, overhead %u subtracted\n",
+               GPS_BENCH_EPOCHS, (unsigned int)iterations, (unsigned int)GPS_BENCH_CLOCK_HZ,
+               (unsigned int)bench_overhead);
+    rt_kprintf("corpus,stage,calls,bytes,mean,p50,p90,p99,max,calls_per_s,kb_per_s,allocs\n");
+
+#ifdef RT_USING_HOOK
+    rt_malloc_sethook(bench_malloc_hook);
+#endif
+    for (id = 0; id < BENCH_CORPUS_NUM; id++)
+    {
+        if (rt_strcmp(which, "all") != 0 && rt_strcmp(which, bench_corpus_name[id]) != 0)
+            continue;
+
+        if (bench_corpus_make(&c, (enum bench_corpus_id)id) != RT_EOK)
+        {
+            rt_kprintf("No memory for the %s corpus\n", bench_corpus_name[id]);
+            break;
+        }
+        if (id == BENCH_CORRUPT)
+        {
+            rt_kprintf("# %s: %u flipped, %u truncated, %u over-long, %u noise\n", c.name,
+                       (unsigned int)c.flipped, (unsigned int)c.truncated,
+                       (unsigned int)c.overlong, (unsigned int)c.noise);
+        }
+
+        bench_feed(&c, iterations);
+        bench_parse(&c, iterations);
+        bench_fixes(&c, iterations);
+
+        rt_free(c.data);
+    }
+#ifdef RT_USING_HOOK
+    rt_malloc_sethook(RT_NULL);
+#endif
+
+    rt_free(bench_sample);
+}
+#ifdef FINSH_USING_MSH
+MSH_CMD_EXPORT(gps_bench, parser and pipeline benchmark: gps_bench [gps|multi|corrupt|all] [iterations]);
+#endif
@@ -0,0 +1,149 @@
+/*
+ * Copyright (c) 2020, RudyLo <luhuadong@163.com>
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ *
+ * Change Logs:
+ * Date           Author       Notes
+ * 2026-10-19     luhuadong    the first version
+ */
+
+#include <rtthread.h>
+#include <stdlib.h>
+#include "gps_fence.h"
+
+#define BENCH_FIXES          20000
+#define BENCH_SIDES          8
+#define BENCH_AREA           5000000   /* 0.5 degree square, 1e-7 degree */
+#define BENCH_RADIUS         20000     /* ~200 m */
+
+/* sin/cos of k * 45 degree, Q14 */
+static const rt_int16_t octagon[BENCH_SIDES][2] =
+{
+    { 16384, 0 }, { 11585, 11585 }, { 0, 16384 }, { -11585, 11585 },
+    { -16384, 0 }, { -11585, -11585 }, { 0, -16384 }, { 11585, -11585 },
+};
+
+static rt_uint32_t bench_seed = 1;
+
+static rt_uint32_t bench_rand(void)
+{
+    /* xorshift32, reproducible across targets */
+    bench_seed ^= bench_seed << 13;
+    bench_seed ^= bench_seed >> 17;
+    bench_seed ^= bench_seed << 5;
+
+    return bench_seed;
+}
+
+static rt_uint32_t bench_events;
+
+static void bench_handler(struct gps_fence_engine *engine, const struct gps_fence *fence,
+                          enum gps_fence_event event, void *user_data)
+{
+    bench_events++;
+}
+
+static void bench_run(rt_uint16_t num, rt_uint16_t grid)
+{
+    struct gps_fence_engine engine;
+    struct gps_fence *fence = RT_NULL;
+    coord_fixed_t *vertex = RT_NULL;
+    coord_fixed_t *fix = RT_NULL;
+    void *index = RT_NULL;
+    rt_size_t size;
+    rt_uint16_t i, k;
+    rt_uint32_t n;
+
+    bench_seed = 1;
+    bench_events = 0;
+
+    fence = rt_calloc(num, sizeof(struct gps_fence));
+    vertex = rt_calloc((rt_uint32_t)num * BENCH_SIDES, sizeof(coord_fixed_t));
+    fix = rt_calloc(BENCH_FIXES, sizeof(coord_fixed_t));
+    if (!fence || !vertex || !fix)
+    {
+        rt_kprintf("No memory for %d fences\n", num);
+        goto __exit;
+    }
+
+    for (i = 0; i < num; i++)
+    {
+        rt_int32_t cx = 1214000000 + (rt_int32_t)(bench_rand() % BENCH_AREA);
+        rt_int32_t cy = 312000000 + (rt_int32_t)(bench_rand() % BENCH_AREA);
+        coord_fixed_t *v = &vertex[(rt_uint32_t)i * BENCH_SIDES];
+
+        for (k = 0; k < BENCH_SIDES; k++)
+        {
+            v[k].lon = cx + (BENCH_RADIUS * octagon[k][0]) / 16384;
+            v[k].lat = cy + (BENCH_RADIUS * octagon[k][1]) / 16384;
+        }
+
+        fence[i].id = i;
+        fence[i].dwell = 60;
+        fence[i].count = BENCH_SIDES;
+        fence[i].vertex = v;
+        gps_fence_calc_bbox(&fence[i]);
+    }
+
+    for (n = 0; n < BENCH_FIXES; n++)
+    {
+        fix[n].lon = 1214000000 + (rt_int32_t)(bench_rand() % BENCH_AREA);
+        fix[n].lat = 312000000 + (rt_int32_t)(bench_rand() % BENCH_AREA);
+    }
+
+    size = gps_fence_index_size(fence, num, grid, grid);
+    index = size ? rt_malloc(size) : RT_NULL;
+    if (index == RT_NULL || gps_fence_init(&engine, fence, num, grid, grid, index, size) != RT_EOK)
+    {
+        rt_kprintf("Can't build index for %d fences on %dx%d grid\n", num, grid, grid);
+        goto __exit;
+    }
+    gps_fence_set_handler(&engine, bench_handler, RT_NULL);
+
+    rt_tick_t start = rt_tick_get();
+    for (n = 0; n < BENCH_FIXES; n++)
+    {
+        gps_fence_update(&engine, &fix[n], (rt_tick_t)n * (RT_TICK_PER_SECOND / 10));
+    }
+    rt_tick_t elapsed = rt_tick_get() - start;
+
+    if (elapsed == 0)
+        elapsed = 1;
+
+    rt_kprintf("%5d fences  %3dx%-3d grid  %6d B index  %8d fix/s  %3d.%02d tested/fix  %d events\n",
+               num, grid, grid, (int)size,
+               (int)((rt_uint64_t)BENCH_FIXES * RT_TICK_PER_SECOND / elapsed),
+               (int)(engine.candidates / BENCH_FIXES), (int)(engine.candidates * 100 / BENCH_FIXES % 100),
+               (int)bench_events);
+
+__exit:
+    if (index)  rt_free(index);
+    if (fix)    rt_free(fix);
+    if (vertex) rt_free(vertex);
+    if (fence)  rt_free(fence);
+}
+
+/* gps_fence_bench [max_fences] [grid] */
+static void gps_fence_bench(int argc, char **argv)
+{
+    rt_uint16_t max = (argc > 1) ? atoi(argv[1]) : 1024;
+    rt_uint16_t grid = (argc > 2) ? atoi(argv[2]) : 0;
+    rt_uint16_t num;
+
+    rt_kprintf("Geofence benchmark, %d random fixes per run\n", BENCH_FIXES);
+
+    for (num = 16; num && num <= max; num *= 2)
+    {
+        /* default grid keeps about one fence per cell */
+        rt_uint16_t g = grid;
+
+        if (g == 0)
+            for (g = 1; (rt_uint32_t)g * g < num; g *= 2);
+
+        bench_run(num, g);
+    }
+}
+#ifdef FINSH_USING_MSH
+MSH_CMD_EXPORT(gps_fence_bench, geofence fixes per second against fence count);
+#endif
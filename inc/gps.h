@@ -14,10 +14,35 @@
 #include <rtthread.h>
 #include <rtdevice.h>
 #include <sensor.h>
+#include "gps_line.h"
 
 #define GPSLIB_VERSION       "0.0.1"
 
 #define GPS_READ_WAIT_TIME   10000
+#define GPS_ACK_WAIT_TIME    1000
+#define GPS_NMEA_LINE_SIZE   96    /* NMEA-0183 allows 82 characters */
+
+#ifndef GPS_STAGE_MAX
+#define GPS_STAGE_MAX        4
+#endif
+#ifndef GPS_SUBSCRIBER_MAX
+#define GPS_SUBSCRIBER_MAX   4
+#endif
+#ifndef GPS_DEVICE_MAX
+#define GPS_DEVICE_MAX       8     /* receivers served by the dispatcher, 32 at most */
+#endif
+#ifndef GPS_DISPATCH_THREADS
+#define GPS_DISPATCH_THREADS 1     /* more only pay off on SMP */
+#endif
+#ifndef GPS_CYCLES_HZ
+#if defined(__ARM_ARCH_7M__) || defined(__ARM_ARCH_7EM__)
+#define GPS_CYCLES_HZ        72000000      /* gps_cycles_get() frequency, the core clock */
+#elif defined(__linux__)
+#define GPS_CYCLES_HZ        1000000000
+#else
+#define GPS_CYCLES_HZ        1000000       /* gps_time_us() fallback */
+#endif
+#endif
 
 struct gnrmc
 {
@@ -39,6 +64,67 @@ struct coord
 };
 typedef struct coord coord_t;
 
+/* fixed-point coordinates for targets without FPU, 1e-7 degree */
+struct coord_fixed
+{
+    rt_int32_t lon;
+    rt_int32_t lat;
+};
+typedef struct coord_fixed coord_fixed_t;
+
+#define GPS_DEG2FIXED(deg)   ((rt_int32_t)((deg) * 1e7 + (((deg) < 0) ? -0.5 : 0.5)))
+#define GPS_FIXED2DEG(fix)   ((double)(fix) * 1e-7)
+
+/* angle units and the flat-earth scale of the mean sphere */
+#define GPS_EARTH_RADIUS     6371008.8   /* mean radius, metres */
+#define GPS_DEG2RAD          (3.14159265358979323846 / 180.0)
+#define GPS_RAD2DEG          (180.0 / 3.14159265358979323846)
+#define GPS_M_PER_DEG        (GPS_EARTH_RADIUS * GPS_DEG2RAD)   /* metres per degree of latitude */
+
+/* receiver error model, see gps_fix_sigma() */
+#define GPS_UERE             4.0f        /* metres, user equivalent range error */
+#define GPS_HDOP_DEFAULT     2.0f        /* for fixes without GSA/GGA dilution */
+#define GPS_SATS_GOOD        6           /* fewer satellites make HDOP optimistic */
+
+/* gps_fix.flags, set by processing stages */
+#define GPS_FIX_FLAG_SUSPECT 0x01    /* failed a quality gate rule */
+#define GPS_FIX_FLAG_TIMED   0x02    /* time holds the receiver's UTC, 0 is midnight */
+
+/* one navigation epoch assembled from the receiver's NMEA sentences */
+struct gps_fix
+{
+    double      lat;       /* decimal degrees, north positive */
+    double      lon;       /* decimal degrees, east positive */
+    float       alt;       /* metres above mean sea level */
+    float       speed;     /* speed over ground, m/s */
+    float       course;    /* course over ground, degrees from true north */
+    float       hdop;
+    float       pdop;
+    rt_uint8_t  sats;      /* satellites in use */
+    rt_uint8_t  quality;   /* GGA fix quality, 0: invalid */
+    rt_uint8_t  mode;      /* GSA fix mode, 1: none, 2: 2D, 3: 3D */
+    rt_uint8_t  status;    /* 1: RMC 'A', 0: RMC 'V' */
+    rt_uint8_t  flags;     /* GPS_FIX_FLAG_* */
+    rt_uint32_t date;      /* UTC date, ddmmyy */
+    rt_uint32_t time;      /* UTC time of day, milliseconds */
+    rt_tick_t   tick;      /* local tick when the epoch completed */
+    rt_uint32_t latency;   /* us from the epoch to its first byte, 0 if unknown */
+    rt_uint64_t rx_us;     /* line_us of the epoch's first sentence, see gps_device */
+    rt_uint64_t epoch_us;  /* gps_time_us() of the epoch itself, 0 if unknown */
+};
+typedef struct gps_fix gps_fix_t;
+
+/* 1-sigma horizontal position error of a fix, uere * HDOP inflated for few satellites */
+rt_inline float gps_fix_sigma(const gps_fix_t *fix, float uere)
+{
+    float sigma = uere * ((fix->hdop > 0.0f) ? fix->hdop : GPS_HDOP_DEFAULT);
+
+    if (fix->sats && fix->sats < GPS_SATS_GOOD)
+        sigma *= (float)GPS_SATS_GOOD / fix->sats;
+
+    return sigma;
+}
+
 struct dms
 {
     int degrees;
@@ -52,61 +138,186 @@ struct gps_response
 };
 typedef struct gps_response *gps_response_t;
 
+struct gps_device;
+struct gps_epoch;
+
+/* parser state other threads ask the dispatcher to reset, it owns it */
+#define GPS_REQUEST_RELEARN   0x01  /* forget the learned epoch sentence set */
+#define GPS_REQUEST_RESYNC    0x02  /* drop the partial sentence */
+
+/*
+ * A stage runs in the dispatcher thread on every assembled fix before it
+ * is published, in registration order. It may rewrite the fix. Returning
+ * GPS_STAGE_SUPPRESS keeps the fix as the last fix and wakes gps_read(),
+ * but skips the later stages and the subscribers; any other return than
+ * RT_EOK drops it.
+ */
+#define GPS_STAGE_SUPPRESS    1
+
+typedef rt_err_t (*gps_stage_t)(struct gps_device *dev, gps_fix_t *fix, void *user_data);
+/* a subscriber is called from the dispatcher thread with every published fix */
+typedef void (*gps_subscriber_t)(struct gps_device *dev, const gps_fix_t *fix, void *user_data);
+
+struct gps_stage_node
+{
+    gps_stage_t      stage;
+    void            *user_data;
+};
+
+struct gps_subscriber_node
+{
+    gps_subscriber_t subscriber;
+    void            *user_data;
+};
+
 struct gps_device
 {
     rt_device_t  serial;
-    struct rt_ringbuffer *rx_fifo;
 
-#ifdef PKG_USING_GPS_UART_DMA
-    rt_mailbox_t rx_mb;
-#else
-    rt_sem_t     rx_sem;
+    /* dispatcher registration, the device is bit 'slot' of the receive event */
+    rt_uint8_t   slot;
+    volatile rt_bool_t busy;       /* a dispatcher thread is draining the UART */
+    volatile rt_bool_t pending;    /* data arrived meanwhile, drain again */
+    volatile rt_uint8_t request;   /* GPS_REQUEST_* for the dispatcher */
+    volatile rt_bool_t idle_wait;  /* gps_detach() waits on idle_sem */
+#ifdef PKG_USING_GPS_INIT_ASYN
+    struct rt_timer init_timer;
+    volatile rt_bool_t init_running;   /* the timer callback reads the device */
+    volatile rt_bool_t init_cancel;
 #endif
+
+    /* IPC objects live in the device, the handles below point at them */
+    struct rt_semaphore ack_sem;
+    struct rt_semaphore fix_sem;
+    struct rt_semaphore deliver_sem;
+    struct rt_semaphore idle_sem;  /* the dispatcher and the init timer let go */
+    struct rt_mutex lock_obj;
+
     rt_sem_t     tx_done;
     rt_sem_t     ack;
-    rt_thread_t  rx_tid;
 
     struct gps_response resp;
 
     rt_mutex_t   lock;
     rt_uint8_t   version;
+
+    /* received bytes, shared by the parser and gps_line readers */
+    struct gps_line_buf rx_buf;
+
+    /*
+     * Sentence assembly. rx_us is stamped by the UART receive indication,
+     * and a sentence's line_us is the rx_us current when its '$' is parsed.
+     * With an interrupt per byte that is within a byte time of the '$';
+     * with DMA or idle-line reception the indication comes per block, so
+     * line_us can be up to one block late, or early by the bytes that
+     * arrived between the indication and the drain. Threads read rx_us
+     * with interrupts off, a 64-bit load tears on a 32-bit core.
+     */
+    char        *line;
+    rt_size_t    line_len;
+    rt_uint64_t  line_us;          /* rx_us when the current sentence started */
+    volatile rt_uint64_t rx_us;    /* the last receive indication */
+    struct gps_epoch *epoch;
+
+    /* PMTK001 acknowledge of the pending command */
+    rt_int32_t   ack_cmd;
+    rt_int32_t   ack_flag;
+
+    /* fix publishing */
+    gps_fix_t    last_fix;
+    rt_sem_t     fix_notice;
+    struct gps_stage_node stage[GPS_STAGE_MAX];
+    struct gps_subscriber_node subscriber[GPS_SUBSCRIBER_MAX];
+    rt_uint8_t   stage_num;
+    rt_uint8_t   subscriber_num;
+    rt_uint8_t   delivering;       /* publishers walking a subscriber snapshot */
+    rt_uint8_t   deliver_waiters;  /* unsubscribers waiting on deliver_sem */
+
+    /* statistics */
+    rt_uint32_t  sentences;
+    rt_uint32_t  bad_checksum;
+    rt_uint32_t  overflow;
+    rt_uint32_t  fixes;
+    rt_uint32_t  suppressed;
+    rt_uint32_t  dropped;
 };
 typedef struct gps_device *gps_device_t;
 
-struct gps_client
-{
-    rt_device_t  device;
-
-    gps_status_t status;
-    char end_sign;
+typedef void (*gps_epoch_handler_t)(struct gps_epoch *epoch, gps_fix_t *fix, void *user_data);
 
-    /* the current received one line data buffer */
-    char *recv_line_buf;
-    /* The length of the currently received one line data */
-    rt_size_t recv_line_len;
-    /* The maximum supported receive data length */
-    rt_size_t recv_bufsz;
-    rt_sem_t rx_notice;
-    rt_mutex_t lock;
+/*
+ * Epoch assembler. Sentences are merged into one fix until the UTC time
+ * changes. The sentence types present in both of the last two epochs are
+ * learned, and later epochs complete as soon as that set has arrived
+ * instead of waiting for the next epoch's first sentence. A learned type
+ * missing from two epochs in a row drops out of the set, so types the
+ * receiver sends only every few epochs (GSV at a PMTK314 divisor) never
+ * hold an epoch back while one corrupted sentence does not change it.
+ *
+ * A sentence stamped with the time of the epoch already published came
+ * after it completed; it is dropped and its type learned, so an epoch is
+ * never published twice.
+ */
+struct gps_epoch
+{
+    gps_fix_t           fix;
+    rt_uint32_t         mask;      /* sentence types seen in this epoch */
+    rt_uint32_t         learned;   /* sentence types of a complete epoch */
+    rt_uint32_t         last_mask; /* sentence types of the previous epoch */
+    rt_bool_t           timed;     /* fix.time is valid */
+    rt_bool_t           published; /* last_time is valid */
+    rt_uint32_t         last_time; /* UTC time of the last published epoch */
+    rt_uint64_t         line_us;   /* arrival of the sentence being fed, set by the caller */
 
-    rt_sem_t resp_notice;
-    rt_size_t urc_table_size;
+    gps_epoch_handler_t handler;
+    void               *user_data;
 
-    rt_thread_t parser;
+    rt_uint32_t         epochs;
+    rt_uint32_t         late;      /* sentences dropped after their epoch was published */
 };
-typedef struct gps_client *gps_client_t;
+typedef struct gps_epoch *gps_epoch_t;
 
+/*
+ * Everything one receiver needs. gps_create() allocates it in one block;
+ * gps_init() takes it from the caller, e.g. a static variable, so the
+ * driver runs without heap:
+ *
+ *     static struct gps_device_storage gps0;
+ *     gps_init(&gps0, "uart2");
+ *     gps_device_t dev = &gps0.device;
+ */
+struct gps_device_storage
+{
+    struct gps_device   device;
+    char                line[GPS_NMEA_LINE_SIZE];
+    struct gps_epoch    epoch;
+    char                rx_data[GPS_LINE_BUF_SIZE];
+};
 
 gps_device_t gps_create(const char *uart_name);
 void         gps_delete(gps_device_t dev);
+rt_err_t     gps_init(struct gps_device_storage *storage, const char *uart_name);
+void         gps_detach(gps_device_t dev);
+void         gps_footprint(void);
+gps_device_t gps_find(const char *uart_name);
 
 rt_err_t     gps_send_command(gps_device_t dev, const char *data);
+rt_err_t     gps_set_rate(gps_device_t dev, rt_uint32_t interval);
+rt_err_t     gps_set_output(gps_device_t dev, const char *plan);
+rt_err_t     gps_set_baudrate(gps_device_t dev, rt_uint32_t baudrate);
 rt_uint16_t  gps_read(gps_device_t dev, void *buf, rt_uint16_t size, rt_int32_t time);
 rt_uint16_t  gps_wait(gps_device_t dev, void *buf, rt_uint16_t size);
 GNRMC_t      gps_gat_gnrmc(gps_device_t dev);
 
 rt_bool_t    gps_is_ready(gps_device_t dev);
 
+void         gps_feed(gps_device_t dev, const char *data, rt_size_t size);
+rt_err_t     gps_add_stage(gps_device_t dev, gps_stage_t stage, void *user_data);
+rt_err_t     gps_subscribe(gps_device_t dev, gps_subscriber_t subscriber, void *user_data);
+rt_err_t     gps_unsubscribe(gps_device_t dev, gps_subscriber_t subscriber, void *user_data);
+rt_uint32_t  gps_cycles_get(void);
+rt_uint64_t  gps_time_us(void);
+
 void         gps_show_response(gps_response_t resp);
 void         gps_dump(const char *buf, rt_uint16_t size);
 
@@ -0,0 +1,103 @@
+/*
+ * Copyright (c) 2020, RudyLo <luhuadong@163.com>
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ *
+ * Change Logs:
+ * Date           Author       Notes
+ * 2026-10-19     luhuadong    the first version
+ */
+
+#ifndef __GPS_BARRIER_H__
+#define __GPS_BARRIER_H__
+
+#include <rtthread.h>
+
+/*
+ * Memory barriers for the lock-free paths. They order accesses for other
+ * cores and weakly ordered memory too, not only in the compiler.
+ */
+#if defined(__GNUC__) || defined(__clang__)
+#define gps_rmb()            __atomic_thread_fence(__ATOMIC_ACQUIRE)
+#define gps_wmb()            __atomic_thread_fence(__ATOMIC_RELEASE)
+#define gps_mb()             __atomic_thread_fence(__ATOMIC_SEQ_CST)
+#elif defined(__CC_ARM)
+#define gps_rmb()            __dmb(0xF)
+#define gps_wmb()            __dmb(0xF)
+#define gps_mb()             __dmb(0xF)
+#else
+#error "gps_barrier.h: no memory barrier for this compiler"
+#endif
+
+/*
+ * Relaxed atomics for statistics, gps_atomic_add() returns the new value.
+ * ARMv6-M has no exclusive access, there the interrupt lock is used.
+ */
+#if (defined(__GNUC__) || defined(__clang__)) && !defined(__ARM_ARCH_6M__)
+rt_inline rt_uint32_t gps_atomic_add(volatile rt_uint32_t *ptr, rt_uint32_t v)
+{
+    return __atomic_add_fetch(ptr, v, __ATOMIC_RELAXED);
+}
+
+rt_inline void gps_atomic_max(volatile rt_uint32_t *ptr, rt_uint32_t v)
+{
+    rt_uint32_t cur = __atomic_load_n(ptr, __ATOMIC_RELAXED);
+
+    while (v > cur && !__atomic_compare_exchange_n(ptr, &cur, v, RT_TRUE, __ATOMIC_RELAXED, __ATOMIC_RELAXED))
+        ;
+}
+#else
+rt_inline rt_uint32_t gps_atomic_add(volatile rt_uint32_t *ptr, rt_uint32_t v)
+{
+    rt_base_t level = rt_hw_interrupt_disable();
+    rt_uint32_t val = *ptr + v;
+
+    *ptr = val;
+    rt_hw_interrupt_enable(level);
+
+    return val;
+}
+
+rt_inline void gps_atomic_max(volatile rt_uint32_t *ptr, rt_uint32_t v)
+{
+    rt_base_t level = rt_hw_interrupt_disable();
+
+    if (v > *ptr) *ptr = v;
+    rt_hw_interrupt_enable(level);
+}
+#endif
+
+/*
+ * Sequence count for one writer and lock-free readers. The writer makes
+ * the count odd, changes the data and makes it even again; a reader
+ * copies the data and retries if the count was odd or has moved.
+ */
+rt_inline void gps_seq_write_begin(volatile rt_uint32_t *seq)
+{
+    *seq = *seq + 1;
+    gps_wmb();
+}
+
+rt_inline void gps_seq_write_end(volatile rt_uint32_t *seq)
+{
+    gps_wmb();
+    *seq = *seq + 1;
+}
+
+rt_inline rt_uint32_t gps_seq_read_begin(const volatile rt_uint32_t *seq)
+{
+    rt_uint32_t start = *seq;
+
+    gps_rmb();
+
+    return start;
+}
+
+rt_inline rt_bool_t gps_seq_read_retry(const volatile rt_uint32_t *seq, rt_uint32_t start)
+{
+    gps_rmb();
+
+    return ((start & 1) || *seq != start) ? RT_TRUE : RT_FALSE;
+}
+
+#endif /* __GPS_BARRIER_H__ */
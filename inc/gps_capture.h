@@ -0,0 +1,97 @@
+/*
+ * Copyright (c) 2020, RudyLo <luhuadong@163.com>
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ *
+ * Change Logs:
+ * Date           Author       Notes
+ * 2026-10-19     luhuadong    the first version
+ */
+
+#ifndef __GPS_CAPTURE_H__
+#define __GPS_CAPTURE_H__
+
+#include "gps.h"
+#include "gps_dbuf.h"
+
+#ifndef GPS_CAPTURE_BUF_SIZE
+#define GPS_CAPTURE_BUF_SIZE   2048    /* bytes per write, two are used */
+#endif
+#ifndef GPS_REPLAY_CHUNK_MAX
+#define GPS_REPLAY_CHUNK_MAX   256     /* bytes handed to the driver at once */
+#endif
+
+#define GPS_CAPTURE_MAGIC      0x50414347  /* "GCAP" */
+#define GPS_CAPTURE_VERSION    1
+#define GPS_CAPTURE_HEADER_SIZE 16
+#define GPS_CAPTURE_RECORD_SIZE 6
+
+/*
+ * Capture file, little-endian:
+ *
+ *   header: u32 magic, u16 version, u16 reserved, u64 gps_time_us() at start
+ *   record: u32 us since the previous record, u16 len, len bytes as received
+ *
+ * The capture is a reader of the device's receive ring. Its thread runs
+ * above the dispatcher, so a record is normally one UART read, stamped
+ * when the thread took it from the ring.
+ */
+struct gps_capture
+{
+    gps_device_t dev;
+    int          fd;
+    struct gps_line_reader reader;
+    rt_thread_t  tid;            /* takes chunks from the ring */
+    volatile rt_bool_t stop;
+    struct rt_semaphore exited;
+
+    rt_uint8_t   buf[2][GPS_CAPTURE_BUF_SIZE];
+    struct gps_dbuf out;
+    rt_uint32_t  fill_bytes;     /* chunk bytes in the buffer being filled */
+    rt_uint64_t  last_us;        /* stamp of the last record */
+    rt_uint64_t  fill_us;        /* last_us when the buffer being filled began */
+
+    /* statistics */
+    rt_uint32_t  chunks;
+    rt_uint32_t  bytes;
+    rt_uint32_t  lost;           /* bytes in buffers the writer had no room for */
+    rt_uint32_t  errors;
+};                               /* ring bytes lost are counted in reader.lost */
+typedef struct gps_capture *gps_capture_t;
+
+/*
+ * Virtual serial device playing a capture back. gps_init() opens it by
+ * name like a UART; playback starts on open. Each chunk waits until the
+ * driver has read the previous one, so every run feeds the parser the
+ * same chunks in the same order whatever the speed.
+ */
+struct gps_replay
+{
+    struct rt_device parent;
+    int          fd;
+    float        speed;          /* 1: real time, N: N times faster, 0: as fast as possible */
+
+    rt_uint8_t   chunk[GPS_REPLAY_CHUNK_MAX];
+    volatile rt_uint16_t len;
+    volatile rt_uint16_t pos;
+    struct rt_semaphore drained;
+    struct rt_semaphore finished;  /* gps_replay_wait() */
+    struct rt_semaphore exited;    /* gps_replay_detach() */
+    rt_thread_t  tid;
+    volatile rt_bool_t stop;
+
+    /* statistics */
+    rt_uint32_t  chunks;
+    rt_uint32_t  bytes;
+    rt_uint32_t  written;        /* command bytes the driver sent, discarded */
+};
+typedef struct gps_replay *gps_replay_t;
+
+rt_err_t gps_capture_start(gps_capture_t cap, gps_device_t dev, const char *path);
+void     gps_capture_stop(gps_capture_t cap);
+
+rt_err_t gps_replay_init(gps_replay_t replay, const char *name, const char *path, float speed);
+rt_err_t gps_replay_wait(gps_replay_t replay, rt_int32_t timeout);
+void     gps_replay_detach(gps_replay_t replay);
+
+#endif /* __GPS_CAPTURE_H__ */
@@ -0,0 +1,74 @@
+/*
+ * Copyright (c) 2020, RudyLo <luhuadong@163.com>
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ *
+ * Change Logs:
+ * Date           Author       Notes
+ * 2026-10-19     luhuadong    the first version
+ */
+
+#ifndef __GPS_DBUF_H__
+#define __GPS_DBUF_H__
+
+#include <rtthread.h>
+
+/* little-endian fields of the binary log and capture formats */
+rt_inline void gps_put_u16(rt_uint8_t *p, rt_uint16_t v)
+{
+    p[0] = (rt_uint8_t)v;
+    p[1] = (rt_uint8_t)(v >> 8);
+}
+
+rt_inline void gps_put_u32(rt_uint8_t *p, rt_uint32_t v)
+{
+    gps_put_u16(p, (rt_uint16_t)v);
+    gps_put_u16(p + 2, (rt_uint16_t)(v >> 16));
+}
+
+rt_inline rt_uint16_t gps_get_u16(const rt_uint8_t *p)
+{
+    return (rt_uint16_t)(p[0] | (p[1] << 8));
+}
+
+rt_inline rt_uint32_t gps_get_u32(const rt_uint8_t *p)
+{
+    return gps_get_u16(p) | ((rt_uint32_t)gps_get_u16(p + 2) << 16);
+}
+
+typedef void (*gps_dbuf_write_t)(void *ctx, const rt_uint8_t *data, rt_size_t len);
+
+/*
+ * Double-buffered writer. The producer fills one buffer while a writer
+ * thread writes the other out, so it never waits for storage. When the
+ * writer still has the other buffer, a submitted buffer is dropped.
+ * Without gps_dbuf_start() buffers are written by the submitting thread.
+ */
+struct gps_dbuf
+{
+    rt_uint8_t         *buf[2];
+    rt_size_t           len[2];
+    rt_size_t           size;
+    rt_uint8_t          fill;          /* buffer being filled */
+    volatile rt_uint8_t full;          /* bit n: buffer n waits for the writer */
+    volatile rt_bool_t  quit;
+
+    gps_dbuf_write_t    write;
+    void               *ctx;
+
+    struct rt_semaphore ready;         /* a buffer was submitted */
+    struct rt_semaphore done;          /* the writer emptied a buffer or exited */
+    rt_thread_t         writer;
+
+    /* statistics */
+    rt_uint32_t         dropped;       /* buffers lost because the writer lagged */
+};
+typedef struct gps_dbuf *gps_dbuf_t;
+
+void     gps_dbuf_init(gps_dbuf_t db, void *storage, rt_size_t size, gps_dbuf_write_t write, void *ctx);
+rt_err_t gps_dbuf_start(gps_dbuf_t db, const char *name, rt_uint8_t priority);
+rt_err_t gps_dbuf_submit(gps_dbuf_t db);
+void     gps_dbuf_flush(gps_dbuf_t db);
+void     gps_dbuf_detach(gps_dbuf_t db);
+
+#endif /* __GPS_DBUF_H__ */
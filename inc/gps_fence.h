@@ -0,0 +1,95 @@
+/*
+ * Copyright (c) 2020, RudyLo <luhuadong@163.com>
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ *
+ * Change Logs:
+ * Date           Author       Notes
+ * 2026-10-19     luhuadong    the first version
+ */
+
+#ifndef __GPS_FENCE_H__
+#define __GPS_FENCE_H__
+
+#include "gps.h"
+
+/* fences a fix can be inside at the same time */
+#ifndef GPS_FENCE_ACTIVE_MAX
+#define GPS_FENCE_ACTIVE_MAX     8
+#endif
+
+/*
+ * A polygon fence. Keep the tables const so they stay in flash, the
+ * engine only reads them. Vertices are in 1e-7 degree, the polygon is
+ * implicitly closed and must not cross the antimeridian. The bounding box
+ * is part of the record so it costs no RAM, fill it offline or with
+ * gps_fence_calc_bbox() for fences built at run time.
+ */
+struct gps_fence
+{
+    rt_uint32_t          id;
+    rt_uint16_t          dwell;     /* seconds inside before GPS_FENCE_DWELL, 0: never */
+    rt_uint16_t          count;     /* number of vertices */
+    coord_fixed_t        min;       /* bounding box */
+    coord_fixed_t        max;
+    const coord_fixed_t *vertex;
+};
+
+enum gps_fence_event
+{
+    GPS_FENCE_ENTER = 0,
+    GPS_FENCE_EXIT,
+    GPS_FENCE_DWELL,
+};
+
+struct gps_fence_engine;
+typedef void (*gps_fence_handler_t)(struct gps_fence_engine *engine, const struct gps_fence *fence,
+                                    enum gps_fence_event event, void *user_data);
+
+struct gps_fence_active
+{
+    rt_uint16_t index;     /* index into the fence table */
+    rt_uint8_t  dwelled;
+    rt_tick_t   enter;
+};
+
+struct gps_fence_engine
+{
+    const struct gps_fence *fence;
+    rt_uint16_t             fence_num;
+
+    /* uniform grid, cell_start[cols * rows + 1] offsets into cell_list */
+    coord_fixed_t           origin;
+    rt_int32_t              cell_w;
+    rt_int32_t              cell_h;
+    rt_uint16_t             cols;
+    rt_uint16_t             rows;
+    rt_uint16_t            *cell_start;
+    rt_uint16_t            *cell_list;
+
+    struct gps_fence_active active[GPS_FENCE_ACTIVE_MAX];
+    rt_uint8_t              active_num;
+
+    gps_fence_handler_t     handler;
+    void                   *user_data;
+
+    /* statistics */
+    rt_uint32_t             updates;
+    rt_uint32_t             candidates;   /* polygons tested */
+    rt_uint32_t             overflow;     /* inside more than GPS_FENCE_ACTIVE_MAX fences */
+};
+typedef struct gps_fence_engine *gps_fence_engine_t;
+
+void      gps_fence_calc_bbox(struct gps_fence *fence);
+rt_bool_t gps_fence_contains(const struct gps_fence *fence, const coord_fixed_t *pos);
+
+rt_size_t gps_fence_index_size(const struct gps_fence *fence, rt_uint16_t num,
+                               rt_uint16_t cols, rt_uint16_t rows);
+rt_err_t  gps_fence_init(gps_fence_engine_t engine, const struct gps_fence *fence, rt_uint16_t num,
+                         rt_uint16_t cols, rt_uint16_t rows, void *buf, rt_size_t size);
+void      gps_fence_set_handler(gps_fence_engine_t engine, gps_fence_handler_t handler, void *user_data);
+rt_size_t gps_fence_update(gps_fence_engine_t engine, const coord_fixed_t *pos, rt_tick_t tick);
+rt_size_t gps_fence_update_fix(gps_fence_engine_t engine, const gps_fix_t *fix);
+void      gps_fence_reset(gps_fence_engine_t engine);
+
+#endif /* __GPS_FENCE_H__ */
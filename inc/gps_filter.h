@@ -0,0 +1,89 @@
+/*
+ * Copyright (c) 2020, RudyLo <luhuadong@163.com>
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ *
+ * Change Logs:
+ * Date           Author       Notes
+ * 2026-10-19     luhuadong    the first version
+ */
+
+#ifndef __GPS_FILTER_H__
+#define __GPS_FILTER_H__
+
+#include "gps.h"
+#include "gps_proj.h"
+
+#ifdef PKG_GPS_FILTER_USING_CMSIS_DSP
+#include <arm_math.h>
+typedef arm_matrix_instance_f32 gps_mat_t;
+#else
+/* layout compatible with arm_matrix_instance_f32 */
+struct gps_mat
+{
+    rt_uint16_t numRows;
+    rt_uint16_t numCols;
+    float      *pData;
+};
+typedef struct gps_mat gps_mat_t;
+#endif
+
+#define GPS_FILTER_STATE_MAX      6     /* e, n, ve, vn, ae, an */
+#define GPS_FILTER_MEAS_MAX       4     /* e, n, ve, vn */
+
+#define GPS_FILTER_UERE           GPS_UERE
+#define GPS_FILTER_MAX_GAP        10000 /* milliseconds without fix before reset */
+#define GPS_FILTER_REANCHOR       5000.0f /* metres from origin before re-anchoring */
+
+enum gps_filter_model
+{
+    GPS_FILTER_CV = 0,    /* constant velocity, white noise acceleration */
+    GPS_FILTER_CA,        /* constant acceleration, white noise jerk */
+};
+
+/*
+ * Kalman position/velocity filter. The state lives in an ENU plane
+ * anchored near the track so the matrices stay in single precision; all
+ * storage is part of the structure.
+ */
+struct gps_filter
+{
+    enum gps_filter_model model;
+    rt_uint8_t  states;           /* 4 for CV, 6 for CA */
+    rt_bool_t   started;
+
+    float       noise;            /* process noise, m/s^2 (CV) or m/s^3 (CA) */
+    float       uere;             /* metres, scaled by HDOP */
+    rt_uint32_t max_gap;          /* milliseconds */
+
+    struct gps_proj proj;
+    rt_uint32_t last_time;        /* UTC ms of day of the last update */
+
+    float x[GPS_FILTER_STATE_MAX];
+    float P[GPS_FILTER_STATE_MAX * GPS_FILTER_STATE_MAX];
+    float F[GPS_FILTER_STATE_MAX * GPS_FILTER_STATE_MAX];
+    float Q[GPS_FILTER_STATE_MAX * GPS_FILTER_STATE_MAX];
+    float H[GPS_FILTER_MEAS_MAX * GPS_FILTER_STATE_MAX];
+    float R[GPS_FILTER_MEAS_MAX * GPS_FILTER_MEAS_MAX];
+    float S[GPS_FILTER_MEAS_MAX * GPS_FILTER_MEAS_MAX];
+    float Si[GPS_FILTER_MEAS_MAX * GPS_FILTER_MEAS_MAX];
+    float K[GPS_FILTER_STATE_MAX * GPS_FILTER_MEAS_MAX];
+    float T1[GPS_FILTER_STATE_MAX * GPS_FILTER_STATE_MAX];
+    float T2[GPS_FILTER_STATE_MAX * GPS_FILTER_STATE_MAX];
+    float y[GPS_FILTER_MEAS_MAX];
+
+    /* statistics */
+    rt_uint32_t updates;
+    rt_uint32_t resets;
+    rt_uint32_t cycles_last;
+    rt_uint32_t cycles_max;
+    rt_uint64_t cycles_total;
+};
+typedef struct gps_filter *gps_filter_t;
+
+void     gps_filter_init(gps_filter_t filter, enum gps_filter_model model, float noise);
+void     gps_filter_reset(gps_filter_t filter);
+rt_err_t gps_filter_update(gps_filter_t filter, gps_fix_t *fix);
+rt_err_t gps_filter_stage(gps_device_t dev, gps_fix_t *fix, void *user_data);
+
+#endif /* __GPS_FILTER_H__ */
@@ -0,0 +1,92 @@
+/*
+ * Copyright (c) 2020, RudyLo <luhuadong@163.com>
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ *
+ * Change Logs:
+ * Date           Author       Notes
+ * 2026-10-19     luhuadong    the first version
+ */
+
+#ifndef __GPS_FUSION_H__
+#define __GPS_FUSION_H__
+
+#include "gps.h"
+
+#ifndef GPS_FUSION_SOURCE_MAX
+#define GPS_FUSION_SOURCE_MAX     4     /* 8 at most, sources are bits of the masks */
+#endif
+
+struct gps_fusion_config
+{
+    float       uere;            /* m, receiver range error, sigma = uere * hdop */
+    float       gate;            /* residual in sigmas that marks a source inconsistent */
+    rt_uint32_t timeout;         /* ms without fixes before a source is not waited for */
+};
+
+/* consistency diagnostics of one fused epoch */
+struct gps_fusion_diag
+{
+    rt_uint8_t  sources;         /* sources that reported the epoch */
+    rt_uint8_t  used;            /* sources in the estimate */
+    rt_uint8_t  used_mask;       /* bit n: source n is in the estimate */
+    rt_uint8_t  outlier_mask;    /* bit n: source n was rejected as inconsistent */
+    float       spread;          /* m, the largest distance of a used source from the estimate */
+    float       residual;        /* the largest residual of a used source, in its sigmas */
+    float       sigma;           /* m, horizontal sigma of the estimate */
+};
+
+struct gps_fusion;
+typedef void (*gps_fusion_handler_t)(struct gps_fusion *fusion, const gps_fix_t *fix,
+                                     const struct gps_fusion_diag *diag, void *user_data);
+
+struct gps_fusion_source
+{
+    gps_device_t dev;
+    gps_fix_t    fix;            /* the fix of the pending epoch */
+    rt_bool_t    has_fix;
+    rt_tick_t    last_tick;      /* when the source was added or last reported */
+
+    /* statistics */
+    rt_uint32_t  fixes;
+    rt_uint32_t  used;
+    rt_uint32_t  outliers;
+    rt_uint32_t  late;
+    rt_uint32_t  untimed;        /* fixes without UTC time, e.g. during a cold start */
+};
+
+/*
+ * Multi-receiver fusion. Fixes are grouped by their UTC time of day; an
+ * epoch is fused as soon as every live source reported it, or when the
+ * next epoch starts, so a receiver that drops out costs one epoch of
+ * latency once and is not waited for after the timeout.
+ */
+struct gps_fusion
+{
+    struct gps_fusion_config cfg;
+    struct gps_fusion_source source[GPS_FUSION_SOURCE_MAX];
+    rt_uint8_t  source_num;
+
+    rt_uint32_t time;            /* ms of day of the pending epoch */
+    rt_bool_t   pending;
+    struct rt_mutex lock;
+
+    gps_fusion_handler_t handler;
+    void       *user_data;
+
+    /* statistics */
+    rt_uint32_t epochs;
+    rt_uint32_t partial;         /* epochs fused without every source */
+};
+typedef struct gps_fusion *gps_fusion_t;
+
+rt_err_t gps_fusion_init(gps_fusion_t fusion, const struct gps_fusion_config *cfg,
+                         gps_fusion_handler_t handler, void *user_data);
+void     gps_fusion_detach(gps_fusion_t fusion);
+rt_err_t gps_fusion_add(gps_fusion_t fusion, gps_device_t dev);
+rt_err_t gps_fusion_remove(gps_fusion_t fusion, gps_device_t dev);
+rt_err_t gps_fusion_input(gps_fusion_t fusion, gps_device_t dev, const gps_fix_t *fix);
+void     gps_fusion_flush(gps_fusion_t fusion);
+void     gps_fusion_subscriber(gps_device_t dev, const gps_fix_t *fix, void *user_data);
+
+#endif /* __GPS_FUSION_H__ */
@@ -0,0 +1,70 @@
+/*
+ * Copyright (c) 2020, RudyLo <luhuadong@163.com>
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ *
+ * Change Logs:
+ * Date           Author       Notes
+ * 2026-10-19     luhuadong    the first version
+ */
+
+#ifndef __GPS_GATE_H__
+#define __GPS_GATE_H__
+
+#include "gps.h"
+
+enum gps_gate_rule
+{
+    GPS_GATE_STATUS = 0,  /* RMC status 'V' or GGA quality 0 */
+    GPS_GATE_QUALITY,     /* GGA quality below quality_min */
+    GPS_GATE_MODE,        /* GSA fix mode below mode_min */
+    GPS_GATE_HDOP,
+    GPS_GATE_PDOP,
+    GPS_GATE_SATS,
+    GPS_GATE_SPEED,       /* implied speed from the last accepted fix */
+    GPS_GATE_ACCEL,       /* change of implied speed */
+    GPS_GATE_RULE_NUM,
+};
+
+#define GPS_GATE_BIT(rule)   (1UL << (rule))
+
+/* a zero limit disables its rule */
+struct gps_gate_config
+{
+    float       hdop_max;
+    float       pdop_max;
+    float       speed_max;     /* m/s */
+    float       accel_max;     /* m/s^2 */
+    rt_uint8_t  sats_min;
+    rt_uint8_t  quality_min;   /* 1: GPS, 2: DGPS, 4: RTK fixed ... */
+    rt_uint8_t  mode_min;      /* 2: 2D, 3: 3D */
+    rt_uint8_t  reseed;        /* motion rejections in a row before trusting the new position */
+    rt_bool_t   flag_only;     /* mark failing fixes GPS_FIX_FLAG_SUSPECT instead of dropping */
+};
+
+struct gps_gate
+{
+    struct gps_gate_config cfg;
+
+    /* the last accepted fix, reference for the motion rules */
+    double      ref_lat;
+    double      ref_lon;
+    rt_uint32_t ref_time;
+    float       ref_speed;     /* implied speed into the reference, m/s */
+    rt_bool_t   has_ref;
+    rt_uint8_t  motion_run;    /* motion rejections in a row */
+
+    /* statistics */
+    rt_uint32_t passed;
+    rt_uint32_t failed;
+    rt_uint32_t last_mask;     /* rules failed by the last fix */
+    rt_uint32_t count[GPS_GATE_RULE_NUM];
+};
+typedef struct gps_gate *gps_gate_t;
+
+void        gps_gate_init(gps_gate_t gate, const struct gps_gate_config *cfg);
+void        gps_gate_reset(gps_gate_t gate);
+rt_uint32_t gps_gate_check(gps_gate_t gate, const gps_fix_t *fix);
+rt_err_t    gps_gate_stage(gps_device_t dev, gps_fix_t *fix, void *user_data);
+
+#endif /* __GPS_GATE_H__ */
@@ -0,0 +1,39 @@
+/*
+ * Copyright (c) 2020, RudyLo <luhuadong@163.com>
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ *
+ * Change Logs:
+ * Date           Author       Notes
+ * 2026-10-19     luhuadong    the first version
+ */
+
+#ifndef __GPS_GEODESIC_H__
+#define __GPS_GEODESIC_H__
+
+#include "gps.h"
+
+enum gps_geodesic_method
+{
+    GPS_GEODESIC_EQUIRECT = 0,   /* flat earth, fast, good below ~10 km */
+    GPS_GEODESIC_HAVERSINE,      /* sphere, ~0.5% worst case */
+    GPS_GEODESIC_VINCENTY,       /* WGS-84 ellipsoid, sub-millimetre */
+};
+
+/* point to point */
+rt_err_t    gps_geodesic_inverse(const coord_t *from, const coord_t *to, enum gps_geodesic_method method,
+                                 double *distance, double *bearing);
+double      gps_distance(const coord_t *from, const coord_t *to, enum gps_geodesic_method method);
+double      gps_bearing(const coord_t *from, const coord_t *to, enum gps_geodesic_method method);
+
+/* consecutive pairs, one to many */
+double      gps_track_length(const coord_t *track, rt_size_t count, enum gps_geodesic_method method,
+                             double *cumulative);
+rt_size_t   gps_distance_batch(const coord_t *from, const coord_t *to, rt_size_t count,
+                               enum gps_geodesic_method method, double *distance, double *bearing);
+
+/* fixed-point, equirectangular, centimetres */
+rt_uint32_t gps_distance_fixed(const coord_fixed_t *from, const coord_fixed_t *to);
+rt_uint32_t gps_track_length_fixed(const coord_fixed_t *track, rt_size_t count, rt_uint32_t *cumulative);
+
+#endif /* __GPS_GEODESIC_H__ */
@@ -0,0 +1,56 @@
+/*
+ * Copyright (c) 2020, RudyLo <luhuadong@163.com>
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ *
+ * Change Logs:
+ * Date           Author       Notes
+ * 2026-10-19     luhuadong    the first version
+ */
+
+#ifndef __GPS_LATENCY_H__
+#define __GPS_LATENCY_H__
+
+#include "gps.h"
+
+/* bucket i counts latencies in [2^(i-1), 2^i) us, the last one everything above */
+#define GPS_LATENCY_BUCKETS    24
+
+/* trace points, each measured from the arrival of the first byte */
+enum gps_latency_point
+{
+    GPS_LATENCY_RX = 0,        /* rx indicate -> a dispatcher reads the data */
+    GPS_LATENCY_SENTENCE,      /* '$' -> sentence checked and tokenized */
+    GPS_LATENCY_EPOCH,         /* first sentence of the epoch -> fix assembled */
+    GPS_LATENCY_FILTER,        /* first sentence of the epoch -> publish stages done */
+    GPS_LATENCY_DELIVER,       /* first sentence of the epoch -> handed to a subscriber */
+    GPS_LATENCY_POINT_NUM
+};
+
+struct gps_latency_hist
+{
+    rt_uint32_t bucket[GPS_LATENCY_BUCKETS];
+    rt_uint32_t count;
+    rt_uint32_t min;           /* us */
+    rt_uint32_t max;
+    rt_uint64_t sum;
+};
+
+#ifdef PKG_USING_GPS_LATENCY
+
+void        gps_latency_record(enum gps_latency_point point, rt_uint64_t since);
+rt_err_t    gps_latency_get(enum gps_latency_point point, struct gps_latency_hist *hist);
+rt_uint32_t gps_latency_percentile(const struct gps_latency_hist *hist, rt_uint8_t percent);
+void        gps_latency_reset(void);
+void        gps_latency_dump(void);
+
+#define GPS_LATENCY(point, since)  do { rt_uint64_t _since = (since); \
+                                        if (_since) gps_latency_record(point, _since); } while (0)
+
+#else
+
+#define GPS_LATENCY(point, since)  do { } while (0)
+
+#endif /* PKG_USING_GPS_LATENCY */
+
+#endif /* __GPS_LATENCY_H__ */
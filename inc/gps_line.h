@@ -0,0 +1,64 @@
+/*
+ * Copyright (c) 2020, RudyLo <luhuadong@163.com>
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ *
+ * Change Logs:
+ * Date           Author       Notes
+ * 2026-10-19     luhuadong    the first version
+ */
+
+#ifndef __GPS_LINE_H__
+#define __GPS_LINE_H__
+
+#include <rtthread.h>
+
+#ifndef GPS_LINE_BUF_SIZE
+#define GPS_LINE_BUF_SIZE      1024    /* bytes, a power of two */
+#endif
+#ifndef GPS_LINE_READER_MAX
+#define GPS_LINE_READER_MAX    2       /* readers besides the parser */
+#endif
+
+struct gps_line_buf;
+
+/* a consumer's view of the received bytes */
+struct gps_line_reader
+{
+    struct gps_line_buf *buf;
+    rt_uint32_t          cursor;       /* bytes consumed */
+    volatile rt_bool_t   waiting;
+    struct rt_semaphore  notice;
+
+    /* statistics */
+    rt_uint32_t          lost;         /* bytes skipped because the reader fell behind */
+    rt_uint32_t          overruns;
+};
+typedef struct gps_line_reader *gps_line_reader_t;
+
+/*
+ * Receive ring. The dispatcher reads the UART straight into it and the
+ * parser, loggers and dumps read the same bytes in place through their own
+ * cursors. The writer never waits: a reader that falls more than the ring
+ * behind loses the oldest bytes.
+ */
+struct gps_line_buf
+{
+    char                *data;
+    rt_uint32_t          size;
+    volatile rt_uint32_t head;         /* bytes written */
+    volatile rt_uint32_t reserve;      /* head plus the chunk being written */
+    struct gps_line_reader *volatile reader[GPS_LINE_READER_MAX];
+};
+typedef struct gps_line_buf *gps_line_buf_t;
+
+void      gps_line_init(gps_line_buf_t buf, char *data, rt_uint32_t size);
+rt_size_t gps_line_write_begin(gps_line_buf_t buf, char **ptr, rt_size_t max);
+void      gps_line_write_end(gps_line_buf_t buf, rt_size_t len);
+
+rt_err_t  gps_line_open(gps_line_buf_t buf, gps_line_reader_t reader);
+void      gps_line_close(gps_line_reader_t reader);
+rt_size_t gps_line_peek(gps_line_reader_t reader, const char **data, rt_int32_t timeout);
+rt_err_t  gps_line_advance(gps_line_reader_t reader, rt_size_t len);
+
+#endif /* __GPS_LINE_H__ */
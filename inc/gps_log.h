@@ -0,0 +1,135 @@
+/*
+ * Copyright (c) 2020, RudyLo <luhuadong@163.com>
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ *
+ * Change Logs:
+ * Date           Author       Notes
+ * 2026-10-19     luhuadong    the first version
+ */
+
+#ifndef __GPS_LOG_H__
+#define __GPS_LOG_H__
+
+#include "gps.h"
+#include "gps_dbuf.h"
+
+#ifndef GPS_LOG_BLOCK_SIZE
+#define GPS_LOG_BLOCK_SIZE     512     /* bytes, divides GPS_LOG_ERASE_SIZE */
+#endif
+#ifndef GPS_LOG_ERASE_SIZE
+#define GPS_LOG_ERASE_SIZE     4096    /* flash sector */
+#endif
+
+#define GPS_LOG_MAGIC          0x4C47  /* "GL" */
+#define GPS_LOG_VERSION        1
+#define GPS_LOG_HEADER_SIZE    16
+#define GPS_LOG_RECORD_MAX     48
+
+/*
+ * Block layout, little-endian:
+ *
+ *   0  u16 magic     4  u32 seq      8  u16 count     12 u32 crc32
+ *   2  u8  version                  10  u16 used
+ *   3  u8  flags
+ *
+ * followed by `used` bytes of records. The first record of a block is a
+ * keyframe, so every block decodes on its own. crc32 (IEEE, as zlib) is
+ * over the whole block with the crc field zero.
+ *
+ * Record: a header byte of GPS_LOG_REC_* bits, then
+ *   KEY:   uvarint date, uvarint time ms, svarint lat, lon (1e-7 deg), alt (dm);
+ *          also written mid-block on a new date or a jump
+ *   delta: svarint dt - last dt, lat and lon against a linear prediction
+ *          from the last two fixes, alt - last alt
+ *   STATE: u8 quality | mode << 4 | status << 6, u8 flags, u8 sats, uvarint hdop * 10
+ *   VEL:   speed cm/s and course 0.1 deg, uvarint on a key, svarint deltas otherwise
+ * svarint is a zigzag-encoded uvarint.
+ */
+#define GPS_LOG_REC_KEY        0x01
+#define GPS_LOG_REC_STATE      0x02
+#define GPS_LOG_REC_VEL        0x04
+
+struct gps_log_config
+{
+    rt_uint32_t blocks;          /* ring length in blocks, 0: the whole partition */
+    rt_bool_t   velocity;        /* also log speed and course */
+    rt_uint8_t  state_hdop;      /* hdop change in 0.1 that logs a new state */
+};
+
+/* block access of a storage backend, block is the index in the ring */
+struct gps_log_io
+{
+    rt_err_t (*read)(void *ctx, rt_uint32_t block, void *buf, rt_size_t size);
+    rt_err_t (*write)(void *ctx, rt_uint32_t block, const void *buf, rt_size_t size);
+    void      *ctx;
+};
+
+/* encoder and decoder state, the last fix in fixed point */
+struct gps_log_state
+{
+    rt_uint32_t date;
+    rt_uint32_t time;
+    rt_int32_t  dt;
+    rt_int32_t  lat[2];          /* last, the one before */
+    rt_int32_t  lon[2];
+    rt_int32_t  alt;
+    rt_int32_t  speed;
+    rt_int32_t  course;
+    rt_uint16_t hdop;
+    rt_uint8_t  sats;
+    rt_uint8_t  quality;
+    rt_uint8_t  mode;
+    rt_uint8_t  status;
+    rt_uint8_t  flags;
+};
+
+/*
+ * Binary track log. Appending encodes into a RAM block; a full block is
+ * written by the caller or, after gps_log_start(), by a writer thread so
+ * the caller never waits for flash. Blocks go round a ring of cfg.blocks
+ * and carry a sequence number, gps_log_init() resumes after the newest.
+ */
+struct gps_log
+{
+    struct gps_log_config cfg;
+    struct gps_log_io io;
+    union
+    {
+        int         fd;
+        const void *part;
+    } backend;
+
+    rt_uint8_t  block[2][GPS_LOG_BLOCK_SIZE];
+    struct gps_dbuf out;         /* full blocks lost to a lagging writer in out.dropped */
+    rt_uint16_t used;
+    rt_uint16_t count;
+    rt_uint32_t seq;             /* of the block being filled */
+    struct gps_log_state last;
+
+    /* statistics */
+    rt_uint32_t fixes;
+    rt_uint32_t bytes;
+    rt_uint32_t blocks;
+    rt_uint32_t errors;
+};
+typedef struct gps_log *gps_log_t;
+
+typedef void (*gps_log_handler_t)(const gps_fix_t *fix, void *user_data);
+
+rt_err_t gps_log_init(gps_log_t log, const struct gps_log_config *cfg, const struct gps_log_io *io);
+#if defined(RT_USING_DFS) || defined(__linux__)
+rt_err_t gps_log_open_file(gps_log_t log, const struct gps_log_config *cfg, const char *path);
+#endif
+#ifdef PKG_USING_FAL
+rt_err_t gps_log_open_fal(gps_log_t log, const struct gps_log_config *cfg, const char *part_name);
+#endif
+rt_err_t gps_log_start(gps_log_t log);
+rt_err_t gps_log_append(gps_log_t log, const gps_fix_t *fix);
+rt_err_t gps_log_sync(gps_log_t log);
+void     gps_log_close(gps_log_t log);
+void     gps_log_subscriber(gps_device_t dev, const gps_fix_t *fix, void *user_data);
+
+int      gps_log_decode(const void *block, rt_size_t size, gps_log_handler_t handler, void *user_data);
+
+#endif /* __GPS_LOG_H__ */
@@ -0,0 +1,101 @@
+/*
+ * Copyright (c) 2020, RudyLo <luhuadong@163.com>
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ *
+ * Change Logs:
+ * Date           Author       Notes
+ * 2026-10-19     luhuadong    the first version
+ */
+
+#ifndef __GPS_MOTION_H__
+#define __GPS_MOTION_H__
+
+#include "gps.h"
+
+#define GPS_MOTION_WINDOW_MAX     16
+
+enum gps_motion_state
+{
+    GPS_MOTION_UNKNOWN = 0,
+    GPS_MOTION_STATIONARY,
+    GPS_MOTION_MOVING,
+};
+
+enum gps_motion_event
+{
+    GPS_MOTION_STOP = 0,      /* became stationary */
+    GPS_MOTION_START,         /* started moving */
+    GPS_MOTION_IDLE,          /* stationary for the idle time */
+};
+
+struct gps_motion;
+typedef void (*gps_motion_handler_t)(struct gps_motion *motion, enum gps_motion_event event, void *user_data);
+
+/* a zero value disables its part of the decision */
+struct gps_motion_config
+{
+    float       speed_still;     /* m/s, below it the fix may be stationary */
+    float       speed_moving;    /* m/s, above it the fix is moving */
+    float       spread_still;    /* m, position standard deviation of a parked receiver */
+    float       deadband;        /* m, movement reported while stationary */
+    float       accel_threshold; /* accelerometer activity that means moving */
+    rt_uint32_t accel_hold;      /* ms an accelerometer report keeps the state moving */
+    rt_uint32_t heartbeat;       /* ms between reports while stationary */
+    rt_uint32_t idle;            /* ms stationary before GPS_MOTION_IDLE */
+    rt_uint8_t  window;          /* fixes in the spread window, up to GPS_MOTION_WINDOW_MAX */
+    const char *standby_cmd;     /* sent on idle, e.g. "$PMTK225,8" (AlwaysLocate) */
+    const char *wake_cmd;        /* sent on start after idle, e.g. "$PMTK225,0" */
+};
+
+/*
+ * Motion state detector and deadband reporter. As the first publish
+ * stage it suppresses repeated fixes of a parked receiver, so later stages
+ * and subscribers only see movement beyond the deadband and heartbeats,
+ * while gps_read() still gets every fix.
+ */
+struct gps_motion
+{
+    struct gps_motion_config cfg;
+    enum gps_motion_state state;
+
+    /* spread window, metres from the window origin */
+    float       x[GPS_MOTION_WINDOW_MAX];
+    float       y[GPS_MOTION_WINDOW_MAX];
+    rt_uint8_t  head;
+    rt_uint8_t  count;
+    double      origin_lat;
+    double      origin_lon;
+    float       m_per_lon;
+
+    /* the last reported fix */
+    double      report_lat;
+    double      report_lon;
+    rt_tick_t   report_tick;
+    rt_bool_t   reported;
+
+    rt_tick_t   still_tick;      /* when the stationary state began */
+    rt_tick_t   accel_tick;      /* the last accelerometer activity */
+    rt_bool_t   accel_active;
+    volatile rt_bool_t idle;          /* standby wanted, wake_cmd undoes it */
+    volatile rt_bool_t power_pending; /* the standby or wake command is still to be sent */
+    gps_device_t dev;
+
+    gps_motion_handler_t handler;
+    void       *user_data;
+
+    /* statistics */
+    rt_uint32_t passed;
+    rt_uint32_t suppressed;
+    rt_uint32_t stops;
+    rt_uint32_t power_retries;   /* power commands the busy command lock deferred */
+};
+typedef struct gps_motion *gps_motion_t;
+
+void     gps_motion_init(gps_motion_t motion, const struct gps_motion_config *cfg);
+void     gps_motion_set_handler(gps_motion_t motion, gps_motion_handler_t handler, void *user_data);
+void     gps_motion_accel(gps_motion_t motion, float activity);
+rt_bool_t gps_motion_update(gps_motion_t motion, const gps_fix_t *fix);
+rt_err_t gps_motion_stage(gps_device_t dev, gps_fix_t *fix, void *user_data);
+
+#endif /* __GPS_MOTION_H__ */
@@ -0,0 +1,55 @@
+/*
+ * Copyright (c) 2020, RudyLo <luhuadong@163.com>
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ *
+ * Change Logs:
+ * Date           Author       Notes
+ * 2026-10-19     luhuadong    the first version
+ */
+
+#ifndef __GPS_NMEA_H__
+#define __GPS_NMEA_H__
+
+#include "gps.h"
+
+#define GPS_NMEA_FIELD_MAX   24
+
+enum gps_nmea_type
+{
+    GPS_NMEA_UNKNOWN = 0,
+    GPS_NMEA_RMC,
+    GPS_NMEA_GGA,
+    GPS_NMEA_GSA,
+    GPS_NMEA_GSV,
+    GPS_NMEA_VTG,
+    GPS_NMEA_GLL,
+    GPS_NMEA_ZDA,
+    GPS_NMEA_TXT,
+    GPS_NMEA_PMTK,
+};
+
+#define GPS_NMEA_BIT(type)   (1UL << (type))
+
+/* one sentence split into fields, pointing into the token's own copy */
+struct gps_nmea_token
+{
+    enum gps_nmea_type type;
+    rt_uint8_t  argc;
+    char       *argv[GPS_NMEA_FIELD_MAX];
+    char        buf[GPS_NMEA_LINE_SIZE];
+};
+
+rt_bool_t gps_nmea_check(const char *line, rt_size_t len);
+rt_err_t  gps_nmea_tokenize(const char *line, rt_size_t len, struct gps_nmea_token *tok);
+rt_bool_t gps_nmea_time(const struct gps_nmea_token *tok, rt_uint32_t *time);
+void      gps_nmea_apply(const struct gps_nmea_token *tok, gps_fix_t *fix);
+rt_size_t gps_nmea_build(char *buf, rt_size_t size, const char *cmd);
+
+double    gps_nmea_atof(const char *s);
+rt_int32_t gps_nmea_atoi(const char *s);
+
+void      gps_epoch_init(gps_epoch_t epoch, gps_epoch_handler_t handler, void *user_data);
+void      gps_epoch_feed(gps_epoch_t epoch, const struct gps_nmea_token *tok);
+
+#endif /* __GPS_NMEA_H__ */
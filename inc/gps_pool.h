@@ -0,0 +1,77 @@
+/*
+ * Copyright (c) 2020, RudyLo <luhuadong@163.com>
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ *
+ * Change Logs:
+ * Date           Author       Notes
+ * 2026-10-19     luhuadong    the first version
+ */
+
+#ifndef __GPS_POOL_H__
+#define __GPS_POOL_H__
+
+#include "gps.h"
+
+#ifndef GPS_POOL_CONSUMER_MAX
+#define GPS_POOL_CONSUMER_MAX    6
+#endif
+
+#define GPS_POOL_NONE            0xFFFF    /* end of the free list */
+
+struct gps_pool;
+
+/* a published fix shared by reference, released by its last holder */
+struct gps_fix_record
+{
+    gps_fix_t            fix;
+    struct gps_pool     *pool;
+    volatile rt_uint32_t ref;
+    rt_uint16_t          next;         /* free list link */
+};
+typedef struct gps_fix_record *gps_fix_record_t;
+
+/*
+ * A consumer is called with every record; to keep it past the call it
+ * takes a reference with gps_pool_ref() and later gps_pool_put()s it,
+ * e.g. after sending the pointer through a mailbox.
+ */
+typedef void (*gps_pool_consumer_t)(gps_fix_record_t rec, void *user_data);
+
+struct gps_pool_consumer_node
+{
+    gps_pool_consumer_t consumer;
+    void               *user_data;
+};
+
+/*
+ * Fixed-capacity pool of reference-counted fix records on caller-provided
+ * storage. The free list head carries a tag against ABA, so alloc and
+ * put are lock-free O(1) and may be called from any thread or interrupt.
+ */
+struct gps_pool
+{
+    struct gps_fix_record *record;
+    rt_uint16_t          num;
+    volatile rt_uint32_t head;         /* tag << 16 | index of the first free record */
+
+    struct gps_pool_consumer_node consumer[GPS_POOL_CONSUMER_MAX];
+    rt_uint8_t           consumer_num;
+
+    /* statistics */
+    volatile rt_uint32_t in_use;
+    volatile rt_uint32_t high_water;
+    volatile rt_uint32_t allocs;
+    volatile rt_uint32_t exhausted;
+};
+typedef struct gps_pool *gps_pool_t;
+
+void             gps_pool_init(gps_pool_t pool, struct gps_fix_record *record, rt_uint16_t num);
+gps_fix_record_t gps_pool_alloc(gps_pool_t pool);
+void             gps_pool_ref(gps_fix_record_t rec);
+void             gps_pool_put(gps_fix_record_t rec);
+rt_err_t         gps_pool_add_consumer(gps_pool_t pool, gps_pool_consumer_t consumer, void *user_data);
+rt_err_t         gps_pool_publish(gps_pool_t pool, const gps_fix_t *fix);
+void             gps_pool_subscriber(gps_device_t dev, const gps_fix_t *fix, void *user_data);
+
+#endif /* __GPS_POOL_H__ */
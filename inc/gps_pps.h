@@ -0,0 +1,73 @@
+/*
+ * Copyright (c) 2020, RudyLo <luhuadong@163.com>
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ *
+ * Change Logs:
+ * Date           Author       Notes
+ * 2026-10-19     luhuadong    the first version
+ */
+
+#ifndef __GPS_PPS_H__
+#define __GPS_PPS_H__
+
+#include "gps.h"
+
+#define GPS_PPS_PERIOD_MIN     900000    /* us, edges closer than this are glitches */
+#define GPS_PPS_PERIOD_MAX     1100000
+
+/*
+ * PPS capture. The edge marks the start of the UTC second that the
+ * following RMC/ZDA reports (PMTK255,1 keeps NMEA after PPS), so a fix at
+ * hh:mm:ss.fff happened fff ms after the edge of second ss.
+ *
+ * Edges are numbered by count. The first fix after a gap is paired with
+ * the newest edge before its rx_us, which labels that edge with the fix's
+ * UTC second; later edges of the unbroken chain are labelled by counting,
+ * and fixes are matched on the label, not on rx_us. rx_us only has to be
+ * good to a second once, for the first fix of a chain.
+ */
+struct gps_pps
+{
+    /* written by the capture interrupt */
+    volatile rt_uint32_t seq;
+    volatile rt_uint64_t edge[2];  /* edge n is in edge[n & 1] */
+    volatile rt_uint32_t count;    /* edges captured */
+    volatile rt_uint32_t chain;    /* number of the first edge after a gap */
+
+    rt_base_t   pin;              /* -1 if captured by a timer or /dev/ppsN */
+    rt_uint32_t period;           /* us between the last two edges */
+
+    /* edge label_edge started UTC second label_sec of the day */
+    rt_bool_t   labelled;
+    rt_uint32_t label_edge;
+    rt_uint32_t label_sec;
+
+    /* statistics */
+    rt_uint32_t paired;
+    rt_uint32_t unpaired;
+    rt_uint32_t relabels;         /* a labelled match disagreed with rx_us */
+    rt_uint32_t glitches;
+    rt_uint32_t latency_min;      /* us from epoch to first byte */
+    rt_uint32_t latency_max;
+
+#if defined(__linux__)
+    int         fd;
+    rt_thread_t tid;
+    volatile rt_bool_t stop;
+    struct rt_semaphore exited;
+#endif
+};
+typedef struct gps_pps *gps_pps_t;
+
+void     gps_pps_init(gps_pps_t pps);
+rt_err_t gps_pps_attach_pin(gps_pps_t pps, rt_base_t pin);
+void     gps_pps_capture(gps_pps_t pps, rt_uint64_t us);
+rt_err_t gps_pps_stamp(gps_pps_t pps, gps_fix_t *fix);
+rt_err_t gps_pps_stage(gps_device_t dev, gps_fix_t *fix, void *user_data);
+#if defined(__linux__)
+rt_err_t gps_pps_open(gps_pps_t pps, const char *path);
+void     gps_pps_close(gps_pps_t pps);
+#endif
+
+#endif /* __GPS_PPS_H__ */
@@ -0,0 +1,100 @@
+/*
+ * Copyright (c) 2020, RudyLo <luhuadong@163.com>
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ *
+ * Change Logs:
+ * Date           Author       Notes
+ * 2026-10-19     luhuadong    the first version
+ */
+
+#ifndef __GPS_PROJ_H__
+#define __GPS_PROJ_H__
+
+#include "gps.h"
+
+/* WGS-84 ellipsoid */
+#define GPS_WGS84_A          6378137.0
+#define GPS_WGS84_F          (1.0 / 298.257223563)
+#define GPS_WGS84_B          (GPS_WGS84_A * (1.0 - GPS_WGS84_F))
+#define GPS_WGS84_E2         (GPS_WGS84_F * (2.0 - GPS_WGS84_F))
+
+/* Earth-centred, earth-fixed cartesian coordinates, metres */
+struct gps_ecef
+{
+    double x;
+    double y;
+    double z;
+};
+
+/* East-north-up coordinates relative to a projection origin, metres */
+struct gps_enu
+{
+    double e;
+    double n;
+    double u;
+};
+
+/* Universal transverse mercator grid coordinates, metres */
+struct gps_utm
+{
+    double     easting;
+    double     northing;
+    rt_uint8_t zone;         /* 1 ~ 60 */
+    char       hemisphere;   /* 'N' or 'S' */
+};
+
+/*
+ * Local tangent plane anchored at an origin. Everything that depends only
+ * on the origin is computed once by gps_proj_set_origin(), so the fast and
+ * batch conversions below cost a handful of multiply-adds per fix.
+ */
+struct gps_proj
+{
+    coord_t         origin;       /* decimal degrees */
+    double          origin_alt;   /* metres */
+    struct gps_ecef origin_ecef;
+
+    double sin_lat;
+    double cos_lat;
+    double sin_lon;
+    double cos_lon;
+
+    double rn;                    /* prime vertical radius of curvature */
+    double rm;                    /* meridian radius of curvature */
+
+    double k_east;                /* metres per degree of longitude */
+    double k_north;               /* metres per degree of latitude */
+    double k_north_inv;
+    double k_east_lat;            /* change of k_east per degree of latitude */
+    double k_north_lat;           /* change of k_north per degree of latitude */
+    double k_north_east;          /* northing offset per square metre of easting */
+    double k_up;                  /* 1 / (2 * mean radius), curvature drop */
+};
+typedef struct gps_proj *gps_proj_t;
+
+/* geodetic <-> ECEF */
+void      gps_geo2ecef(const coord_t *geo, double alt, struct gps_ecef *ecef);
+void      gps_ecef2geo(const struct gps_ecef *ecef, coord_t *geo, double *alt);
+
+/* local tangent plane */
+void      gps_proj_set_origin(gps_proj_t proj, const coord_t *origin, double alt);
+void      gps_proj_ecef2enu(gps_proj_t proj, const struct gps_ecef *ecef, struct gps_enu *enu);
+void      gps_proj_enu2ecef(gps_proj_t proj, const struct gps_enu *enu, struct gps_ecef *ecef);
+void      gps_proj_geo2enu(gps_proj_t proj, const coord_t *geo, double alt, struct gps_enu *enu);
+void      gps_proj_enu2geo(gps_proj_t proj, const struct gps_enu *enu, coord_t *geo, double *alt);
+void      gps_proj_geo2enu_fast(gps_proj_t proj, const coord_t *geo, double alt, struct gps_enu *enu);
+void      gps_proj_enu2geo_fast(gps_proj_t proj, const struct gps_enu *enu, coord_t *geo, double *alt);
+rt_size_t gps_proj_geo2enu_batch(gps_proj_t proj, const coord_t *geo, const double *alt,
+                                 struct gps_enu *enu, rt_size_t count);
+rt_size_t gps_proj_enu2geo_batch(gps_proj_t proj, const struct gps_enu *enu,
+                                 coord_t *geo, double *alt, rt_size_t count);
+
+/* UTM */
+rt_uint8_t gps_utm_zone(const coord_t *geo);
+rt_err_t   gps_geo2utm(const coord_t *geo, struct gps_utm *utm);
+rt_err_t   gps_geo2utm_zone(const coord_t *geo, rt_uint8_t zone, struct gps_utm *utm);
+rt_err_t   gps_utm2geo(const struct gps_utm *utm, coord_t *geo);
+rt_size_t  gps_geo2utm_batch(const coord_t *geo, rt_uint8_t zone, struct gps_utm *utm, rt_size_t count);
+
+#endif /* __GPS_PROJ_H__ */
@@ -0,0 +1,89 @@
+/*
+ * Copyright (c) 2020, RudyLo <luhuadong@163.com>
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ *
+ * Change Logs:
+ * Date           Author       Notes
+ * 2026-10-19     luhuadong    the first version
+ */
+
+#ifndef __GPS_RATE_H__
+#define __GPS_RATE_H__
+
+#include "gps.h"
+
+enum gps_rate_level
+{
+    GPS_RATE_STOPPED = 0,
+    GPS_RATE_CRUISE,
+    GPS_RATE_DYNAMIC,      /* fast or turning */
+    GPS_RATE_LEVEL_NUM,
+};
+
+/* what the receiver is told at one level */
+struct gps_rate_plan
+{
+    rt_uint32_t interval;  /* PMTK220 fix interval, ms */
+    rt_uint32_t baudrate;  /* PMTK251 link rate, every plan names one */
+    const char *output;    /* PMTK314 sentence set, RT_NULL keeps the current set */
+};
+
+struct gps_rate_config
+{
+    struct gps_rate_plan plan[GPS_RATE_LEVEL_NUM];
+    float       stop_speed;   /* m/s, below it the receiver is stopped */
+    float       fast_speed;   /* m/s, above it the dynamic level is used */
+    float       turn_rate;    /* deg/s, above it the dynamic level is used */
+    float       hysteresis;   /* fraction the thresholds move by when leaving a level */
+    rt_uint32_t hold;         /* ms a lower level has to be wanted before stepping down */
+    rt_uint32_t min_gap;      /* ms between level changes */
+};
+
+/*
+ * Adaptive fix rate controller. Stepping up needs only the minimum gap
+ * since the last change, so turns are sampled densely; stepping down also
+ * waits for the hold time. The gap bounds the command traffic.
+ *
+ * The subscriber only decides, a worker thread sends the commands and
+ * waits for their acknowledges; the level changes when all succeeded.
+ */
+struct gps_rate
+{
+    struct gps_rate_config cfg;
+    enum gps_rate_level level;
+    rt_uint32_t baudrate;      /* the link rate now */
+
+    float       last_course;
+    rt_tick_t   last_tick;
+    rt_tick_t   change_tick;   /* when the level last changed or failed to */
+    rt_tick_t   want_tick;     /* since when a lower level has been wanted */
+    rt_bool_t   started;
+    rt_bool_t   wanting;
+
+    /* transition worker */
+    gps_device_t dev;
+    rt_thread_t worker;
+    struct rt_semaphore request;
+    struct rt_semaphore exited;
+    enum gps_rate_level target;
+    rt_bool_t   applying;      /* the worker owns a transition */
+    volatile rt_bool_t quit;
+
+    /* statistics */
+    rt_uint32_t commands;
+    rt_uint32_t changes;
+    rt_uint32_t failures;
+    rt_uint32_t fixes[GPS_RATE_LEVEL_NUM];
+    rt_uint64_t time[GPS_RATE_LEVEL_NUM];   /* ms spent at each level */
+};
+typedef struct gps_rate *gps_rate_t;
+
+void     gps_rate_init(gps_rate_t rate, const struct gps_rate_config *cfg);
+rt_err_t gps_rate_apply(gps_rate_t rate, gps_device_t dev, enum gps_rate_level level);
+enum gps_rate_level gps_rate_update(gps_rate_t rate, const gps_fix_t *fix);
+rt_err_t gps_rate_start(gps_rate_t rate, gps_device_t dev);
+void     gps_rate_stop(gps_rate_t rate);
+void     gps_rate_dump(gps_rate_t rate);
+
+#endif /* __GPS_RATE_H__ */
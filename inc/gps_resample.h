@@ -0,0 +1,89 @@
+/*
+ * Copyright (c) 2020, RudyLo <luhuadong@163.com>
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ *
+ * Change Logs:
+ * Date           Author       Notes
+ * 2026-10-19     luhuadong    the first version
+ */
+
+#ifndef __GPS_RESAMPLE_H__
+#define __GPS_RESAMPLE_H__
+
+#include "gps.h"
+
+#define GPS_RESAMPLE_EXTRAPOLATE_MAX  2000    /* ms of dead reckoning before samples are stale */
+#define GPS_RESAMPLE_ACCEL            2.0f    /* m/s^2, assumed for the confidence radius */
+
+enum gps_resample_mode
+{
+    GPS_RESAMPLE_NONE = 0,        /* no fix yet */
+    GPS_RESAMPLE_INTERPOLATED,    /* between the last two fixes */
+    GPS_RESAMPLE_EXTRAPOLATED,    /* dead reckoned from the newest fix */
+    GPS_RESAMPLE_STALE,           /* extrapolated beyond extrapolate_max */
+};
+
+struct gps_resample_sample
+{
+    double      lat;
+    double      lon;
+    float       speed;        /* m/s */
+    float       course;       /* degrees */
+    float       sigma;        /* metres, 1-sigma horizontal confidence */
+    rt_tick_t   tick;         /* the requested time */
+    rt_uint32_t age;          /* ms from the newest fix to the requested time */
+    rt_uint8_t  mode;         /* enum gps_resample_mode */
+};
+
+/* a published fix in the form the readers need */
+struct gps_resample_slot
+{
+    volatile rt_uint32_t seq;     /* odd while being written */
+    double      lat[2];           /* [0] previous, [1] newest */
+    double      lon[2];
+    rt_tick_t   tick[2];          /* epoch tick, corrected for transport latency */
+    float       ve;               /* m/s east */
+    float       vn;               /* m/s north */
+    float       sigma;            /* position sigma of the newest fix */
+    float       m_per_lon;
+    rt_bool_t   has_prev;
+};
+
+struct gps_resample;
+typedef void (*gps_resample_handler_t)(struct gps_resample *rs, const struct gps_resample_sample *sample, void *user_data);
+
+/*
+ * Fixed-rate resampler. The writer fills the slot readers are not using
+ * and then flips the index; readers copy the published slot and retry if
+ * its sequence moved, so neither side ever blocks on the other.
+ */
+struct gps_resample
+{
+    struct gps_resample_slot slot[2];
+    volatile rt_uint8_t      index;
+
+    rt_uint32_t latency;           /* ms between epoch and fix publication */
+    rt_uint32_t extrapolate_max;   /* ms */
+
+    struct rt_timer          timer;
+    gps_resample_handler_t   handler;
+    void                    *user_data;
+    volatile rt_bool_t       running;      /* the timer callback is in the handler */
+    volatile rt_bool_t       stop_wait;    /* gps_resample_stop() waits on idle */
+    struct rt_semaphore      idle;
+
+    /* statistics */
+    rt_uint32_t updates;
+    volatile rt_uint32_t retries;  /* readers count concurrently */
+};
+typedef struct gps_resample *gps_resample_t;
+
+void     gps_resample_init(gps_resample_t rs, rt_uint32_t latency);
+void     gps_resample_update(gps_resample_t rs, const gps_fix_t *fix);
+rt_err_t gps_resample_at(gps_resample_t rs, rt_tick_t tick, struct gps_resample_sample *sample);
+rt_err_t gps_resample_start(gps_resample_t rs, rt_uint32_t period, gps_resample_handler_t handler, void *user_data);
+void     gps_resample_stop(gps_resample_t rs);
+void     gps_resample_subscriber(gps_device_t dev, const gps_fix_t *fix, void *user_data);
+
+#endif /* __GPS_RESAMPLE_H__ */
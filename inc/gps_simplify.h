@@ -0,0 +1,61 @@
+/*
+ * Copyright (c) 2020, RudyLo <luhuadong@163.com>
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ *
+ * Change Logs:
+ * Date           Author       Notes
+ * 2026-10-19     luhuadong    the first version
+ */
+
+#ifndef __GPS_SIMPLIFY_H__
+#define __GPS_SIMPLIFY_H__
+
+#include "gps.h"
+
+struct gps_simplify;
+typedef void (*gps_simplify_handler_t)(struct gps_simplify *simplify, const gps_fix_t *fix, void *user_data);
+
+/* a window point, metres east/north of the anchor */
+struct gps_simplify_point
+{
+    float x;
+    float y;
+};
+
+/*
+ * Opening window simplifier. Memory is the window buffer plus two fixes;
+ * only the last point of the window can ever be emitted, so the window
+ * keeps projected coordinates and not whole fixes.
+ */
+struct gps_simplify
+{
+    float                      tolerance2;   /* squared cross-track tolerance, m^2 */
+    struct gps_simplify_point *window;
+    rt_uint16_t                window_max;
+    rt_uint16_t                window_num;
+
+    gps_fix_t                  anchor;
+    gps_fix_t                  last;         /* the newest fix in the window */
+    double                     m_per_lon;    /* metres per degree at the anchor */
+    rt_bool_t                  started;
+
+    gps_simplify_handler_t     handler;
+    void                      *user_data;
+
+    /* statistics */
+    rt_uint32_t                in;
+    rt_uint32_t                out;
+    rt_uint32_t                forced;       /* emitted because the window was full */
+};
+typedef struct gps_simplify *gps_simplify_t;
+
+void      gps_simplify_init(gps_simplify_t simplify, float tolerance,
+                            struct gps_simplify_point *window, rt_uint16_t window_max,
+                            gps_simplify_handler_t handler, void *user_data);
+void      gps_simplify_push(gps_simplify_t simplify, const gps_fix_t *fix);
+void      gps_simplify_flush(gps_simplify_t simplify);
+
+rt_size_t gps_simplify_dp(const gps_fix_t *track, rt_size_t count, float tolerance, rt_uint8_t *keep);
+
+#endif /* __GPS_SIMPLIFY_H__ */
@@ -0,0 +1,84 @@
+/*
+ * Copyright (c) 2020, RudyLo <luhuadong@163.com>
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ *
+ * Change Logs:
+ * Date           Author       Notes
+ * 2026-10-19     luhuadong    the first version
+ */
+
+#ifndef __GPS_TELEMETRY_H__
+#define __GPS_TELEMETRY_H__
+
+#include "gps.h"
+
+#define GPS_TELEMETRY_VERSION      1
+#define GPS_TELEMETRY_HEADER_SIZE  8
+#define GPS_TELEMETRY_COUNT_MAX    255
+
+/* gps_telemetry_config.fields */
+#define GPS_TELEMETRY_TIME         0x01    /* UTC time */
+#define GPS_TELEMETRY_POS          0x02    /* latitude and longitude */
+#define GPS_TELEMETRY_ALT          0x04    /* altitude */
+#define GPS_TELEMETRY_SPEED        0x08    /* speed, 0.1 m/s */
+#define GPS_TELEMETRY_COURSE       0x10    /* course, 1 deg */
+#define GPS_TELEMETRY_QUALITY      0x20    /* satellites and hdop, 0.1 */
+
+/*
+ * Frame, little-endian:
+ *
+ *   0  u8  version       3  u8  pos_digits
+ *   1  u8  fields        4  u16 time_res, ms
+ *   2  u8  count         6  u16 alt_res, mm
+ *
+ * then the base of the first fix for the fields present: u32 date and
+ * u32 time of day (ms) for TIME, i32 lat and i32 lon in 10^-pos_digits
+ * deg for POS, i32 alt in alt_res for ALT. A bit stream, MSB first,
+ * follows with one group per fix, fields in mask order. Each value is
+ * a zigzag-mapped residual in exp-Golomb code of a per-field order:
+ *   TIME    interval - last interval, in time_res
+ *   POS     lat, lon against a linear prediction from the last two fixes
+ *   ALT     alt - last alt
+ *   SPEED   speed - last speed     COURSE  turn in (-180, 180]
+ *   QUALITY sats - last sats, hdop - last hdop
+ * The first fix's TIME, POS and ALT residuals are 0 against the base,
+ * the other fields start from 0.
+ */
+struct gps_telemetry_config
+{
+    rt_uint8_t  fields;          /* GPS_TELEMETRY_* */
+    rt_uint8_t  pos_digits;      /* 5..7, 7 is 1e-7 deg */
+    rt_uint16_t time_res;        /* ms */
+    rt_uint16_t alt_res;         /* mm */
+};
+
+/* a frame being built in the caller's buffer */
+struct gps_telemetry
+{
+    struct gps_telemetry_config cfg;
+    rt_uint8_t *buf;
+    rt_size_t   size;
+    rt_size_t   bits;            /* bits used, header and base included */
+    rt_uint8_t  count;
+
+    /* prediction state, in frame units */
+    rt_uint32_t base_time;
+    rt_int32_t  time;
+    rt_int32_t  dt;
+    rt_int32_t  lat[2];
+    rt_int32_t  lon[2];
+    rt_int32_t  alt;
+    rt_int32_t  speed;
+    rt_int32_t  course;
+    rt_int32_t  sats;
+    rt_int32_t  hdop;
+};
+typedef struct gps_telemetry *gps_telemetry_t;
+
+rt_err_t  gps_telemetry_begin(gps_telemetry_t tlm, const struct gps_telemetry_config *cfg,
+                              void *buf, rt_size_t size);
+rt_err_t  gps_telemetry_add(gps_telemetry_t tlm, const gps_fix_t *fix);
+rt_size_t gps_telemetry_finish(gps_telemetry_t tlm);
+
+#endif /* __GPS_TELEMETRY_H__ */
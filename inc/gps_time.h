@@ -0,0 +1,65 @@
+/*
+ * Copyright (c) 2020, RudyLo <luhuadong@163.com>
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ *
+ * Change Logs:
+ * Date           Author       Notes
+ * 2026-10-19     luhuadong    the first version
+ */
+
+#ifndef __GPS_TIME_H__
+#define __GPS_TIME_H__
+
+#include "gps.h"
+
+#define GPS_TIME_STEP_LIMIT     500000     /* us, larger errors step instead of slew */
+#define GPS_TIME_SLEW_MAX       500000     /* ppb, the fastest slew */
+#define GPS_TIME_SYNC_INTERVAL  1000000    /* us between loop updates */
+#define GPS_TIME_SYSTEM_INTERVAL 3600      /* s between system clock updates */
+
+/* local clock to UTC mapping, published to readers */
+struct gps_time_slot
+{
+    volatile rt_uint32_t seq;      /* odd while being written */
+    rt_uint64_t base_local;        /* gps_time_us() */
+    rt_int64_t  base_utc;          /* us since 1970-01-01 UTC */
+    rt_int32_t  rate;              /* ppb, UTC gained per local microsecond */
+};
+
+/*
+ * Disciplined UTC. Every sync compares the UTC of an epoch with the
+ * mapping; a frequency-locked loop estimates the drift of the local
+ * oscillator and the remaining phase error is slewed out over the next
+ * interval, so the clock never jumps once locked.
+ */
+struct gps_time
+{
+    struct gps_time_slot slot[2];
+    volatile rt_uint8_t  index;
+
+    rt_int32_t  freq;              /* ppb, estimated local oscillator error */
+    rt_uint64_t last_local;        /* local time of the last loop update */
+    rt_int64_t  offset;            /* us, the last measured phase error */
+    rt_bool_t   locked;
+
+    rt_uint32_t latency;           /* us from epoch to first byte, used without PPS */
+    rt_bool_t   set_system;        /* discipline the RTC or the host clock too */
+    rt_uint64_t system_local;      /* local time of the last system clock update */
+
+    /* statistics */
+    rt_uint32_t syncs;
+    rt_uint32_t steps;
+};
+typedef struct gps_time *gps_time_t;
+
+rt_int64_t gps_time_utc(rt_uint32_t date, rt_uint32_t time);
+
+void       gps_time_init(gps_time_t t, rt_uint32_t latency, rt_bool_t set_system);
+rt_err_t   gps_time_sync(gps_time_t t, rt_int64_t utc, rt_uint64_t local, rt_bool_t pps);
+rt_err_t   gps_time_update(gps_time_t t, const gps_fix_t *fix);
+rt_err_t   gps_time_now(gps_time_t t, rt_int64_t *utc);
+rt_int64_t gps_time_at(gps_time_t t, rt_uint64_t local);
+void       gps_time_subscriber(gps_device_t dev, const gps_fix_t *fix, void *user_data);
+
+#endif /* __GPS_TIME_H__ */
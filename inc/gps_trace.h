@@ -0,0 +1,107 @@
+/*
+ * Copyright (c) 2020, RudyLo <luhuadong@163.com>
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ *
+ * Change Logs:
+ * Date           Author       Notes
+ * 2026-10-19     luhuadong    the first version
+ */
+
+#ifndef __GPS_TRACE_H__
+#define __GPS_TRACE_H__
+
+#include "gps.h"
+
+#ifndef GPS_TRACE_SIZE
+#define GPS_TRACE_SIZE         1024    /* events, a power of two */
+#endif
+
+#ifndef GPS_TRACE_CLOCK_HZ
+#define GPS_TRACE_CLOCK_HZ     GPS_CYCLES_HZ
+#endif
+#ifndef GPS_TRACE_SYNC_MS
+#define GPS_TRACE_SYNC_MS      1000    /* sync period, well below half a counter wrap */
+#endif
+
+/* event phase, or'ed into the id */
+#define GPS_TRACE_ENTER_FLAG   0x4000
+#define GPS_TRACE_LEAVE_FLAG   0x8000
+#define GPS_TRACE_ID_MASK      0x3fff
+
+enum gps_trace_id
+{
+    GPS_TRACE_RX_ISR = 1,      /* mark, arg: bytes indicated */
+    GPS_TRACE_RX_THREAD,       /* span, a dispatcher draining a UART, arg: device slot */
+    GPS_TRACE_SENTENCE,        /* span, arg: line length */
+    GPS_TRACE_PUBLISH,         /* span, arg: fix time ms mod 65536 */
+    GPS_TRACE_STAGE,           /* span, arg: stage index */
+    GPS_TRACE_SUBSCRIBER,      /* span, arg: subscriber index */
+    GPS_TRACE_COMMAND,         /* span, arg: PMTK number / negated result */
+    GPS_TRACE_SYNC,            /* mark, every GPS_TRACE_SYNC_MS, arg: gps_time_us() ms mod 65536 */
+    GPS_TRACE_USER = 0x100     /* first id free for applications */
+};
+
+/*
+ * 8 bytes per event. The 32-bit counter wraps every 4.29 s at 1 GHz, so
+ * while recording a sync event keeps gaps well below half a wrap, and its
+ * millisecond arg lets the decoder count the wraps of a longer stall.
+ */
+struct gps_trace_event
+{
+    rt_uint32_t cycles;        /* gps_cycles_get() */
+    rt_uint16_t id;
+    rt_uint16_t arg;
+};
+
+struct gps_trace
+{
+    volatile rt_uint32_t head;     /* total events reserved */
+    volatile rt_bool_t   enable;
+    rt_uint32_t          hz;
+    struct gps_trace_event event[GPS_TRACE_SIZE];
+};
+
+#ifdef PKG_USING_GPS_TRACE
+
+extern struct gps_trace gps_trace_ring;
+
+/* Producers may be interrupts; a slot is reserved with one atomic add. */
+rt_inline void gps_trace_event(rt_uint16_t id, rt_uint16_t arg)
+{
+    if (gps_trace_ring.enable)
+    {
+#if defined(__GNUC__) || defined(__clang__)
+        rt_uint32_t i = __atomic_fetch_add(&gps_trace_ring.head, 1, __ATOMIC_RELAXED);
+#else
+        rt_base_t level = rt_hw_interrupt_disable();
+        rt_uint32_t i = gps_trace_ring.head++;
+        rt_hw_interrupt_enable(level);
+#endif
+        struct gps_trace_event *e = &gps_trace_ring.event[i & (GPS_TRACE_SIZE - 1)];
+
+        e->cycles = gps_cycles_get();
+        e->id = id;
+        e->arg = arg;
+    }
+}
+
+void gps_trace_start(rt_uint32_t hz);
+void gps_trace_stop(void);
+void gps_trace_clear(void);
+rt_size_t gps_trace_read(struct gps_trace_event *buf, rt_size_t num);
+void gps_trace_dump(void);
+
+#define GPS_TRACE_MARK(id, arg)    gps_trace_event((id), (rt_uint16_t)(arg))
+#define GPS_TRACE_ENTER(id, arg)   gps_trace_event((id) | GPS_TRACE_ENTER_FLAG, (rt_uint16_t)(arg))
+#define GPS_TRACE_LEAVE(id, arg)   gps_trace_event((id) | GPS_TRACE_LEAVE_FLAG, (rt_uint16_t)(arg))
+
+#else
+
+#define GPS_TRACE_MARK(id, arg)    do { } while (0)
+#define GPS_TRACE_ENTER(id, arg)   do { } while (0)
+#define GPS_TRACE_LEAVE(id, arg)   do { } while (0)
+
+#endif /* PKG_USING_GPS_TRACE */
+
+#endif /* __GPS_TRACE_H__ */
@@ -0,0 +1,32 @@
+/*
+ * Copyright (c) 2020, RudyLo <luhuadong@163.com>
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ *
+ * Change Logs:
+ * Date           Author       Notes
+ * 2026-10-19     luhuadong    the first version
+ */
+
+/*
+ * Runs the gps_bench shell command from examples/ once with the program's
+ * arguments, so the host numbers come from the same code as the target's:
+ *
+ *   gps_bench multi 100 > multi.csv
+ */
+
+#include <rtthread.h>
+
+int main(int argc, char **argv)
+{
+    char cmd[RT_CONSOLEBUF_SIZE] = "gps_bench";
+    rt_size_t len = rt_strlen(cmd);
+    int i;
+
+    for (i = 1; i < argc; i++)
+        len += rt_snprintf(cmd + len, len < sizeof(cmd) ? sizeof(cmd) - len : 0, " %s", argv[i]);
+    if (len >= sizeof(cmd))
+        return 1;
+
+    return msh_exec(cmd, len) == 0 ? 0 : 1;
+}
@@ -0,0 +1,180 @@
+/*
+ * Copyright (c) 2020, RudyLo <luhuadong@163.com>
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ *
+ * Change Logs:
+ * Date           Author       Notes
+ * 2026-10-19     luhuadong    the first version
+ */
+
+/*
+ * The gps driver on a Linux host. The receiver is a pseudo terminal, fed
+ * from an NMEA file with -f or by any program writing to the printed path,
+ * or a real receiver with -d. Fixes are printed as they are published and
+ * stdin is a shell for the package's msh commands.
+ *
+ *   gps_host -f track.nmea -r 10
+ *   gps_host -d /dev/ttyUSB0 -b 9600
+ */
+
+#include <rtthread.h>
+#include <rtdevice.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include "gps.h"
+
+#define GPS_HOST_UART_NAME      "uart1"
+#define GPS_HOST_LINE_SIZE      256
+
+struct gps_host_feed
+{
+    const char *file;
+    const char *peer;
+    int rate;                   /* epochs per second, 0: as fast as possible */
+};
+
+static rt_bool_t gps_host_quiet;
+
+static void gps_host_print(gps_device_t dev, const gps_fix_t *fix, void *user_data)
+{
+    RT_UNUSED(dev);
+    RT_UNUSED(user_data);
+
+    if (gps_host_quiet)
+        return;
+
+    rt_kprintf("%02d:%02d:%02d.%03d %12.7f %12.7f %8.1f m %6.2f m/s %5.1f deg  sats %2d hdop %4.1f%s\n",
+               (int)(fix->time / 3600000), (int)(fix->time / 60000 % 60),
+               (int)(fix->time / 1000 % 60), (int)(fix->time % 1000),
+               fix->lat, fix->lon, fix->alt, fix->speed, fix->course,
+               fix->sats, fix->hdop, fix->status ? "" : "  (no fix)");
+}
+
+/* writes the file to the pty line by line, an epoch ends at each RMC */
+static void gps_host_feed_entry(void *parameter)
+{
+    struct gps_host_feed *feed = parameter;
+    char line[GPS_HOST_LINE_SIZE];
+    FILE *fp;
+    int fd;
+
+    fd = open(feed->peer, O_WRONLY | O_NOCTTY);
+    if (fd < 0)
+    {
+        rt_kprintf("Can't open '%s' (%d)\n", feed->peer, errno);
+        return;
+    }
+
+    do
+    {
+        fp = fopen(feed->file, "r");
+        if (fp == RT_NULL)
+        {
+            rt_kprintf("Can't open '%s' (%d)\n", feed->file, errno);
+            break;
+        }
+
+        while (fgets(line, sizeof(line), fp))
+        {
+            rt_size_t len = rt_strlen(line);
+
+            /* the file may have LF only, NMEA wants CR LF */
+            while (len > 0 && (line[len - 1] == '\n' || line[len - 1] == '\r'))
+                len--;
+            if (len == 0)
+                continue;
+            line[len++] = '\r';
+            line[len++] = '\n';
+
+            if (write(fd, line, len) != (ssize_t)len)
+                break;
+
+            if (feed->rate > 0 && len > 6 && rt_strncmp(line + 3, "RMC", 3) == 0)
+                rt_thread_mdelay(1000 / feed->rate);
+        }
+
+        fclose(fp);
+    } while (feed->rate > 0);
+
+    close(fd);
+}
+
+static void gps_host_usage(const char *prog)
+{
+    fprintf(stderr,
+            "usage: %s [-d tty] [-b baudrate] [-f nmea_file] [-r rate] [-q]\n"
+            "  -d tty       a real receiver, default a pseudo terminal\n"
+            "  -b baudrate  the receiver's baud rate, default 9600\n"
+            "  -f file      play an NMEA file into the pseudo terminal\n"
+            "  -r rate      epochs per second of the file, 0 once at full speed (default 1)\n"
+            "  -q           do not print fixes\n", prog);
+}
+
+int main(int argc, char **argv)
+{
+    static struct gps_host_feed feed;
+    const char *tty = RT_NULL;
+    rt_uint32_t baudrate = BAUD_RATE_9600;
+    char cmd[RT_CONSOLEBUF_SIZE];
+    gps_device_t dev;
+    int opt;
+
+    feed.rate = 1;
+    while ((opt = getopt(argc, argv, "d:b:f:r:qh")) != -1)
+    {
+        switch (opt)
+        {
+        case 'd': tty = optarg; break;
+        case 'b': baudrate = (rt_uint32_t)atoi(optarg); break;
+        case 'f': feed.file = optarg; break;
+        case 'r': feed.rate = atoi(optarg); break;
+        case 'q': gps_host_quiet = RT_TRUE; break;
+        default:
+            gps_host_usage(argv[0]);
+            return opt == 'h' ? 0 : 1;
+        }
+    }
+    if (tty && feed.file)
+    {
+        gps_host_usage(argv[0]);
+        return 1;
+    }
+
+    rt_components_init();
+
+    if (rt_hw_serial_posix_register(GPS_HOST_UART_NAME, tty) != RT_EOK)
+        return 1;
+    feed.peer = rt_hw_serial_posix_peer(GPS_HOST_UART_NAME);
+    if (tty == RT_NULL)
+        rt_kprintf("receiver pty: %s\n", feed.peer);
+
+    dev = gps_create(GPS_HOST_UART_NAME);
+    if (dev == RT_NULL)
+        return 1;
+    if (baudrate != BAUD_RATE_9600)
+    {
+        struct serial_configure config = RT_SERIAL_CONFIG_DEFAULT;
+
+        config.baud_rate = baudrate;
+        rt_device_control(dev->serial, RT_DEVICE_CTRL_CONFIG, &config);
+    }
+    gps_subscribe(dev, gps_host_print, RT_NULL);
+
+    if (feed.file)
+    {
+        rt_thread_t feeder = rt_thread_create("gps_feed", gps_host_feed_entry, &feed,
+                                              2048, RT_THREAD_PRIORITY_MAX / 2, 20);
+        if (feeder)
+            rt_thread_startup(feeder);
+    }
+
+    /* msh on stdin, EOF quits */
+    while (fgets(cmd, sizeof(cmd), stdin))
+        msh_exec(cmd, rt_strlen(cmd));
+
+    gps_delete(dev);
+
+    return 0;
+}
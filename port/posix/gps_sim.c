@@ -0,0 +1,900 @@
+/*
+ * Copyright (c) 2020, RudyLo <luhuadong@163.com>
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ *
+ * Change Logs:
+ * Date           Author       Notes
+ * 2026-10-19     luhuadong    the first version
+ */
+
+#include <rtthread.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <math.h>
+#include <poll.h>
+#include <sys/stat.h>
+#include <termios.h>
+#include <time.h>
+#include <unistd.h>
+#include "gps_sim.h"
+
+#define DBG_TAG "gps.sim"
+#define DBG_LVL DBG_INFO
+#include <rtdbg.h>
+
+#define SIM_EARTH_RADIUS     6371008.8
+#define SIM_DEG2RAD          (M_PI / 180.0)
+#define SIM_KNOTS            1.943844f       /* per m/s */
+#define SIM_GEOID            7.0f            /* geoid separation, m */
+#define SIM_SYSTEM_SATS      12
+#define SIM_POLL_MAX_MS      100             /* how soon a stop is noticed */
+
+const struct gps_sim_config gps_sim_config_default =
+{
+    .interval = 1000,
+    .baudrate = 9600,
+    .divisor  = { 1, 1, 1, 1, 1, 5 },        /* the L76 set, GSV every 5th fix */
+    .systems  = GPS_SIM_GPS,
+    .start    = GPS_SIM_START_FIX,
+    .reply_ms = 30,
+    .ttff_ms  = { 1000, 30000, 35000, 40000 },
+    .lat      = 31.2304,
+    .lon      = 121.4737,
+    .alt      = 10.0f,
+    .seed     = 1,
+};
+
+struct sim_sat
+{
+    int prn;
+    int elev;
+    int azim;
+    int snr;                    /* 0: not tracked */
+    rt_bool_t used;
+};
+
+static rt_uint64_t sim_now_us(void)
+{
+    struct timespec ts;
+
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+
+    return (rt_uint64_t)ts.tv_sec * 1000000 + ts.tv_nsec / 1000;
+}
+
+static rt_uint64_t sim_now_ms(void)
+{
+    return sim_now_us() / 1000;
+}
+
+static rt_uint32_t sim_rand(gps_sim_t sim)
+{
+    rt_uint32_t x = sim->rand;
+
+    x ^= x << 13;
+    x ^= x >> 17;
+    x ^= x << 5;
+
+    return sim->rand = x;
+}
+
+static rt_bool_t sim_chance(gps_sim_t sim, rt_uint16_t per_mille)
+{
+    return per_mille && sim_rand(sim) % 1000 < per_mille;
+}
+
+static const struct
+{
+    speed_t     speed;
+    rt_uint32_t baudrate;
+} sim_speeds[] =
+{
+    { B4800, 4800 }, { B9600, 9600 }, { B19200, 19200 }, { B38400, 38400 },
+    { B57600, 57600 }, { B115200, 115200 }, { B230400, 230400 }, { B460800, 460800 },
+    { B921600, 921600 },
+};
+
+/* the speed the other side set on the slave, what its UART would run at */
+static rt_uint32_t sim_peer_baudrate(gps_sim_t sim)
+{
+    struct termios tio;
+    speed_t speed;
+    rt_size_t i;
+
+    if (tcgetattr(sim->peer_fd, &tio) != 0)
+        return 0;
+
+    speed = cfgetispeed(&tio);
+    for (i = 0; i < sizeof(sim_speeds) / sizeof(sim_speeds[0]); i++)
+    {
+        if (sim_speeds[i].speed == speed)
+            return sim_speeds[i].baudrate;
+    }
+
+    return 0;
+}
+
+static rt_bool_t sim_valid_baudrate(rt_uint32_t baudrate)
+{
+    rt_size_t i;
+
+    for (i = 0; i < sizeof(sim_speeds) / sizeof(sim_speeds[0]); i++)
+    {
+        if (sim_speeds[i].baudrate == baudrate)
+            return baudrate <= 115200;
+    }
+
+    return RT_FALSE;
+}
+
+/**
+ * This function puts one line on the wire. The line is busy for the
+ * bytes' time at the module's baud rate; a receiver at another rate
+ * gets framing noise instead of the bytes.
+ */
+static void sim_send(gps_sim_t sim, const char *line, rt_size_t len)
+{
+    char noise[GPS_SIM_LINE_SIZE];
+    rt_uint64_t now = sim_now_us();
+    rt_size_t i;
+
+    if (sim_peer_baudrate(sim) != sim->baudrate)
+    {
+        for (i = 0; i < len && i < sizeof(noise); i++)
+            noise[i] = (char)(((rt_uint8_t)line[i] * 37 + 0x5B) | 0x80);
+        line = noise;
+        sim->garbled++;
+    }
+
+    /* nobody reading: the bytes are lost like on an open UART line */
+    if (write(sim->fd, line, len) < 0 && errno != EAGAIN)
+        LOG_W("write failed (%d)", errno);
+    sim->bytes += len;
+
+    if (sim->tx_free_us < now)
+        sim->tx_free_us = now;
+    sim->tx_free_us += (rt_uint64_t)len * 10 * 1000000 / sim->baudrate;
+
+    now = sim_now_us();
+    if (sim->tx_free_us > now && !sim->stop)
+    {
+        struct timespec ts;
+        rt_uint64_t us = sim->tx_free_us - now;
+
+        ts.tv_sec = us / 1000000;
+        ts.tv_nsec = (us % 1000000) * 1000;
+        nanosleep(&ts, RT_NULL);
+    }
+}
+
+/* formats "$..." and completes it with the checksum and CR LF */
+static rt_size_t sim_format(char *buf, const char *fmt, ...)
+{
+    va_list args;
+    rt_uint8_t sum = 0;
+    int len, i;
+
+    va_start(args, fmt);
+    len = vsnprintf(buf, GPS_SIM_LINE_SIZE - 5, fmt, args);
+    va_end(args);
+    if (len < 0)
+        return 0;
+    if (len > GPS_SIM_LINE_SIZE - 6)
+        len = GPS_SIM_LINE_SIZE - 6;
+
+    for (i = 1; i < len; i++)
+        sum ^= (rt_uint8_t)buf[i];
+
+    return len + snprintf(buf + len, 6, "*%02X\r\n", sum);
+}
+
+/* a navigation sentence, with the configured faults */
+static void sim_emit(gps_sim_t sim, char *buf, rt_size_t len)
+{
+    if (len == 0)
+        return;
+
+    if (sim_chance(sim, sim->cfg.bad_checksum))
+    {
+        buf[len - 3] = (buf[len - 3] == '0') ? '1' : '0';
+        sim->corrupted++;
+    }
+    else if (sim_chance(sim, sim->cfg.truncate))
+    {
+        len = 1 + sim_rand(sim) % (len - 3);
+        sim->truncated++;
+    }
+
+    sim_send(sim, buf, len);
+    sim->sentences++;
+}
+
+static void sim_reply(gps_sim_t sim, const char *fmt, int cmd, int flag)
+{
+    if (sim->reply_num >= sizeof(sim->reply) / sizeof(sim->reply[0]))
+        return;
+
+    sim_format(sim->reply[sim->reply_num++], fmt, cmd, flag);
+    sim->reply_at_ms = sim_now_ms() + sim->cfg.reply_ms;
+}
+
+static void sim_ack(gps_sim_t sim, int cmd, int flag)
+{
+    sim_reply(sim, "$PMTK001,%d,%d", cmd, flag);
+}
+
+/* "ddmm.mmmm,N" or "dddmm.mmmm,E" */
+static void sim_coord(char *buf, rt_size_t size, double deg, int width, char pos, char neg)
+{
+    long v = lround(fabs(deg) * 600000.0);
+    long m = v % 600000;
+
+    snprintf(buf, size, "%0*ld%02ld.%04ld,%c", width, v / 600000, m / 10000, m % 10000,
+             deg < 0 ? neg : pos);
+}
+
+static int sim_sats(gps_sim_t sim, int system, double t, rt_bool_t fixed, struct sim_sat *sat)
+{
+    int used = 0, i;
+
+    RT_UNUSED(sim);
+
+    for (i = 0; i < SIM_SYSTEM_SATS; i++)
+    {
+        sat[i].prn  = (system == GPS_SIM_GLONASS) ? 65 + i * 2 :
+                      (system == GPS_SIM_BEIDOU) ? 1 + i * 3 : 1 + i * 2;
+        sat[i].elev = 5 + (i * 37 + system * 11) % 80;
+        sat[i].azim = (i * 97 + system * 40 + (int)(t / 60)) % 360;
+        sat[i].snr  = fixed ? 18 + sat[i].elev * 30 / 90 + (i * 7) % 6 : 0;
+        sat[i].used = fixed && sat[i].elev >= 15 && used < 12;
+        if (sat[i].used)
+            used++;
+    }
+
+    return used;
+}
+
+static void sim_move(gps_sim_t sim, double t, double dt)
+{
+    if (sim->track_num > 1)
+    {
+        const struct gps_sim_point *a, *b;
+        double total = sim->track[sim->track_num - 1].t;
+        double dn, de, f;
+        rt_uint32_t i = 0;
+
+        t = (total > 0) ? fmod(t, total) : 0;
+        while (i + 2 < sim->track_num && sim->track[i + 1].t <= t)
+            i++;
+        a = &sim->track[i];
+        b = &sim->track[i + 1];
+
+        f = (b->t > a->t) ? (t - a->t) / (b->t - a->t) : 0;
+        sim->lat = a->lat + (b->lat - a->lat) * f;
+        sim->lon = a->lon + (b->lon - a->lon) * f;
+        sim->alt = a->alt + (b->alt - a->alt) * (float)f;
+
+        dn = (b->lat - a->lat) * SIM_DEG2RAD * SIM_EARTH_RADIUS;
+        de = (b->lon - a->lon) * SIM_DEG2RAD * SIM_EARTH_RADIUS * cos(a->lat * SIM_DEG2RAD);
+        sim->speed = (b->t > a->t) ? (float)(sqrt(dn * dn + de * de) / (b->t - a->t)) : 0;
+        if (sim->speed > 0)
+            sim->course = (float)fmod(atan2(de, dn) / SIM_DEG2RAD + 360.0, 360.0);
+        return;
+    }
+
+    if (sim->speed > 0)
+    {
+        double d = sim->speed * dt;
+        double c;
+
+        sim->course = (float)fmod(sim->course + sim->cfg.turn * dt + 360.0, 360.0);
+        c = sim->course * SIM_DEG2RAD;
+        sim->lat += d * cos(c) / SIM_EARTH_RADIUS / SIM_DEG2RAD;
+        sim->lon += d * sin(c) / (SIM_EARTH_RADIUS * cos(sim->lat * SIM_DEG2RAD)) / SIM_DEG2RAD;
+    }
+}
+
+/**
+ * This function sends one epoch in the L76 order: RMC, VTG, GGA, GSA,
+ * GSV, GLL, each when its PMTK314 divisor is due
+ */
+static void sim_epoch(gps_sim_t sim, rt_uint64_t epoch_ms)
+{
+    static const struct { int system; const char *talker; } systems[] =
+    {
+        { GPS_SIM_GPS, "GP" }, { GPS_SIM_GLONASS, "GL" }, { GPS_SIM_BEIDOU, "BD" },
+    };
+    struct sim_sat sat[3][SIM_SYSTEM_SATS];
+    const rt_uint8_t *div = sim->cfg.divisor;
+    const char *tk = (sim->cfg.systems == GPS_SIM_GPS) ? "GP" : "GN";
+    rt_bool_t fixed = epoch_ms >= sim->fix_at_ms;
+    rt_bool_t timed = fixed || sim->restart < GPS_SIM_START_COLD;
+    char line[GPS_SIM_LINE_SIZE], tod[24] = "", date[24] = "", lat[32] = "", lon[32] = "";
+    double t = (epoch_ms - sim->start_ms) / 1000.0;
+    float hdop, knots = sim->speed * SIM_KNOTS;
+    int used = 0, s, i;
+
+#define DUE(n)  (div[n] && sim->count % div[n] == 0)
+
+    if (timed)
+    {
+        rt_int64_t utc = (rt_int64_t)epoch_ms + sim->utc_ms;
+        time_t sec = (time_t)(utc / 1000);
+        struct tm tm;
+
+        gmtime_r(&sec, &tm);
+        snprintf(tod, sizeof(tod), "%02d%02d%02d.%03d", tm.tm_hour, tm.tm_min, tm.tm_sec, (int)(utc % 1000));
+        snprintf(date, sizeof(date), "%02d%02d%02d", tm.tm_mday, tm.tm_mon + 1, tm.tm_year % 100);
+    }
+    sim_coord(lat, sizeof(lat), sim->lat, 2, 'N', 'S');
+    sim_coord(lon, sizeof(lon), sim->lon, 3, 'E', 'W');
+
+    for (s = 0; s < 3; s++)
+    {
+        if (sim->cfg.systems & systems[s].system)
+            used += sim_sats(sim, systems[s].system, t, fixed, sat[s]);
+    }
+    hdop = used ? 0.6f + 4.0f / used : 99.99f;
+
+    if (DUE(GPS_SIM_RMC))
+    {
+        if (fixed)
+            sim_emit(sim, line, sim_format(line, "$%sRMC,%s,A,%s,%s,%.2f,%.2f,%s,,,A",
+                                           tk, tod, lat, lon, knots, sim->course, date));
+        else
+            sim_emit(sim, line, sim_format(line, "$%sRMC,%s,V,,,,,0.00,0.00,%s,,,N", tk, tod, date));
+    }
+
+    if (DUE(GPS_SIM_VTG))
+    {
+        if (fixed)
+            sim_emit(sim, line, sim_format(line, "$%sVTG,%.2f,T,,M,%.2f,N,%.2f,K,A",
+                                           tk, sim->course, knots, sim->speed * 3.6f));
+        else
+            sim_emit(sim, line, sim_format(line, "$%sVTG,,T,,M,,N,,K,N", tk));
+    }
+
+    if (DUE(GPS_SIM_GGA))
+    {
+        if (fixed)
+            sim_emit(sim, line, sim_format(line, "$%sGGA,%s,%s,%s,1,%02d,%.2f,%.1f,M,%.1f,M,,",
+                                           tk, tod, lat, lon, used, hdop, sim->alt, SIM_GEOID));
+        else
+            sim_emit(sim, line, sim_format(line, "$%sGGA,%s,,,,,0,0,,,M,,M,,", tk, tod));
+    }
+
+    for (s = 0; s < 3 && DUE(GPS_SIM_GSA); s++)
+    {
+        char prn[12 * 3 + 1] = "";
+        int n = 0, len = 0;
+
+        if (!(sim->cfg.systems & systems[s].system))
+            continue;
+
+        for (i = 0; i < SIM_SYSTEM_SATS && n < 12; i++)
+        {
+            if (sat[s][i].used)
+            {
+                len += snprintf(prn + len, sizeof(prn) - len, "%02d,", sat[s][i].prn);
+                n++;
+            }
+        }
+        for (; n < 12; n++)
+            len += snprintf(prn + len, sizeof(prn) - len, ",");
+
+        if (fixed)
+            sim_emit(sim, line, sim_format(line, "$%sGSA,A,3,%s%.2f,%.2f,%.2f",
+                                           tk, prn, hdop * 1.6f, hdop, hdop * 1.2f));
+        else
+            sim_emit(sim, line, sim_format(line, "$%sGSA,A,1,%s,,", tk, prn));
+    }
+
+    for (s = 0; s < 3 && DUE(GPS_SIM_GSV); s++)
+    {
+        int total = (SIM_SYSTEM_SATS + 3) / 4;
+
+        if (!(sim->cfg.systems & systems[s].system))
+            continue;
+
+        for (i = 0; i < total; i++)
+        {
+            char field[4][48];
+            int k;
+
+            for (k = 0; k < 4; k++)
+            {
+                const struct sim_sat *p = &sat[s][i * 4 + k];
+
+                if (p->snr)
+                    snprintf(field[k], sizeof(field[k]), "%02d,%02d,%03d,%02d", p->prn, p->elev, p->azim, p->snr);
+                else
+                    snprintf(field[k], sizeof(field[k]), "%02d,%02d,%03d,", p->prn, p->elev, p->azim);
+            }
+            sim_emit(sim, line, sim_format(line, "$%sGSV,%d,%d,%02d,%s,%s,%s,%s", systems[s].talker,
+                                           total, i + 1, SIM_SYSTEM_SATS,
+                                           field[0], field[1], field[2], field[3]));
+        }
+    }
+
+    if (DUE(GPS_SIM_GLL))
+    {
+        if (fixed)
+            sim_emit(sim, line, sim_format(line, "$%sGLL,%s,%s,%s,A,A", tk, lat, lon, tod));
+        else
+            sim_emit(sim, line, sim_format(line, "$%sGLL,,,,,%s,V,N", tk, tod));
+    }
+
+#undef DUE
+}
+
+/* the first epoch after 'ms', epochs fall on whole intervals of UTC */
+static rt_uint64_t sim_align(gps_sim_t sim, rt_uint64_t ms)
+{
+    rt_uint64_t utc = (rt_uint64_t)((rt_int64_t)ms + sim->utc_ms);
+
+    return ms + sim->cfg.interval - utc % sim->cfg.interval;
+}
+
+/* a restart, or power-on with start = cfg.start */
+static void sim_restart(gps_sim_t sim, rt_uint8_t start, rt_uint64_t now)
+{
+    if (start == GPS_SIM_START_FULL_COLD)
+        sim->cfg = sim->boot;
+
+    sim->restart = start;
+    sim->power = 0;
+    sim->fix_at_ms = (start == GPS_SIM_START_FIX) ? 0 : now + sim->cfg.ttff_ms[start - 1];
+    sim->banner_at_ms = now + sim->cfg.reply_ms;
+    sim->epoch_ms = sim_align(sim, sim->banner_at_ms);
+}
+
+static rt_uint32_t sim_interval(gps_sim_t sim)
+{
+    if ((sim->power == 8 || sim->power == 9) && sim->cfg.interval < 1000)
+        return 1000;
+
+    return sim->cfg.interval;
+}
+
+static rt_bool_t sim_awake(gps_sim_t sim, rt_uint64_t now)
+{
+    rt_uint32_t period = sim->run_ms + sim->sleep_ms;
+
+    if (sim->power == 4)
+        return RT_FALSE;
+    if (sim->power == 2 && period > 0)
+        return (now - sim->power_ms) % period < sim->run_ms;
+
+    return RT_TRUE;
+}
+
+static void sim_command(gps_sim_t sim, char *line, rt_size_t len, rt_uint64_t now)
+{
+    int argv[20], argc = 0, cmd, i;
+    rt_uint8_t sum = 0;
+    char *p, *star;
+
+    /* the module drops anything that is not a well-formed PMTK packet */
+    star = memchr(line, '*', len);
+    if (line[0] != '$' || star == RT_NULL || star + 3 > line + len)
+        return;
+    for (p = line + 1; p < star; p++)
+        sum ^= (rt_uint8_t)*p;
+    if (strtoul(star + 1, RT_NULL, 16) != sum || rt_strncmp(line + 1, "PMTK", 4) != 0)
+        return;
+
+    *star = '\0';
+    cmd = atoi(line + 5);
+    for (p = strchr(line, ','); p && argc < 20; p = strchr(p + 1, ','))
+        argv[argc++] = atoi(p + 1);
+    sim->commands++;
+
+    switch (cmd)
+    {
+    case 101:
+    case 102:
+    case 103:
+    case 104:
+        /* no acknowledge, the PMTK010/011 banner follows */
+        sim_restart(sim, (rt_uint8_t)(cmd - 100), now);
+        break;
+
+    case 220:
+        if (argc >= 1 && argv[0] >= 100 && argv[0] <= 10000)
+        {
+            sim->cfg.interval = argv[0];
+            sim->epoch_ms = sim_align(sim, now);
+            sim_ack(sim, cmd, 3);
+        }
+        else
+            sim_ack(sim, cmd, 2);
+        break;
+
+    case 225:
+        if (argc >= 1 && (argv[0] == 0 || argv[0] == 4 || argv[0] == 8 || argv[0] == 9 ||
+                          (argv[0] == 2 && argc >= 3)))
+        {
+            sim->power = (rt_uint8_t)argv[0];
+            sim->power_ms = now;
+            if (argv[0] == 2)
+            {
+                sim->run_ms = argv[1];
+                sim->sleep_ms = argv[2];
+            }
+            sim_ack(sim, cmd, 3);
+        }
+        else
+            sim_ack(sim, cmd, 2);
+        break;
+
+    case 251:
+        /* taken once the command has been processed, never acknowledged */
+        if (argc >= 1 && (argv[0] == 0 || sim_valid_baudrate(argv[0])))
+        {
+            sim->baud_next = argv[0] ? (rt_uint32_t)argv[0] : sim->boot.baudrate;
+            sim->baud_at_ms = now + sim->cfg.reply_ms;
+        }
+        break;
+
+    case 314:
+        if (argc == 1 && argv[0] == -1)
+        {
+            rt_memcpy(sim->cfg.divisor, sim->boot.divisor, sizeof(sim->cfg.divisor));
+            sim_ack(sim, cmd, 3);
+        }
+        else if (argc >= GPS_SIM_SENTENCE_NUM)
+        {
+            for (i = 0; i < GPS_SIM_SENTENCE_NUM; i++)
+                sim->cfg.divisor[i] = (argv[i] < 0) ? 0 : (argv[i] > 5) ? 5 : (rt_uint8_t)argv[i];
+            sim_ack(sim, cmd, 3);
+        }
+        else
+            sim_ack(sim, cmd, 2);
+        break;
+
+    default:
+        sim_ack(sim, cmd, 1);
+        break;
+    }
+}
+
+static void sim_receive(gps_sim_t sim, rt_uint64_t now)
+{
+    char buf[256];
+    ssize_t len, i;
+
+    len = read(sim->fd, buf, sizeof(buf));
+    if (len <= 0)
+        return;
+
+    /* at another baud rate the module's UART sees only framing errors */
+    if (sim_peer_baudrate(sim) != sim->baudrate)
+        return;
+
+    if (sim->power == 4)
+        sim_restart(sim, GPS_SIM_START_HOT, now);
+
+    for (i = 0; i < len; i++)
+    {
+        if (buf[i] == '$')
+            sim->rx_len = 0;
+        if (sim->rx_len < sizeof(sim->rx_line) - 1)
+            sim->rx_line[sim->rx_len++] = buf[i];
+
+        if (buf[i] == '\n')
+        {
+            sim->rx_line[sim->rx_len] = '\0';
+            sim_command(sim, sim->rx_line, sim->rx_len, now);
+            sim->rx_len = 0;
+        }
+    }
+}
+
+static void sim_entry(void *parameter)
+{
+    gps_sim_t sim = parameter;
+
+    while (!sim->stop)
+    {
+        struct pollfd pfd = { sim->fd, POLLIN, 0 };
+        rt_uint64_t now = sim_now_ms();
+        rt_uint64_t next = sim->banner_at_ms ? sim->banner_at_ms : sim->epoch_ms;
+        rt_uint32_t interval;
+
+        if (sim->reply_num && sim->reply_at_ms < next)
+            next = sim->reply_at_ms;
+        if (sim->baud_next && sim->baud_at_ms < next)
+            next = sim->baud_at_ms;
+        next = (next > now) ? next - now : 0;
+
+        if (poll(&pfd, 1, next > SIM_POLL_MAX_MS ? SIM_POLL_MAX_MS : (int)next) > 0)
+            sim_receive(sim, sim_now_ms());
+
+        now = sim_now_ms();
+        if (sim->reply_num && now >= sim->reply_at_ms)
+        {
+            rt_uint8_t i;
+
+            for (i = 0; i < sim->reply_num; i++)
+                sim_send(sim, sim->reply[i], rt_strlen(sim->reply[i]));
+            sim->reply_num = 0;
+        }
+
+        if (sim->baud_next && now >= sim->baud_at_ms)
+        {
+            sim->baudrate = sim->baud_next;
+            sim->baud_next = 0;
+        }
+
+        if (sim->banner_at_ms)
+        {
+            if (now >= sim->banner_at_ms)
+            {
+                char line[GPS_SIM_LINE_SIZE];
+
+                sim_send(sim, line, sim_format(line, "$PMTK011,MTKGPS"));
+                sim_send(sim, line, sim_format(line, "$PMTK010,001"));
+                sim->banner_at_ms = 0;
+            }
+            continue;
+        }
+
+        if (now < sim->epoch_ms)
+            continue;
+
+        /* the wire is still busy with older epochs: the module skips */
+        interval = sim_interval(sim);
+        if (now >= sim->epoch_ms + interval)
+        {
+            rt_uint32_t n = (rt_uint32_t)((now - sim->epoch_ms) / interval);
+
+            sim->skipped += n;
+            sim->count += n;
+            sim->epoch_ms += (rt_uint64_t)n * interval;
+        }
+
+        sim_move(sim, (sim->epoch_ms - sim->start_ms) / 1000.0, interval / 1000.0);
+        if (sim_awake(sim, now))
+        {
+            if (sim_chance(sim, sim->cfg.drop_epoch))
+                sim->dropped++;
+            else
+                sim_epoch(sim, sim->epoch_ms);
+            sim->epochs++;
+        }
+        sim->count++;
+        sim->epoch_ms += interval;
+    }
+
+    sim->done = RT_TRUE;
+}
+
+/**
+ * This function creates the pseudo terminal and powers the module on
+ *
+ * @param sim the simulator
+ * @param cfg the configuration, RT_NULL for a fixed 1 Hz L76 at 9600 baud
+ *
+ * @return RT_EOK on success
+ */
+rt_err_t gps_sim_init(gps_sim_t sim, const struct gps_sim_config *cfg)
+{
+    RT_ASSERT(sim);
+
+    struct termios tio;
+    struct timespec ts;
+    rt_uint64_t now, utc;
+    rt_size_t i;
+
+    rt_memset(sim, 0, sizeof(struct gps_sim));
+    sim->cfg = cfg ? *cfg : gps_sim_config_default;
+    sim->boot = sim->cfg;
+    sim->peer_fd = -1;
+
+    for (i = 0; i < sizeof(sim_speeds) / sizeof(sim_speeds[0]); i++)
+    {
+        if (sim_speeds[i].baudrate == sim->cfg.baudrate)
+            break;
+    }
+    if (i == sizeof(sim_speeds) / sizeof(sim_speeds[0]) || sim->cfg.interval < 100 ||
+        sim->cfg.systems == 0 || sim->cfg.start > GPS_SIM_START_FULL_COLD)
+    {
+        LOG_E("invalid configuration");
+        return -RT_EINVAL;
+    }
+
+    sim->fd = posix_openpt(O_RDWR | O_NOCTTY | O_NONBLOCK);
+    if (sim->fd < 0 || grantpt(sim->fd) != 0 || unlockpt(sim->fd) != 0)
+    {
+        LOG_E("Can't create a pseudo terminal (%d)", errno);
+        goto __close;
+    }
+    rt_strncpy(sim->peer, ptsname(sim->fd), sizeof(sim->peer) - 1);
+
+    /* raw at the module's rate, so a plain 'cat' of the slave works too */
+    sim->peer_fd = open(sim->peer, O_RDWR | O_NOCTTY | O_NONBLOCK);
+    if (sim->peer_fd < 0 || tcgetattr(sim->peer_fd, &tio) != 0)
+    {
+        LOG_E("Can't open '%s' (%d)", sim->peer, errno);
+        goto __close;
+    }
+    cfmakeraw(&tio);
+    tio.c_cflag |= CLOCAL | CREAD;
+    cfsetispeed(&tio, sim_speeds[i].speed);
+    cfsetospeed(&tio, sim_speeds[i].speed);
+    tcsetattr(sim->peer_fd, TCSANOW, &tio);
+
+    sim->baudrate = sim->cfg.baudrate;
+    sim->rand = sim->cfg.seed ? sim->cfg.seed : 1;
+    sim->lat = sim->cfg.lat;
+    sim->lon = sim->cfg.lon;
+    sim->alt = sim->cfg.alt;
+    sim->speed = sim->cfg.speed;
+    sim->course = sim->cfg.course;
+
+    now = sim_now_ms();
+    clock_gettime(CLOCK_REALTIME, &ts);
+    utc = (rt_uint64_t)ts.tv_sec * 1000 + ts.tv_nsec / 1000000;
+    sim->utc_ms = (rt_int64_t)utc - (rt_int64_t)now;
+    sim->start_ms = now;
+    sim_restart(sim, sim->cfg.start, now);
+
+    return RT_EOK;
+
+__close:
+    if (sim->peer_fd >= 0)
+        close(sim->peer_fd);
+    if (sim->fd >= 0)
+        close(sim->fd);
+
+    return -RT_EIO;
+}
+
+/**
+ * This function loads a scripted trajectory, one "seconds,lat,lon[,alt]"
+ * point per line; '#' starts a comment. The script loops at its end.
+ */
+rt_err_t gps_sim_load(gps_sim_t sim, const char *path)
+{
+    RT_ASSERT(sim);
+    RT_ASSERT(path);
+
+    char line[128];
+    FILE *fp;
+
+    fp = fopen(path, "r");
+    if (fp == RT_NULL)
+    {
+        LOG_E("Can't open '%s'", path);
+        return -RT_EIO;
+    }
+
+    rt_free(sim->track);
+    sim->track = rt_calloc(GPS_SIM_TRACK_MAX, sizeof(struct gps_sim_point));
+    sim->track_num = 0;
+    if (sim->track == RT_NULL)
+    {
+        fclose(fp);
+        return -RT_ENOMEM;
+    }
+
+    while (fgets(line, sizeof(line), fp) && sim->track_num < GPS_SIM_TRACK_MAX)
+    {
+        struct gps_sim_point *p = &sim->track[sim->track_num];
+        int n;
+
+        if (line[0] == '#')
+            continue;
+
+        p->alt = sim->cfg.alt;
+        n = sscanf(line, "%lf,%lf,%lf,%f", &p->t, &p->lat, &p->lon, &p->alt);
+        if (n < 3)
+            continue;
+        if (sim->track_num > 0 && p->t <= sim->track[sim->track_num - 1].t)
+        {
+            LOG_E("'%s': time must increase", path);
+            break;
+        }
+        sim->track_num++;
+    }
+    fclose(fp);
+
+    if (sim->track_num < 2)
+    {
+        LOG_E("'%s': at least two points are needed", path);
+        rt_free(sim->track);
+        sim->track = RT_NULL;
+        sim->track_num = 0;
+        return -RT_ERROR;
+    }
+
+    sim->lat = sim->track[0].lat;
+    sim->lon = sim->track[0].lon;
+    sim->alt = sim->track[0].alt;
+
+    return RT_EOK;
+}
+
+/**
+ * This function makes a symlink to the slave, e.g. for a program with a
+ * fixed device name. An existing symlink at the path is replaced.
+ */
+rt_err_t gps_sim_link(gps_sim_t sim, const char *path)
+{
+    RT_ASSERT(sim);
+    RT_ASSERT(path);
+
+    struct stat st;
+
+    if (lstat(path, &st) == 0 && S_ISLNK(st.st_mode))
+        unlink(path);
+
+    if (symlink(sim->peer, path) != 0)
+    {
+        LOG_E("Can't link '%s' to '%s' (%d)", path, sim->peer, errno);
+        return -RT_EIO;
+    }
+    rt_strncpy(sim->link, path, sizeof(sim->link) - 1);
+
+    return RT_EOK;
+}
+
+rt_err_t gps_sim_start(gps_sim_t sim)
+{
+    RT_ASSERT(sim);
+
+    sim->tid = rt_thread_create("gps_sim", sim_entry, sim, 4096, RT_THREAD_PRIORITY_MAX / 3, 20);
+    if (sim->tid == RT_NULL)
+        return -RT_ENOMEM;
+
+    return rt_thread_startup(sim->tid);
+}
+
+/**
+ * This function stops the receiver after the sentence it is sending, the
+ * pty stays open so the other side can read what is already on the wire
+ */
+void gps_sim_stop(gps_sim_t sim)
+{
+    RT_ASSERT(sim);
+
+    if (sim->tid)
+    {
+        sim->stop = RT_TRUE;
+        while (!sim->done)
+            rt_thread_mdelay(1);
+        sim->tid = RT_NULL;
+    }
+}
+
+/**
+ * This function stops the module and removes the pseudo terminal
+ */
+void gps_sim_detach(gps_sim_t sim)
+{
+    RT_ASSERT(sim);
+
+    gps_sim_stop(sim);
+
+    if (sim->link[0])
+        unlink(sim->link);
+    close(sim->peer_fd);
+    close(sim->fd);
+    rt_free(sim->track);
+    sim->track = RT_NULL;
+}
+
+void gps_sim_show(gps_sim_t sim)
+{
+    RT_ASSERT(sim);
+
+    rt_kprintf("epochs %d, sentences %d, bytes %d, commands %d\n",
+               (int)sim->epochs, (int)sim->sentences, (int)sim->bytes, (int)sim->commands);
+    rt_kprintf("skipped %d, garbled %d; injected: dropped %d, bad checksum %d, truncated %d\n",
+               (int)sim->skipped, (int)sim->garbled, (int)sim->dropped,
+               (int)sim->corrupted, (int)sim->truncated);
+    rt_kprintf("baud %d, interval %d ms, power mode %d, %s\n",
+               (int)sim->baudrate, (int)sim_interval(sim), (int)sim->power,
+               sim_now_ms() >= sim->fix_at_ms ? "fixed" : "no fix");
+}
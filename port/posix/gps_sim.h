@@ -0,0 +1,173 @@
+/*
+ * Copyright (c) 2020, RudyLo <luhuadong@163.com>
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ *
+ * Change Logs:
+ * Date           Author       Notes
+ * 2026-10-19     luhuadong    the first version
+ */
+
+#ifndef __GPS_SIM_H__
+#define __GPS_SIM_H__
+
+#include <rtthread.h>
+
+/*
+ * A simulated L76 on the master side of a pseudo terminal. Whatever opens
+ * the slave side (the POSIX port with -d, the RaspberryPi example through
+ * a symlink) sees the module: checksummed RMC, VTG, GGA, GSA, GSV and GLL
+ * at the fix interval, paced at the baud rate, with PMTK001 answers after
+ * a reply delay. Bytes only get through when the slave's termios speed
+ * matches the module's baud rate, like a real UART.
+ *
+ * Commands handled:
+ *   PMTK101-104  hot, warm, cold, full cold restart; PMTK010/011 banner,
+ *                then no fix for the configured time to first fix
+ *   PMTK220      fix interval, 100 ~ 10000 ms
+ *   PMTK225      power mode: 0 normal, 2 periodic, 4 backup (silent until
+ *                the next byte received), 8/9 AlwaysLocate (1 Hz at most)
+ *   PMTK251      baud rate, taken after the reply delay, not acknowledged
+ *   PMTK314      sentence output divisors, -1 for the default set
+ * other PMTK packets get flag 1 (unsupported).
+ */
+
+#ifndef GPS_SIM_LINE_SIZE
+#define GPS_SIM_LINE_SIZE       96
+#endif
+#ifndef GPS_SIM_SAT_MAX
+#define GPS_SIM_SAT_MAX         36      /* 12 per constellation */
+#endif
+#ifndef GPS_SIM_TRACK_MAX
+#define GPS_SIM_TRACK_MAX       1024    /* scripted trajectory points */
+#endif
+
+/* gps_sim_config.systems */
+#define GPS_SIM_GPS             0x01
+#define GPS_SIM_GLONASS         0x02
+#define GPS_SIM_BEIDOU          0x04
+
+/* gps_sim_config.start */
+enum gps_sim_start
+{
+    GPS_SIM_START_FIX = 0,      /* already fixed */
+    GPS_SIM_START_HOT,
+    GPS_SIM_START_WARM,
+    GPS_SIM_START_COLD,
+    GPS_SIM_START_FULL_COLD,
+};
+
+/* PMTK314 divisors, in the command's field order */
+enum gps_sim_sentence
+{
+    GPS_SIM_GLL = 0,
+    GPS_SIM_RMC,
+    GPS_SIM_VTG,
+    GPS_SIM_GGA,
+    GPS_SIM_GSA,
+    GPS_SIM_GSV,
+    GPS_SIM_SENTENCE_NUM,
+};
+
+struct gps_sim_config
+{
+    rt_uint32_t interval;          /* fix interval, ms */
+    rt_uint32_t baudrate;
+    rt_uint8_t  divisor[GPS_SIM_SENTENCE_NUM];  /* 0 off, N every N fixes */
+    rt_uint8_t  systems;           /* GPS_SIM_* */
+    rt_uint8_t  start;             /* enum gps_sim_start */
+    rt_uint32_t reply_ms;          /* command to answer */
+    rt_uint32_t ttff_ms[4];        /* hot, warm, cold, full cold */
+
+    /* generated trajectory, used without a script */
+    double      lat;               /* start, degrees */
+    double      lon;
+    float       alt;               /* metres */
+    float       speed;             /* m/s */
+    float       course;            /* degrees */
+    float       turn;              /* degrees/s, 0 drives straight */
+
+    /* faults, per thousand sentences or epochs */
+    rt_uint16_t bad_checksum;
+    rt_uint16_t truncate;
+    rt_uint16_t drop_epoch;
+    rt_uint32_t seed;
+};
+
+struct gps_sim_point
+{
+    double t;                      /* seconds from the script start */
+    double lat;
+    double lon;
+    float  alt;
+};
+
+struct gps_sim
+{
+    struct gps_sim_config cfg;
+    struct gps_sim_config boot;    /* settings a full cold restart returns to */
+
+    int          fd;               /* pty master */
+    int          peer_fd;          /* the slave, held to read its termios */
+    char         peer[64];
+    char         link[64];         /* symlink to the slave, if any */
+
+    /* trajectory */
+    struct gps_sim_point *track;
+    rt_uint32_t  track_num;
+    double       lat, lon;
+    float        alt, speed, course;
+
+    /* receiver state */
+    rt_uint32_t  baudrate;         /* the module's current rate */
+    rt_uint32_t  baud_next;
+    rt_uint64_t  baud_at_ms;
+    rt_uint8_t   power;            /* PMTK225 mode */
+    rt_uint32_t  run_ms, sleep_ms; /* PMTK225,2 periods */
+    rt_uint64_t  power_ms;         /* when the power mode was set */
+    rt_uint8_t   restart;          /* enum gps_sim_start of the last restart */
+    rt_uint64_t  fix_at_ms;        /* no fix before this */
+    rt_uint64_t  banner_at_ms;     /* start-up banner due, 0 if none */
+    rt_uint64_t  epoch_ms;         /* the next epoch, monotonic ms */
+    rt_int64_t   utc_ms;           /* UTC minus monotonic time, ms */
+    rt_uint64_t  start_ms;
+    rt_uint32_t  count;            /* epochs since start, for divisors */
+    rt_uint32_t  rand;
+
+    /* wire, one thread sends and receives */
+    rt_uint64_t  tx_free_us;       /* the line is busy until then */
+    char         rx_line[GPS_SIM_LINE_SIZE];
+    rt_size_t    rx_len;
+    rt_uint64_t  reply_at_ms;
+    char         reply[4][GPS_SIM_LINE_SIZE];
+    rt_uint8_t   reply_num;
+
+    rt_thread_t  tid;
+    volatile rt_bool_t stop;
+    volatile rt_bool_t done;
+
+    /* statistics */
+    rt_uint32_t  epochs;
+    rt_uint32_t  sentences;
+    rt_uint32_t  bytes;
+    rt_uint32_t  skipped;          /* epochs the wire had no time for */
+    rt_uint32_t  dropped;          /* injected: epochs */
+    rt_uint32_t  corrupted;        /* injected: checksums */
+    rt_uint32_t  truncated;        /* injected: lines */
+    rt_uint32_t  garbled;          /* lines sent at a mismatched baud rate */
+    rt_uint32_t  commands;
+};
+typedef struct gps_sim *gps_sim_t;
+
+/* a fixed 1 Hz L76 at 9600 baud, what gps_sim_init(sim, RT_NULL) uses */
+extern const struct gps_sim_config gps_sim_config_default;
+
+rt_err_t gps_sim_init(gps_sim_t sim, const struct gps_sim_config *cfg);
+rt_err_t gps_sim_load(gps_sim_t sim, const char *path);
+rt_err_t gps_sim_link(gps_sim_t sim, const char *path);
+rt_err_t gps_sim_start(gps_sim_t sim);
+void     gps_sim_stop(gps_sim_t sim);
+void     gps_sim_detach(gps_sim_t sim);
+void     gps_sim_show(gps_sim_t sim);
+
+#endif /* __GPS_SIM_H__ */
@@ -0,0 +1,141 @@
+/*
+ * Copyright (c) 2020, RudyLo <luhuadong@163.com>
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ *
+ * Change Logs:
+ * Date           Author       Notes
+ * 2026-10-19     luhuadong    the first version
+ */
+
+/*
+ * The L76 simulator as a program. It prints the pty slave to connect to,
+ * runs until interrupted and prints its statistics.
+ *
+ *   gps_sim -b 9600 -i 1000 -l /tmp/ttyGPS
+ *   gps_host -d /tmp/ttyGPS
+ */
+
+#include <rtthread.h>
+#include <signal.h>
+#include <unistd.h>
+#include "gps_sim.h"
+
+static volatile sig_atomic_t gps_sim_quit;
+
+static void gps_sim_signal(int sig)
+{
+    RT_UNUSED(sig);
+    gps_sim_quit = 1;
+}
+
+static void gps_sim_usage(const char *prog)
+{
+    fprintf(stderr,
+            "usage: %s [options]\n"
+            "  -b baudrate          module baud rate, default 9600\n"
+            "  -i ms                fix interval, default 1000\n"
+            "  -m gll,rmc,vtg,gga,gsa,gsv  PMTK314 divisors, default 1,1,1,1,1,5\n"
+            "  -g systems           any of g (GPS), r (GLONASS), b (BeiDou), default g\n"
+            "  -s start             fix, hot, warm, cold or full, default fix\n"
+            "  -T hot,warm,cold,full  time to first fix, ms\n"
+            "  -d ms                command reply delay, default 30\n"
+            "  -p lat,lon[,alt]     start position\n"
+            "  -v speed,course[,turn]  m/s, degrees, degrees/s\n"
+            "  -t file              scripted trajectory, seconds,lat,lon[,alt] per line\n"
+            "  -f crc,trunc,drop    faults per thousand sentences/epochs\n"
+            "  -e seed              fault generator seed\n"
+            "  -l path              symlink to the pty slave, e.g. /dev/ttyS0\n", prog);
+}
+
+int main(int argc, char **argv)
+{
+    static const char *starts[] = { "fix", "hot", "warm", "cold", "full" };
+    static struct gps_sim sim;
+    struct gps_sim_config cfg;
+    const char *script = RT_NULL, *link = RT_NULL;
+    int opt, i;
+
+    cfg = gps_sim_config_default;
+    while ((opt = getopt(argc, argv, "b:i:m:g:s:T:d:p:v:t:f:e:l:h")) != -1)
+    {
+        int d[GPS_SIM_SENTENCE_NUM];
+
+        switch (opt)
+        {
+        case 'b': cfg.baudrate = (rt_uint32_t)atoi(optarg); break;
+        case 'i': cfg.interval = (rt_uint32_t)atoi(optarg); break;
+        case 'm':
+            if (sscanf(optarg, "%d,%d,%d,%d,%d,%d", &d[0], &d[1], &d[2], &d[3], &d[4], &d[5]) != 6)
+                goto __usage;
+            for (i = 0; i < GPS_SIM_SENTENCE_NUM; i++)
+                cfg.divisor[i] = (rt_uint8_t)d[i];
+            break;
+        case 'g':
+            cfg.systems = 0;
+            for (i = 0; optarg[i]; i++)
+            {
+                cfg.systems |= (optarg[i] == 'g') ? GPS_SIM_GPS :
+                               (optarg[i] == 'r') ? GPS_SIM_GLONASS :
+                               (optarg[i] == 'b') ? GPS_SIM_BEIDOU : 0;
+            }
+            break;
+        case 's':
+            for (i = 0; i < 5 && rt_strcmp(optarg, starts[i]) != 0; i++)
+                ;
+            if (i == 5)
+                goto __usage;
+            cfg.start = (rt_uint8_t)i;
+            break;
+        case 'T':
+            if (sscanf(optarg, "%u,%u,%u,%u", &cfg.ttff_ms[0], &cfg.ttff_ms[1],
+                       &cfg.ttff_ms[2], &cfg.ttff_ms[3]) != 4)
+                goto __usage;
+            break;
+        case 'd': cfg.reply_ms = (rt_uint32_t)atoi(optarg); break;
+        case 'p':
+            if (sscanf(optarg, "%lf,%lf,%f", &cfg.lat, &cfg.lon, &cfg.alt) < 2)
+                goto __usage;
+            break;
+        case 'v':
+            if (sscanf(optarg, "%f,%f,%f", &cfg.speed, &cfg.course, &cfg.turn) < 2)
+                goto __usage;
+            break;
+        case 't': script = optarg; break;
+        case 'f':
+            if (sscanf(optarg, "%hu,%hu,%hu", &cfg.bad_checksum, &cfg.truncate, &cfg.drop_epoch) != 3)
+                goto __usage;
+            break;
+        case 'e': cfg.seed = (rt_uint32_t)strtoul(optarg, RT_NULL, 0); break;
+        case 'l': link = optarg; break;
+        default:
+            goto __usage;
+        }
+    }
+
+    if (gps_sim_init(&sim, &cfg) != RT_EOK)
+        return 1;
+    if ((script && gps_sim_load(&sim, script) != RT_EOK) ||
+        (link && gps_sim_link(&sim, link) != RT_EOK) ||
+        gps_sim_start(&sim) != RT_EOK)
+    {
+        gps_sim_detach(&sim);
+        return 1;
+    }
+
+    signal(SIGINT, gps_sim_signal);
+    signal(SIGTERM, gps_sim_signal);
+    rt_kprintf("receiver on %s%s%s\n", sim.peer, link ? " -> " : "", link ? link : "");
+
+    while (!gps_sim_quit)
+        pause();
+
+    gps_sim_detach(&sim);
+    gps_sim_show(&sim);
+
+    return 0;
+
+__usage:
+    gps_sim_usage(argv[0]);
+    return opt == 'h' ? 0 : 1;
+}
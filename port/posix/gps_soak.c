@@ -0,0 +1,473 @@
+/*
+ * Copyright (c) 2020, RudyLo <luhuadong@163.com>
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ *
+ * Change Logs:
+ * Date           Author       Notes
+ * 2026-10-19     luhuadong    the first version
+ */
+
+/*
+ * Soak and overload harness. The simulated L76 is on one side of a pseudo
+ * terminal and the whole driver on the other: host serial port, receive
+ * ring, dispatcher, parser, epoch assembler and a subscriber that spends
+ * the configured time per fix, like a slow consumer in the dispatcher.
+ * Every combination of fix rate, sentence set, baud rate and consumer load
+ * runs for a while and prints one CSV row:
+ *
+ *   bytes, sentences accepted and rejected, epochs sent, assembled and
+ *   delivered, UART ring overruns, epoch-to-delivery latency, and a result:
+ *
+ *   pass     every epoch delivered in time
+ *   wire     the baud rate can't carry the sentences at this rate, the
+ *            module skipped epochs
+ *   overrun  the receive ring overflowed
+ *   reject   lines were corrupted or over-long
+ *   loss     epochs sent but not delivered
+ *   latency  p99 epoch-to-delivery latency over the limit
+ *
+ * After each sweep the highest passing rate of every sentence set, baud
+ * rate and load is printed as the capacity envelope; '#' lines are
+ * comments. -n 0 repeats the sweep until interrupted, and a setting only
+ * stays in the envelope while it passes every sweep.
+ *
+ *   gps_soak -r 1,5,10 -m default,all -b 9600,115200 -c 0,50000 -t 60 -n 0
+ */
+
+#include <rtthread.h>
+#include <rtdevice.h>
+#include <signal.h>
+#include <unistd.h>
+#include "gps.h"
+#include "gps_sim.h"
+
+#define SOAK_UART_NAME          "soak"
+#define SOAK_LIST_MAX           8
+#define SOAK_SAMPLES            8192        /* latest latencies kept */
+#define SOAK_DRAIN_MS           500         /* after the module stops */
+#define SOAK_DAY_US             86400000000LL
+
+struct soak_mask
+{
+    const char *name;
+    rt_uint8_t  divisor[GPS_SIM_SENTENCE_NUM];  /* PMTK314 order */
+};
+
+static const struct soak_mask soak_masks[] =
+{
+    { "rmc",     { 0, 1, 0, 0, 0, 0 } },
+    { "nav",     { 0, 1, 0, 1, 0, 0 } },        /* RMC, GGA */
+    { "default", { 1, 1, 1, 1, 1, 5 } },        /* the L76 default */
+    { "all",     { 1, 1, 1, 1, 1, 1 } },        /* GSV every epoch too */
+};
+
+struct soak_options
+{
+    rt_uint32_t rate[SOAK_LIST_MAX];        /* Hz */
+    rt_uint32_t baud[SOAK_LIST_MAX];
+    rt_uint32_t load[SOAK_LIST_MAX];        /* us per fix */
+    rt_uint8_t  mask[SOAK_LIST_MAX];        /* soak_masks[] */
+    int         rate_num, baud_num, load_num, mask_num;
+
+    rt_uint8_t  systems;
+    rt_uint32_t seconds;                    /* per configuration */
+    rt_uint32_t warmup_ms;                  /* 0: three fix intervals and a second */
+    rt_uint32_t sweeps;                     /* 0: until interrupted */
+    rt_uint32_t max_loss;                   /* per thousand epochs */
+    rt_uint32_t max_latency;                /* ms, 0: one fix interval */
+};
+
+struct soak_result
+{
+    rt_uint32_t bytes;
+    rt_uint32_t sentences;
+    rt_uint32_t rejected;
+    rt_uint32_t sent;                       /* epochs the module sent */
+    rt_uint32_t epochs;                     /* assembled by the driver */
+    rt_uint32_t delivered;
+    rt_uint32_t lost;
+    rt_uint32_t skipped;
+    rt_uint32_t overruns;
+    rt_uint32_t lost_bytes;
+    rt_uint32_t p50, p99, max;              /* latency, us */
+    const char *verdict;
+};
+
+/* the subscriber's side, written in the dispatcher */
+static struct
+{
+    volatile rt_bool_t measure;
+    rt_int64_t   utc_us;                    /* UTC minus gps_time_us() */
+    rt_uint32_t  load_us;
+    rt_uint32_t  delivered;
+    rt_uint32_t  measured;
+    rt_uint32_t *sample;
+} soak;
+
+static volatile sig_atomic_t soak_quit;
+
+static void soak_signal(int sig)
+{
+    RT_UNUSED(sig);
+    soak_quit = 1;
+}
+
+static void soak_deliver(gps_device_t dev, const gps_fix_t *fix, void *user_data)
+{
+    rt_uint64_t now = gps_time_us();
+
+    soak.delivered++;
+    if (soak.measure)
+    {
+        rt_int64_t latency = ((rt_int64_t)now + soak.utc_us) % SOAK_DAY_US - (rt_int64_t)fix->time * 1000;
+
+        if (latency < -SOAK_DAY_US / 2)
+            latency += SOAK_DAY_US;
+        if (latency < 0)
+            latency = 0;
+        soak.sample[soak.measured++ % SOAK_SAMPLES] = (rt_uint32_t)latency;
+    }
+
+    /* the consumer's work */
+    while (gps_time_us() - now < soak.load_us)
+        ;
+}
+
+/* sleeps in short steps so an interrupt ends the run early */
+static void soak_sleep(rt_uint32_t ms)
+{
+    while (ms > 0 && !soak_quit)
+    {
+        rt_uint32_t step = (ms > 100) ? 100 : ms;
+
+        rt_thread_mdelay(step);
+        ms -= step;
+    }
+}
+
+static int soak_cmp(const void *a, const void *b)
+{
+    rt_uint32_t x = *(const rt_uint32_t *)a, y = *(const rt_uint32_t *)b;
+
+    return (x > y) - (x < y);
+}
+
+struct soak_counters
+{
+    rt_uint32_t sim_epochs, sim_dropped, sim_skipped;
+    rt_uint32_t sentences, rejected, epochs;
+    struct serial_posix_stats serial;
+};
+
+static void soak_snapshot(gps_sim_t sim, gps_device_t dev, struct soak_counters *c)
+{
+    c->sim_epochs = sim->epochs;
+    c->sim_dropped = sim->dropped;
+    c->sim_skipped = sim->skipped;
+    c->sentences = dev->sentences;
+    c->rejected = dev->bad_checksum + dev->overflow;
+    c->epochs = dev->fixes + dev->suppressed + dev->dropped;
+    rt_hw_serial_posix_stats(SOAK_UART_NAME, &c->serial);
+}
+
+/* one configuration: the module and the driver from power on to detach */
+static rt_err_t soak_run(const struct soak_options *opt, rt_uint32_t interval,
+                         const struct soak_mask *mask, rt_uint32_t baudrate,
+                         rt_uint32_t load, struct soak_result *res)
+{
+    static struct gps_sim sim;
+    struct gps_sim_config cfg = gps_sim_config_default;
+    struct serial_configure config = RT_SERIAL_CONFIG_DEFAULT;
+    struct soak_counters c0, c1;
+    gps_device_t dev = RT_NULL;
+    rt_uint32_t num, limit;
+    rt_err_t ret;
+
+    rt_memset(res, 0, sizeof(struct soak_result));
+
+    cfg.interval = interval;
+    cfg.baudrate = baudrate;
+    cfg.systems = opt->systems;
+    rt_memcpy(cfg.divisor, mask->divisor, sizeof(cfg.divisor));
+    ret = gps_sim_init(&sim, &cfg);
+    if (ret != RT_EOK)
+        return ret;
+
+    ret = rt_hw_serial_posix_register(SOAK_UART_NAME, sim.peer);
+    if (ret != RT_EOK)
+        goto __sim;
+
+    dev = gps_create(SOAK_UART_NAME);
+    if (dev == RT_NULL)
+    {
+        ret = -RT_ERROR;
+        goto __serial;
+    }
+    config.baud_rate = baudrate;
+    rt_device_control(dev->serial, RT_DEVICE_CTRL_CONFIG, &config);
+
+    soak.measure = RT_FALSE;
+    soak.load_us = load;
+    soak.delivered = 0;
+    soak.measured = 0;
+    gps_subscribe(dev, soak_deliver, RT_NULL);
+
+    ret = gps_sim_start(&sim);
+    if (ret != RT_EOK)
+        goto __gps;
+    soak.utc_us = sim.utc_ms * 1000;
+
+    /*
+     * Epochs are counted from power on, so none is lost at the edges; the
+     * other counters and latency start once the assembler has learned the
+     * epoch's sentence set.
+     */
+    soak_sleep(opt->warmup_ms ? opt->warmup_ms : 3 * interval + 1000);
+    soak_snapshot(&sim, dev, &c0);
+    soak.measure = RT_TRUE;
+
+    soak_sleep(opt->seconds * 1000);
+
+    gps_sim_stop(&sim);
+    rt_thread_mdelay(SOAK_DRAIN_MS + load / 1000);
+    soak.measure = RT_FALSE;
+    soak_snapshot(&sim, dev, &c1);
+
+    res->bytes = c1.serial.bytes - c0.serial.bytes;
+    res->sentences = c1.sentences - c0.sentences;
+    res->rejected = c1.rejected - c0.rejected;
+    res->sent = c1.sim_epochs - c1.sim_dropped;
+    res->epochs = c1.epochs;
+    res->delivered = soak.delivered;
+    res->lost = (res->sent > res->delivered) ? res->sent - res->delivered : 0;
+    res->skipped = c1.sim_skipped - c0.sim_skipped;
+    res->overruns = c1.serial.overruns - c0.serial.overruns;
+    res->lost_bytes = c1.serial.lost - c0.serial.lost;
+
+    num = (soak.measured < SOAK_SAMPLES) ? soak.measured : SOAK_SAMPLES;
+    if (num > 0)
+    {
+        qsort(soak.sample, num, sizeof(rt_uint32_t), soak_cmp);
+        res->p50 = soak.sample[num * 50 / 100];
+        res->p99 = soak.sample[num * 99 / 100];
+        res->max = soak.sample[num - 1];
+    }
+
+    limit = opt->max_latency ? opt->max_latency : interval;
+    if (res->skipped > 0)
+        res->verdict = "wire";
+    else if (res->overruns > 0)
+        res->verdict = "overrun";
+    else if (res->rejected > 0)
+        res->verdict = "reject";
+    else if (res->sent == 0 || (rt_uint64_t)res->lost * 1000 > (rt_uint64_t)res->sent * opt->max_loss)
+        res->verdict = "loss";
+    else if (res->p99 > limit * 1000)
+        res->verdict = "latency";
+    else
+        res->verdict = "pass";
+
+__gps:
+    gps_delete(dev);
+__serial:
+    rt_hw_serial_posix_unregister(SOAK_UART_NAME);
+__sim:
+    gps_sim_detach(&sim);
+
+    return ret;
+}
+
+/* "1,5,10" */
+static int soak_list(const char *arg, rt_uint32_t *list)
+{
+    int num = 0;
+    char *end;
+
+    while (num < SOAK_LIST_MAX)
+    {
+        list[num++] = (rt_uint32_t)strtoul(arg, &end, 10);
+        if (end == arg || (*end != ',' && *end != '\0'))
+            return -1;
+        if (*end == '\0')
+            return num;
+        arg = end + 1;
+    }
+
+    return -1;
+}
+
+/* "default,all" */
+static int soak_mask_list(const char *arg, rt_uint8_t *list)
+{
+    int num = 0;
+    rt_size_t len;
+    rt_uint8_t i;
+
+    while (*arg && num < SOAK_LIST_MAX)
+    {
+        len = strcspn(arg, ",");
+        for (i = 0; i < sizeof(soak_masks) / sizeof(soak_masks[0]); i++)
+        {
+            if (rt_strlen(soak_masks[i].name) == len && rt_strncmp(arg, soak_masks[i].name, len) == 0)
+                break;
+        }
+        if (i == sizeof(soak_masks) / sizeof(soak_masks[0]))
+            return -1;
+
+        list[num++] = i;
+        arg += len;
+        if (*arg == ',')
+            arg++;
+    }
+
+    return (*arg == '\0') ? num : -1;
+}
+
+static void soak_usage(const char *prog)
+{
+    fprintf(stderr,
+            "usage: %s [options]\n"
+            "  -r hz,...            fix rates, default 1,5,10\n"
+            "  -m set,...           sentence sets: rmc, nav, default, all; default default,all\n"
+            "  -b baud,...          baud rates, default 9600,38400,115200\n"
+            "  -c us,...            consumer time per fix, default 0\n"
+            "  -g systems           any of g (GPS), r (GLONASS), b (BeiDou), default grb\n"
+            "  -t seconds           per configuration, default 10\n"
+            "  -w ms                warm-up before counting, default 3 intervals + 1 s\n"
+            "  -n sweeps            0 repeats until interrupted, default 1\n"
+            "  -l per-mille         epochs that may be lost, default 0\n"
+            "  -p ms                p99 latency limit, default one fix interval\n", prog);
+}
+
+int main(int argc, char **argv)
+{
+    /* runs and failures of each configuration over all sweeps */
+    static rt_uint32_t runs[SOAK_LIST_MAX][SOAK_LIST_MAX][SOAK_LIST_MAX][SOAK_LIST_MAX];
+    static rt_uint32_t fails[SOAK_LIST_MAX][SOAK_LIST_MAX][SOAK_LIST_MAX][SOAK_LIST_MAX];
+    struct soak_options opt;
+    struct soak_result res;
+    rt_uint32_t sweep;
+    int opt_ch, r, m, b, l, i;
+
+    rt_memset(&opt, 0, sizeof(opt));
+    opt.rate[0] = 1; opt.rate[1] = 5; opt.rate[2] = 10; opt.rate_num = 3;
+    opt.mask[0] = 2; opt.mask[1] = 3; opt.mask_num = 2;
+    opt.baud[0] = 9600; opt.baud[1] = 38400; opt.baud[2] = 115200; opt.baud_num = 3;
+    opt.load[0] = 0; opt.load_num = 1;
+    opt.systems = GPS_SIM_GPS | GPS_SIM_GLONASS | GPS_SIM_BEIDOU;
+    opt.seconds = 10;
+    opt.sweeps = 1;
+
+    while ((opt_ch = getopt(argc, argv, "r:m:b:c:g:t:w:n:l:p:h")) != -1)
+    {
+        switch (opt_ch)
+        {
+        case 'r': opt.rate_num = soak_list(optarg, opt.rate); break;
+        case 'm': opt.mask_num = soak_mask_list(optarg, opt.mask); break;
+        case 'b': opt.baud_num = soak_list(optarg, opt.baud); break;
+        case 'c': opt.load_num = soak_list(optarg, opt.load); break;
+        case 'g':
+            opt.systems = 0;
+            for (i = 0; optarg[i]; i++)
+            {
+                opt.systems |= (optarg[i] == 'g') ? GPS_SIM_GPS :
+                               (optarg[i] == 'r') ? GPS_SIM_GLONASS :
+                               (optarg[i] == 'b') ? GPS_SIM_BEIDOU : 0;
+            }
+            break;
+        case 't': opt.seconds = (rt_uint32_t)atoi(optarg); break;
+        case 'w': opt.warmup_ms = (rt_uint32_t)atoi(optarg); break;
+        case 'n': opt.sweeps = (rt_uint32_t)atoi(optarg); break;
+        case 'l': opt.max_loss = (rt_uint32_t)atoi(optarg); break;
+        case 'p': opt.max_latency = (rt_uint32_t)atoi(optarg); break;
+        default:
+            goto __usage;
+        }
+    }
+    if (opt.rate_num <= 0 || opt.mask_num <= 0 || opt.baud_num <= 0 || opt.load_num <= 0 ||
+        opt.systems == 0 || opt.seconds == 0)
+        goto __usage;
+    for (r = 0; r < opt.rate_num; r++)
+    {
+        if (opt.rate[r] == 0 || opt.rate[r] > 10)
+        {
+            fprintf(stderr, "fix rates are 1 to 10 Hz\n");
+            return 1;
+        }
+    }
+
+    soak.sample = rt_malloc(SOAK_SAMPLES * sizeof(rt_uint32_t));
+    if (soak.sample == RT_NULL)
+        return 1;
+
+    rt_components_init();
+    signal(SIGINT, soak_signal);
+    signal(SIGTERM, soak_signal);
+
+    rt_kprintf("rate_hz,mask,baud,load_us,seconds,bytes,sentences,rejected,epochs_sent,epochs,"
+               "delivered,lost,skipped,overruns,lost_bytes,lat_p50_us,lat_p99_us,lat_max_us,result\n");
+
+    for (sweep = 0; (opt.sweeps == 0 || sweep < opt.sweeps) && !soak_quit; sweep++)
+    {
+        for (m = 0; m < opt.mask_num && !soak_quit; m++)
+        for (b = 0; b < opt.baud_num && !soak_quit; b++)
+        for (l = 0; l < opt.load_num && !soak_quit; l++)
+        for (r = 0; r < opt.rate_num && !soak_quit; r++)
+        {
+            const struct soak_mask *mask = &soak_masks[opt.mask[m]];
+
+            if (soak_run(&opt, 1000 / opt.rate[r], mask, opt.baud[b], opt.load[l], &res) != RT_EOK)
+            {
+                rt_kprintf("# %u Hz %s %u baud: can't set up the run\n",
+                           (unsigned int)opt.rate[r], mask->name, (unsigned int)opt.baud[b]);
+                runs[m][b][l][r]++;
+                fails[m][b][l][r]++;
+                continue;
+            }
+            /* an interrupted run is incomplete, it doesn't count */
+            if (soak_quit)
+                break;
+
+            rt_kprintf("%u,%s,%u,%u,%u,%u,%u,%u,%u,%u,%u,%u,%u,%u,%u,%u,%u,%u,%s\n",
+                       (unsigned int)opt.rate[r], mask->name, (unsigned int)opt.baud[b],
+                       (unsigned int)opt.load[l], (unsigned int)opt.seconds,
+                       (unsigned int)res.bytes, (unsigned int)res.sentences,
+                       (unsigned int)res.rejected, (unsigned int)res.sent,
+                       (unsigned int)res.epochs, (unsigned int)res.delivered,
+                       (unsigned int)res.lost, (unsigned int)res.skipped,
+                       (unsigned int)res.overruns, (unsigned int)res.lost_bytes,
+                       (unsigned int)res.p50, (unsigned int)res.p99, (unsigned int)res.max,
+                       res.verdict);
+            runs[m][b][l][r]++;
+            if (rt_strcmp(res.verdict, "pass") != 0)
+                fails[m][b][l][r]++;
+        }
+
+        /* the envelope: the highest rate each setting carried every sweep */
+        rt_kprintf("# envelope after %u sweep(s): mask,baud,load_us,max_rate_hz\n",
+                   (unsigned int)(sweep + (soak_quit ? 0 : 1)));
+        for (m = 0; m < opt.mask_num; m++)
+        for (b = 0; b < opt.baud_num; b++)
+        for (l = 0; l < opt.load_num; l++)
+        {
+            rt_uint32_t best = 0;
+
+            for (r = 0; r < opt.rate_num; r++)
+            {
+                if (runs[m][b][l][r] && !fails[m][b][l][r] && opt.rate[r] > best)
+                    best = opt.rate[r];
+            }
+            rt_kprintf("# %s,%u,%u,%u\n", soak_masks[opt.mask[m]].name,
+                       (unsigned int)opt.baud[b], (unsigned int)opt.load[l], (unsigned int)best);
+        }
+    }
+
+    rt_free(soak.sample);
+
+    return 0;
+
+__usage:
+    soak_usage(argv[0]);
+    return opt_ch == 'h' ? 0 : 1;
+}
@@ -0,0 +1,53 @@
+/*
+ * Copyright (c) 2020, RudyLo <luhuadong@163.com>
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ *
+ * Change Logs:
+ * Date           Author       Notes
+ * 2026-10-19     luhuadong    the first version
+ */
+
+#ifndef RT_CONFIG_H__
+#define RT_CONFIG_H__
+
+/* kernel */
+#define RT_NAME_MAX                  8
+#define RT_ALIGN_SIZE                8
+#define RT_THREAD_PRIORITY_MAX       32
+#define RT_TICK_PER_SECOND           1000
+#define RT_CONSOLEBUF_SIZE           256
+#define RT_SERIAL_RB_BUFSZ           1024
+
+#define RT_USING_HOOK
+#define RT_USING_TIMER_SOFT          /* the shim runs every timer in a thread */
+#define RT_USING_DEVICE
+#define RT_USING_SERIAL
+#define RT_USING_SENSOR
+#define RT_USING_FINSH
+#define FINSH_USING_MSH
+
+/* gps package, every module the host can run */
+#define PKG_USING_GPS
+#define PKG_USING_GPS_INIT_ASYN
+#define PKG_USING_GPS_CLI
+#define PKG_USING_GPS_PROJ
+#define PKG_USING_GPS_GEODESIC
+#define PKG_USING_GPS_FENCE
+#define PKG_USING_GPS_SIMPLIFY
+#define PKG_USING_GPS_FILTER
+#define PKG_USING_GPS_GATE
+#define PKG_USING_GPS_RESAMPLE
+#define PKG_USING_GPS_MOTION
+#define PKG_USING_GPS_RATE
+#define PKG_USING_GPS_PPS
+#define PKG_USING_GPS_TIME
+#define PKG_USING_GPS_LATENCY
+#define PKG_USING_GPS_TRACE
+#define PKG_USING_GPS_FUSION
+#define PKG_USING_GPS_POOL
+#define PKG_USING_GPS_LOG
+#define PKG_USING_GPS_CAPTURE
+#define PKG_USING_GPS_TELEMETRY
+
+#endif /* RT_CONFIG_H__ */
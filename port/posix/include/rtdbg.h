@@ -0,0 +1,59 @@
+/*
+ * Copyright (c) 2020, RudyLo <luhuadong@163.com>
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ *
+ * Change Logs:
+ * Date           Author       Notes
+ * 2026-10-19     luhuadong    the first version
+ */
+
+/* ulog-style log macros on stderr, per file DBG_TAG and DBG_LVL */
+
+#ifndef RT_DBG_H__
+#define RT_DBG_H__
+
+#include <rtthread.h>
+
+#define DBG_ERROR           0
+#define DBG_WARNING         4
+#define DBG_INFO            6
+#define DBG_LOG             7
+
+#ifndef DBG_TAG
+#define DBG_TAG             "DBG"
+#endif
+#ifndef DBG_LVL
+#define DBG_LVL             DBG_WARNING
+#endif
+
+#define dbg_log_line(lvl, fmt, ...) \
+    fprintf(stderr, "[" lvl "/" DBG_TAG "] " fmt "\n", ##__VA_ARGS__)
+
+#if (DBG_LVL >= DBG_LOG)
+#define LOG_D(fmt, ...)     dbg_log_line("D", fmt, ##__VA_ARGS__)
+#else
+#define LOG_D(...)
+#endif
+
+#if (DBG_LVL >= DBG_INFO)
+#define LOG_I(fmt, ...)     dbg_log_line("I", fmt, ##__VA_ARGS__)
+#else
+#define LOG_I(...)
+#endif
+
+#if (DBG_LVL >= DBG_WARNING)
+#define LOG_W(fmt, ...)     dbg_log_line("W", fmt, ##__VA_ARGS__)
+#else
+#define LOG_W(...)
+#endif
+
+#if (DBG_LVL >= DBG_ERROR)
+#define LOG_E(fmt, ...)     dbg_log_line("E", fmt, ##__VA_ARGS__)
+#else
+#define LOG_E(...)
+#endif
+
+#define LOG_RAW(...)        fprintf(stderr, __VA_ARGS__)
+
+#endif /* RT_DBG_H__ */
@@ -0,0 +1,157 @@
+/*
+ * Copyright (c) 2020, RudyLo <luhuadong@163.com>
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ *
+ * Change Logs:
+ * Date           Author       Notes
+ * 2026-10-19     luhuadong    the first version
+ */
+
+/* device driver framework types the gps package uses: serial, ring buffer, pin */
+
+#ifndef __RT_DEVICE_H__
+#define __RT_DEVICE_H__
+
+#include <rtthread.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/* serial */
+#define BAUD_RATE_2400                  2400
+#define BAUD_RATE_4800                  4800
+#define BAUD_RATE_9600                  9600
+#define BAUD_RATE_19200                 19200
+#define BAUD_RATE_38400                 38400
+#define BAUD_RATE_57600                 57600
+#define BAUD_RATE_115200                115200
+#define BAUD_RATE_230400                230400
+#define BAUD_RATE_460800                460800
+#define BAUD_RATE_921600                921600
+
+#define DATA_BITS_5                     5
+#define DATA_BITS_6                     6
+#define DATA_BITS_7                     7
+#define DATA_BITS_8                     8
+
+#define STOP_BITS_1                     0
+#define STOP_BITS_2                     1
+
+#define PARITY_NONE                     0
+#define PARITY_ODD                      1
+#define PARITY_EVEN                     2
+
+#define BIT_ORDER_LSB                   0
+#define BIT_ORDER_MSB                   1
+
+#define NRZ_NORMAL                      0
+#define NRZ_INVERTED                    1
+
+#ifndef RT_SERIAL_RB_BUFSZ
+#define RT_SERIAL_RB_BUFSZ              64
+#endif
+
+struct serial_configure
+{
+    rt_uint32_t baud_rate;
+
+    rt_uint32_t data_bits   :4;
+    rt_uint32_t stop_bits   :2;
+    rt_uint32_t parity      :2;
+    rt_uint32_t bit_order   :1;
+    rt_uint32_t invert      :1;
+    rt_uint32_t bufsz       :16;
+    rt_uint32_t reserved    :6;
+};
+
+#define RT_SERIAL_CONFIG_DEFAULT                                              \
+{                                                                             \
+    BAUD_RATE_115200,                                                         \
+    DATA_BITS_8,                                                              \
+    STOP_BITS_1,                                                              \
+    PARITY_NONE,                                                              \
+    BIT_ORDER_LSB,                                                            \
+    NRZ_NORMAL,                                                               \
+    RT_SERIAL_RB_BUFSZ,                                                       \
+    0                                                                         \
+}
+
+/* ring buffer */
+struct rt_ringbuffer
+{
+    rt_uint8_t *buffer_ptr;
+    rt_uint16_t read_mirror : 1;
+    rt_uint16_t read_index : 15;
+    rt_uint16_t write_mirror : 1;
+    rt_uint16_t write_index : 15;
+    rt_int16_t  buffer_size;
+};
+
+enum rt_ringbuffer_state
+{
+    RT_RINGBUFFER_EMPTY,
+    RT_RINGBUFFER_FULL,
+    RT_RINGBUFFER_HALFFULL,
+};
+
+void        rt_ringbuffer_init(struct rt_ringbuffer *rb, rt_uint8_t *pool, rt_int16_t size);
+void        rt_ringbuffer_reset(struct rt_ringbuffer *rb);
+rt_size_t   rt_ringbuffer_put(struct rt_ringbuffer *rb, const rt_uint8_t *ptr, rt_uint16_t length);
+rt_size_t   rt_ringbuffer_put_force(struct rt_ringbuffer *rb, const rt_uint8_t *ptr, rt_uint16_t length);
+rt_size_t   rt_ringbuffer_get(struct rt_ringbuffer *rb, rt_uint8_t *ptr, rt_uint16_t length);
+rt_size_t   rt_ringbuffer_data_len(struct rt_ringbuffer *rb);
+enum rt_ringbuffer_state rt_ringbuffer_status(struct rt_ringbuffer *rb);
+
+rt_inline rt_uint16_t rt_ringbuffer_get_size(struct rt_ringbuffer *rb)
+{
+    RT_ASSERT(rb != RT_NULL);
+    return rb->buffer_size;
+}
+
+#define rt_ringbuffer_space_len(rb) ((rb)->buffer_size - rt_ringbuffer_data_len(rb))
+
+/* pin, the host has none */
+#define PIN_LOW                         0x00
+#define PIN_HIGH                        0x01
+
+#define PIN_MODE_OUTPUT                 0x00
+#define PIN_MODE_INPUT                  0x01
+#define PIN_MODE_INPUT_PULLUP           0x02
+#define PIN_MODE_INPUT_PULLDOWN         0x03
+#define PIN_MODE_OUTPUT_OD              0x04
+
+#define PIN_IRQ_MODE_RISING             0x00
+#define PIN_IRQ_MODE_FALLING            0x01
+#define PIN_IRQ_MODE_RISING_FALLING     0x02
+
+#define PIN_IRQ_DISABLE                 0x00
+#define PIN_IRQ_ENABLE                  0x01
+
+void        rt_pin_mode(rt_base_t pin, rt_base_t mode);
+void        rt_pin_write(rt_base_t pin, rt_base_t value);
+int         rt_pin_read(rt_base_t pin);
+rt_err_t    rt_pin_attach_irq(rt_int32_t pin, rt_uint32_t mode,
+                              void (*hdr)(void *args), void *args);
+rt_err_t    rt_pin_detach_irq(rt_int32_t pin);
+rt_err_t    rt_pin_irq_enable(rt_base_t pin, rt_uint32_t enabled);
+
+/* host serial port, on a pty or a tty */
+struct serial_posix_stats
+{
+    rt_uint32_t bytes;          /* received */
+    rt_uint32_t overruns;       /* reads that found the ring full */
+    rt_uint32_t lost;           /* bytes overwritten before they were read */
+};
+
+rt_err_t    rt_hw_serial_posix_register(const char *name, const char *path);
+rt_err_t    rt_hw_serial_posix_unregister(const char *name);
+const char *rt_hw_serial_posix_peer(const char *name);
+rt_err_t    rt_hw_serial_posix_stats(const char *name, struct serial_posix_stats *stats);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* __RT_DEVICE_H__ */
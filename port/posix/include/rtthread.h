@@ -0,0 +1,399 @@
+/*
+ * Copyright (c) 2020, RudyLo <luhuadong@163.com>
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ *
+ * Change Logs:
+ * Date           Author       Notes
+ * 2026-10-19     luhuadong    the first version
+ */
+
+/*
+ * The part of the RT-Thread kernel API the gps package uses, on pthreads.
+ * Ticks are milliseconds since start-up; thread priorities and stacks are
+ * accepted and ignored; interrupt locks and critical sections share one
+ * recursive mutex.
+ */
+
+#ifndef __RT_THREAD_H__
+#define __RT_THREAD_H__
+
+#include <rtconfig.h>
+#include <stdint.h>
+#include <stddef.h>
+#include <stdarg.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <pthread.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+typedef int8_t                  rt_int8_t;
+typedef int16_t                 rt_int16_t;
+typedef int32_t                 rt_int32_t;
+typedef int64_t                 rt_int64_t;
+typedef uint8_t                 rt_uint8_t;
+typedef uint16_t                rt_uint16_t;
+typedef uint32_t                rt_uint32_t;
+typedef uint64_t                rt_uint64_t;
+typedef int                     rt_bool_t;
+typedef long                    rt_base_t;
+typedef unsigned long           rt_ubase_t;
+typedef rt_base_t               rt_err_t;
+typedef rt_uint32_t             rt_time_t;
+typedef rt_uint32_t             rt_tick_t;
+typedef rt_base_t               rt_flag_t;
+typedef rt_ubase_t              rt_size_t;
+typedef rt_base_t               rt_ssize_t;
+typedef rt_base_t               rt_off_t;
+
+#define RT_TRUE                 1
+#define RT_FALSE                0
+#define RT_NULL                 (0)
+
+#define RT_EOK                  0
+#define RT_ERROR                1
+#define RT_ETIMEOUT             2
+#define RT_EFULL                3
+#define RT_EEMPTY               4
+#define RT_ENOMEM               5
+#define RT_ENOSYS               6
+#define RT_EBUSY                7
+#define RT_EIO                  8
+#define RT_EINTR                9
+#define RT_EINVAL               10
+
+#define RT_WAITING_FOREVER      -1
+#define RT_WAITING_NO           0
+
+#define RT_IPC_FLAG_FIFO        0x00
+#define RT_IPC_FLAG_PRIO        0x01
+#define RT_IPC_CMD_RESET        0x01
+
+#define RT_EVENT_FLAG_AND       0x01
+#define RT_EVENT_FLAG_OR        0x02
+#define RT_EVENT_FLAG_CLEAR     0x04
+
+#define RT_TIMER_FLAG_ONE_SHOT      0x0
+#define RT_TIMER_FLAG_PERIODIC      0x2
+#define RT_TIMER_FLAG_HARD_TIMER    0x0
+#define RT_TIMER_FLAG_SOFT_TIMER    0x4
+#define RT_TIMER_CTRL_SET_TIME      0x0
+#define RT_TIMER_CTRL_GET_TIME      0x1
+
+#define RT_ALIGN(size, align)   (((size) + (align) - 1) & ~((align) - 1))
+#define ALIGN(n)                __attribute__((aligned(n)))
+#define RT_WEAK                 __attribute__((weak))
+#define RT_UNUSED(x)            ((void)(x))
+#define rt_inline               static __inline
+#define rt_container_of(ptr, type, member) \
+    ((type *)((char *)(ptr) - (unsigned long)(&((type *)0)->member)))
+
+#define RT_ASSERT(EX)                                                         \
+    do                                                                        \
+    {                                                                         \
+        if (!(EX))                                                            \
+            rt_assert_handler(#EX, __FUNCTION__, __LINE__);                   \
+    } while (0)
+
+struct rt_object
+{
+    char       name[RT_NAME_MAX];
+    rt_uint8_t type;
+    rt_uint8_t flag;
+};
+typedef struct rt_object *rt_object_t;
+
+/* thread */
+struct rt_thread
+{
+    struct rt_object parent;
+    pthread_t  tid;
+    void     (*entry)(void *parameter);
+    void      *parameter;
+    rt_bool_t  dynamic;
+    rt_bool_t  started;            /* running, until it exits or is joined */
+    rt_bool_t  joining;            /* rt_thread_detach() joins and frees it */
+    void      *user_data;
+};
+typedef struct rt_thread *rt_thread_t;
+
+/* semaphore */
+struct rt_semaphore
+{
+    struct rt_object parent;
+    pthread_mutex_t lock;
+    pthread_cond_t  cond;
+    rt_uint32_t     value;
+};
+typedef struct rt_semaphore *rt_sem_t;
+
+/* mutex, recursive like the kernel's */
+struct rt_mutex
+{
+    struct rt_object parent;
+    pthread_mutex_t lock;
+};
+typedef struct rt_mutex *rt_mutex_t;
+
+/* event */
+struct rt_event
+{
+    struct rt_object parent;
+    pthread_mutex_t lock;
+    pthread_cond_t  cond;
+    rt_uint32_t     set;
+};
+typedef struct rt_event *rt_event_t;
+
+/* mailbox */
+struct rt_mailbox
+{
+    struct rt_object parent;
+    pthread_mutex_t lock;
+    pthread_cond_t  cond;
+    rt_ubase_t     *msg_pool;
+    rt_uint16_t     size;
+    rt_uint16_t     entry;
+    rt_uint16_t     in_offset;
+    rt_uint16_t     out_offset;
+};
+typedef struct rt_mailbox *rt_mailbox_t;
+
+/* timer, served by one timer thread */
+struct rt_timer
+{
+    struct rt_object parent;
+    void      (*timeout_func)(void *parameter);
+    void       *parameter;
+    rt_tick_t   init_tick;
+    rt_tick_t   timeout_tick;
+    rt_bool_t   active;
+    rt_bool_t   dynamic;
+    struct rt_timer *next;
+};
+typedef struct rt_timer *rt_timer_t;
+
+/* device */
+enum rt_device_class_type
+{
+    RT_Device_Class_Char = 0,
+    RT_Device_Class_Block,
+    RT_Device_Class_NetIf,
+    RT_Device_Class_MTD,
+    RT_Device_Class_CAN,
+    RT_Device_Class_RTC,
+    RT_Device_Class_Sound,
+    RT_Device_Class_Graphic,
+    RT_Device_Class_I2CBUS,
+    RT_Device_Class_USBDevice,
+    RT_Device_Class_USBHost,
+    RT_Device_Class_SPIBUS,
+    RT_Device_Class_SPIDevice,
+    RT_Device_Class_SDIO,
+    RT_Device_Class_PM,
+    RT_Device_Class_Pipe,
+    RT_Device_Class_Portal,
+    RT_Device_Class_Timer,
+    RT_Device_Class_Miscellaneous,
+    RT_Device_Class_Sensor,
+    RT_Device_Class_Touch,
+    RT_Device_Class_Unknown
+};
+
+#define RT_DEVICE_FLAG_DEACTIVATE       0x000
+#define RT_DEVICE_FLAG_RDONLY           0x001
+#define RT_DEVICE_FLAG_WRONLY           0x002
+#define RT_DEVICE_FLAG_RDWR             0x003
+#define RT_DEVICE_FLAG_REMOVABLE        0x004
+#define RT_DEVICE_FLAG_STANDALONE       0x008
+#define RT_DEVICE_FLAG_ACTIVATED        0x010
+#define RT_DEVICE_FLAG_SUSPENDED        0x020
+#define RT_DEVICE_FLAG_STREAM           0x040
+#define RT_DEVICE_FLAG_INT_RX           0x100
+#define RT_DEVICE_FLAG_DMA_RX           0x200
+#define RT_DEVICE_FLAG_INT_TX           0x400
+#define RT_DEVICE_FLAG_DMA_TX           0x800
+
+#define RT_DEVICE_OFLAG_CLOSE           0x000
+#define RT_DEVICE_OFLAG_RDONLY          0x001
+#define RT_DEVICE_OFLAG_WRONLY          0x002
+#define RT_DEVICE_OFLAG_RDWR            0x003
+#define RT_DEVICE_OFLAG_OPEN            0x008
+#define RT_DEVICE_OFLAG_MASK            0xf0f
+
+#define RT_DEVICE_CTRL_RESUME           0x01
+#define RT_DEVICE_CTRL_SUSPEND          0x02
+#define RT_DEVICE_CTRL_CONFIG           0x03
+#define RT_DEVICE_CTRL_CLOSE            0x04
+#define RT_DEVICE_CTRL_SET_INT          0x10
+#define RT_DEVICE_CTRL_CLR_INT          0x11
+#define RT_DEVICE_CTRL_GET_INT          0x12
+#define RT_DEVICE_CTRL_RTC_GET_TIME     0x10
+#define RT_DEVICE_CTRL_RTC_SET_TIME     0x11
+
+typedef struct rt_device *rt_device_t;
+
+struct rt_device
+{
+    struct rt_object parent;
+    enum rt_device_class_type type;
+    rt_uint16_t flag;
+    rt_uint16_t open_flag;
+    rt_uint8_t  ref_count;
+    rt_uint8_t  device_id;
+
+    rt_err_t (*rx_indicate)(rt_device_t dev, rt_size_t size);
+    rt_err_t (*tx_complete)(rt_device_t dev, void *buffer);
+
+    rt_err_t  (*init)   (rt_device_t dev);
+    rt_err_t  (*open)   (rt_device_t dev, rt_uint16_t oflag);
+    rt_err_t  (*close)  (rt_device_t dev);
+    rt_size_t (*read)   (rt_device_t dev, rt_off_t pos, void *buffer, rt_size_t size);
+    rt_size_t (*write)  (rt_device_t dev, rt_off_t pos, const void *buffer, rt_size_t size);
+    rt_err_t  (*control)(rt_device_t dev, int cmd, void *args);
+
+    void *user_data;
+    struct rt_device *next;
+};
+
+/* kernel services */
+#define rt_memset               memset
+#define rt_memcpy               memcpy
+#define rt_memmove              memmove
+#define rt_memcmp               memcmp
+#define rt_strlen               strlen
+#define rt_strncpy              strncpy
+#define rt_strcmp               strcmp
+#define rt_strncmp              strncmp
+#define rt_strstr               strstr
+#define rt_snprintf             snprintf
+#define rt_vsnprintf            vsnprintf
+#define rt_sprintf              sprintf
+#define rt_realloc              realloc
+#define rt_free                 free
+
+/* the C heap, with the kernel's allocation hook */
+void       *rt_malloc(rt_size_t size);
+void       *rt_calloc(rt_size_t count, rt_size_t size);
+#ifdef RT_USING_HOOK
+void        rt_malloc_sethook(void (*hook)(void *ptr, rt_size_t size));
+#endif
+
+void        rt_kprintf(const char *fmt, ...);
+void        rt_assert_handler(const char *ex, const char *func, rt_size_t line);
+
+rt_tick_t   rt_tick_get(void);
+rt_tick_t   rt_tick_from_millisecond(rt_int32_t ms);
+
+rt_base_t   rt_hw_interrupt_disable(void);
+void        rt_hw_interrupt_enable(rt_base_t level);
+void        rt_enter_critical(void);
+void        rt_exit_critical(void);
+
+rt_err_t    rt_thread_init(struct rt_thread *thread, const char *name,
+                           void (*entry)(void *parameter), void *parameter,
+                           void *stack_start, rt_uint32_t stack_size,
+                           rt_uint8_t priority, rt_uint32_t tick);
+rt_thread_t rt_thread_create(const char *name, void (*entry)(void *parameter), void *parameter,
+                             rt_uint32_t stack_size, rt_uint8_t priority, rt_uint32_t tick);
+rt_err_t    rt_thread_startup(rt_thread_t thread);
+rt_err_t    rt_thread_detach(rt_thread_t thread);
+rt_err_t    rt_thread_delete(rt_thread_t thread);
+rt_thread_t rt_thread_self(void);
+rt_err_t    rt_thread_yield(void);
+rt_err_t    rt_thread_delay(rt_tick_t tick);
+rt_err_t    rt_thread_mdelay(rt_int32_t ms);
+
+rt_err_t    rt_sem_init(rt_sem_t sem, const char *name, rt_uint32_t value, rt_uint8_t flag);
+rt_err_t    rt_sem_detach(rt_sem_t sem);
+rt_sem_t    rt_sem_create(const char *name, rt_uint32_t value, rt_uint8_t flag);
+rt_err_t    rt_sem_delete(rt_sem_t sem);
+rt_err_t    rt_sem_take(rt_sem_t sem, rt_int32_t time);
+rt_err_t    rt_sem_trytake(rt_sem_t sem);
+rt_err_t    rt_sem_release(rt_sem_t sem);
+rt_err_t    rt_sem_control(rt_sem_t sem, int cmd, void *arg);
+
+rt_err_t    rt_mutex_init(rt_mutex_t mutex, const char *name, rt_uint8_t flag);
+rt_err_t    rt_mutex_detach(rt_mutex_t mutex);
+rt_mutex_t  rt_mutex_create(const char *name, rt_uint8_t flag);
+rt_err_t    rt_mutex_delete(rt_mutex_t mutex);
+rt_err_t    rt_mutex_take(rt_mutex_t mutex, rt_int32_t time);
+rt_err_t    rt_mutex_release(rt_mutex_t mutex);
+
+rt_err_t    rt_event_init(rt_event_t event, const char *name, rt_uint8_t flag);
+rt_err_t    rt_event_detach(rt_event_t event);
+rt_err_t    rt_event_send(rt_event_t event, rt_uint32_t set);
+rt_err_t    rt_event_recv(rt_event_t event, rt_uint32_t set, rt_uint8_t opt,
+                          rt_int32_t timeout, rt_uint32_t *recved);
+
+rt_err_t     rt_mb_init(rt_mailbox_t mb, const char *name, void *msgpool, rt_size_t size, rt_uint8_t flag);
+rt_err_t     rt_mb_detach(rt_mailbox_t mb);
+rt_mailbox_t rt_mb_create(const char *name, rt_size_t size, rt_uint8_t flag);
+rt_err_t     rt_mb_delete(rt_mailbox_t mb);
+rt_err_t     rt_mb_send(rt_mailbox_t mb, rt_ubase_t value);
+rt_err_t     rt_mb_recv(rt_mailbox_t mb, rt_ubase_t *value, rt_int32_t timeout);
+
+void        rt_timer_init(rt_timer_t timer, const char *name, void (*timeout)(void *parameter),
+                          void *parameter, rt_tick_t time, rt_uint8_t flag);
+rt_err_t    rt_timer_detach(rt_timer_t timer);
+rt_timer_t  rt_timer_create(const char *name, void (*timeout)(void *parameter),
+                            void *parameter, rt_tick_t time, rt_uint8_t flag);
+rt_err_t    rt_timer_delete(rt_timer_t timer);
+rt_err_t    rt_timer_start(rt_timer_t timer);
+rt_err_t    rt_timer_stop(rt_timer_t timer);
+rt_err_t    rt_timer_control(rt_timer_t timer, int cmd, void *arg);
+
+rt_device_t rt_device_find(const char *name);
+rt_err_t    rt_device_register(rt_device_t dev, const char *name, rt_uint16_t flags);
+rt_err_t    rt_device_unregister(rt_device_t dev);
+rt_err_t    rt_device_open(rt_device_t dev, rt_uint16_t oflag);
+rt_err_t    rt_device_close(rt_device_t dev);
+rt_size_t   rt_device_read(rt_device_t dev, rt_off_t pos, void *buffer, rt_size_t size);
+rt_size_t   rt_device_write(rt_device_t dev, rt_off_t pos, const void *buffer, rt_size_t size);
+rt_err_t    rt_device_control(rt_device_t dev, int cmd, void *arg);
+rt_err_t    rt_device_set_rx_indicate(rt_device_t dev, rt_err_t (*rx_ind)(rt_device_t dev, rt_size_t size));
+rt_device_t rt_console_get_device(void);
+
+/* automatic initialization, run in level order by rt_components_init() */
+typedef int (*init_fn_t)(void);
+void        rt_components_register(init_fn_t fn, int level);
+void        rt_components_init(void);
+
+#define INIT_EXPORT(fn, level)                                                \
+    static void __attribute__((constructor)) __rt_init_##fn(void)            \
+    {                                                                         \
+        rt_components_register((init_fn_t)(fn), level);                      \
+    }
+#define INIT_BOARD_EXPORT(fn)           INIT_EXPORT(fn, 1)
+#define INIT_PREV_EXPORT(fn)            INIT_EXPORT(fn, 2)
+#define INIT_DEVICE_EXPORT(fn)          INIT_EXPORT(fn, 3)
+#define INIT_COMPONENT_EXPORT(fn)       INIT_EXPORT(fn, 4)
+#define INIT_ENV_EXPORT(fn)             INIT_EXPORT(fn, 5)
+#define INIT_APP_EXPORT(fn)             INIT_EXPORT(fn, 6)
+
+/* msh commands, run by msh_exec() */
+typedef long (*syscall_func)(void);
+void        msh_register(const char *name, const char *desc, syscall_func func);
+int         msh_exec(char *cmd, rt_size_t length);
+
+#define MSH_CMD_EXPORT(command, desc)                                         \
+    static void __attribute__((constructor)) __msh_cmd_##command(void)       \
+    {                                                                         \
+        msh_register(#command, #desc, (syscall_func)(command));              \
+    }
+#define MSH_CMD_EXPORT_ALIAS(command, alias, desc)                            \
+    static void __attribute__((constructor)) __msh_cmd_##alias(void)         \
+    {                                                                         \
+        msh_register(#alias, #desc, (syscall_func)(command));                \
+    }
+#define FINSH_FUNCTION_EXPORT(name, desc)
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* __RT_THREAD_H__ */
@@ -0,0 +1,140 @@
+/*
+ * Copyright (c) 2020, RudyLo <luhuadong@163.com>
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ *
+ * Change Logs:
+ * Date           Author       Notes
+ * 2026-10-19     luhuadong    the first version
+ */
+
+/* the subset of the sensor framework a GNSS sensor driver needs */
+
+#ifndef __SENSOR_H__
+#define __SENSOR_H__
+
+#include <rtthread.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#define RT_SENSOR_CLASS_NONE           (0)
+#define RT_SENSOR_CLASS_ACCE           (1)
+#define RT_SENSOR_CLASS_GYRO           (2)
+#define RT_SENSOR_CLASS_MAG            (3)
+#define RT_SENSOR_CLASS_TEMP           (4)
+#define RT_SENSOR_CLASS_HUMI           (5)
+#define RT_SENSOR_CLASS_BARO           (6)
+#define RT_SENSOR_CLASS_LIGHT          (7)
+#define RT_SENSOR_CLASS_PROXIMITY      (8)
+#define RT_SENSOR_CLASS_HR             (9)
+#define RT_SENSOR_CLASS_TVOC           (10)
+#define RT_SENSOR_CLASS_NOISE          (11)
+#define RT_SENSOR_CLASS_STEP           (12)
+#define RT_SENSOR_CLASS_FORCE          (13)
+#define RT_SENSOR_CLASS_DUST           (14)
+#define RT_SENSOR_CLASS_ECO2           (15)
+#define RT_SENSOR_CLASS_GNSS           (16)
+
+#define RT_SENSOR_VENDOR_UNKNOWN       (0)
+
+#define RT_SENSOR_UNIT_NONE            (0)
+#define RT_SENSOR_UNIT_DD              (17)    /* decimal degrees */
+
+#define RT_SENSOR_INTF_I2C             (1 << 0)
+#define RT_SENSOR_INTF_SPI             (1 << 1)
+#define RT_SENSOR_INTF_UART            (1 << 2)
+#define RT_SENSOR_INTF_ONEWIRE         (1 << 3)
+
+#define RT_SENSOR_MODE_POLLING         (1)
+#define RT_SENSOR_MODE_INT             (2)
+#define RT_SENSOR_MODE_FIFO            (3)
+
+#define RT_SENSOR_CTRL_GET_ID          (0)
+#define RT_SENSOR_CTRL_GET_INFO        (1)
+#define RT_SENSOR_CTRL_SET_RANGE       (2)
+#define RT_SENSOR_CTRL_SET_ODR         (3)
+#define RT_SENSOR_CTRL_SET_MODE        (4)
+#define RT_SENSOR_CTRL_SET_POWER       (5)
+#define RT_SENSOR_CTRL_SELF_TEST       (6)
+#define RT_SENSOR_CTRL_USER_CMD_START  (0x100)
+
+struct rt_sensor_info
+{
+    rt_uint8_t     type;
+    rt_uint8_t     vendor;
+    const char    *model;
+    rt_uint8_t     unit;
+    rt_uint8_t     intf_type;
+    rt_int32_t     range_max;
+    rt_int32_t     range_min;
+    rt_uint32_t    period_min;
+    rt_uint8_t     fifo_max;
+};
+
+struct rt_sensor_intf
+{
+    char          *dev_name;
+    rt_uint8_t     type;
+    void          *user_data;
+};
+
+struct rt_sensor_config
+{
+    struct rt_sensor_intf intf;
+    rt_uint8_t     mode;
+    rt_uint8_t     power;
+    rt_uint16_t    odr;
+    rt_int32_t     range;
+};
+
+typedef struct rt_sensor_device *rt_sensor_t;
+
+struct rt_sensor_device
+{
+    struct rt_device             parent;
+    struct rt_sensor_info        info;
+    struct rt_sensor_config      config;
+    void                        *data_buf;
+    rt_size_t                    data_len;
+    const struct rt_sensor_ops  *ops;
+    struct rt_sensor_module     *module;
+    rt_err_t (*irq_handle)(rt_sensor_t sensor);
+};
+
+struct coordinates
+{
+    double longitude;
+    double latitude;
+};
+
+struct rt_sensor_data
+{
+    rt_uint32_t    timestamp;
+    rt_uint8_t     type;
+    union
+    {
+        rt_int32_t          temp;
+        rt_int32_t          humi;
+        rt_int32_t          baro;
+        rt_uint32_t         dust;
+        struct coordinates  coord;
+    } data;
+};
+
+struct rt_sensor_ops
+{
+    rt_size_t (*fetch_data)(struct rt_sensor_device *sensor, void *buf, rt_size_t len);
+    rt_err_t (*control)(struct rt_sensor_device *sensor, int cmd, void *arg);
+};
+
+int         rt_hw_sensor_register(rt_sensor_t sensor, const char *name,
+                                  rt_uint32_t flag, void *data);
+rt_uint32_t rt_sensor_get_ts(void);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* __SENSOR_H__ */
@@ -0,0 +1,1345 @@
+/*
+ * Copyright (c) 2020, RudyLo <luhuadong@163.com>
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ *
+ * Change Logs:
+ * Date           Author       Notes
+ * 2026-10-19     luhuadong    the first version
+ */
+
+/*
+ * RT-Thread kernel services on pthreads, enough to run the gps package on
+ * a Linux host. IPC waits use CLOCK_MONOTONIC condition variables, one
+ * thread serves every rt_timer, and rt_thread_delete() cancels at the next
+ * blocking call like the kernel does at the next schedule, then joins the
+ * thread before it frees it. A thread that returns from its entry or
+ * deletes itself detaches and frees itself, as the idle thread would.
+ */
+
+#include <rtthread.h>
+#include <rtdevice.h>
+#include <sensor.h>
+#include <errno.h>
+#include <time.h>
+#include <unistd.h>
+
+static pthread_mutex_t kernel_lock;
+static pthread_once_t  kernel_once = PTHREAD_ONCE_INIT;
+static pthread_condattr_t cond_attr;
+static struct timespec tick_base;
+
+static __thread struct rt_thread *thread_current;
+static struct rt_thread thread_main;
+
+static void kernel_init(void)
+{
+    pthread_mutexattr_t attr;
+
+    pthread_mutexattr_init(&attr);
+    pthread_mutexattr_settype(&attr, PTHREAD_MUTEX_RECURSIVE);
+    pthread_mutex_init(&kernel_lock, &attr);
+    pthread_mutexattr_destroy(&attr);
+
+    pthread_condattr_init(&cond_attr);
+    pthread_condattr_setclock(&cond_attr, CLOCK_MONOTONIC);
+
+    clock_gettime(CLOCK_MONOTONIC, &tick_base);
+
+    rt_strncpy(thread_main.parent.name, "main", RT_NAME_MAX - 1);
+    thread_main.tid = pthread_self();
+    thread_main.started = RT_TRUE;
+}
+
+static void kernel_check(void)
+{
+    pthread_once(&kernel_once, kernel_init);
+}
+
+static void object_init(struct rt_object *object, const char *name)
+{
+    kernel_check();
+    rt_memset(object, 0, sizeof(struct rt_object));
+    if (name)
+        rt_strncpy(object->name, name, RT_NAME_MAX - 1);
+}
+
+/* ------------------------------------------------------------------------ */
+
+void rt_kprintf(const char *fmt, ...)
+{
+    va_list args;
+
+    va_start(args, fmt);
+    vfprintf(stdout, fmt, args);
+    va_end(args);
+    fflush(stdout);
+}
+
+void rt_assert_handler(const char *ex, const char *func, rt_size_t line)
+{
+    fprintf(stderr, "(%s) assertion failed at function:%s, line number:%d\n",
+            ex, func, (int)line);
+    abort();
+}
+
+rt_tick_t rt_tick_get(void)
+{
+    struct timespec now;
+
+    kernel_check();
+    clock_gettime(CLOCK_MONOTONIC, &now);
+
+    return (rt_tick_t)((now.tv_sec - tick_base.tv_sec) * RT_TICK_PER_SECOND +
+                       (now.tv_nsec - tick_base.tv_nsec) / (1000000000L / RT_TICK_PER_SECOND));
+}
+
+rt_tick_t rt_tick_from_millisecond(rt_int32_t ms)
+{
+    if (ms < 0)
+        return (rt_tick_t)RT_WAITING_FOREVER;
+
+    return (rt_tick_t)(((rt_int64_t)ms * RT_TICK_PER_SECOND + 999) / 1000);
+}
+
+/* the absolute CLOCK_MONOTONIC time 'tick' ticks from now */
+static void tick_deadline(struct timespec *ts, rt_int32_t tick)
+{
+    clock_gettime(CLOCK_MONOTONIC, ts);
+    ts->tv_sec  += tick / RT_TICK_PER_SECOND;
+    ts->tv_nsec += (long)(tick % RT_TICK_PER_SECOND) * (1000000000L / RT_TICK_PER_SECOND);
+    if (ts->tv_nsec >= 1000000000L)
+    {
+        ts->tv_sec++;
+        ts->tv_nsec -= 1000000000L;
+    }
+}
+
+/* interrupt locks and the scheduler lock are one recursive mutex */
+rt_base_t rt_hw_interrupt_disable(void)
+{
+    kernel_check();
+    pthread_mutex_lock(&kernel_lock);
+
+    return 0;
+}
+
+void rt_hw_interrupt_enable(rt_base_t level)
+{
+    RT_UNUSED(level);
+    pthread_mutex_unlock(&kernel_lock);
+}
+
+void rt_enter_critical(void)
+{
+    rt_hw_interrupt_disable();
+}
+
+void rt_exit_critical(void)
+{
+    rt_hw_interrupt_enable(0);
+}
+
+/* ------------------------------------------------------------------------ */
+/* thread */
+
+/* runs on return, pthread_exit() and cancellation alike */
+static void thread_exit(void *parameter)
+{
+    struct rt_thread *thread = parameter;
+    rt_bool_t joined;
+
+    pthread_mutex_lock(&kernel_lock);
+    joined = thread->joining;
+    if (!joined)
+    {
+        thread->started = RT_FALSE;
+        pthread_detach(pthread_self());
+    }
+    pthread_mutex_unlock(&kernel_lock);
+
+    /* otherwise the thread is not ours any more, the joiner frees it */
+    if (!joined && thread->dynamic)
+        rt_free(thread);
+}
+
+static void *thread_entry(void *parameter)
+{
+    struct rt_thread *thread = parameter;
+
+    thread_current = thread;
+    pthread_setcanceltype(PTHREAD_CANCEL_DEFERRED, RT_NULL);
+    pthread_cleanup_push(thread_exit, thread);
+    thread->entry(thread->parameter);
+    pthread_cleanup_pop(1);
+
+    return RT_NULL;
+}
+
+rt_err_t rt_thread_init(struct rt_thread *thread, const char *name,
+                        void (*entry)(void *parameter), void *parameter,
+                        void *stack_start, rt_uint32_t stack_size,
+                        rt_uint8_t priority, rt_uint32_t tick)
+{
+    RT_ASSERT(thread != RT_NULL);
+    RT_ASSERT(entry != RT_NULL);
+    RT_UNUSED(stack_start);
+    RT_UNUSED(stack_size);
+    RT_UNUSED(priority);
+    RT_UNUSED(tick);
+
+    rt_memset(thread, 0, sizeof(struct rt_thread));
+    object_init(&thread->parent, name);
+    thread->entry = entry;
+    thread->parameter = parameter;
+
+    return RT_EOK;
+}
+
+rt_thread_t rt_thread_create(const char *name, void (*entry)(void *parameter), void *parameter,
+                             rt_uint32_t stack_size, rt_uint8_t priority, rt_uint32_t tick)
+{
+    struct rt_thread *thread = rt_malloc(sizeof(struct rt_thread));
+
+    if (thread == RT_NULL)
+        return RT_NULL;
+
+    rt_thread_init(thread, name, entry, parameter, RT_NULL, stack_size, priority, tick);
+    thread->dynamic = RT_TRUE;
+
+    return thread;
+}
+
+rt_err_t rt_thread_startup(rt_thread_t thread)
+{
+    pthread_attr_t attr;
+    int ret;
+
+    RT_ASSERT(thread != RT_NULL);
+    RT_ASSERT(!thread->started);
+
+    pthread_attr_init(&attr);
+    pthread_attr_setdetachstate(&attr, PTHREAD_CREATE_JOINABLE);
+    thread->started = RT_TRUE;
+    ret = pthread_create(&thread->tid, &attr, thread_entry, thread);
+    pthread_attr_destroy(&attr);
+
+    if (ret != 0)
+    {
+        thread->started = RT_FALSE;
+        return -RT_ERROR;
+    }
+
+    return RT_EOK;
+}
+
+/* stop another thread and wait until it has unwound */
+static void thread_join(rt_thread_t thread)
+{
+    rt_bool_t started;
+
+    pthread_mutex_lock(&kernel_lock);
+    started = thread->started;
+    if (started)
+        thread->joining = RT_TRUE;
+    pthread_mutex_unlock(&kernel_lock);
+
+    /* a thread that already exited has detached itself */
+    if (started)
+    {
+        pthread_cancel(thread->tid);
+        pthread_join(thread->tid, RT_NULL);
+        thread->started = RT_FALSE;
+        thread->joining = RT_FALSE;
+    }
+}
+
+rt_err_t rt_thread_detach(rt_thread_t thread)
+{
+    RT_ASSERT(thread != RT_NULL);
+
+    /* thread_exit() cleans up on the way out */
+    if (thread == thread_current)
+        pthread_exit(RT_NULL);
+
+    thread_join(thread);
+
+    return RT_EOK;
+}
+
+rt_err_t rt_thread_delete(rt_thread_t thread)
+{
+    RT_ASSERT(thread != RT_NULL);
+
+    /* thread_exit() frees it on the way out */
+    if (thread == thread_current)
+        pthread_exit(RT_NULL);
+
+    thread_join(thread);
+    if (thread->dynamic)
+        rt_free(thread);
+
+    return RT_EOK;
+}
+
+rt_thread_t rt_thread_self(void)
+{
+    kernel_check();
+
+    return thread_current ? thread_current : &thread_main;
+}
+
+rt_err_t rt_thread_yield(void)
+{
+    sched_yield();
+
+    return RT_EOK;
+}
+
+rt_err_t rt_thread_delay(rt_tick_t tick)
+{
+    struct timespec ts;
+
+    ts.tv_sec  = tick / RT_TICK_PER_SECOND;
+    ts.tv_nsec = (long)(tick % RT_TICK_PER_SECOND) * (1000000000L / RT_TICK_PER_SECOND);
+    while (nanosleep(&ts, &ts) != 0 && errno == EINTR)
+        ;
+
+    return RT_EOK;
+}
+
+rt_err_t rt_thread_mdelay(rt_int32_t ms)
+{
+    return rt_thread_delay(rt_tick_from_millisecond(ms));
+}
+
+/* ------------------------------------------------------------------------ */
+/* semaphore */
+
+static void cleanup_unlock(void *lock)
+{
+    pthread_mutex_unlock(lock);
+}
+
+/* wait on cond until pred holds or the timeout elapses, lock held */
+#define WAIT_UNTIL(lock, cond, pred, time, ret)                               \
+    do                                                                        \
+    {                                                                         \
+        struct timespec __ts;                                                 \
+        ret = RT_EOK;                                                         \
+        if ((time) > 0)                                                       \
+            tick_deadline(&__ts, (time));                                     \
+        pthread_cleanup_push(cleanup_unlock, (lock));                         \
+        while (!(pred))                                                       \
+        {                                                                     \
+            if ((time) == 0)                                                  \
+            {                                                                 \
+                ret = -RT_ETIMEOUT;                                           \
+                break;                                                        \
+            }                                                                 \
+            if ((time) < 0)                                                   \
+                pthread_cond_wait((cond), (lock));                            \
+            else if (pthread_cond_timedwait((cond), (lock), &__ts) == ETIMEDOUT && !(pred)) \
+            {                                                                 \
+                ret = -RT_ETIMEOUT;                                           \
+                break;                                                        \
+            }                                                                 \
+        }                                                                     \
+        pthread_cleanup_pop(0);                                               \
+    } while (0)
+
+rt_err_t rt_sem_init(rt_sem_t sem, const char *name, rt_uint32_t value, rt_uint8_t flag)
+{
+    RT_ASSERT(sem != RT_NULL);
+    RT_UNUSED(flag);
+
+    object_init(&sem->parent, name);
+    pthread_mutex_init(&sem->lock, RT_NULL);
+    pthread_cond_init(&sem->cond, &cond_attr);
+    sem->value = value;
+
+    return RT_EOK;
+}
+
+rt_err_t rt_sem_detach(rt_sem_t sem)
+{
+    RT_ASSERT(sem != RT_NULL);
+
+    pthread_cond_destroy(&sem->cond);
+    pthread_mutex_destroy(&sem->lock);
+
+    return RT_EOK;
+}
+
+rt_sem_t rt_sem_create(const char *name, rt_uint32_t value, rt_uint8_t flag)
+{
+    rt_sem_t sem = rt_malloc(sizeof(struct rt_semaphore));
+
+    if (sem)
+        rt_sem_init(sem, name, value, flag);
+
+    return sem;
+}
+
+rt_err_t rt_sem_delete(rt_sem_t sem)
+{
+    rt_sem_detach(sem);
+    rt_free(sem);
+
+    return RT_EOK;
+}
+
+rt_err_t rt_sem_take(rt_sem_t sem, rt_int32_t time)
+{
+    rt_err_t ret;
+
+    RT_ASSERT(sem != RT_NULL);
+
+    pthread_mutex_lock(&sem->lock);
+    WAIT_UNTIL(&sem->lock, &sem->cond, sem->value > 0, time, ret);
+    if (ret == RT_EOK)
+        sem->value--;
+    pthread_mutex_unlock(&sem->lock);
+
+    return ret;
+}
+
+rt_err_t rt_sem_trytake(rt_sem_t sem)
+{
+    return rt_sem_take(sem, RT_WAITING_NO);
+}
+
+rt_err_t rt_sem_release(rt_sem_t sem)
+{
+    RT_ASSERT(sem != RT_NULL);
+
+    pthread_mutex_lock(&sem->lock);
+    if (sem->value < 0xFFFF)
+        sem->value++;
+    pthread_cond_signal(&sem->cond);
+    pthread_mutex_unlock(&sem->lock);
+
+    return RT_EOK;
+}
+
+rt_err_t rt_sem_control(rt_sem_t sem, int cmd, void *arg)
+{
+    RT_ASSERT(sem != RT_NULL);
+
+    if (cmd != RT_IPC_CMD_RESET)
+        return -RT_ERROR;
+
+    pthread_mutex_lock(&sem->lock);
+    sem->value = (rt_uint32_t)(rt_ubase_t)arg;
+    pthread_mutex_unlock(&sem->lock);
+
+    return RT_EOK;
+}
+
+/* ------------------------------------------------------------------------ */
+/* mutex */
+
+rt_err_t rt_mutex_init(rt_mutex_t mutex, const char *name, rt_uint8_t flag)
+{
+    pthread_mutexattr_t attr;
+
+    RT_ASSERT(mutex != RT_NULL);
+    RT_UNUSED(flag);
+
+    object_init(&mutex->parent, name);
+    pthread_mutexattr_init(&attr);
+    pthread_mutexattr_settype(&attr, PTHREAD_MUTEX_RECURSIVE);
+    pthread_mutex_init(&mutex->lock, &attr);
+    pthread_mutexattr_destroy(&attr);
+
+    return RT_EOK;
+}
+
+rt_err_t rt_mutex_detach(rt_mutex_t mutex)
+{
+    RT_ASSERT(mutex != RT_NULL);
+
+    pthread_mutex_destroy(&mutex->lock);
+
+    return RT_EOK;
+}
+
+rt_mutex_t rt_mutex_create(const char *name, rt_uint8_t flag)
+{
+    rt_mutex_t mutex = rt_malloc(sizeof(struct rt_mutex));
+
+    if (mutex)
+        rt_mutex_init(mutex, name, flag);
+
+    return mutex;
+}
+
+rt_err_t rt_mutex_delete(rt_mutex_t mutex)
+{
+    rt_mutex_detach(mutex);
+    rt_free(mutex);
+
+    return RT_EOK;
+}
+
+rt_err_t rt_mutex_take(rt_mutex_t mutex, rt_int32_t time)
+{
+    struct timespec ts;
+
+    RT_ASSERT(mutex != RT_NULL);
+
+    if (time < 0)
+        return pthread_mutex_lock(&mutex->lock) == 0 ? RT_EOK : -RT_ERROR;
+    if (time == 0)
+        return pthread_mutex_trylock(&mutex->lock) == 0 ? RT_EOK : -RT_ETIMEOUT;
+
+    /* pthread_mutex_timedlock() takes CLOCK_REALTIME */
+    clock_gettime(CLOCK_REALTIME, &ts);
+    ts.tv_sec  += time / RT_TICK_PER_SECOND;
+    ts.tv_nsec += (long)(time % RT_TICK_PER_SECOND) * (1000000000L / RT_TICK_PER_SECOND);
+    if (ts.tv_nsec >= 1000000000L)
+    {
+        ts.tv_sec++;
+        ts.tv_nsec -= 1000000000L;
+    }
+
+    return pthread_mutex_timedlock(&mutex->lock, &ts) == 0 ? RT_EOK : -RT_ETIMEOUT;
+}
+
+rt_err_t rt_mutex_release(rt_mutex_t mutex)
+{
+    RT_ASSERT(mutex != RT_NULL);
+
+    return pthread_mutex_unlock(&mutex->lock) == 0 ? RT_EOK : -RT_ERROR;
+}
+
+/* ------------------------------------------------------------------------ */
+/* event */
+
+rt_err_t rt_event_init(rt_event_t event, const char *name, rt_uint8_t flag)
+{
+    RT_ASSERT(event != RT_NULL);
+    RT_UNUSED(flag);
+
+    object_init(&event->parent, name);
+    pthread_mutex_init(&event->lock, RT_NULL);
+    pthread_cond_init(&event->cond, &cond_attr);
+    event->set = 0;
+
+    return RT_EOK;
+}
+
+rt_err_t rt_event_detach(rt_event_t event)
+{
+    RT_ASSERT(event != RT_NULL);
+
+    pthread_cond_destroy(&event->cond);
+    pthread_mutex_destroy(&event->lock);
+
+    return RT_EOK;
+}
+
+rt_err_t rt_event_send(rt_event_t event, rt_uint32_t set)
+{
+    RT_ASSERT(event != RT_NULL);
+
+    pthread_mutex_lock(&event->lock);
+    event->set |= set;
+    pthread_cond_broadcast(&event->cond);
+    pthread_mutex_unlock(&event->lock);
+
+    return RT_EOK;
+}
+
+rt_err_t rt_event_recv(rt_event_t event, rt_uint32_t set, rt_uint8_t opt,
+                       rt_int32_t timeout, rt_uint32_t *recved)
+{
+    rt_err_t ret;
+
+    RT_ASSERT(event != RT_NULL);
+
+    pthread_mutex_lock(&event->lock);
+    if (opt & RT_EVENT_FLAG_AND)
+        WAIT_UNTIL(&event->lock, &event->cond, (event->set & set) == set, timeout, ret);
+    else
+        WAIT_UNTIL(&event->lock, &event->cond, (event->set & set) != 0, timeout, ret);
+
+    if (ret == RT_EOK)
+    {
+        if (recved)
+            *recved = event->set & set;
+        if (opt & RT_EVENT_FLAG_CLEAR)
+            event->set &= ~set;
+    }
+    pthread_mutex_unlock(&event->lock);
+
+    return ret;
+}
+
+/* ------------------------------------------------------------------------ */
+/* mailbox */
+
+rt_err_t rt_mb_init(rt_mailbox_t mb, const char *name, void *msgpool, rt_size_t size, rt_uint8_t flag)
+{
+    RT_ASSERT(mb != RT_NULL);
+    RT_UNUSED(flag);
+
+    object_init(&mb->parent, name);
+    pthread_mutex_init(&mb->lock, RT_NULL);
+    pthread_cond_init(&mb->cond, &cond_attr);
+    mb->msg_pool = msgpool;
+    mb->size = (rt_uint16_t)size;
+    mb->entry = 0;
+    mb->in_offset = 0;
+    mb->out_offset = 0;
+
+    return RT_EOK;
+}
+
+rt_err_t rt_mb_detach(rt_mailbox_t mb)
+{
+    RT_ASSERT(mb != RT_NULL);
+
+    pthread_cond_destroy(&mb->cond);
+    pthread_mutex_destroy(&mb->lock);
+
+    return RT_EOK;
+}
+
+rt_mailbox_t rt_mb_create(const char *name, rt_size_t size, rt_uint8_t flag)
+{
+    rt_mailbox_t mb = rt_malloc(sizeof(struct rt_mailbox) + size * sizeof(rt_ubase_t));
+
+    if (mb)
+        rt_mb_init(mb, name, mb + 1, size, flag);
+
+    return mb;
+}
+
+rt_err_t rt_mb_delete(rt_mailbox_t mb)
+{
+    rt_mb_detach(mb);
+    rt_free(mb);
+
+    return RT_EOK;
+}
+
+rt_err_t rt_mb_send(rt_mailbox_t mb, rt_ubase_t value)
+{
+    RT_ASSERT(mb != RT_NULL);
+
+    pthread_mutex_lock(&mb->lock);
+    if (mb->entry == mb->size)
+    {
+        pthread_mutex_unlock(&mb->lock);
+        return -RT_EFULL;
+    }
+
+    mb->msg_pool[mb->in_offset] = value;
+    mb->in_offset = (mb->in_offset + 1) % mb->size;
+    mb->entry++;
+    pthread_cond_broadcast(&mb->cond);
+    pthread_mutex_unlock(&mb->lock);
+
+    return RT_EOK;
+}
+
+rt_err_t rt_mb_recv(rt_mailbox_t mb, rt_ubase_t *value, rt_int32_t timeout)
+{
+    rt_err_t ret;
+
+    RT_ASSERT(mb != RT_NULL);
+
+    pthread_mutex_lock(&mb->lock);
+    WAIT_UNTIL(&mb->lock, &mb->cond, mb->entry > 0, timeout, ret);
+    if (ret == RT_EOK)
+    {
+        *value = mb->msg_pool[mb->out_offset];
+        mb->out_offset = (mb->out_offset + 1) % mb->size;
+        mb->entry--;
+    }
+    pthread_mutex_unlock(&mb->lock);
+
+    return ret;
+}
+
+/* ------------------------------------------------------------------------ */
+/* timer, every active timer is on one list served by one thread */
+
+static pthread_mutex_t timer_lock = PTHREAD_MUTEX_INITIALIZER;
+static pthread_cond_t  timer_cond;
+static pthread_t       timer_tid;
+static rt_bool_t       timer_running;
+static struct rt_timer *timer_list;
+
+static void timer_remove(rt_timer_t timer)
+{
+    struct rt_timer **node;
+
+    for (node = &timer_list; *node; node = &(*node)->next)
+    {
+        if (*node == timer)
+        {
+            *node = timer->next;
+            break;
+        }
+    }
+    timer->next = RT_NULL;
+    timer->active = RT_FALSE;
+}
+
+static void *timer_entry(void *parameter)
+{
+    RT_UNUSED(parameter);
+
+    pthread_mutex_lock(&timer_lock);
+    for (;;)
+    {
+        struct rt_timer *timer, *next = RT_NULL;
+        void (*timeout)(void *parameter);
+        void *arg;
+        rt_tick_t now = rt_tick_get();
+
+        for (timer = timer_list; timer; timer = timer->next)
+        {
+            if (next == RT_NULL || (rt_int32_t)(timer->timeout_tick - next->timeout_tick) < 0)
+                next = timer;
+        }
+
+        if (next == RT_NULL)
+        {
+            pthread_cond_wait(&timer_cond, &timer_lock);
+            continue;
+        }
+
+        if ((rt_int32_t)(next->timeout_tick - now) > 0)
+        {
+            struct timespec ts;
+
+            tick_deadline(&ts, (rt_int32_t)(next->timeout_tick - now));
+            pthread_cond_timedwait(&timer_cond, &timer_lock, &ts);
+            continue;
+        }
+
+        if (next->parent.flag & RT_TIMER_FLAG_PERIODIC)
+            next->timeout_tick += next->init_tick ? next->init_tick : 1;
+        else
+            timer_remove(next);
+
+        /*
+         * the callback may start or stop timers, itself included; once the
+         * lock is dropped the timer may be stopped and freed, so it is not
+         * read again
+         */
+        timeout = next->timeout_func;
+        arg = next->parameter;
+        pthread_mutex_unlock(&timer_lock);
+        timeout(arg);
+        pthread_mutex_lock(&timer_lock);
+    }
+
+    return RT_NULL;
+}
+
+void rt_timer_init(rt_timer_t timer, const char *name, void (*timeout)(void *parameter),
+                   void *parameter, rt_tick_t time, rt_uint8_t flag)
+{
+    RT_ASSERT(timer != RT_NULL);
+
+    rt_memset(timer, 0, sizeof(struct rt_timer));
+    object_init(&timer->parent, name);
+    timer->parent.flag = flag;
+    timer->timeout_func = timeout;
+    timer->parameter = parameter;
+    timer->init_tick = time;
+}
+
+rt_err_t rt_timer_detach(rt_timer_t timer)
+{
+    return rt_timer_stop(timer);
+}
+
+rt_timer_t rt_timer_create(const char *name, void (*timeout)(void *parameter),
+                           void *parameter, rt_tick_t time, rt_uint8_t flag)
+{
+    rt_timer_t timer = rt_malloc(sizeof(struct rt_timer));
+
+    if (timer)
+    {
+        rt_timer_init(timer, name, timeout, parameter, time, flag);
+        timer->dynamic = RT_TRUE;
+    }
+
+    return timer;
+}
+
+rt_err_t rt_timer_delete(rt_timer_t timer)
+{
+    rt_timer_stop(timer);
+    rt_free(timer);
+
+    return RT_EOK;
+}
+
+rt_err_t rt_timer_start(rt_timer_t timer)
+{
+    RT_ASSERT(timer != RT_NULL);
+
+    pthread_mutex_lock(&timer_lock);
+    if (!timer_running)
+    {
+        pthread_cond_init(&timer_cond, &cond_attr);
+        if (pthread_create(&timer_tid, RT_NULL, timer_entry, RT_NULL) != 0)
+        {
+            pthread_mutex_unlock(&timer_lock);
+            return -RT_ERROR;
+        }
+        pthread_detach(timer_tid);
+        timer_running = RT_TRUE;
+    }
+
+    if (timer->active)
+        timer_remove(timer);
+    timer->timeout_tick = rt_tick_get() + timer->init_tick;
+    timer->active = RT_TRUE;
+    timer->next = timer_list;
+    timer_list = timer;
+    pthread_cond_signal(&timer_cond);
+    pthread_mutex_unlock(&timer_lock);
+
+    return RT_EOK;
+}
+
+rt_err_t rt_timer_stop(rt_timer_t timer)
+{
+    rt_err_t ret = -RT_ERROR;
+
+    RT_ASSERT(timer != RT_NULL);
+
+    pthread_mutex_lock(&timer_lock);
+    if (timer->active)
+    {
+        timer_remove(timer);
+        ret = RT_EOK;
+    }
+    pthread_mutex_unlock(&timer_lock);
+
+    return ret;
+}
+
+rt_err_t rt_timer_control(rt_timer_t timer, int cmd, void *arg)
+{
+    RT_ASSERT(timer != RT_NULL);
+
+    pthread_mutex_lock(&timer_lock);
+    if (cmd == RT_TIMER_CTRL_SET_TIME)
+        timer->init_tick = *(rt_tick_t *)arg;
+    else if (cmd == RT_TIMER_CTRL_GET_TIME)
+        *(rt_tick_t *)arg = timer->init_tick;
+    pthread_mutex_unlock(&timer_lock);
+
+    return RT_EOK;
+}
+
+/* ------------------------------------------------------------------------ */
+/* device */
+
+static pthread_mutex_t device_lock = PTHREAD_MUTEX_INITIALIZER;
+static struct rt_device *device_list;
+
+rt_device_t rt_device_find(const char *name)
+{
+    struct rt_device *dev;
+
+    pthread_mutex_lock(&device_lock);
+    for (dev = device_list; dev; dev = dev->next)
+    {
+        if (rt_strncmp(dev->parent.name, name, RT_NAME_MAX - 1) == 0)
+            break;
+    }
+    pthread_mutex_unlock(&device_lock);
+
+    return dev;
+}
+
+rt_err_t rt_device_register(rt_device_t dev, const char *name, rt_uint16_t flags)
+{
+    RT_ASSERT(dev != RT_NULL);
+
+    if (rt_device_find(name) != RT_NULL)
+        return -RT_ERROR;
+
+    rt_strncpy(dev->parent.name, name, RT_NAME_MAX - 1);
+    dev->parent.name[RT_NAME_MAX - 1] = '\0';
+    dev->flag = flags;
+    dev->ref_count = 0;
+    dev->open_flag = 0;
+
+    pthread_mutex_lock(&device_lock);
+    dev->next = device_list;
+    device_list = dev;
+    pthread_mutex_unlock(&device_lock);
+
+    return RT_EOK;
+}
+
+rt_err_t rt_device_unregister(rt_device_t dev)
+{
+    struct rt_device **node;
+
+    RT_ASSERT(dev != RT_NULL);
+
+    pthread_mutex_lock(&device_lock);
+    for (node = &device_list; *node; node = &(*node)->next)
+    {
+        if (*node == dev)
+        {
+            *node = dev->next;
+            break;
+        }
+    }
+    pthread_mutex_unlock(&device_lock);
+
+    return RT_EOK;
+}
+
+rt_err_t rt_device_open(rt_device_t dev, rt_uint16_t oflag)
+{
+    rt_err_t ret = RT_EOK;
+
+    RT_ASSERT(dev != RT_NULL);
+
+    if (!(dev->flag & RT_DEVICE_FLAG_ACTIVATED))
+    {
+        if (dev->init)
+        {
+            ret = dev->init(dev);
+            if (ret != RT_EOK)
+                return ret;
+        }
+        dev->flag |= RT_DEVICE_FLAG_ACTIVATED;
+    }
+
+    if ((dev->flag & RT_DEVICE_FLAG_STANDALONE) && (dev->open_flag & RT_DEVICE_OFLAG_OPEN))
+        return -RT_EBUSY;
+
+    if (!(dev->open_flag & RT_DEVICE_OFLAG_OPEN))
+    {
+        if (dev->open)
+            ret = dev->open(dev, oflag);
+        if (ret != RT_EOK)
+            return ret;
+        dev->open_flag = (oflag & RT_DEVICE_OFLAG_MASK) | RT_DEVICE_OFLAG_OPEN;
+    }
+    dev->ref_count++;
+
+    return RT_EOK;
+}
+
+rt_err_t rt_device_close(rt_device_t dev)
+{
+    rt_err_t ret = RT_EOK;
+
+    RT_ASSERT(dev != RT_NULL);
+
+    if (dev->ref_count == 0)
+        return -RT_ERROR;
+
+    if (--dev->ref_count == 0)
+    {
+        if (dev->close)
+            ret = dev->close(dev);
+        dev->open_flag = RT_DEVICE_OFLAG_CLOSE;
+    }
+
+    return ret;
+}
+
+rt_size_t rt_device_read(rt_device_t dev, rt_off_t pos, void *buffer, rt_size_t size)
+{
+    RT_ASSERT(dev != RT_NULL);
+
+    return dev->read ? dev->read(dev, pos, buffer, size) : 0;
+}
+
+rt_size_t rt_device_write(rt_device_t dev, rt_off_t pos, const void *buffer, rt_size_t size)
+{
+    RT_ASSERT(dev != RT_NULL);
+
+    return dev->write ? dev->write(dev, pos, buffer, size) : 0;
+}
+
+rt_err_t rt_device_control(rt_device_t dev, int cmd, void *arg)
+{
+    RT_ASSERT(dev != RT_NULL);
+
+    return dev->control ? dev->control(dev, cmd, arg) : -RT_ENOSYS;
+}
+
+rt_err_t rt_device_set_rx_indicate(rt_device_t dev, rt_err_t (*rx_ind)(rt_device_t dev, rt_size_t size))
+{
+    RT_ASSERT(dev != RT_NULL);
+
+    dev->rx_indicate = rx_ind;
+
+    return RT_EOK;
+}
+
+/* rt_kprintf() is the console */
+rt_device_t rt_console_get_device(void)
+{
+    return RT_NULL;
+}
+
+/* ------------------------------------------------------------------------ */
+/* heap, malloc() with the hook RT-Thread calls after each allocation */
+#ifdef RT_USING_HOOK
+static void (*rt_malloc_hook)(void *ptr, rt_size_t size);
+
+void rt_malloc_sethook(void (*hook)(void *ptr, rt_size_t size))
+{
+    rt_malloc_hook = hook;
+}
+#endif
+
+void *rt_malloc(rt_size_t size)
+{
+    void *ptr = malloc(size);
+
+#ifdef RT_USING_HOOK
+    if (rt_malloc_hook)
+        rt_malloc_hook(ptr, size);
+#endif
+
+    return ptr;
+}
+
+void *rt_calloc(rt_size_t count, rt_size_t size)
+{
+    void *ptr;
+
+    if (size && count > (rt_size_t)-1 / size)
+        return RT_NULL;
+
+    ptr = rt_malloc(count * size);
+    if (ptr)
+        memset(ptr, 0, count * size);
+
+    return ptr;
+}
+
+/* ------------------------------------------------------------------------ */
+/* ring buffer */
+
+void rt_ringbuffer_init(struct rt_ringbuffer *rb, rt_uint8_t *pool, rt_int16_t size)
+{
+    RT_ASSERT(rb != RT_NULL);
+    RT_ASSERT(size > 0);
+
+    rb->read_mirror = rb->read_index = 0;
+    rb->write_mirror = rb->write_index = 0;
+    rb->buffer_ptr = pool;
+    rb->buffer_size = size;
+}
+
+void rt_ringbuffer_reset(struct rt_ringbuffer *rb)
+{
+    rb->read_mirror = rb->read_index = 0;
+    rb->write_mirror = rb->write_index = 0;
+}
+
+enum rt_ringbuffer_state rt_ringbuffer_status(struct rt_ringbuffer *rb)
+{
+    if (rb->read_index == rb->write_index)
+        return rb->read_mirror == rb->write_mirror ? RT_RINGBUFFER_EMPTY : RT_RINGBUFFER_FULL;
+
+    return RT_RINGBUFFER_HALFFULL;
+}
+
+rt_size_t rt_ringbuffer_data_len(struct rt_ringbuffer *rb)
+{
+    switch (rt_ringbuffer_status(rb))
+    {
+    case RT_RINGBUFFER_EMPTY:
+        return 0;
+    case RT_RINGBUFFER_FULL:
+        return rb->buffer_size;
+    default:
+        if (rb->write_index > rb->read_index)
+            return rb->write_index - rb->read_index;
+        return rb->buffer_size - (rb->read_index - rb->write_index);
+    }
+}
+
+rt_size_t rt_ringbuffer_put(struct rt_ringbuffer *rb, const rt_uint8_t *ptr, rt_uint16_t length)
+{
+    rt_uint16_t space = rt_ringbuffer_space_len(rb);
+
+    if (length > space)
+        length = space;
+
+    return rt_ringbuffer_put_force(rb, ptr, length);
+}
+
+rt_size_t rt_ringbuffer_put_force(struct rt_ringbuffer *rb, const rt_uint8_t *ptr, rt_uint16_t length)
+{
+    rt_uint16_t space = rt_ringbuffer_space_len(rb);
+    rt_uint16_t i;
+
+    if (length > rb->buffer_size)
+    {
+        ptr += length - rb->buffer_size;
+        length = rb->buffer_size;
+    }
+
+    for (i = 0; i < length; i++)
+    {
+        rb->buffer_ptr[rb->write_index] = ptr[i];
+        if (rb->write_index == rb->buffer_size - 1)
+        {
+            rb->write_mirror = ~rb->write_mirror;
+            rb->write_index = 0;
+        }
+        else
+            rb->write_index++;
+    }
+
+    /* the oldest bytes were overwritten, the buffer is full */
+    if (length > space)
+    {
+        rb->read_mirror = ~rb->write_mirror;
+        rb->read_index = rb->write_index;
+    }
+
+    return length;
+}
+
+rt_size_t rt_ringbuffer_get(struct rt_ringbuffer *rb, rt_uint8_t *ptr, rt_uint16_t length)
+{
+    rt_uint16_t size = rt_ringbuffer_data_len(rb);
+    rt_uint16_t i;
+
+    if (length > size)
+        length = size;
+
+    for (i = 0; i < length; i++)
+    {
+        ptr[i] = rb->buffer_ptr[rb->read_index];
+        if (rb->read_index == rb->buffer_size - 1)
+        {
+            rb->read_mirror = ~rb->read_mirror;
+            rb->read_index = 0;
+        }
+        else
+            rb->read_index++;
+    }
+
+    return length;
+}
+
+/* ------------------------------------------------------------------------ */
+/* pin, the host has none */
+
+void rt_pin_mode(rt_base_t pin, rt_base_t mode)
+{
+    RT_UNUSED(pin);
+    RT_UNUSED(mode);
+}
+
+void rt_pin_write(rt_base_t pin, rt_base_t value)
+{
+    RT_UNUSED(pin);
+    RT_UNUSED(value);
+}
+
+int rt_pin_read(rt_base_t pin)
+{
+    RT_UNUSED(pin);
+
+    return PIN_LOW;
+}
+
+rt_err_t rt_pin_attach_irq(rt_int32_t pin, rt_uint32_t mode,
+                           void (*hdr)(void *args), void *args)
+{
+    RT_UNUSED(pin);
+    RT_UNUSED(mode);
+    RT_UNUSED(hdr);
+    RT_UNUSED(args);
+
+    return -RT_ENOSYS;
+}
+
+rt_err_t rt_pin_detach_irq(rt_int32_t pin)
+{
+    RT_UNUSED(pin);
+
+    return -RT_ENOSYS;
+}
+
+rt_err_t rt_pin_irq_enable(rt_base_t pin, rt_uint32_t enabled)
+{
+    RT_UNUSED(pin);
+    RT_UNUSED(enabled);
+
+    return -RT_ENOSYS;
+}
+
+/* ------------------------------------------------------------------------ */
+/* sensor, a device whose read fetches samples from the driver */
+
+static rt_size_t sensor_read(rt_device_t dev, rt_off_t pos, void *buffer, rt_size_t size)
+{
+    rt_sensor_t sensor = (rt_sensor_t)dev;
+
+    RT_UNUSED(pos);
+
+    if (buffer == RT_NULL || size == 0)
+        return 0;
+
+    return sensor->ops->fetch_data(sensor, buffer, size);
+}
+
+static rt_err_t sensor_control(rt_device_t dev, int cmd, void *args)
+{
+    rt_sensor_t sensor = (rt_sensor_t)dev;
+
+    if (cmd == RT_SENSOR_CTRL_GET_INFO)
+    {
+        rt_memcpy(args, &sensor->info, sizeof(struct rt_sensor_info));
+        return RT_EOK;
+    }
+
+    return sensor->ops->control(sensor, cmd, args);
+}
+
+int rt_hw_sensor_register(rt_sensor_t sensor, const char *name, rt_uint32_t flag, void *data)
+{
+    struct rt_device *device = &sensor->parent;
+
+    device->type    = RT_Device_Class_Sensor;
+    device->read    = sensor_read;
+    device->control = sensor_control;
+    device->user_data = data;
+
+    return rt_device_register(device, name, (rt_uint16_t)(flag | RT_DEVICE_FLAG_STANDALONE));
+}
+
+rt_uint32_t rt_sensor_get_ts(void)
+{
+    return rt_tick_get();
+}
+
+/* ------------------------------------------------------------------------ */
+/* automatic initialization and msh */
+
+#define INIT_TABLE_MAX      64
+#define MSH_TABLE_MAX       64
+#define MSH_ARG_MAX         10
+
+struct init_entry
+{
+    init_fn_t fn;
+    int       level;
+};
+
+struct msh_entry
+{
+    const char  *name;
+    const char  *desc;
+    syscall_func func;
+};
+
+static struct init_entry init_table[INIT_TABLE_MAX];
+static int init_num;
+static struct msh_entry msh_table[MSH_TABLE_MAX];
+static int msh_num;
+
+void rt_components_register(init_fn_t fn, int level)
+{
+    RT_ASSERT(init_num < INIT_TABLE_MAX);
+
+    init_table[init_num].fn = fn;
+    init_table[init_num].level = level;
+    init_num++;
+}
+
+void rt_components_init(void)
+{
+    int level, i;
+
+    kernel_check();
+
+    for (level = 1; level <= 6; level++)
+    {
+        for (i = 0; i < init_num; i++)
+        {
+            if (init_table[i].level == level)
+                init_table[i].fn();
+        }
+    }
+}
+
+void msh_register(const char *name, const char *desc, syscall_func func)
+{
+    RT_ASSERT(msh_num < MSH_TABLE_MAX);
+
+    msh_table[msh_num].name = name;
+    msh_table[msh_num].desc = desc;
+    msh_table[msh_num].func = func;
+    msh_num++;
+}
+
+static void msh_help(void)
+{
+    int i;
+
+    rt_kprintf("RT-Thread shell commands:\n");
+    for (i = 0; i < msh_num; i++)
+        rt_kprintf("%-16s - %s\n", msh_table[i].name, msh_table[i].desc);
+}
+
+/**
+ * This function runs one shell command line
+ *
+ * @return the command's return value, -1 if there is no such command
+ */
+int msh_exec(char *cmd, rt_size_t length)
+{
+    char *argv[MSH_ARG_MAX];
+    char *p = cmd, *end = cmd + length;
+    int argc = 0, i;
+
+    while (p < end && argc < MSH_ARG_MAX)
+    {
+        while (p < end && (*p == ' ' || *p == '\t' || *p == '\n' || *p == '\r'))
+            *p++ = '\0';
+        if (p >= end || *p == '\0')
+            break;
+
+        argv[argc++] = p;
+        while (p < end && *p != ' ' && *p != '\t' && *p != '\n' && *p != '\r' && *p != '\0')
+            p++;
+    }
+    if (p < end)
+        *p = '\0';
+
+    if (argc == 0)
+        return 0;
+
+    if (rt_strcmp(argv[0], "help") == 0)
+    {
+        msh_help();
+        return 0;
+    }
+
+    for (i = 0; i < msh_num; i++)
+    {
+        if (rt_strcmp(argv[0], msh_table[i].name) == 0)
+            return ((int (*)(int, char **))msh_table[i].func)(argc, argv);
+    }
+
+    rt_kprintf("%s: command not found.\n", argv[0]);
+
+    return -1;
+}
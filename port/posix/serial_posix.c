@@ -0,0 +1,389 @@
+/*
+ * Copyright (c) 2020, RudyLo <luhuadong@163.com>
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ *
+ * Change Logs:
+ * Date           Author       Notes
+ * 2026-10-19     luhuadong    the first version
+ */
+
+/*
+ * A serial device on a host tty, or on a pseudo terminal when no path is
+ * given: the driver owns the master side and the receiver (a simulator,
+ * gpsfake, a file piped through socat) talks to the slave side, whose path
+ * rt_hw_serial_posix_peer() returns. A receive thread moves bytes into the
+ * ring buffer and calls rx_indicate like a UART interrupt would.
+ */
+
+#include <rtthread.h>
+#include <rtdevice.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <poll.h>
+#include <termios.h>
+#include <unistd.h>
+
+#define DBG_TAG "serial.posix"
+#define DBG_LVL DBG_INFO
+#include <rtdbg.h>
+
+#define SERIAL_POSIX_PATH_MAX   64
+#define SERIAL_POSIX_CHUNK      256
+#define SERIAL_POSIX_POLL_MS    100
+
+struct serial_posix
+{
+    struct rt_device parent;
+
+    int fd;
+    int peer_fd;                        /* the pty slave, kept open, -1 on a tty */
+    char path[SERIAL_POSIX_PATH_MAX];   /* the tty, or the pty slave */
+
+    pthread_mutex_t lock;
+    struct rt_ringbuffer rx_rb;
+    rt_uint8_t rx_pool[RT_SERIAL_RB_BUFSZ];
+
+    pthread_t rx_tid;
+    volatile rt_bool_t running;
+
+    /* statistics */
+    struct serial_posix_stats stats;
+};
+
+static speed_t serial_posix_speed(rt_uint32_t baud_rate)
+{
+    switch (baud_rate)
+    {
+    case BAUD_RATE_2400:   return B2400;
+    case BAUD_RATE_4800:   return B4800;
+    case BAUD_RATE_9600:   return B9600;
+    case BAUD_RATE_19200:  return B19200;
+    case BAUD_RATE_38400:  return B38400;
+    case BAUD_RATE_57600:  return B57600;
+    case BAUD_RATE_115200: return B115200;
+    case BAUD_RATE_230400: return B230400;
+    case BAUD_RATE_460800: return B460800;
+    case BAUD_RATE_921600: return B921600;
+    default:               return B0;
+    }
+}
+
+static rt_err_t serial_posix_termios(int fd, const struct serial_configure *cfg)
+{
+    struct termios tio;
+
+    if (tcgetattr(fd, &tio) != 0)
+        return -RT_EIO;
+
+    cfmakeraw(&tio);
+    tio.c_cflag |= CLOCAL | CREAD;
+
+    if (cfg)
+    {
+        speed_t speed = serial_posix_speed(cfg->baud_rate);
+
+        if (speed == B0)
+            return -RT_EINVAL;
+        cfsetispeed(&tio, speed);
+        cfsetospeed(&tio, speed);
+
+        tio.c_cflag &= ~(CSIZE | CSTOPB | PARENB | PARODD);
+        switch (cfg->data_bits)
+        {
+        case DATA_BITS_5: tio.c_cflag |= CS5; break;
+        case DATA_BITS_6: tio.c_cflag |= CS6; break;
+        case DATA_BITS_7: tio.c_cflag |= CS7; break;
+        default:          tio.c_cflag |= CS8; break;
+        }
+        if (cfg->stop_bits == STOP_BITS_2)
+            tio.c_cflag |= CSTOPB;
+        if (cfg->parity == PARITY_ODD)
+            tio.c_cflag |= PARENB | PARODD;
+        else if (cfg->parity == PARITY_EVEN)
+            tio.c_cflag |= PARENB;
+    }
+
+    return tcsetattr(fd, TCSANOW, &tio) == 0 ? RT_EOK : -RT_EIO;
+}
+
+static void *serial_posix_rx_entry(void *parameter)
+{
+    struct serial_posix *serial = parameter;
+    rt_uint8_t chunk[SERIAL_POSIX_CHUNK];
+
+    while (serial->running)
+    {
+        struct pollfd pfd = { serial->fd, POLLIN, 0 };
+        rt_size_t space;
+        ssize_t len;
+
+        if (poll(&pfd, 1, SERIAL_POSIX_POLL_MS) <= 0)
+            continue;
+
+        len = read(serial->fd, chunk, sizeof(chunk));
+        if (len <= 0)
+        {
+            if (len < 0 && errno != EAGAIN && errno != EINTR && errno != EIO)
+            {
+                LOG_E("'%s' read failed (%d)", serial->parent.parent.name, errno);
+                break;
+            }
+            /* EIO: no process holds the slave, wait for one */
+            rt_thread_mdelay(SERIAL_POSIX_POLL_MS);
+            continue;
+        }
+
+        pthread_mutex_lock(&serial->lock);
+        space = rt_ringbuffer_space_len(&serial->rx_rb);
+        serial->stats.bytes += (rt_uint32_t)len;
+        if ((rt_size_t)len > space)
+        {
+            /* the oldest bytes go, as in a UART FIFO nobody empties */
+            serial->stats.overruns++;
+            serial->stats.lost += (rt_uint32_t)(len - space);
+        }
+        rt_ringbuffer_put_force(&serial->rx_rb, chunk, (rt_uint16_t)len);
+        len = rt_ringbuffer_data_len(&serial->rx_rb);
+        pthread_mutex_unlock(&serial->lock);
+
+        if (serial->parent.rx_indicate)
+            serial->parent.rx_indicate(&serial->parent, (rt_size_t)len);
+    }
+
+    return RT_NULL;
+}
+
+static rt_err_t serial_posix_open(rt_device_t dev, rt_uint16_t oflag)
+{
+    struct serial_posix *serial = (struct serial_posix *)dev;
+
+    RT_UNUSED(oflag);
+
+    rt_ringbuffer_reset(&serial->rx_rb);
+    serial->running = RT_TRUE;
+    if (pthread_create(&serial->rx_tid, RT_NULL, serial_posix_rx_entry, serial) != 0)
+    {
+        serial->running = RT_FALSE;
+        return -RT_ENOMEM;
+    }
+
+    return RT_EOK;
+}
+
+static rt_err_t serial_posix_close(rt_device_t dev)
+{
+    struct serial_posix *serial = (struct serial_posix *)dev;
+
+    serial->running = RT_FALSE;
+    pthread_join(serial->rx_tid, RT_NULL);
+
+    return RT_EOK;
+}
+
+static rt_size_t serial_posix_read(rt_device_t dev, rt_off_t pos, void *buffer, rt_size_t size)
+{
+    struct serial_posix *serial = (struct serial_posix *)dev;
+    rt_size_t len;
+
+    RT_UNUSED(pos);
+
+    if (size > 0xFFFF)
+        size = 0xFFFF;
+
+    pthread_mutex_lock(&serial->lock);
+    len = rt_ringbuffer_get(&serial->rx_rb, buffer, (rt_uint16_t)size);
+    pthread_mutex_unlock(&serial->lock);
+
+    return len;
+}
+
+static rt_size_t serial_posix_write(rt_device_t dev, rt_off_t pos, const void *buffer, rt_size_t size)
+{
+    struct serial_posix *serial = (struct serial_posix *)dev;
+    const rt_uint8_t *data = buffer;
+    rt_size_t sent = 0;
+
+    RT_UNUSED(pos);
+
+    while (sent < size)
+    {
+        ssize_t len = write(serial->fd, data + sent, size - sent);
+
+        if (len < 0)
+        {
+            if (errno == EINTR)
+                continue;
+            break;
+        }
+        sent += len;
+    }
+
+    return sent;
+}
+
+static rt_err_t serial_posix_control(rt_device_t dev, int cmd, void *args)
+{
+    struct serial_posix *serial = (struct serial_posix *)dev;
+
+    switch (cmd)
+    {
+    case RT_DEVICE_CTRL_CONFIG:
+        if (args == RT_NULL)
+            return -RT_EINVAL;
+        return serial_posix_termios(serial->fd, args);
+    case RT_DEVICE_CTRL_SET_INT:
+    case RT_DEVICE_CTRL_CLR_INT:
+        return RT_EOK;
+    default:
+        return -RT_ENOSYS;
+    }
+}
+
+/**
+ * This function registers a serial device on a host tty
+ *
+ * @param name the device name
+ * @param path the tty, RT_NULL creates a pseudo terminal
+ *
+ * @return RT_EOK on success
+ */
+rt_err_t rt_hw_serial_posix_register(const char *name, const char *path)
+{
+    struct serial_posix *serial;
+    rt_err_t ret;
+
+    RT_ASSERT(name);
+
+    serial = rt_calloc(1, sizeof(struct serial_posix));
+    if (serial == RT_NULL)
+        return -RT_ENOMEM;
+
+    serial->peer_fd = -1;
+    if (path)
+    {
+        serial->fd = open(path, O_RDWR | O_NOCTTY | O_NONBLOCK);
+        if (serial->fd < 0)
+        {
+            LOG_E("Can't open '%s' (%d)", path, errno);
+            rt_free(serial);
+            return -RT_EIO;
+        }
+        rt_strncpy(serial->path, path, SERIAL_POSIX_PATH_MAX - 1);
+    }
+    else
+    {
+        serial->fd = posix_openpt(O_RDWR | O_NOCTTY | O_NONBLOCK);
+        if (serial->fd < 0 || grantpt(serial->fd) != 0 || unlockpt(serial->fd) != 0)
+        {
+            LOG_E("Can't create a pseudo terminal (%d)", errno);
+            goto __close;
+        }
+        rt_strncpy(serial->path, ptsname(serial->fd), SERIAL_POSIX_PATH_MAX - 1);
+
+        /* holding the slave keeps the master readable between peers, raw so
+         * NMEA passes unchanged */
+        serial->peer_fd = open(serial->path, O_RDWR | O_NOCTTY);
+        if (serial->peer_fd < 0 || serial_posix_termios(serial->peer_fd, RT_NULL) != RT_EOK)
+        {
+            LOG_E("Can't set up '%s' (%d)", serial->path, errno);
+            goto __close;
+        }
+    }
+
+    serial_posix_termios(serial->fd, RT_NULL);
+    pthread_mutex_init(&serial->lock, RT_NULL);
+    rt_ringbuffer_init(&serial->rx_rb, serial->rx_pool, sizeof(serial->rx_pool));
+
+    serial->parent.type    = RT_Device_Class_Char;
+    serial->parent.open    = serial_posix_open;
+    serial->parent.close   = serial_posix_close;
+    serial->parent.read    = serial_posix_read;
+    serial->parent.write   = serial_posix_write;
+    serial->parent.control = serial_posix_control;
+
+    ret = rt_device_register(&serial->parent, name, RT_DEVICE_FLAG_RDWR | RT_DEVICE_FLAG_INT_RX);
+    if (ret != RT_EOK)
+    {
+        LOG_E("Can't register '%s'", name);
+        pthread_mutex_destroy(&serial->lock);
+        goto __close;
+    }
+
+    return RT_EOK;
+
+__close:
+    if (serial->peer_fd >= 0)
+        close(serial->peer_fd);
+    if (serial->fd >= 0)
+        close(serial->fd);
+    rt_free(serial);
+
+    return -RT_EIO;
+}
+
+/**
+ * This function returns the path the receiver side opens: the pty slave,
+ * or the tty itself
+ */
+const char *rt_hw_serial_posix_peer(const char *name)
+{
+    rt_device_t dev = rt_device_find(name);
+
+    if (dev == RT_NULL || dev->open != serial_posix_open)
+        return RT_NULL;
+
+    return ((struct serial_posix *)dev)->path;
+}
+
+/**
+ * This function returns the receive statistics of a host serial device
+ *
+ * @param name  the device name
+ * @param stats the statistics
+ *
+ * @return RT_EOK, -RT_ERROR if there is no such host serial device
+ */
+rt_err_t rt_hw_serial_posix_stats(const char *name, struct serial_posix_stats *stats)
+{
+    rt_device_t dev = rt_device_find(name);
+    struct serial_posix *serial = (struct serial_posix *)dev;
+
+    RT_ASSERT(stats);
+
+    if (dev == RT_NULL || dev->open != serial_posix_open)
+        return -RT_ERROR;
+
+    pthread_mutex_lock(&serial->lock);
+    *stats = serial->stats;
+    pthread_mutex_unlock(&serial->lock);
+
+    return RT_EOK;
+}
+
+/**
+ * This function removes a closed host serial device and frees it, so the
+ * name can be registered again
+ *
+ * @param name the device name
+ *
+ * @return RT_EOK, -RT_ERROR if there is no such host serial device
+ */
+rt_err_t rt_hw_serial_posix_unregister(const char *name)
+{
+    rt_device_t dev = rt_device_find(name);
+    struct serial_posix *serial = (struct serial_posix *)dev;
+
+    if (dev == RT_NULL || dev->open != serial_posix_open)
+        return -RT_ERROR;
+    RT_ASSERT(!serial->running);
+
+    rt_device_unregister(dev);
+    pthread_mutex_destroy(&serial->lock);
+    if (serial->peer_fd >= 0)
+        close(serial->peer_fd);
+    close(serial->fd);
+    rt_free(serial);
+
+    return RT_EOK;
+}
@@ -12,26 +12,41 @@
 #include <rtdevice.h>
 #include <string.h>
 #include "gps.h"
+#include "gps_nmea.h"
+#include "gps_latency.h"
+#include "gps_trace.h"
+
+#if defined(__linux__)
+#include <time.h>
+#endif
 
 #define DBG_TAG "sensor.gps"
 #define DBG_LVL DBG_INFO
 #include <rtdbg.h>
 
 
-#define GPS_THREAD_STACK_SIZE          1024
+#define GPS_THREAD_STACK_SIZE          2048
+#define GPS_RECV_CHUNK_SIZE            64
 #define GPS_THREAD_PRIORITY            (RT_THREAD_PRIORITY_MAX/2)
 
 #define ntohs(x) ((((x)&0x00ffUL) << 8) | (((x)&0xff00UL) >> 8))
 
-static int checksum(const char *s)
-{
-    int c = 0;
-
-    while (*s)
-        c ^= *s++;
+#if GPS_DEVICE_MAX > 32
+#error "GPS_DEVICE_MAX is limited by the bits of an rt_event"
+#endif
 
-    return c;
-}
+/*
+ * All receivers share the dispatcher threads: the receive callback sets
+ * bit n of gps_rx_event for gps_table[n] and a dispatcher drains that
+ * UART. The table is written with interrupts disabled.
+ */
+static gps_device_t     gps_table[GPS_DEVICE_MAX];
+static struct rt_event  gps_rx_event;
+static struct rt_mutex  gps_table_lock;
+static rt_thread_t      gps_rx_pool[GPS_DISPATCH_THREADS];
+static struct rt_thread gps_rx_thread[GPS_DISPATCH_THREADS];
+ALIGN(RT_ALIGN_SIZE)
+static rt_uint8_t       gps_rx_stack[GPS_DISPATCH_THREADS][GPS_THREAD_STACK_SIZE];
 
 /**
  * Receive callback function
@@ -39,17 +54,41 @@ static int checksum(const char *s)
 static rt_err_t gps_uart_input(rt_device_t dev, rt_size_t size)
 {
     RT_ASSERT(dev);
-    gps_device_t gps = (gps_device_t)dev->user_data;
+    rt_uint8_t i;
 
-#ifdef PKG_USING_GPS_UART_DMA
-    if (gps) rt_mb_send(gps->rx_mb, size);
-#else
-    if (gps) rt_sem_release(gps->rx_sem);
-#endif
+    for (i = 0; i < GPS_DEVICE_MAX; i++)
+    {
+        gps_device_t gps = gps_table[i];
+
+        if (gps && gps->serial == dev)
+        {
+            gps->rx_us = gps_time_us();
+            GPS_TRACE_MARK(GPS_TRACE_RX_ISR, size);
+            rt_event_send(&gps_rx_event, 1UL << i);
+            break;
+        }
+    }
 
     return RT_EOK;
 }
 
+/**
+ * This function reads the last receive indication time. The indication
+ * writes it from interrupt context and a 64-bit store is two on a 32-bit
+ * core, so it is read with interrupts off to never see half of each.
+ */
+static rt_uint64_t gps_rx_us(gps_device_t dev)
+{
+    rt_base_t level;
+    rt_uint64_t us;
+
+    level = rt_hw_interrupt_disable();
+    us = dev->rx_us;
+    rt_hw_interrupt_enable(level);
+
+    return us;
+}
+
 /** 
  * Cortex-M3 is Little endian usually
  */
@@ -68,31 +107,567 @@ static rt_err_t gps_check_frame(gps_device_t dev, const char *buf, rt_uint16_t s
 {
     RT_ASSERT(dev);
 
+    if (!gps_nmea_check(buf, size))
+    {
+        dev->bad_checksum++;
+        return -RT_ERROR;
+    }
+
     return RT_EOK;
 }
 
-#ifdef PKG_USING_GPS_UART_DMA
-static void gps_recv_thread_entry(void *parameter)
+/**
+ * The cycle counter used to profile stages and time trace events, it runs
+ * at GPS_CYCLES_HZ. Cortex-M3/M4 use DWT CYCCNT, which gps_trace_start()
+ * or the board has to enable; Linux counts CLOCK_MONOTONIC nanoseconds.
+ * Other targets fall back to gps_time_us(), at its resolution, unless the
+ * board overrides it.
+ */
+RT_WEAK rt_uint32_t gps_cycles_get(void)
 {
-    gps_device_t dev = (gps_device_t)parameter;
+#if defined(__ARM_ARCH_7M__) || defined(__ARM_ARCH_7EM__)
+    return *(volatile rt_uint32_t *)0xE0001004;
+#elif defined(__linux__)
+    struct timespec ts;
+
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+
+    return (rt_uint32_t)((rt_uint64_t)ts.tv_sec * 1000000000 + ts.tv_nsec);
+#else
+    return (rt_uint32_t)gps_time_us();
+#endif
 }
+
+/**
+ * The microsecond clock used to timestamp sentences, PPS edges and latency
+ * trace points. On Cortex-M it interpolates the OS tick with the SysTick
+ * counter, on Linux it is CLOCK_MONOTONIC; boards with a free-running
+ * timer may override it.
+ */
+RT_WEAK rt_uint64_t gps_time_us(void)
+{
+#if defined(__ARM_ARCH_6M__) || defined(__ARM_ARCH_7M__) || defined(__ARM_ARCH_7EM__)
+    volatile rt_uint32_t *syst_load = (volatile rt_uint32_t *)0xE000E014;
+    volatile rt_uint32_t *syst_val  = (volatile rt_uint32_t *)0xE000E018;
+    volatile rt_uint32_t *scb_icsr  = (volatile rt_uint32_t *)0xE000ED04;
+    rt_uint32_t load = *syst_load + 1;
+    rt_uint32_t val, pend;
+    rt_tick_t tick;
+
+    do
+    {
+        tick = rt_tick_get();
+        val = *syst_val;
+        pend = *scb_icsr & (1UL << 26);
+    } while (tick != rt_tick_get());
+
+    /* the counter wrapped but the tick interrupt has not run yet */
+    if (pend)
+    {
+        val = *syst_val;
+        tick++;
+    }
+
+    return (rt_uint64_t)tick * (1000000 / RT_TICK_PER_SECOND) +
+           (rt_uint64_t)(load - 1 - val) * (1000000 / RT_TICK_PER_SECOND) / load;
+#elif defined(__linux__)
+    struct timespec ts;
+
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+
+    return (rt_uint64_t)ts.tv_sec * 1000000 + ts.tv_nsec / 1000;
 #else
-static void gps_recv_thread_entry(void *parameter)
+    return (rt_uint64_t)rt_tick_get() * 1000000 / RT_TICK_PER_SECOND;
+#endif
+}
+
+static void gps_publish(gps_epoch_t epoch, gps_fix_t *fix, void *user_data)
 {
-    gps_device_t dev = (gps_device_t)parameter;
+    gps_device_t dev = (gps_device_t)user_data;
+    struct gps_subscriber_node subscriber[GPS_SUBSCRIBER_MAX];
+    rt_uint8_t subscriber_num, waiters = 0;
+    rt_uint8_t i;
+
+    fix->tick = rt_tick_get();
+    GPS_LATENCY(GPS_LATENCY_EPOCH, fix->rx_us);
+    GPS_TRACE_ENTER(GPS_TRACE_PUBLISH, fix->time);
+
+    for (i = 0; i < dev->stage_num; i++)
+    {
+        rt_err_t ret;
+
+        GPS_TRACE_ENTER(GPS_TRACE_STAGE, i);
+        ret = dev->stage[i].stage(dev, fix, dev->stage[i].user_data);
+        GPS_TRACE_LEAVE(GPS_TRACE_STAGE, i);
+
+        if (ret == GPS_STAGE_SUPPRESS)
+        {
+            rt_enter_critical();
+            dev->last_fix = *fix;
+            dev->suppressed++;
+            rt_exit_critical();
+
+            rt_sem_release(dev->fix_notice);
+            GPS_TRACE_LEAVE(GPS_TRACE_PUBLISH, fix->time);
+            return;
+        }
+        if (ret != RT_EOK)
+        {
+            dev->dropped++;
+            GPS_TRACE_LEAVE(GPS_TRACE_PUBLISH, fix->time);
+            return;
+        }
+    }
+    GPS_LATENCY(GPS_LATENCY_FILTER, fix->rx_us);
+
+    /* deliver from a snapshot, gps_unsubscribe() waits for it to finish */
+    rt_enter_critical();
+    dev->last_fix = *fix;
+    dev->fixes++;
+    subscriber_num = dev->subscriber_num;
+    rt_memcpy(subscriber, dev->subscriber, subscriber_num * sizeof(subscriber[0]));
+    dev->delivering++;
+    rt_exit_critical();
+
+    rt_sem_release(dev->fix_notice);
+
+    for (i = 0; i < subscriber_num; i++)
+    {
+        GPS_LATENCY(GPS_LATENCY_DELIVER, fix->rx_us);
+        GPS_TRACE_ENTER(GPS_TRACE_SUBSCRIBER, i);
+        subscriber[i].subscriber(dev, fix, subscriber[i].user_data);
+        GPS_TRACE_LEAVE(GPS_TRACE_SUBSCRIBER, i);
+    }
+
+    rt_enter_critical();
+    if (--dev->delivering == 0)
+    {
+        waiters = dev->deliver_waiters;
+        dev->deliver_waiters = 0;
+    }
+    rt_exit_critical();
+
+    while (waiters--)
+        rt_sem_release(&dev->deliver_sem);
+
+    GPS_TRACE_LEAVE(GPS_TRACE_PUBLISH, fix->time);
+}
+
+static void gps_process_line(gps_device_t dev, const char *line, rt_size_t len)
+{
+    struct gps_nmea_token tok;
+
+    if (gps_check_frame(dev, line, len) != RT_EOK)
+        return;
+
+    if (gps_nmea_tokenize(line, len, &tok) != RT_EOK)
+        return;
+
+    dev->sentences++;
+    GPS_LATENCY(GPS_LATENCY_SENTENCE, dev->line_us);
+
+    /* $PMTK001,<cmd>,<flag>: 0 invalid, 1 unsupported, 2 failed, 3 succeeded */
+    if (tok.type == GPS_NMEA_PMTK && rt_strcmp(tok.argv[0], "PMTK001") == 0 && tok.argc > 2)
+    {
+        if (gps_nmea_atoi(tok.argv[1]) == dev->ack_cmd)
+        {
+            dev->ack_flag = gps_nmea_atoi(tok.argv[2]);
+            dev->ack_cmd = -1;
+            rt_sem_release(dev->ack);
+        }
+        return;
+    }
+
+    dev->epoch->line_us = dev->line_us;
+    gps_epoch_feed(dev->epoch, &tok);
 }
+
+/* post a parser reset to whichever thread feeds the device next */
+static void gps_post_request(gps_device_t dev, rt_uint8_t request)
+{
+    rt_base_t level = rt_hw_interrupt_disable();
+    dev->request |= request;
+    rt_hw_interrupt_enable(level);
+}
+
+static void gps_serve_request(gps_device_t dev)
+{
+    rt_base_t level = rt_hw_interrupt_disable();
+    rt_uint8_t request = dev->request;
+    dev->request = 0;
+    rt_hw_interrupt_enable(level);
+
+    if (request & GPS_REQUEST_RELEARN)
+    {
+        dev->epoch->learned = 0;
+        dev->epoch->last_mask = 0;
+    }
+    if (request & GPS_REQUEST_RESYNC)
+        dev->line_len = 0;
+}
+
+/**
+ * This function feeds received bytes to the sentence parser. The receive
+ * thread calls it with UART data; it can also replay recorded streams.
+ *
+ * @param dev  the gps device
+ * @param data the received bytes
+ * @param size the number of bytes
+ */
+void gps_feed(gps_device_t dev, const char *data, rt_size_t size)
+{
+    RT_ASSERT(dev);
+    RT_ASSERT(data || size == 0);
+
+    if (dev->request)
+        gps_serve_request(dev);
+
+    while (size--)
+    {
+        char ch = *data++;
+
+        if (ch == '$')
+        {
+            dev->line_len = 0;
+            dev->line_us = gps_rx_us(dev);
+        }
+        else if (dev->line_len == 0)
+        {
+            /* wait for the start of a sentence */
+            continue;
+        }
+
+        if (ch == '\n')
+        {
+            GPS_TRACE_ENTER(GPS_TRACE_SENTENCE, dev->line_len);
+            gps_process_line(dev, dev->line, dev->line_len);
+            GPS_TRACE_LEAVE(GPS_TRACE_SENTENCE, dev->line_len);
+            dev->line_len = 0;
+        }
+        else if (dev->line_len < GPS_NMEA_LINE_SIZE)
+        {
+            dev->line[dev->line_len++] = ch;
+        }
+        else
+        {
+            dev->overflow++;
+            dev->line_len = 0;
+        }
+    }
+}
+
+/* with interrupts off: nothing uses the device any more and gps_detach() waits */
+static rt_bool_t gps_idle_wake(gps_device_t dev)
+{
+#ifdef PKG_USING_GPS_INIT_ASYN
+    if (dev->init_running)
+        return RT_FALSE;
 #endif
+    if (dev->busy || !dev->idle_wait)
+        return RT_FALSE;
+
+    dev->idle_wait = RT_FALSE;
+
+    return RT_TRUE;
+}
+
+/* claim a registered device for one dispatcher, or leave it to its owner */
+static gps_device_t gps_claim(rt_uint8_t slot)
+{
+    rt_base_t level = rt_hw_interrupt_disable();
+    gps_device_t dev = gps_table[slot];
+
+    if (dev && dev->busy)
+    {
+        dev->pending = RT_TRUE;
+        dev = RT_NULL;
+    }
+    else if (dev)
+    {
+        dev->busy = RT_TRUE;
+    }
+    rt_hw_interrupt_enable(level);
+
+    return dev;
+}
+
+static void gps_drain(gps_device_t dev)
+{
+    char *buf;
+    rt_size_t len;
+    rt_base_t level;
+    rt_bool_t again, wake = RT_FALSE;
+
+    do
+    {
+        dev->pending = RT_FALSE;
+        GPS_LATENCY(GPS_LATENCY_RX, gps_rx_us(dev));
+        GPS_TRACE_ENTER(GPS_TRACE_RX_THREAD, dev->slot);
+
+        /* read in place into the shared ring, the parser is its first reader */
+        while (1)
+        {
+            len = gps_line_write_begin(&dev->rx_buf, &buf, GPS_RECV_CHUNK_SIZE);
+            len = rt_device_read(dev->serial, 0, buf, len);
+            gps_line_write_end(&dev->rx_buf, len);
+            if (len == 0)
+                break;
+
+            gps_feed(dev, buf, len);
+        }
+        GPS_TRACE_LEAVE(GPS_TRACE_RX_THREAD, dev->slot);
+
+        level = rt_hw_interrupt_disable();
+        again = dev->pending;
+        if (!again)
+        {
+            dev->busy = RT_FALSE;
+            wake = gps_idle_wake(dev);
+        }
+        rt_hw_interrupt_enable(level);
+    } while (again);
+
+    /* the device may be freed once this is released */
+    if (wake)
+        rt_sem_release(&dev->idle_sem);
+}
 
+static void gps_dispatch_entry(void *parameter)
+{
+    rt_uint32_t set;
+    rt_uint8_t i;
+
+    while (1)
+    {
+        if (rt_event_recv(&gps_rx_event, 0xFFFFFFFF, RT_EVENT_FLAG_OR | RT_EVENT_FLAG_CLEAR,
+                          RT_WAITING_FOREVER, &set) != RT_EOK)
+            continue;
+
+        for (i = 0; set; i++, set >>= 1)
+        {
+            gps_device_t dev;
+
+            if ((set & 1) && (dev = gps_claim(i)) != RT_NULL)
+                gps_drain(dev);
+        }
+    }
+}
+
+static rt_bool_t gps_in_dispatcher(void)
+{
+    rt_thread_t self = rt_thread_self();
+    rt_uint8_t i;
+
+    for (i = 0; i < GPS_DISPATCH_THREADS; i++)
+    {
+        if (gps_rx_pool[i] == self)
+            return RT_TRUE;
+    }
+
+    return RT_FALSE;
+}
+
+static int gps_dispatch_init(void)
+{
+    rt_event_init(&gps_rx_event, "gps_rx", RT_IPC_FLAG_FIFO);
+    rt_mutex_init(&gps_table_lock, "gps_tab", RT_IPC_FLAG_FIFO);
+
+    return RT_EOK;
+}
+INIT_COMPONENT_EXPORT(gps_dispatch_init);
+
+/* the dispatcher threads start with the first receiver */
+static rt_err_t gps_register(gps_device_t dev)
+{
+    rt_err_t ret;
+    rt_base_t level;
+    rt_uint8_t i;
+
+    rt_mutex_take(&gps_table_lock, RT_WAITING_FOREVER);
+
+    for (i = 0; i < GPS_DISPATCH_THREADS; i++)
+    {
+        char name[RT_NAME_MAX];
+
+        if (gps_rx_pool[i])
+            continue;
+
+        rt_snprintf(name, sizeof(name), "gps_rx%d", (int)i);
+        ret = rt_thread_init(&gps_rx_thread[i], name, gps_dispatch_entry, RT_NULL,
+                             gps_rx_stack[i], GPS_THREAD_STACK_SIZE, GPS_THREAD_PRIORITY, 10);
+        if (ret != RT_EOK)
+            goto __exit;
+
+        gps_rx_pool[i] = &gps_rx_thread[i];
+        rt_thread_startup(gps_rx_pool[i]);
+    }
+
+    ret = -RT_EFULL;
+    for (i = 0; i < GPS_DEVICE_MAX; i++)
+    {
+        if (gps_table[i] == RT_NULL)
+        {
+            dev->slot = i;
+            level = rt_hw_interrupt_disable();
+            gps_table[i] = dev;
+            rt_hw_interrupt_enable(level);
+            ret = RT_EOK;
+            break;
+        }
+    }
+
+__exit:
+    rt_mutex_release(&gps_table_lock);
+
+    return ret;
+}
+
+/* remove a device from the dispatcher and wait until nothing uses it */
+static void gps_unregister(gps_device_t dev)
+{
+    rt_base_t level;
+    rt_bool_t wait = RT_FALSE;
+
+    rt_mutex_take(&gps_table_lock, RT_WAITING_FOREVER);
+    level = rt_hw_interrupt_disable();
+    if (gps_table[dev->slot] == dev)
+        gps_table[dev->slot] = RT_NULL;
+    rt_hw_interrupt_enable(level);
+    rt_mutex_release(&gps_table_lock);
+
+    /* a dispatcher may still be draining it, or the init timer checking it */
+    level = rt_hw_interrupt_disable();
+    dev->idle_wait = RT_TRUE;
+    if (gps_idle_wake(dev) == RT_FALSE)
+        wait = RT_TRUE;
+    rt_hw_interrupt_enable(level);
+
+    if (wait)
+        rt_sem_take(&dev->idle_sem, RT_WAITING_FOREVER);
+}
+
+/**
+ * This function finds a registered receiver by its serial device
+ *
+ * @param uart_name the name of serial device
+ *
+ * @return the gps device, RT_NULL if none uses the serial device
+ */
+gps_device_t gps_find(const char *uart_name)
+{
+    RT_ASSERT(uart_name);
+
+    gps_device_t dev = RT_NULL;
+    rt_uint8_t i;
+
+    rt_mutex_take(&gps_table_lock, RT_WAITING_FOREVER);
+    for (i = 0; i < GPS_DEVICE_MAX; i++)
+    {
+        if (gps_table[i] && rt_strncmp(gps_table[i]->serial->parent.name, uart_name, RT_NAME_MAX) == 0)
+        {
+            dev = gps_table[i];
+            break;
+        }
+    }
+    rt_mutex_release(&gps_table_lock);
+
+    return dev;
+}
+
+/**
+ * This function sends a command and waits for its acknowledge
+ *
+ * @param dev  the gps device
+ * @param data the command without checksum, e.g. "$PMTK220,100"
+ *
+ * @return RT_EOK if the module accepted the command, -RT_ETIMEOUT if it
+ *         did not answer, -RT_ERROR if it rejected the command. Stages
+ *         and subscribers run in a dispatcher thread; there the command
+ *         is sent without waiting, and -RT_EBUSY is returned if another
+ *         command is pending.
+ */
 rt_err_t gps_send_command(gps_device_t dev, const char *data)
 {
     RT_ASSERT(dev);
+    RT_ASSERT(data);
 
-    return RT_EOK;
+    char buf[GPS_NMEA_LINE_SIZE];
+    rt_size_t len;
+    rt_err_t ret = RT_EOK;
+
+    len = gps_nmea_build(buf, sizeof(buf), data);
+    if (len == 0)
+        return -RT_EINVAL;
+
+    /* the dispatcher processes acknowledges, it must not wait for one */
+    rt_bool_t from_rx = gps_in_dispatcher();
+
+    if (rt_mutex_take(dev->lock, from_rx ? RT_WAITING_NO : RT_WAITING_FOREVER) != RT_EOK)
+        return -RT_EBUSY;
+
+    GPS_TRACE_ENTER(GPS_TRACE_COMMAND, (rt_strncmp(data, "$PMTK", 5) == 0) ? gps_nmea_atoi(data + 5) : 0);
+
+    /* only PMTK packets are acknowledged */
+    if (rt_strncmp(data, "$PMTK", 5) == 0 && !from_rx)
+    {
+        rt_sem_control(dev->ack, RT_IPC_CMD_RESET, RT_NULL);
+        dev->ack_cmd = gps_nmea_atoi(data + 5);
+    }
+    else
+    {
+        dev->ack_cmd = -1;
+    }
+
+    if (rt_device_write(dev->serial, 0, buf, len) != len)
+    {
+        ret = -RT_EIO;
+    }
+    else if (dev->ack_cmd >= 0)
+    {
+        if (rt_sem_take(dev->ack, rt_tick_from_millisecond(GPS_ACK_WAIT_TIME)) != RT_EOK)
+        {
+            LOG_E("No acknowledge for '%s'", data);
+            ret = -RT_ETIMEOUT;
+        }
+        else if (dev->ack_flag != 3)
+        {
+            LOG_E("Command '%s' rejected (%d)", data, (int)dev->ack_flag);
+            ret = -RT_ERROR;
+        }
+    }
+
+    dev->ack_cmd = -1;
+    GPS_TRACE_LEAVE(GPS_TRACE_COMMAND, -ret);
+    rt_mutex_release(dev->lock);
+
+    return ret;
 }
 
+/**
+ * This function waits for the next published fix
+ *
+ * @param dev  the gps device
+ * @param buf  the buffer for a gps_fix_t
+ * @param size the size of the buffer
+ * @param time the timeout in ticks
+ *
+ * @return the number of bytes copied, 0 on timeout
+ */
 rt_uint16_t gps_read(gps_device_t dev, void *buf, rt_uint16_t size, rt_int32_t time)
 {
     RT_ASSERT(dev);
+    RT_ASSERT(buf);
+
+    if (size > sizeof(gps_fix_t))
+        size = sizeof(gps_fix_t);
+
+    rt_sem_control(dev->fix_notice, RT_IPC_CMD_RESET, RT_NULL);
+    if (rt_sem_take(dev->fix_notice, time) != RT_EOK)
+        return 0;
+
+    rt_enter_critical();
+    rt_memcpy(buf, &dev->last_fix, size);
+    rt_exit_critical();
 
     return size;
 }
@@ -101,56 +676,276 @@ rt_uint16_t gps_wait(gps_device_t dev, void *buf, rt_uint16_t size)
 {
     RT_ASSERT(dev);
 
-    return size;
+    return gps_read(dev, buf, size, RT_WAITING_FOREVER);
+}
+
+/**
+ * This function returns the last published fix in the legacy format
+ */
+GNRMC_t gps_gat_gnrmc(gps_device_t dev)
+{
+    RT_ASSERT(dev);
+
+    GNRMC_t gnrmc;
+    gps_fix_t fix;
+
+    rt_enter_critical();
+    fix = dev->last_fix;
+    rt_exit_critical();
+
+    gnrmc.lon      = (fix.lon < 0) ? -fix.lon : fix.lon;
+    gnrmc.lat      = (fix.lat < 0) ? -fix.lat : fix.lat;
+    gnrmc.lon_area = (fix.lon < 0) ? 'W' : 'E';
+    gnrmc.lat_area = (fix.lat < 0) ? 'S' : 'N';
+    gnrmc.time_H   = fix.time / 3600000;
+    gnrmc.time_M   = fix.time / 60000 % 60;
+    gnrmc.time_S   = fix.time / 1000 % 60;
+    gnrmc.status   = fix.status;
+
+    return gnrmc;
+}
+
+/**
+ * This function sets the fix interval with PMTK220
+ *
+ * @param dev      the gps device
+ * @param interval the fix interval in milliseconds, 100 ~ 10000
+ */
+rt_err_t gps_set_rate(gps_device_t dev, rt_uint32_t interval)
+{
+    RT_ASSERT(dev);
+
+    char cmd[24];
+
+    if (interval < 100 || interval > 10000)
+        return -RT_EINVAL;
+
+    rt_snprintf(cmd, sizeof(cmd), "$PMTK220,%d", (int)interval);
+
+    return gps_send_command(dev, cmd);
+}
+
+/**
+ * This function selects the output sentences with a PMTK314 command. The
+ * epoch assembler learns the new sentence set from the next epochs.
+ *
+ * @param dev  the gps device
+ * @param plan the command, e.g. "$PMTK314,0,1,0,1,1,0,0,0,0,0,0,0,0,0,0,0,0,0,0"
+ *             for RMC, GGA and GSA, or "$PMTK314,-1" for the default set
+ */
+rt_err_t gps_set_output(gps_device_t dev, const char *plan)
+{
+    RT_ASSERT(dev);
+    RT_ASSERT(plan);
+
+    rt_err_t ret = gps_send_command(dev, plan);
+
+    gps_post_request(dev, GPS_REQUEST_RELEARN);
+
+    return ret;
+}
+
+/**
+ * This function switches the module and the UART to another baud rate
+ * with PMTK251. The module takes the new rate after acknowledging.
+ */
+rt_err_t gps_set_baudrate(gps_device_t dev, rt_uint32_t baudrate)
+{
+    RT_ASSERT(dev);
+
+    struct serial_configure config = RT_SERIAL_CONFIG_DEFAULT;
+    char cmd[24];
+    rt_err_t ret;
+
+    rt_snprintf(cmd, sizeof(cmd), "$PMTK251,%d", (int)baudrate);
+    ret = gps_send_command(dev, cmd);
+    if (ret != RT_EOK && ret != -RT_ETIMEOUT)
+        return ret;
+
+    /* let the command leave the shift register before switching */
+    rt_thread_mdelay(50);
+
+    config.baud_rate = baudrate;
+    config.data_bits = DATA_BITS_8;
+    config.stop_bits = STOP_BITS_1;
+    config.bufsz = RT_SERIAL_RB_BUFSZ;
+    config.parity = PARITY_NONE;
+
+    ret = rt_device_control(dev->serial, RT_DEVICE_CTRL_CONFIG, &config);
+
+    /* bytes of the old rate may have started a sentence */
+    gps_post_request(dev, GPS_REQUEST_RESYNC);
+
+    return ret;
 }
 
 rt_bool_t gps_is_ready(gps_device_t dev)
 {
-    return RT_TRUE;
+    RT_ASSERT(dev);
+
+    return (dev->sentences > 0) ? RT_TRUE : RT_FALSE;
+}
+
+/**
+ * This function appends a processing stage to the publish path. Stages
+ * are registered once at start-up, before fixes arrive.
+ *
+ * @return RT_EOK on success, -RT_EFULL if GPS_STAGE_MAX stages exist
+ */
+rt_err_t gps_add_stage(gps_device_t dev, gps_stage_t stage, void *user_data)
+{
+    RT_ASSERT(dev);
+    RT_ASSERT(stage);
+
+    if (dev->stage_num >= GPS_STAGE_MAX)
+        return -RT_EFULL;
+
+    dev->stage[dev->stage_num].stage = stage;
+    dev->stage[dev->stage_num].user_data = user_data;
+    dev->stage_num++;
+
+    return RT_EOK;
 }
 
+/**
+ * This function registers a subscriber for published fixes
+ *
+ * @return RT_EOK on success, -RT_EFULL if GPS_SUBSCRIBER_MAX subscribers exist
+ */
+rt_err_t gps_subscribe(gps_device_t dev, gps_subscriber_t subscriber, void *user_data)
+{
+    RT_ASSERT(dev);
+    RT_ASSERT(subscriber);
+
+    rt_err_t ret = -RT_EFULL;
+
+    rt_enter_critical();
+    if (dev->subscriber_num < GPS_SUBSCRIBER_MAX)
+    {
+        dev->subscriber[dev->subscriber_num].subscriber = subscriber;
+        dev->subscriber[dev->subscriber_num].user_data = user_data;
+        dev->subscriber_num++;
+        ret = RT_EOK;
+    }
+    rt_exit_critical();
+
+    return ret;
+}
+
+/**
+ * This function removes a subscriber. Called from a thread other than a
+ * dispatcher, it returns only after a delivery in progress has finished,
+ * so the subscriber's state can be released afterwards. From a stage or
+ * subscriber it cannot wait, the current delivery still completes.
+ *
+ * @return RT_EOK on success, -RT_ERROR if the subscriber is not registered
+ */
+rt_err_t gps_unsubscribe(gps_device_t dev, gps_subscriber_t subscriber, void *user_data)
+{
+    RT_ASSERT(dev);
+
+    rt_err_t ret = -RT_ERROR;
+    rt_bool_t wait = RT_FALSE;
+    rt_uint8_t i;
+
+    rt_enter_critical();
+    for (i = 0; i < dev->subscriber_num; i++)
+    {
+        if (dev->subscriber[i].subscriber == subscriber && dev->subscriber[i].user_data == user_data)
+        {
+            dev->subscriber_num--;
+            dev->subscriber[i] = dev->subscriber[dev->subscriber_num];
+            ret = RT_EOK;
+            break;
+        }
+    }
+    if (ret == RT_EOK && dev->delivering && !gps_in_dispatcher())
+    {
+        dev->deliver_waiters++;
+        wait = RT_TRUE;
+    }
+    rt_exit_critical();
+
+    if (wait)
+        rt_sem_take(&dev->deliver_sem, RT_WAITING_FOREVER);
+
+    return ret;
+}
+
+#ifdef PKG_USING_GPS_INIT_ASYN
+static void sensor_init_timeout(void *parameter)
+{
+    gps_device_t dev = (gps_device_t)parameter;
+    rt_base_t level;
+    rt_bool_t wake;
+
+    /* gps_detach() may have stopped the timer after it expired */
+    level = rt_hw_interrupt_disable();
+    if (dev->init_cancel)
+    {
+        rt_hw_interrupt_enable(level);
+        return;
+    }
+    dev->init_running = RT_TRUE;
+    rt_hw_interrupt_enable(level);
+
+    if (!gps_is_ready(dev))
+    {
+        LOG_E("Can't receive response from gps device");
+    }
+
+    level = rt_hw_interrupt_disable();
+    dev->init_running = RT_FALSE;
+    wake = gps_idle_wake(dev);
+    rt_hw_interrupt_enable(level);
+
+    if (wake)
+        rt_sem_release(&dev->idle_sem);
+}
+#else
 static void sensor_init_entry(void *parameter)
 {
     gps_device_t dev = (gps_device_t)parameter;
 
     rt_uint16_t ret;
-    struct gps_response resp;
+    gps_fix_t fix;
 
     //gps_send_command(dev, "");
 
-    ret = gps_read(dev, &resp, sizeof(resp), rt_tick_from_millisecond(GPS_READ_WAIT_TIME));
-    if (ret != sizeof(resp))
+    ret = gps_read(dev, &fix, sizeof(fix), rt_tick_from_millisecond(GPS_READ_WAIT_TIME));
+    if (ret != sizeof(fix))
     {
         LOG_E("Can't receive response from gps device");
         //gps_send_command(dev, "");
     }
 }
+#endif /* PKG_USING_GPS_INIT_ASYN */
 
 /**
- * This function initializes gps registered device driver
+ * This function initializes a gps device in caller-provided storage, it
+ * never touches the heap
  *
+ * @param storage   the device with its line buffer and epoch assembler
  * @param uart_name the name of serial device
  *
- * @return the gps device.
+ * @return RT_EOK on success, the device is &storage->device
  */
-gps_device_t gps_create(const char *uart_name)
+rt_err_t gps_init(struct gps_device_storage *storage, const char *uart_name)
 {
+    RT_ASSERT(storage);
     RT_ASSERT(uart_name);
+
+    gps_device_t dev = &storage->device;
     rt_err_t ret;
 
-    gps_device_t dev = rt_calloc(1, sizeof(struct gps_device));
-    if (dev == RT_NULL)
-    {
-        LOG_E("Can't allocate memory for gps device on '%s'", uart_name);
-        return RT_NULL;
-    }
+    rt_memset(storage, 0, sizeof(struct gps_device_storage));
 
     /* init uart */
     dev->serial = rt_device_find(uart_name);
     if (dev->serial == RT_NULL)
     {
         LOG_E("Can't find '%s' serial device", uart_name);
-        goto __exit;
+        return -RT_ERROR;
     }
 
     struct serial_configure config = RT_SERIAL_CONFIG_DEFAULT;
@@ -163,37 +958,29 @@ gps_device_t gps_create(const char *uart_name)
 
     rt_device_control(dev->serial, RT_DEVICE_CTRL_CONFIG, &config);
 
-    /* Dangerous? */
-    dev->serial->user_data = (void *)dev;
+    dev->line  = storage->line;
+    dev->epoch = &storage->epoch;
+    gps_line_init(&dev->rx_buf, storage->rx_data, GPS_LINE_BUF_SIZE);
+    gps_epoch_init(dev->epoch, gps_publish, dev);
+    dev->ack_cmd = -1;
 
-    //dev->rx_fifo = rt_ringbuffer_create(AT_CLI_FIFO_SIZE);
-
-    dev->ack  = rt_sem_create("gps_ack", 0, RT_IPC_FLAG_FIFO);
-    if (dev->ack == RT_NULL)
-    {
-        LOG_E("Can't create semaphore for gps device");
-        goto __exit;
-    }
+    rt_sem_init(&dev->ack_sem, "gps_ack", 0, RT_IPC_FLAG_FIFO);
+    rt_sem_init(&dev->fix_sem, "gps_fix", 0, RT_IPC_FLAG_FIFO);
+    rt_sem_init(&dev->deliver_sem, "gps_dlv", 0, RT_IPC_FLAG_FIFO);
+    rt_sem_init(&dev->idle_sem, "gps_idl", 0, RT_IPC_FLAG_FIFO);
+    rt_mutex_init(&dev->lock_obj, "gps_lock", RT_IPC_FLAG_FIFO);
+    dev->ack = &dev->ack_sem;
+    dev->fix_notice = &dev->fix_sem;
+    dev->lock = &dev->lock_obj;
 
-    /* init mutex */
-    dev->lock = rt_mutex_create("gps_lock", RT_IPC_FLAG_FIFO);
-    if (dev->lock == RT_NULL)
-    {
-        LOG_E("Can't create mutex for gps device");
-        goto __exit;
-    }
-
-    /* create thread */
-    dev->rx_tid = rt_thread_create("gps_rx", gps_recv_thread_entry, (void *)dev, 
-                                   GPS_THREAD_STACK_SIZE, GPS_THREAD_PRIORITY, 10);
-    if (dev->rx_tid == RT_NULL)
+    /* hand the device to the dispatcher */
+    ret = gps_register(dev);
+    if (ret != RT_EOK)
     {
-        LOG_E("Can't create thread for gps device");
-        goto __exit;
+        LOG_E("Can't register gps device (%d)", (int)ret);
+        goto __detach;
     }
 
-    rt_thread_startup(dev->rx_tid);
-
     /* open UART device and enable UART RX */
 #ifdef PKG_USING_GPS_UART_DMA
     ret = rt_device_open(dev->serial, RT_DEVICE_OFLAG_RDWR | RT_DEVICE_FLAG_DMA_RX);
@@ -203,50 +990,105 @@ gps_device_t gps_create(const char *uart_name)
     if (ret != RT_EOK)
     {
         LOG_E("Can't open '%s' serial device", uart_name);
-        goto __exit;
+        goto __unregister;
     }
 
     rt_device_set_rx_indicate(dev->serial, gps_uart_input);
+    /* drain what arrived between the open and the indication */
+    gps_uart_input(dev->serial, 0);
 
-    /* run init thread or call init function */
+    /* check the receiver later with a timer or wait for it now */
 #ifdef PKG_USING_GPS_INIT_ASYN
-    rt_thread_t tid;
-
-    tid = rt_thread_create("gps_init", sensor_init_entry, (void *)dev,
-                            GPS_THREAD_STACK_SIZE, GPS_THREAD_PRIORITY, 10);
-    if (tid)
-    {
-        rt_thread_startup(tid);
-    }
-    else
-    {
-        LOG_E("create sensor init thread failed.");
-        goto __exit;
-    }
+    rt_timer_init(&dev->init_timer, "gps_init", sensor_init_timeout, (void *)dev,
+                  rt_tick_from_millisecond(GPS_READ_WAIT_TIME),
+                  RT_TIMER_FLAG_ONE_SHOT | RT_TIMER_FLAG_SOFT_TIMER);
+    rt_timer_start(&dev->init_timer);
 #else
     sensor_init_entry(dev);
 
     if (!gps_is_ready(dev))
     {
+        ret = -RT_ETIMEOUT;
+        rt_device_set_rx_indicate(dev->serial, RT_NULL);
         rt_device_close(dev->serial);
-        goto __exit;
+        goto __unregister;
     }
 #endif /* PKG_USING_GPS_INIT_ASYN */
 
-    return dev;
+    return RT_EOK;
 
-__exit:
-    if (dev->rx_tid)   rt_thread_delete(dev->rx_tid);
-    if (dev->lock)     rt_mutex_delete(dev->lock);
-#ifdef PKG_USING_GPS_UART_DMA
-    if (dev->rx_mb)    rt_mb_delete(dev->rx_mb);
-#else
-    if (dev->rx_sem)   rt_sem_delete(dev->rx_sem);
+__unregister:
+    gps_unregister(dev);
+__detach:
+    rt_mutex_detach(&dev->lock_obj);
+    rt_sem_detach(&dev->fix_sem);
+    rt_sem_detach(&dev->deliver_sem);
+    rt_sem_detach(&dev->idle_sem);
+    rt_sem_detach(&dev->ack_sem);
+
+    return ret;
+}
+
+/**
+ * This function releases a device initialized by gps_init()
+ *
+ * @param dev the gps device
+ */
+void gps_detach(gps_device_t dev)
+{
+    RT_ASSERT(dev);
+
+#ifdef PKG_USING_GPS_INIT_ASYN
+    rt_base_t level;
+#endif
+
+    //gps_send_command(dev, "");
+    rt_device_set_rx_indicate(dev->serial, RT_NULL);
+#ifdef PKG_USING_GPS_INIT_ASYN
+    /* a callback already running is waited for by gps_unregister() */
+    rt_timer_stop(&dev->init_timer);
+    level = rt_hw_interrupt_disable();
+    dev->init_cancel = RT_TRUE;
+    rt_hw_interrupt_enable(level);
 #endif
-    if (dev->ack)      rt_sem_delete(dev->ack);
-    
-    rt_free(dev);
-    return RT_NULL;
+    gps_unregister(dev);
+#ifdef PKG_USING_GPS_INIT_ASYN
+    rt_timer_detach(&dev->init_timer);
+#endif
+
+    rt_sem_detach(&dev->ack_sem);
+    rt_sem_detach(&dev->fix_sem);
+    rt_sem_detach(&dev->deliver_sem);
+    rt_sem_detach(&dev->idle_sem);
+    rt_mutex_detach(&dev->lock_obj);
+    rt_device_close(dev->serial);
+}
+
+/**
+ * This function initializes gps registered device driver
+ *
+ * @param uart_name the name of serial device
+ *
+ * @return the gps device.
+ */
+gps_device_t gps_create(const char *uart_name)
+{
+    RT_ASSERT(uart_name);
+
+    struct gps_device_storage *storage = rt_malloc(sizeof(struct gps_device_storage));
+    if (storage == RT_NULL)
+    {
+        LOG_E("Can't allocate memory for gps device on '%s'", uart_name);
+        return RT_NULL;
+    }
+
+    if (gps_init(storage, uart_name) != RT_EOK)
+    {
+        rt_free(storage);
+        return RT_NULL;
+    }
+
+    return &storage->device;
 }
 
 /**
@@ -258,19 +1100,28 @@ void gps_delete(gps_device_t dev)
 {
     if (dev)
     {
-        //gps_send_command(dev, "");
-        dev->serial->user_data = RT_NULL;
-        
-        rt_sem_delete(dev->ack);
-#ifdef PKG_USING_GPS_UART_DMA
-        rt_mb_delete(dev->rx_mb);
-#else
-        rt_sem_delete(dev->rx_sem);
-#endif
-        rt_thread_delete(dev->rx_tid);
-        rt_mutex_delete(dev->lock);
-        rt_device_close(dev->serial);
-
-        rt_free(dev);
+        gps_detach(dev);
+        rt_free(rt_container_of(dev, struct gps_device_storage, device));
     }
 }
+
+/**
+ * This function prints the RAM the driver uses, all of it is static or
+ * part of struct gps_device_storage
+ */
+void gps_footprint(void)
+{
+    rt_kprintf("per receiver (struct gps_device_storage): %d bytes\n",
+               (int)sizeof(struct gps_device_storage));
+    rt_kprintf("  device %d, line %d, epoch %d, receive ring %d\n", (int)sizeof(struct gps_device),
+               (int)GPS_NMEA_LINE_SIZE, (int)sizeof(struct gps_epoch), (int)GPS_LINE_BUF_SIZE);
+    rt_kprintf("shared: %d bytes\n", (int)(sizeof(gps_table) + sizeof(gps_rx_event) + sizeof(gps_table_lock) +
+               sizeof(gps_rx_pool) + sizeof(gps_rx_thread) + sizeof(gps_rx_stack)));
+    rt_kprintf("  %d dispatcher(s): thread %d, stack %d\n", (int)GPS_DISPATCH_THREADS,
+               (int)sizeof(struct rt_thread), (int)GPS_THREAD_STACK_SIZE);
+    rt_kprintf("  registry of %d receivers: %d\n", (int)GPS_DEVICE_MAX,
+               (int)(sizeof(gps_table) + sizeof(gps_rx_event) + sizeof(gps_table_lock)));
+}
+#ifdef FINSH_USING_MSH
+MSH_CMD_EXPORT(gps_footprint, print the RAM used by the gps driver);
+#endif
@@ -0,0 +1,489 @@
+/*
+ * Copyright (c) 2020, RudyLo <luhuadong@163.com>
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ *
+ * Change Logs:
+ * Date           Author       Notes
+ * 2026-10-19     luhuadong    the first version
+ */
+
+#include <rtthread.h>
+#include <rtdevice.h>
+#include <stdlib.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include "gps_capture.h"
+#include "gps_barrier.h"
+
+#define DBG_TAG "sensor.gps"
+#define DBG_LVL DBG_INFO
+#include <rtdbg.h>
+
+#define GPS_CAPTURE_PRIORITY           (RT_THREAD_PRIORITY_MAX / 2 + 2)
+#define GPS_CAPTURE_READER_PRIORITY    (RT_THREAD_PRIORITY_MAX / 2 - 1)  /* above the dispatcher */
+
+static void capture_write(void *ctx, const rt_uint8_t *data, rt_size_t len)
+{
+    gps_capture_t cap = (gps_capture_t)ctx;
+
+    if (write(cap->fd, data, len) != (int)len)
+        cap->errors++;
+}
+
+/* hand the buffer being filled to the writer */
+static void capture_submit(gps_capture_t cap)
+{
+    if (gps_dbuf_submit(&cap->out) != RT_EOK)
+    {
+        /* the writer still had the other buffer, this one is lost */
+        cap->lost += cap->fill_bytes;
+        cap->last_us = cap->fill_us;
+    }
+
+    cap->fill_bytes = 0;
+    cap->fill_us = cap->last_us;
+}
+
+/* record a chunk taken from the ring at gps_time_us() 'us' */
+static void capture_chunk(gps_capture_t cap, const char *data, rt_size_t len, rt_uint64_t us)
+{
+    rt_uint8_t *p;
+    rt_size_t n;
+
+    cap->chunks++;
+
+    /* a chunk longer than a buffer takes several records, the later ones 0 us apart */
+    while (len > 0)
+    {
+        rt_uint64_t dt = us > cap->last_us ? us - cap->last_us : 0;
+
+        n = len;
+        if (n > GPS_CAPTURE_BUF_SIZE - GPS_CAPTURE_RECORD_SIZE)
+            n = GPS_CAPTURE_BUF_SIZE - GPS_CAPTURE_RECORD_SIZE;
+        if (cap->out.len[cap->out.fill] + GPS_CAPTURE_RECORD_SIZE + n > GPS_CAPTURE_BUF_SIZE)
+            capture_submit(cap);
+
+        p = cap->out.buf[cap->out.fill] + cap->out.len[cap->out.fill];
+        gps_put_u32(p, dt > 0xFFFFFFFF ? 0xFFFFFFFF : (rt_uint32_t)dt);
+        gps_put_u16(p + 4, (rt_uint16_t)n);
+        rt_memcpy(p + GPS_CAPTURE_RECORD_SIZE, data, n);
+        cap->out.len[cap->out.fill] += GPS_CAPTURE_RECORD_SIZE + n;
+        cap->fill_bytes += n;
+        cap->last_us = us;
+
+        cap->bytes += n;
+        data += n;
+        len -= n;
+    }
+}
+
+static void capture_reader_entry(void *parameter)
+{
+    gps_capture_t cap = (gps_capture_t)parameter;
+    const char *data;
+    rt_size_t len;
+
+    while (!cap->stop)
+    {
+        len = gps_line_peek(&cap->reader, &data, rt_tick_from_millisecond(100));
+        if (len == 0)
+            continue;
+
+        capture_chunk(cap, data, len, gps_time_us());
+        gps_line_advance(&cap->reader, len);
+    }
+
+    rt_sem_release(&cap->exited);
+}
+
+/**
+ * This function starts capturing what a receiver sends into a file
+ *
+ * @param cap  the capture
+ * @param dev  the receiver
+ * @param path the capture file, truncated
+ *
+ * @return RT_EOK on success
+ */
+rt_err_t gps_capture_start(gps_capture_t cap, gps_device_t dev, const char *path)
+{
+    RT_ASSERT(cap);
+    RT_ASSERT(dev);
+    RT_ASSERT(path);
+
+    rt_uint8_t hdr[GPS_CAPTURE_HEADER_SIZE] = { 0 };
+    rt_err_t ret = -RT_ERROR;
+
+    rt_memset(cap, 0, sizeof(struct gps_capture));
+    cap->dev = dev;
+    cap->fd = open(path, O_WRONLY | O_CREAT | O_TRUNC, 0644);
+    if (cap->fd < 0)
+    {
+        LOG_E("Can't open '%s'", path);
+        return -RT_EIO;
+    }
+
+    cap->last_us = gps_time_us();
+    cap->fill_us = cap->last_us;
+    gps_put_u32(hdr, GPS_CAPTURE_MAGIC);
+    gps_put_u16(hdr + 4, GPS_CAPTURE_VERSION);
+    gps_put_u32(hdr + 8, (rt_uint32_t)cap->last_us);
+    gps_put_u32(hdr + 12, (rt_uint32_t)(cap->last_us >> 32));
+    if (write(cap->fd, hdr, sizeof(hdr)) != sizeof(hdr))
+        goto __close;
+
+    rt_sem_init(&cap->exited, "gps_cpx", 0, RT_IPC_FLAG_FIFO);
+    gps_dbuf_init(&cap->out, cap->buf, GPS_CAPTURE_BUF_SIZE, capture_write, cap);
+    ret = gps_dbuf_start(&cap->out, "gps_cap", GPS_CAPTURE_PRIORITY);
+    if (ret != RT_EOK)
+        goto __detach;
+
+    /* the capture is a reader of the receive ring, like gpsdump */
+    ret = gps_line_open(&dev->rx_buf, &cap->reader);
+    if (ret != RT_EOK)
+        goto __detach;
+
+    cap->tid = rt_thread_create("gps_cpr", capture_reader_entry, cap, 1024, GPS_CAPTURE_READER_PRIORITY, 10);
+    if (cap->tid == RT_NULL)
+    {
+        ret = -RT_ENOMEM;
+        gps_line_close(&cap->reader);
+        goto __detach;
+    }
+    rt_thread_startup(cap->tid);
+
+    return RT_EOK;
+
+__detach:
+    gps_dbuf_detach(&cap->out);
+    rt_sem_detach(&cap->exited);
+__close:
+    close(cap->fd);
+    return ret;
+}
+
+/**
+ * This function stops reading the receive ring and flushes the capture
+ */
+void gps_capture_stop(gps_capture_t cap)
+{
+    RT_ASSERT(cap);
+
+    cap->stop = RT_TRUE;
+    rt_sem_take(&cap->exited, RT_WAITING_FOREVER);
+    cap->tid = RT_NULL;
+    gps_line_close(&cap->reader);
+
+    capture_submit(cap);
+    gps_dbuf_detach(&cap->out);
+    rt_sem_detach(&cap->exited);
+    close(cap->fd);
+}
+
+static rt_err_t replay_deliver(gps_replay_t replay, const rt_uint8_t *data, rt_size_t len)
+{
+    rt_sem_take(&replay->drained, RT_WAITING_FOREVER);
+    if (replay->stop)
+        return -RT_ERROR;
+
+    replay->len = 0;
+    rt_memcpy(replay->chunk, data, len);
+    replay->pos = 0;
+    replay->len = (rt_uint16_t)len;
+
+    replay->chunks++;
+    replay->bytes += len;
+
+    /*
+     * gps_init() opens the device before it installs the indication and
+     * drains once after, so a chunk staged before is read then
+     */
+    gps_mb();
+    if (replay->parent.rx_indicate)
+        replay->parent.rx_indicate(&replay->parent, len);
+
+    return RT_EOK;
+}
+
+static void replay_entry(void *parameter)
+{
+    gps_replay_t replay = (gps_replay_t)parameter;
+    rt_uint8_t rec[GPS_CAPTURE_RECORD_SIZE];
+    rt_uint8_t data[GPS_REPLAY_CHUNK_MAX];
+    rt_tick_t start;
+    rt_uint64_t at = 0;
+    rt_int32_t wait;
+    rt_size_t len, n;
+
+    start = rt_tick_get();
+
+    while (!replay->stop && read(replay->fd, rec, sizeof(rec)) == sizeof(rec))
+    {
+        at += gps_get_u32(rec);
+        len = gps_get_u16(rec + 4);
+
+        if (replay->speed > 0)
+        {
+            wait = (rt_int32_t)(start + rt_tick_from_millisecond((rt_int32_t)(at / (1000.0 * replay->speed)))
+                                - rt_tick_get());
+            if (wait > 0)
+                rt_thread_delay(wait);
+        }
+
+        while (len > 0)
+        {
+            n = len > sizeof(data) ? sizeof(data) : len;
+            if (read(replay->fd, data, n) != (int)n || replay_deliver(replay, data, n) != RT_EOK)
+                goto __end;
+            len -= n;
+        }
+    }
+
+__end:
+    /* the last chunk is consumed too */
+    if (!replay->stop)
+        rt_sem_take(&replay->drained, RT_WAITING_FOREVER);
+    rt_sem_release(&replay->finished);
+    rt_sem_release(&replay->exited);
+}
+
+static rt_err_t replay_open(rt_device_t dev, rt_uint16_t oflag)
+{
+    gps_replay_t replay = (gps_replay_t)dev;
+
+    if (replay->tid)
+        return RT_EOK;
+
+    replay->tid = rt_thread_create("gps_rp", replay_entry, replay, 2048, GPS_CAPTURE_PRIORITY, 10);
+    if (replay->tid == RT_NULL)
+        return -RT_ENOMEM;
+
+    return rt_thread_startup(replay->tid);
+}
+
+static rt_err_t replay_close(rt_device_t dev)
+{
+    gps_replay_t replay = (gps_replay_t)dev;
+
+    replay->stop = RT_TRUE;
+    rt_sem_release(&replay->drained);
+
+    return RT_EOK;
+}
+
+/* only the dispatcher reads, a chunk it drains lets the next one in */
+static rt_size_t replay_read(rt_device_t dev, rt_off_t pos, void *buffer, rt_size_t size)
+{
+    gps_replay_t replay = (gps_replay_t)dev;
+    rt_uint16_t len = replay->len;
+    rt_size_t n;
+
+    if (replay->pos >= len)
+        return 0;
+
+    n = len - replay->pos;
+    if (n > size)
+        n = size;
+    rt_memcpy(buffer, replay->chunk + replay->pos, n);
+    replay->pos += n;
+
+    if (replay->pos == len)
+        rt_sem_release(&replay->drained);
+
+    return n;
+}
+
+static rt_size_t replay_write(rt_device_t dev, rt_off_t pos, const void *buffer, rt_size_t size)
+{
+    gps_replay_t replay = (gps_replay_t)dev;
+
+    replay->written += size;
+
+    return size;
+}
+
+static rt_err_t replay_control(rt_device_t dev, int cmd, void *args)
+{
+    /* baud rate and framing do not apply */
+    return RT_EOK;
+}
+
+#ifdef RT_USING_DEVICE_OPS
+static const struct rt_device_ops replay_ops =
+{
+    RT_NULL,
+    replay_open,
+    replay_close,
+    replay_read,
+    replay_write,
+    replay_control,
+};
+#endif
+
+/**
+ * This function registers a virtual serial device that plays a capture
+ * back, open it with gps_init()/gps_create() under the same name
+ *
+ * @param replay the replay device
+ * @param name   the device name
+ * @param path   the capture file
+ * @param speed  1: real time, N: N times faster, 0: as fast as possible
+ *
+ * @return RT_EOK on success
+ */
+rt_err_t gps_replay_init(gps_replay_t replay, const char *name, const char *path, float speed)
+{
+    RT_ASSERT(replay);
+    RT_ASSERT(name);
+    RT_ASSERT(path);
+
+    rt_uint8_t hdr[GPS_CAPTURE_HEADER_SIZE];
+    rt_device_t device = &replay->parent;
+
+    rt_memset(replay, 0, sizeof(struct gps_replay));
+    replay->speed = speed;
+    replay->fd = open(path, O_RDONLY);
+    if (replay->fd < 0)
+    {
+        LOG_E("Can't open '%s'", path);
+        return -RT_EIO;
+    }
+
+    if (read(replay->fd, hdr, sizeof(hdr)) != sizeof(hdr) ||
+        gps_get_u32(hdr) != GPS_CAPTURE_MAGIC || gps_get_u16(hdr + 4) != GPS_CAPTURE_VERSION)
+    {
+        LOG_E("'%s' is not a gps capture", path);
+        close(replay->fd);
+        return -RT_ERROR;
+    }
+
+    rt_sem_init(&replay->drained, "gps_rpd", 1, RT_IPC_FLAG_FIFO);
+    rt_sem_init(&replay->finished, "gps_rpf", 0, RT_IPC_FLAG_FIFO);
+    rt_sem_init(&replay->exited, "gps_rpx", 0, RT_IPC_FLAG_FIFO);
+
+    device->type = RT_Device_Class_Char;
+#ifdef RT_USING_DEVICE_OPS
+    device->ops = &replay_ops;
+#else
+    device->init = RT_NULL;
+    device->open = replay_open;
+    device->close = replay_close;
+    device->read = replay_read;
+    device->write = replay_write;
+    device->control = replay_control;
+#endif
+
+    return rt_device_register(device, name, RT_DEVICE_FLAG_RDWR | RT_DEVICE_FLAG_INT_RX);
+}
+
+/**
+ * This function waits until the whole capture was played and read by the
+ * driver
+ *
+ * @return RT_EOK when done, -RT_ETIMEOUT otherwise
+ */
+rt_err_t gps_replay_wait(gps_replay_t replay, rt_int32_t timeout)
+{
+    RT_ASSERT(replay);
+
+    return rt_sem_take(&replay->finished, timeout);
+}
+
+/**
+ * This function unregisters the replay device, delete the gps device on
+ * it first
+ */
+void gps_replay_detach(gps_replay_t replay)
+{
+    RT_ASSERT(replay);
+
+    if (replay->tid)
+    {
+        replay->stop = RT_TRUE;
+        rt_sem_release(&replay->drained);
+        rt_sem_take(&replay->exited, RT_WAITING_FOREVER);
+    }
+
+    rt_device_unregister(&replay->parent);
+    rt_sem_detach(&replay->drained);
+    rt_sem_detach(&replay->finished);
+    rt_sem_detach(&replay->exited);
+    close(replay->fd);
+}
+
+#ifdef FINSH_USING_MSH
+static struct gps_capture gps_capture_obj;
+static struct gps_replay gps_replay_obj;
+
+static void gps_capture(int argc, char **argv)
+{
+    gps_device_t dev;
+
+    if (argc == 2 && rt_strcmp(argv[1], "stop") == 0)
+    {
+        if (gps_capture_obj.tid == RT_NULL)
+        {
+            rt_kprintf("No capture running\n");
+            return;
+        }
+        gps_capture_stop(&gps_capture_obj);
+        rt_kprintf("%d chunks, %d bytes, %d bytes lost in the ring, %d in %d dropped buffers, %d write errors\n",
+                   (int)gps_capture_obj.chunks, (int)gps_capture_obj.bytes, (int)gps_capture_obj.reader.lost,
+                   (int)gps_capture_obj.lost, (int)gps_capture_obj.out.dropped, (int)gps_capture_obj.errors);
+        return;
+    }
+
+    if (argc != 3)
+    {
+        rt_kprintf("Please input 'gps_capture <dev_name> <file>' or 'gps_capture stop'\n");
+        return;
+    }
+
+    dev = gps_find(argv[1]);
+    if (dev == RT_NULL)
+    {
+        rt_kprintf("No gps device on '%s'\n", argv[1]);
+        return;
+    }
+
+    if (gps_capture_obj.tid)
+    {
+        rt_kprintf("A capture is running\n");
+        return;
+    }
+
+    if (gps_capture_start(&gps_capture_obj, dev, argv[2]) != RT_EOK)
+        rt_kprintf("Can't capture to '%s'\n", argv[2]);
+}
+MSH_CMD_EXPORT(gps_capture, capture raw receiver data: gps_capture <dev_name> <file> | stop);
+
+static void gps_replay(int argc, char **argv)
+{
+    gps_device_t dev;
+    rt_tick_t start;
+
+    if (argc < 2 || argc > 3)
+    {
+        rt_kprintf("Please input 'gps_replay <file> [speed]', speed 0 is as fast as possible\n");
+        return;
+    }
+
+    if (gps_replay_init(&gps_replay_obj, "replay", argv[1], argc == 3 ? (float)atof(argv[2]) : 1.0f) != RT_EOK)
+        return;
+
+    start = rt_tick_get();
+    dev = gps_create("replay");
+    if (dev)
+    {
+        gps_replay_wait(&gps_replay_obj, RT_WAITING_FOREVER);
+        rt_kprintf("%d chunks, %d bytes, %d sentences, %d fixes in %d ms\n",
+                   (int)gps_replay_obj.chunks, (int)gps_replay_obj.bytes, (int)dev->sentences,
+                   (int)dev->fixes, (int)((rt_tick_get() - start) * 1000 / RT_TICK_PER_SECOND));
+        gps_delete(dev);
+    }
+
+    gps_replay_detach(&gps_replay_obj);
+}
+MSH_CMD_EXPORT(gps_replay, play a capture back: gps_replay <file> [speed]);
+#endif
@@ -0,0 +1,168 @@
+/*
+ * Copyright (c) 2020, RudyLo <luhuadong@163.com>
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ *
+ * Change Logs:
+ * Date           Author       Notes
+ * 2026-10-19     luhuadong    the first version
+ */
+
+#include <rtthread.h>
+#include "gps_dbuf.h"
+
+#define DBG_TAG "sensor.gps"
+#define DBG_LVL DBG_INFO
+#include <rtdbg.h>
+
+/**
+ * This function initializes a double-buffered writer
+ *
+ * @param db      the writer
+ * @param storage two buffers of size bytes, one after the other
+ * @param size    the size of one buffer
+ * @param write   writes a buffer out, in the writer thread once started
+ * @param ctx     passed to write
+ */
+void gps_dbuf_init(gps_dbuf_t db, void *storage, rt_size_t size, gps_dbuf_write_t write, void *ctx)
+{
+    RT_ASSERT(db);
+    RT_ASSERT(storage);
+    RT_ASSERT(write);
+
+    rt_memset(db, 0, sizeof(struct gps_dbuf));
+    db->buf[0] = (rt_uint8_t *)storage;
+    db->buf[1] = (rt_uint8_t *)storage + size;
+    db->size = size;
+    db->write = write;
+    db->ctx = ctx;
+
+    rt_sem_init(&db->ready, "gps_dbr", 0, RT_IPC_FLAG_FIFO);
+    rt_sem_init(&db->done, "gps_dbd", 0, RT_IPC_FLAG_FIFO);
+}
+
+static void dbuf_writer_entry(void *parameter)
+{
+    gps_dbuf_t db = (gps_dbuf_t)parameter;
+    rt_base_t level;
+    rt_uint8_t i;
+
+    while (1)
+    {
+        rt_sem_take(&db->ready, RT_WAITING_FOREVER);
+
+        for (i = 0; i < 2; i++)
+        {
+            if ((db->full & (1 << i)) == 0)
+                continue;
+
+            db->write(db->ctx, db->buf[i], db->len[i]);
+
+            level = rt_hw_interrupt_disable();
+            db->full &= ~(1 << i);
+            rt_hw_interrupt_enable(level);
+            rt_sem_release(&db->done);
+        }
+
+        if (db->quit)
+            break;
+    }
+
+    rt_sem_release(&db->done);
+}
+
+/**
+ * This function moves buffer writes to a thread of their own
+ */
+rt_err_t gps_dbuf_start(gps_dbuf_t db, const char *name, rt_uint8_t priority)
+{
+    RT_ASSERT(db);
+
+    if (db->writer)
+        return RT_EOK;
+
+    db->quit = RT_FALSE;
+    db->writer = rt_thread_create(name, dbuf_writer_entry, db, 1024, priority, 10);
+    if (db->writer == RT_NULL)
+        return -RT_ENOMEM;
+
+    return rt_thread_startup(db->writer);
+}
+
+/**
+ * This function hands the buffer being filled to the writer, the other
+ * buffer is filled next and starts empty
+ *
+ * @return RT_EOK on success, -RT_EFULL if the writer still had the other
+ *         buffer and this one was dropped
+ */
+rt_err_t gps_dbuf_submit(gps_dbuf_t db)
+{
+    RT_ASSERT(db);
+
+    rt_uint8_t other = db->fill ^ 1;
+    rt_base_t level;
+
+    if (db->len[db->fill] == 0)
+        return RT_EOK;
+
+    if (db->writer == RT_NULL)
+    {
+        db->write(db->ctx, db->buf[db->fill], db->len[db->fill]);
+    }
+    else if (db->full & (1 << other))
+    {
+        db->dropped++;
+        db->len[db->fill] = 0;
+        return -RT_EFULL;
+    }
+    else
+    {
+        level = rt_hw_interrupt_disable();
+        db->full |= 1 << db->fill;
+        rt_hw_interrupt_enable(level);
+        rt_sem_release(&db->ready);
+
+        db->fill = other;
+    }
+
+    db->len[db->fill] = 0;
+
+    return RT_EOK;
+}
+
+/**
+ * This function waits until the writer has written every submitted buffer
+ */
+void gps_dbuf_flush(gps_dbuf_t db)
+{
+    RT_ASSERT(db);
+
+    /* the writer clears a bit before it releases done */
+    rt_sem_control(&db->done, RT_IPC_CMD_RESET, RT_NULL);
+    while (db->full)
+        rt_sem_take(&db->done, RT_WAITING_FOREVER);
+}
+
+/**
+ * This function flushes the writer, ends its thread and releases the
+ * semaphores. The buffer being filled is not submitted.
+ */
+void gps_dbuf_detach(gps_dbuf_t db)
+{
+    RT_ASSERT(db);
+
+    if (db->writer)
+    {
+        gps_dbuf_flush(db);
+
+        rt_sem_control(&db->done, RT_IPC_CMD_RESET, RT_NULL);
+        db->quit = RT_TRUE;
+        rt_sem_release(&db->ready);
+        rt_sem_take(&db->done, RT_WAITING_FOREVER);
+        db->writer = RT_NULL;
+    }
+
+    rt_sem_detach(&db->ready);
+    rt_sem_detach(&db->done);
+}
@@ -0,0 +1,383 @@
+/*
+ * Copyright (c) 2020, RudyLo <luhuadong@163.com>
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ *
+ * Change Logs:
+ * Date           Author       Notes
+ * 2026-10-19     luhuadong    the first version
+ */
+
+#include <rtthread.h>
+#include <string.h>
+#include "gps_fence.h"
+
+#define DBG_TAG "sensor.gps"
+#define DBG_LVL DBG_INFO
+#include <rtdbg.h>
+
+#define FENCE_INDEX_MAX      0xFFFF
+
+/**
+ * This function computes the bounding box of a fence from its vertices
+ */
+void gps_fence_calc_bbox(struct gps_fence *fence)
+{
+    RT_ASSERT(fence);
+    RT_ASSERT(fence->vertex);
+
+    rt_uint16_t i;
+
+    fence->min = fence->vertex[0];
+    fence->max = fence->vertex[0];
+
+    for (i = 1; i < fence->count; i++)
+    {
+        const coord_fixed_t *v = &fence->vertex[i];
+
+        if (v->lon < fence->min.lon) fence->min.lon = v->lon;
+        if (v->lon > fence->max.lon) fence->max.lon = v->lon;
+        if (v->lat < fence->min.lat) fence->min.lat = v->lat;
+        if (v->lat > fence->max.lat) fence->max.lat = v->lat;
+    }
+}
+
+/**
+ * This function tests whether a position is inside a fence, using the
+ * crossing number rule on integer coordinates. Points exactly on the
+ * bottom or left edges count as inside, on the top or right edges as
+ * outside, so adjacent fences never both claim a point.
+ */
+rt_bool_t gps_fence_contains(const struct gps_fence *fence, const coord_fixed_t *pos)
+{
+    RT_ASSERT(fence);
+    RT_ASSERT(pos);
+
+    const coord_fixed_t *v = fence->vertex;
+    rt_int64_t px = pos->lon, py = pos->lat;
+    rt_bool_t inside = RT_FALSE;
+    rt_uint16_t i, j;
+
+    if (pos->lon < fence->min.lon || pos->lon > fence->max.lon ||
+        pos->lat < fence->min.lat || pos->lat > fence->max.lat || fence->count < 3)
+    {
+        return RT_FALSE;
+    }
+
+    for (i = 0, j = fence->count - 1; i < fence->count; j = i++)
+    {
+        rt_int64_t yi = v[i].lat, yj = v[j].lat;
+
+        if ((yi > py) != (yj > py))
+        {
+            /* px < xi + (py - yi) * (xj - xi) / (yj - yi), without the division */
+            rt_int64_t lhs = (px - v[i].lon) * (yj - yi);
+            rt_int64_t rhs = (py - yi) * ((rt_int64_t)v[j].lon - v[i].lon);
+
+            if ((yj > yi) ? (lhs < rhs) : (lhs > rhs))
+                inside = !inside;
+        }
+    }
+
+    return inside;
+}
+
+static void fence_grid_bounds(const struct gps_fence *fence, rt_uint16_t num,
+                              coord_fixed_t *min, coord_fixed_t *max)
+{
+    rt_uint16_t i;
+
+    *min = fence[0].min;
+    *max = fence[0].max;
+
+    for (i = 1; i < num; i++)
+    {
+        if (fence[i].min.lon < min->lon) min->lon = fence[i].min.lon;
+        if (fence[i].min.lat < min->lat) min->lat = fence[i].min.lat;
+        if (fence[i].max.lon > max->lon) max->lon = fence[i].max.lon;
+        if (fence[i].max.lat > max->lat) max->lat = fence[i].max.lat;
+    }
+}
+
+static rt_int32_t fence_cell_size(rt_int32_t lo, rt_int32_t hi, rt_uint16_t n)
+{
+    rt_int64_t span = (rt_int64_t)hi - lo + 1;
+
+    return (rt_int32_t)((span + n - 1) / n);
+}
+
+/* cell range covered by a fence's bounding box */
+static void fence_cell_range(gps_fence_engine_t engine, const struct gps_fence *fence,
+                             rt_uint16_t *x0, rt_uint16_t *y0, rt_uint16_t *x1, rt_uint16_t *y1)
+{
+    *x0 = (rt_uint16_t)(((rt_int64_t)fence->min.lon - engine->origin.lon) / engine->cell_w);
+    *y0 = (rt_uint16_t)(((rt_int64_t)fence->min.lat - engine->origin.lat) / engine->cell_h);
+    *x1 = (rt_uint16_t)(((rt_int64_t)fence->max.lon - engine->origin.lon) / engine->cell_w);
+    *y1 = (rt_uint16_t)(((rt_int64_t)fence->max.lat - engine->origin.lat) / engine->cell_h);
+
+    if (*x1 >= engine->cols) *x1 = engine->cols - 1;
+    if (*y1 >= engine->rows) *y1 = engine->rows - 1;
+}
+
+static void fence_setup_grid(gps_fence_engine_t engine, const struct gps_fence *fence, rt_uint16_t num,
+                             rt_uint16_t cols, rt_uint16_t rows)
+{
+    coord_fixed_t min, max;
+
+    fence_grid_bounds(fence, num, &min, &max);
+
+    engine->fence = fence;
+    engine->fence_num = num;
+    engine->origin = min;
+    engine->cols = cols;
+    engine->rows = rows;
+    engine->cell_w = fence_cell_size(min.lon, max.lon, cols);
+    engine->cell_h = fence_cell_size(min.lat, max.lat, rows);
+}
+
+/**
+ * This function returns the size of the work buffer gps_fence_init()
+ * needs for a fence table and grid resolution.
+ *
+ * @param fence the fence table
+ * @param num   the number of fences
+ * @param cols  grid columns
+ * @param rows  grid rows
+ *
+ * @return the buffer size in bytes, 0 if the index would not fit in 16 bits
+ */
+rt_size_t gps_fence_index_size(const struct gps_fence *fence, rt_uint16_t num,
+                               rt_uint16_t cols, rt_uint16_t rows)
+{
+    struct gps_fence_engine engine;
+    rt_uint32_t entries = 0;
+    rt_uint16_t i, x0, y0, x1, y1;
+
+    if (fence == RT_NULL || num == 0 || cols == 0 || rows == 0)
+        return 0;
+
+    fence_setup_grid(&engine, fence, num, cols, rows);
+
+    for (i = 0; i < num; i++)
+    {
+        fence_cell_range(&engine, &fence[i], &x0, &y0, &x1, &y1);
+        entries += (rt_uint32_t)(x1 - x0 + 1) * (y1 - y0 + 1);
+    }
+
+    if (entries > FENCE_INDEX_MAX)
+        return 0;
+
+    return ((rt_uint32_t)cols * rows + 1 + entries) * sizeof(rt_uint16_t);
+}
+
+/**
+ * This function builds the grid index of a fence table. The index lives
+ * in the caller's buffer, the fence table itself is only referenced.
+ *
+ * @param engine the geofence engine
+ * @param fence  the fence table, must outlive the engine
+ * @param num    the number of fences
+ * @param cols   grid columns
+ * @param rows   grid rows
+ * @param buf    work buffer, see gps_fence_index_size()
+ * @param size   the size of the work buffer
+ *
+ * @return RT_EOK on success, -RT_EINVAL on bad parameters or an index
+ *         larger than 16 bits, -RT_ENOMEM if the buffer is too small
+ */
+rt_err_t gps_fence_init(gps_fence_engine_t engine, const struct gps_fence *fence, rt_uint16_t num,
+                        rt_uint16_t cols, rt_uint16_t rows, void *buf, rt_size_t size)
+{
+    RT_ASSERT(engine);
+
+    rt_size_t need = gps_fence_index_size(fence, num, cols, rows);
+    rt_uint32_t cells = (rt_uint32_t)cols * rows;
+    rt_uint32_t c;
+    rt_uint16_t i, x, y, x0, y0, x1, y1;
+
+    if (need == 0)
+    {
+        LOG_E("Invalid geofence table or index too large");
+        return -RT_EINVAL;
+    }
+
+    if (buf == RT_NULL || size < need)
+    {
+        LOG_E("Geofence index needs %d bytes", (int)need);
+        return -RT_ENOMEM;
+    }
+
+    rt_memset(engine, 0, sizeof(struct gps_fence_engine));
+    fence_setup_grid(engine, fence, num, cols, rows);
+
+    engine->cell_start = (rt_uint16_t *)buf;
+    engine->cell_list = engine->cell_start + cells + 1;
+    rt_memset(engine->cell_start, 0, (cells + 1) * sizeof(rt_uint16_t));
+
+    /* count, then turn counts into running end offsets, cell_start[cells] is the total */
+    for (i = 0; i < num; i++)
+    {
+        fence_cell_range(engine, &fence[i], &x0, &y0, &x1, &y1);
+        for (y = y0; y <= y1; y++)
+            for (x = x0; x <= x1; x++)
+                engine->cell_start[(rt_uint32_t)y * cols + x]++;
+    }
+
+    for (c = 1; c <= cells; c++)
+        engine->cell_start[c] += engine->cell_start[c - 1];
+
+    /* fill backwards so each cell ends up at its start offset, in fence order */
+    for (i = num; i-- > 0;)
+    {
+        fence_cell_range(engine, &fence[i], &x0, &y0, &x1, &y1);
+        for (y = y0; y <= y1; y++)
+            for (x = x0; x <= x1; x++)
+                engine->cell_list[--engine->cell_start[(rt_uint32_t)y * cols + x]] = i;
+    }
+
+    return RT_EOK;
+}
+
+/**
+ * This function sets the enter/exit/dwell callback
+ */
+void gps_fence_set_handler(gps_fence_engine_t engine, gps_fence_handler_t handler, void *user_data)
+{
+    RT_ASSERT(engine);
+
+    engine->handler = handler;
+    engine->user_data = user_data;
+}
+
+static void fence_notify(gps_fence_engine_t engine, rt_uint16_t index, enum gps_fence_event event)
+{
+    if (engine->handler)
+        engine->handler(engine, &engine->fence[index], event, engine->user_data);
+}
+
+/**
+ * This function evaluates a position against the fence table and emits
+ * the resulting events. Only the fences registered in the position's grid
+ * cell are tested.
+ *
+ * @param engine the geofence engine
+ * @param pos    the position, 1e-7 degree
+ * @param tick   the time of the position, for dwell
+ *
+ * @return the number of fences containing the position
+ */
+rt_size_t gps_fence_update(gps_fence_engine_t engine, const coord_fixed_t *pos, rt_tick_t tick)
+{
+    RT_ASSERT(engine);
+    RT_ASSERT(pos);
+
+    rt_uint16_t inside[GPS_FENCE_ACTIVE_MAX];
+    rt_uint8_t inside_num = 0;
+    rt_int64_t dx = (rt_int64_t)pos->lon - engine->origin.lon;
+    rt_int64_t dy = (rt_int64_t)pos->lat - engine->origin.lat;
+    rt_uint8_t i, k;
+
+    engine->updates++;
+
+    if (dx >= 0 && dy >= 0 &&
+        dx < (rt_int64_t)engine->cell_w * engine->cols &&
+        dy < (rt_int64_t)engine->cell_h * engine->rows)
+    {
+        rt_uint32_t cell = (rt_uint32_t)(dy / engine->cell_h) * engine->cols + (rt_uint32_t)(dx / engine->cell_w);
+        rt_uint16_t n;
+
+        for (n = engine->cell_start[cell]; n < engine->cell_start[cell + 1]; n++)
+        {
+            rt_uint16_t index = engine->cell_list[n];
+
+            engine->candidates++;
+            if (!gps_fence_contains(&engine->fence[index], pos))
+                continue;
+
+            if (inside_num < GPS_FENCE_ACTIVE_MAX)
+                inside[inside_num++] = index;
+            else
+                engine->overflow++;
+        }
+    }
+
+    /* exits */
+    for (i = engine->active_num; i-- > 0;)
+    {
+        for (k = 0; k < inside_num; k++)
+        {
+            if (inside[k] == engine->active[i].index)
+                break;
+        }
+
+        if (k == inside_num)
+        {
+            rt_uint16_t index = engine->active[i].index;
+
+            engine->active[i] = engine->active[--engine->active_num];
+            fence_notify(engine, index, GPS_FENCE_EXIT);
+        }
+    }
+
+    /* enters and dwells */
+    for (k = 0; k < inside_num; k++)
+    {
+        for (i = 0; i < engine->active_num; i++)
+        {
+            if (engine->active[i].index == inside[k])
+                break;
+        }
+
+        if (i == engine->active_num)
+        {
+            engine->active[i].index = inside[k];
+            engine->active[i].enter = tick;
+            engine->active[i].dwelled = 0;
+            engine->active_num++;
+            fence_notify(engine, inside[k], GPS_FENCE_ENTER);
+        }
+        else
+        {
+            struct gps_fence_active *a = &engine->active[i];
+            rt_uint16_t dwell = engine->fence[a->index].dwell;
+
+            if (dwell && !a->dwelled && (rt_tick_t)(tick - a->enter) >= (rt_tick_t)dwell * RT_TICK_PER_SECOND)
+            {
+                a->dwelled = 1;
+                fence_notify(engine, a->index, GPS_FENCE_DWELL);
+            }
+        }
+    }
+
+    return inside_num;
+}
+
+/**
+ * This function feeds a fix to the geofence engine. Fixes without a
+ * valid position are ignored and leave the fence state untouched.
+ */
+rt_size_t gps_fence_update_fix(gps_fence_engine_t engine, const gps_fix_t *fix)
+{
+    RT_ASSERT(fix);
+
+    coord_fixed_t pos;
+
+    if (!fix->status)
+        return 0;
+
+    pos.lon = GPS_DEG2FIXED(fix->lon);
+    pos.lat = GPS_DEG2FIXED(fix->lat);
+
+    return gps_fence_update(engine, &pos, fix->tick);
+}
+
+/**
+ * This function forgets which fences the device is inside, without
+ * emitting exit events
+ */
+void gps_fence_reset(gps_fence_engine_t engine)
+{
+    RT_ASSERT(engine);
+
+    engine->active_num = 0;
+}
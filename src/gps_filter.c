@@ -0,0 +1,482 @@
+/*
+ * Copyright (c) 2020, RudyLo <luhuadong@163.com>
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ *
+ * Change Logs:
+ * Date           Author       Notes
+ * 2026-10-19     luhuadong    the first version
+ */
+
+#include <rtthread.h>
+#include <math.h>
+#include "gps_filter.h"
+
+#define DBG_TAG "sensor.gps"
+#define DBG_LVL DBG_INFO
+#include <rtdbg.h>
+
+#define DEG2RAD              ((float)GPS_DEG2RAD)
+#define RAD2DEG              ((float)GPS_RAD2DEG)
+#define MS_PER_DAY           86400000UL
+
+#define SPEED_COURSE_MIN     0.5f    /* m/s, below it the course is noise */
+
+#ifdef PKG_GPS_FILTER_USING_CMSIS_DSP
+
+#define mat_init(m, r, c, d) arm_mat_init_f32(m, r, c, d)
+#define mat_mult(a, b, d)    ((arm_mat_mult_f32(a, b, d) == ARM_MATH_SUCCESS) ? RT_EOK : -RT_ERROR)
+#define mat_sub(a, b, d)     ((arm_mat_sub_f32(a, b, d) == ARM_MATH_SUCCESS) ? RT_EOK : -RT_ERROR)
+#define mat_add(a, b, d)     ((arm_mat_add_f32(a, b, d) == ARM_MATH_SUCCESS) ? RT_EOK : -RT_ERROR)
+#define mat_trans(a, d)      ((arm_mat_trans_f32(a, d) == ARM_MATH_SUCCESS) ? RT_EOK : -RT_ERROR)
+#define mat_inverse(a, d)    ((arm_mat_inverse_f32(a, d) == ARM_MATH_SUCCESS) ? RT_EOK : -RT_ERROR)
+
+#else
+
+/* portable versions with the semantics of the CMSIS-DSP arm_mat_*_f32 */
+
+static void mat_init(gps_mat_t *m, rt_uint16_t rows, rt_uint16_t cols, float *data)
+{
+    m->numRows = rows;
+    m->numCols = cols;
+    m->pData = data;
+}
+
+static rt_err_t mat_mult(const gps_mat_t *a, const gps_mat_t *b, gps_mat_t *dst)
+{
+    rt_uint16_t i, j, k;
+
+    if (a->numCols != b->numRows || dst->numRows != a->numRows || dst->numCols != b->numCols)
+        return -RT_ERROR;
+
+    for (i = 0; i < a->numRows; i++)
+    {
+        for (j = 0; j < b->numCols; j++)
+        {
+            float sum = 0.0f;
+
+            for (k = 0; k < a->numCols; k++)
+                sum += a->pData[i * a->numCols + k] * b->pData[k * b->numCols + j];
+
+            dst->pData[i * dst->numCols + j] = sum;
+        }
+    }
+
+    return RT_EOK;
+}
+
+static rt_err_t mat_add(const gps_mat_t *a, const gps_mat_t *b, gps_mat_t *dst)
+{
+    rt_uint32_t i, n = (rt_uint32_t)a->numRows * a->numCols;
+
+    if (a->numRows != b->numRows || a->numCols != b->numCols)
+        return -RT_ERROR;
+
+    for (i = 0; i < n; i++)
+        dst->pData[i] = a->pData[i] + b->pData[i];
+
+    return RT_EOK;
+}
+
+static rt_err_t mat_sub(const gps_mat_t *a, const gps_mat_t *b, gps_mat_t *dst)
+{
+    rt_uint32_t i, n = (rt_uint32_t)a->numRows * a->numCols;
+
+    if (a->numRows != b->numRows || a->numCols != b->numCols)
+        return -RT_ERROR;
+
+    for (i = 0; i < n; i++)
+        dst->pData[i] = a->pData[i] - b->pData[i];
+
+    return RT_EOK;
+}
+
+static rt_err_t mat_trans(const gps_mat_t *a, gps_mat_t *dst)
+{
+    rt_uint16_t i, j;
+
+    if (dst->numRows != a->numCols || dst->numCols != a->numRows)
+        return -RT_ERROR;
+
+    for (i = 0; i < a->numRows; i++)
+        for (j = 0; j < a->numCols; j++)
+            dst->pData[j * dst->numCols + i] = a->pData[i * a->numCols + j];
+
+    return RT_EOK;
+}
+
+/* Gauss-Jordan with partial pivoting, the source is destroyed like in CMSIS */
+static rt_err_t mat_inverse(gps_mat_t *a, gps_mat_t *dst)
+{
+    rt_uint16_t n = a->numRows;
+    rt_uint16_t i, j, k;
+    float *s = a->pData, *d = dst->pData;
+
+    if (a->numCols != n || dst->numRows != n || dst->numCols != n)
+        return -RT_ERROR;
+
+    for (i = 0; i < n; i++)
+        for (j = 0; j < n; j++)
+            d[i * n + j] = (i == j) ? 1.0f : 0.0f;
+
+    for (k = 0; k < n; k++)
+    {
+        rt_uint16_t pivot = k;
+
+        for (i = k + 1; i < n; i++)
+        {
+            if (fabsf(s[i * n + k]) > fabsf(s[pivot * n + k]))
+                pivot = i;
+        }
+
+        if (s[pivot * n + k] == 0.0f)
+            return -RT_ERROR;
+
+        if (pivot != k)
+        {
+            for (j = 0; j < n; j++)
+            {
+                float t = s[k * n + j]; s[k * n + j] = s[pivot * n + j]; s[pivot * n + j] = t;
+                t = d[k * n + j]; d[k * n + j] = d[pivot * n + j]; d[pivot * n + j] = t;
+            }
+        }
+
+        float inv = 1.0f / s[k * n + k];
+        for (j = 0; j < n; j++)
+        {
+            s[k * n + j] *= inv;
+            d[k * n + j] *= inv;
+        }
+
+        for (i = 0; i < n; i++)
+        {
+            float f = s[i * n + k];
+
+            if (i == k || f == 0.0f)
+                continue;
+
+            for (j = 0; j < n; j++)
+            {
+                s[i * n + j] -= f * s[k * n + j];
+                d[i * n + j] -= f * d[k * n + j];
+            }
+        }
+    }
+
+    return RT_EOK;
+}
+
+#endif /* PKG_GPS_FILTER_USING_CMSIS_DSP */
+
+/**
+ * This function initializes a Kalman filter
+ *
+ * @param filter the filter
+ * @param model  GPS_FILTER_CV or GPS_FILTER_CA
+ * @param noise  process noise, the acceleration (CV, m/s^2) or jerk
+ *               (CA, m/s^3) the tracked object is expected to show;
+ *               0 selects a default for vehicles
+ */
+void gps_filter_init(gps_filter_t filter, enum gps_filter_model model, float noise)
+{
+    RT_ASSERT(filter);
+
+    rt_memset(filter, 0, sizeof(struct gps_filter));
+    filter->model = model;
+    filter->states = (model == GPS_FILTER_CA) ? 6 : 4;
+    filter->noise = (noise > 0.0f) ? noise : ((model == GPS_FILTER_CA) ? 1.0f : 2.0f);
+    filter->uere = GPS_FILTER_UERE;
+    filter->max_gap = GPS_FILTER_MAX_GAP;
+}
+
+/**
+ * This function forgets the track, the next fix starts it again
+ */
+void gps_filter_reset(gps_filter_t filter)
+{
+    RT_ASSERT(filter);
+
+    filter->started = RT_FALSE;
+}
+
+/* measurement variance of one horizontal axis */
+static float filter_pos_var(gps_filter_t filter, const gps_fix_t *fix)
+{
+    float sigma = gps_fix_sigma(fix, filter->uere);
+
+    return sigma * sigma;
+}
+
+static float filter_vel_var(const gps_fix_t *fix)
+{
+    float hdop = (fix->hdop > 0.0f) ? fix->hdop : GPS_HDOP_DEFAULT;
+    float sigma = 0.1f + 0.1f * hdop;
+
+    return sigma * sigma;
+}
+
+static rt_bool_t filter_has_velocity(const gps_fix_t *fix)
+{
+    return (fix->speed > 0.0f || fix->course > 0.0f) ? RT_TRUE : RT_FALSE;
+}
+
+static void filter_start(gps_filter_t filter, const gps_fix_t *fix)
+{
+    coord_t origin = { fix->lon, fix->lat };
+    rt_uint8_t n = filter->states;
+    rt_uint8_t i;
+
+    gps_proj_set_origin(&filter->proj, &origin, 0.0);
+
+    rt_memset(filter->x, 0, sizeof(filter->x));
+    rt_memset(filter->P, 0, sizeof(filter->P));
+
+    float pos_var = filter_pos_var(filter, fix);
+    float vel_var = 25.0f;
+
+    if (filter_has_velocity(fix))
+    {
+        filter->x[2] = fix->speed * sinf(fix->course * DEG2RAD);
+        filter->x[3] = fix->speed * cosf(fix->course * DEG2RAD);
+        vel_var = filter_vel_var(fix);
+    }
+
+    for (i = 0; i < n; i++)
+    {
+        float var = (i < 2) ? pos_var : ((i < 4) ? vel_var : 1.0f);
+        filter->P[i * n + i] = var;
+    }
+
+    filter->started = RT_TRUE;
+    filter->last_time = fix->time;
+    filter->resets++;
+}
+
+/* move the plane origin under the estimate, velocities are kept */
+static void filter_reanchor(gps_filter_t filter)
+{
+    struct gps_enu enu = { filter->x[0], filter->x[1], 0.0 };
+    coord_t origin;
+
+    gps_proj_enu2geo_fast(&filter->proj, &enu, &origin, RT_NULL);
+    gps_proj_set_origin(&filter->proj, &origin, 0.0);
+    filter->x[0] = 0.0f;
+    filter->x[1] = 0.0f;
+}
+
+static rt_err_t filter_predict(gps_filter_t filter, float dt)
+{
+    rt_uint8_t n = filter->states;
+    rt_uint8_t axis;
+    gps_mat_t F, Ft, P, Q, FP;
+    float q = filter->noise * filter->noise;
+    float dt2 = dt * dt, dt3 = dt2 * dt;
+
+    rt_memset(filter->F, 0, sizeof(float) * n * n);
+    rt_memset(filter->Q, 0, sizeof(float) * n * n);
+
+    for (axis = 0; axis < n; axis++)
+        filter->F[axis * n + axis] = 1.0f;
+
+    for (axis = 0; axis < 2; axis++)
+    {
+        rt_uint8_t p = axis, v = axis + 2, a = axis + 4;
+
+        filter->F[p * n + v] = dt;
+
+        if (filter->model == GPS_FILTER_CA)
+        {
+            filter->F[p * n + a] = 0.5f * dt2;
+            filter->F[v * n + a] = dt;
+
+            /* white noise jerk */
+            filter->Q[p * n + p] = q * dt3 * dt2 / 20.0f;
+            filter->Q[p * n + v] = filter->Q[v * n + p] = q * dt2 * dt2 / 8.0f;
+            filter->Q[p * n + a] = filter->Q[a * n + p] = q * dt3 / 6.0f;
+            filter->Q[v * n + v] = q * dt3 / 3.0f;
+            filter->Q[v * n + a] = filter->Q[a * n + v] = q * dt2 / 2.0f;
+            filter->Q[a * n + a] = q * dt;
+
+            filter->x[p] += filter->x[v] * dt + 0.5f * filter->x[a] * dt2;
+            filter->x[v] += filter->x[a] * dt;
+        }
+        else
+        {
+            /* white noise acceleration */
+            filter->Q[p * n + p] = q * dt2 * dt2 / 4.0f;
+            filter->Q[p * n + v] = filter->Q[v * n + p] = q * dt3 / 2.0f;
+            filter->Q[v * n + v] = q * dt2;
+
+            filter->x[p] += filter->x[v] * dt;
+        }
+    }
+
+    /* P = F * P * F' + Q */
+    mat_init(&F, n, n, filter->F);
+    mat_init(&Ft, n, n, filter->T2);
+    mat_init(&P, n, n, filter->P);
+    mat_init(&Q, n, n, filter->Q);
+    mat_init(&FP, n, n, filter->T1);
+
+    if (mat_trans(&F, &Ft) != RT_EOK ||
+        mat_mult(&F, &P, &FP) != RT_EOK ||
+        mat_mult(&FP, &Ft, &P) != RT_EOK ||
+        mat_add(&P, &Q, &P) != RT_EOK)
+        return -RT_ERROR;
+
+    return RT_EOK;
+}
+
+static rt_err_t filter_correct(gps_filter_t filter, const gps_fix_t *fix)
+{
+    rt_uint8_t n = filter->states;
+    rt_uint8_t m = filter_has_velocity(fix) ? 4 : 2;
+    rt_uint8_t i, j;
+    gps_mat_t H, Ht, P, PHt, S, R, Si, K, KH, KHP;
+    struct gps_enu enu;
+    coord_t geo = { fix->lon, fix->lat };
+    float z[GPS_FILTER_MEAS_MAX];
+
+    gps_proj_geo2enu_fast(&filter->proj, &geo, 0.0, &enu);
+    z[0] = (float)enu.e;
+    z[1] = (float)enu.n;
+    if (m == 4)
+    {
+        z[2] = fix->speed * sinf(fix->course * DEG2RAD);
+        z[3] = fix->speed * cosf(fix->course * DEG2RAD);
+    }
+
+    /* H selects the measured states, the innovation needs no product */
+    rt_memset(filter->H, 0, sizeof(float) * m * n);
+    rt_memset(filter->R, 0, sizeof(float) * m * m);
+    for (i = 0; i < m; i++)
+    {
+        filter->H[i * n + i] = 1.0f;
+        filter->R[i * m + i] = (i < 2) ? filter_pos_var(filter, fix) : filter_vel_var(fix);
+        filter->y[i] = z[i] - filter->x[i];
+    }
+
+    mat_init(&H, m, n, filter->H);
+    mat_init(&Ht, n, m, filter->T2);
+    mat_init(&P, n, n, filter->P);
+    mat_init(&PHt, n, m, filter->T1);
+    mat_init(&S, m, m, filter->S);
+    mat_init(&R, m, m, filter->R);
+    mat_init(&Si, m, m, filter->Si);
+    mat_init(&K, n, m, filter->K);
+
+    /* S = H * P * H' + R, K = P * H' * inv(S) */
+    if (mat_trans(&H, &Ht) != RT_EOK ||
+        mat_mult(&P, &Ht, &PHt) != RT_EOK ||
+        mat_mult(&H, &PHt, &S) != RT_EOK ||
+        mat_add(&S, &R, &S) != RT_EOK ||
+        mat_inverse(&S, &Si) != RT_EOK ||
+        mat_mult(&PHt, &Si, &K) != RT_EOK)
+        return -RT_ERROR;
+
+    for (i = 0; i < n; i++)
+        for (j = 0; j < m; j++)
+            filter->x[i] += filter->K[i * m + j] * filter->y[j];
+
+    /* P = P - K * H * P */
+    mat_init(&KH, n, n, filter->T2);
+    mat_init(&KHP, n, n, filter->T1);
+    if (mat_mult(&K, &H, &KH) != RT_EOK ||
+        mat_mult(&KH, &P, &KHP) != RT_EOK ||
+        mat_sub(&P, &KHP, &P) != RT_EOK)
+        return -RT_ERROR;
+
+    /* keep P symmetric against rounding */
+    for (i = 0; i < n; i++)
+    {
+        for (j = i + 1; j < n; j++)
+        {
+            float v = 0.5f * (filter->P[i * n + j] + filter->P[j * n + i]);
+            filter->P[i * n + j] = filter->P[j * n + i] = v;
+        }
+    }
+
+    return RT_EOK;
+}
+
+/**
+ * This function runs one predict/correct cycle and writes the filtered
+ * position, speed and course back into the fix
+ *
+ * @param filter the filter
+ * @param fix    a valid fix, updated in place
+ *
+ * @return RT_EOK on success, -RT_ERROR if the filter diverged and was
+ *         restarted from this fix
+ */
+rt_err_t gps_filter_update(gps_filter_t filter, gps_fix_t *fix)
+{
+    RT_ASSERT(filter);
+    RT_ASSERT(fix);
+
+    rt_uint32_t start = gps_cycles_get();
+    rt_uint32_t dt_ms;
+    rt_err_t ret = RT_EOK;
+
+    dt_ms = (fix->time + MS_PER_DAY - filter->last_time) % MS_PER_DAY;
+
+    if (!filter->started || dt_ms > filter->max_gap)
+    {
+        filter_start(filter, fix);
+        goto __exit;
+    }
+
+    if (fabsf(filter->x[0]) > GPS_FILTER_REANCHOR || fabsf(filter->x[1]) > GPS_FILTER_REANCHOR)
+        filter_reanchor(filter);
+
+    if (filter_predict(filter, dt_ms * 0.001f) != RT_EOK ||
+        filter_correct(filter, fix) != RT_EOK)
+    {
+        LOG_E("Kalman filter diverged, restarting");
+        filter_start(filter, fix);
+        ret = -RT_ERROR;
+        goto __exit;
+    }
+
+    filter->last_time = fix->time;
+
+    struct gps_enu enu = { filter->x[0], filter->x[1], 0.0 };
+    coord_t geo;
+    float speed = sqrtf(filter->x[2] * filter->x[2] + filter->x[3] * filter->x[3]);
+
+    gps_proj_enu2geo_fast(&filter->proj, &enu, &geo, RT_NULL);
+    fix->lat = geo.lat;
+    fix->lon = geo.lon;
+    fix->speed = speed;
+    if (speed > SPEED_COURSE_MIN)
+    {
+        float course = atan2f(filter->x[2], filter->x[3]) * RAD2DEG;
+        fix->course = (course < 0.0f) ? course + 360.0f : course;
+    }
+
+__exit:
+    filter->updates++;
+    filter->cycles_last = gps_cycles_get() - start;
+    filter->cycles_total += filter->cycles_last;
+    if (filter->cycles_last > filter->cycles_max)
+        filter->cycles_max = filter->cycles_last;
+
+    return ret;
+}
+
+/**
+ * This function is the publish stage adapter, register it with
+ * gps_add_stage(dev, gps_filter_stage, filter). Invalid fixes pass
+ * through unfiltered.
+ */
+rt_err_t gps_filter_stage(gps_device_t dev, gps_fix_t *fix, void *user_data)
+{
+    gps_filter_t filter = (gps_filter_t)user_data;
+
+    RT_ASSERT(filter);
+
+    if (fix->status)
+        gps_filter_update(filter, fix);
+
+    return RT_EOK;
+}
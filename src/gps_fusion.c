@@ -0,0 +1,449 @@
+/*
+ * Copyright (c) 2020, RudyLo <luhuadong@163.com>
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ *
+ * Change Logs:
+ * Date           Author       Notes
+ * 2026-10-19     luhuadong    the first version
+ */
+
+#include <rtthread.h>
+#include <math.h>
+#include "gps_fusion.h"
+
+#define DBG_TAG "sensor.gps"
+#define DBG_LVL DBG_INFO
+#include <rtdbg.h>
+
+#define MS_PER_DAY           86400000UL
+
+static const struct gps_fusion_config fusion_default =
+{
+    .uere    = GPS_UERE,
+    .gate    = 3.0f,
+    .timeout = 3000,
+};
+
+/**
+ * This function initializes a fusion of several receivers
+ *
+ * @param fusion    the fusion
+ * @param cfg       the parameters, RT_NULL for defaults
+ * @param handler   called with every fused fix
+ * @param user_data passed to the handler
+ *
+ * @return RT_EOK on success
+ */
+rt_err_t gps_fusion_init(gps_fusion_t fusion, const struct gps_fusion_config *cfg,
+                         gps_fusion_handler_t handler, void *user_data)
+{
+    RT_ASSERT(fusion);
+    RT_ASSERT(handler);
+
+    rt_memset(fusion, 0, sizeof(struct gps_fusion));
+    fusion->cfg = cfg ? *cfg : fusion_default;
+    fusion->handler = handler;
+    fusion->user_data = user_data;
+
+    return rt_mutex_init(&fusion->lock, "gps_fus", RT_IPC_FLAG_FIFO);
+}
+
+/**
+ * This function unsubscribes from all receivers and releases the lock
+ */
+void gps_fusion_detach(gps_fusion_t fusion)
+{
+    RT_ASSERT(fusion);
+
+    while (fusion->source_num)
+        gps_fusion_remove(fusion, fusion->source[0].dev);
+
+    rt_mutex_detach(&fusion->lock);
+}
+
+/**
+ * This function adds a receiver and subscribes to its fixes
+ *
+ * @return RT_EOK on success, -RT_EFULL if GPS_FUSION_SOURCE_MAX sources
+ *         exist or the receiver has no free subscriber slot
+ */
+rt_err_t gps_fusion_add(gps_fusion_t fusion, gps_device_t dev)
+{
+    RT_ASSERT(fusion);
+    RT_ASSERT(dev);
+
+    rt_err_t ret = -RT_EFULL;
+
+    rt_mutex_take(&fusion->lock, RT_WAITING_FOREVER);
+    if (fusion->source_num < GPS_FUSION_SOURCE_MAX)
+    {
+        struct gps_fusion_source *src = &fusion->source[fusion->source_num];
+
+        rt_memset(src, 0, sizeof(struct gps_fusion_source));
+        src->dev = dev;
+        src->last_tick = rt_tick_get();
+        fusion->source_num++;
+        ret = RT_EOK;
+    }
+    rt_mutex_release(&fusion->lock);
+
+    if (ret == RT_EOK)
+    {
+        ret = gps_subscribe(dev, gps_fusion_subscriber, fusion);
+        if (ret != RT_EOK)
+            gps_fusion_remove(fusion, dev);
+    }
+
+    return ret;
+}
+
+/**
+ * This function removes a receiver, the remaining sources may change
+ * their index
+ */
+rt_err_t gps_fusion_remove(gps_fusion_t fusion, gps_device_t dev)
+{
+    RT_ASSERT(fusion);
+
+    rt_err_t ret = -RT_ERROR;
+    rt_uint8_t i;
+
+    gps_unsubscribe(dev, gps_fusion_subscriber, fusion);
+
+    rt_mutex_take(&fusion->lock, RT_WAITING_FOREVER);
+    for (i = 0; i < fusion->source_num; i++)
+    {
+        if (fusion->source[i].dev == dev)
+        {
+            fusion->source_num--;
+            fusion->source[i] = fusion->source[fusion->source_num];
+            ret = RT_EOK;
+            break;
+        }
+    }
+    rt_mutex_release(&fusion->lock);
+
+    return ret;
+}
+
+/* every source that is alive has reported the pending epoch */
+static rt_bool_t fusion_complete(gps_fusion_t fusion, rt_tick_t now)
+{
+    rt_tick_t timeout = rt_tick_from_millisecond(fusion->cfg.timeout);
+    rt_uint8_t i;
+
+    for (i = 0; i < fusion->source_num; i++)
+    {
+        struct gps_fusion_source *src = &fusion->source[i];
+
+        if (!src->has_fix && now - src->last_tick <= timeout)
+            return RT_FALSE;
+    }
+
+    return RT_TRUE;
+}
+
+/* fuse the pending epoch, returns RT_FALSE if no source reported it */
+static rt_bool_t fusion_combine(gps_fusion_t fusion, gps_fix_t *out, struct gps_fusion_diag *diag)
+{
+    float x[GPS_FUSION_SOURCE_MAX], y[GPS_FUSION_SOURCE_MAX], sigma[GPS_FUSION_SOURCE_MAX];
+    double lat0 = 0.0, lon0 = 0.0;
+    float m_per_lon = 0.0f;
+    float ex = 0.0f, ey = 0.0f, wsum;
+    rt_uint8_t valid = 0, best = 0xFF;
+    rt_uint8_t i;
+
+    rt_memset(diag, 0, sizeof(struct gps_fusion_diag));
+
+    for (i = 0; i < fusion->source_num; i++)
+    {
+        struct gps_fusion_source *src = &fusion->source[i];
+        const gps_fix_t *fix = &src->fix;
+
+        if (!src->has_fix)
+            continue;
+
+        diag->sources++;
+        if (best == 0xFF)
+            best = i;
+
+        if (!fix->status)
+            continue;
+
+        if (valid == 0)
+        {
+            lat0 = fix->lat;
+            lon0 = fix->lon;
+            m_per_lon = (float)(GPS_M_PER_DEG * cos(lat0 * GPS_DEG2RAD));
+        }
+
+        double dlon = fix->lon - lon0;
+        if (dlon > 180.0) dlon -= 360.0;
+        if (dlon < -180.0) dlon += 360.0;
+
+        x[i] = (float)dlon * m_per_lon;
+        y[i] = (float)((fix->lat - lat0) * GPS_M_PER_DEG);
+
+        sigma[i] = gps_fix_sigma(fix, fusion->cfg.uere);
+
+        diag->used_mask |= 1 << i;
+        valid++;
+    }
+
+    if (diag->sources == 0)
+        return RT_FALSE;
+
+    /* weighted mean, then drop the worst inconsistent source while three remain */
+    while (1)
+    {
+        float worst = 0.0f;
+        rt_uint8_t worst_i = 0;
+
+        ex = ey = wsum = 0.0f;
+        for (i = 0; i < fusion->source_num; i++)
+        {
+            if (diag->used_mask & (1 << i))
+            {
+                float w = 1.0f / (sigma[i] * sigma[i]);
+
+                ex += w * x[i];
+                ey += w * y[i];
+                wsum += w;
+            }
+        }
+        if (wsum <= 0.0f)
+            break;
+
+        ex /= wsum;
+        ey /= wsum;
+
+        diag->spread = 0.0f;
+        for (i = 0; i < fusion->source_num; i++)
+        {
+            if (diag->used_mask & (1 << i))
+            {
+                float d = sqrtf((x[i] - ex) * (x[i] - ex) + (y[i] - ey) * (y[i] - ey));
+
+                if (d > diag->spread)
+                    diag->spread = d;
+                if (d / sigma[i] > worst)
+                {
+                    worst = d / sigma[i];
+                    worst_i = i;
+                }
+            }
+        }
+        diag->residual = worst;
+
+        if (worst <= fusion->cfg.gate || valid < 3)
+            break;
+
+        diag->used_mask &= ~(1 << worst_i);
+        diag->outlier_mask |= 1 << worst_i;
+        fusion->source[worst_i].outliers++;
+        valid--;
+    }
+
+    diag->used = valid;
+
+    if (valid == 0)
+    {
+        /* nobody has a fix, pass the no-fix report on */
+        *out = fusion->source[best].fix;
+        return RT_TRUE;
+    }
+
+    /* the most precise source supplies date, time and the other fields */
+    for (i = 0; i < fusion->source_num; i++)
+    {
+        if ((diag->used_mask & (1 << i)) && (!(diag->used_mask & (1 << best)) || sigma[i] < sigma[best]))
+            best = i;
+    }
+    *out = fusion->source[best].fix;
+
+    float vx = 0.0f, vy = 0.0f, alt = 0.0f;
+
+    for (i = 0; i < fusion->source_num; i++)
+    {
+        const gps_fix_t *fix = &fusion->source[i].fix;
+        float w;
+
+        if (!(diag->used_mask & (1 << i)))
+            continue;
+
+        w = 1.0f / (sigma[i] * sigma[i]) / wsum;
+        vx += w * fix->speed * sinf(fix->course * (float)GPS_DEG2RAD);
+        vy += w * fix->speed * cosf(fix->course * (float)GPS_DEG2RAD);
+        alt += w * fix->alt;
+
+        if (fix->sats > out->sats) out->sats = fix->sats;
+        if (fix->quality > out->quality) out->quality = fix->quality;
+        if (fix->mode > out->mode) out->mode = fix->mode;
+        if (fix->rx_us && (out->rx_us == 0 || fix->rx_us < out->rx_us)) out->rx_us = fix->rx_us;
+        if (fix->epoch_us && out->epoch_us == 0)
+        {
+            out->epoch_us = fix->epoch_us;
+            out->latency = fix->latency;
+        }
+
+        fusion->source[i].used++;
+    }
+
+    out->lat = lat0 + ey / GPS_M_PER_DEG;
+    out->lon = lon0 + ((m_per_lon > 1.0f) ? ex / m_per_lon : 0.0);
+    if (out->lon > 180.0) out->lon -= 360.0;
+    if (out->lon < -180.0) out->lon += 360.0;
+    out->alt = alt;
+    out->speed = sqrtf(vx * vx + vy * vy);
+    out->course = atan2f(vx, vy) / (float)GPS_DEG2RAD;
+    if (out->course < 0.0f)
+        out->course += 360.0f;
+
+    diag->sigma = 1.0f / sqrtf(wsum);
+    out->hdop = diag->sigma / fusion->cfg.uere;
+
+    /* two disagreeing sources cannot be told apart */
+    if (diag->residual > fusion->cfg.gate)
+        out->flags |= GPS_FIX_FLAG_SUSPECT;
+
+    return RT_TRUE;
+}
+
+/* called with the lock held, clears the pending epoch */
+static rt_bool_t fusion_emit(gps_fusion_t fusion, gps_fix_t *out, struct gps_fusion_diag *diag)
+{
+    rt_bool_t ret = fusion_combine(fusion, out, diag);
+    rt_uint8_t i;
+
+    for (i = 0; i < fusion->source_num; i++)
+        fusion->source[i].has_fix = RT_FALSE;
+    fusion->pending = RT_FALSE;
+
+    if (ret)
+    {
+        fusion->epochs++;
+        if (diag->sources < fusion->source_num)
+            fusion->partial++;
+    }
+
+    return ret;
+}
+
+/**
+ * This function feeds a fix of one receiver
+ *
+ * @param fusion the fusion
+ * @param dev    the receiver, added with gps_fusion_add()
+ * @param fix    its fix
+ *
+ * @return RT_EOK on success, -RT_EINVAL for an unknown receiver,
+ *         -RT_EEMPTY for a fix without UTC time, -RT_ERROR for a fix
+ *         older than the pending epoch
+ */
+rt_err_t gps_fusion_input(gps_fusion_t fusion, gps_device_t dev, const gps_fix_t *fix)
+{
+    RT_ASSERT(fusion);
+    RT_ASSERT(fix);
+
+    struct gps_fusion_source *src = RT_NULL;
+    gps_fix_t out[2];
+    struct gps_fusion_diag diag[2];
+    rt_tick_t now = rt_tick_get();
+    rt_uint8_t n = 0, i;
+
+    rt_mutex_take(&fusion->lock, RT_WAITING_FOREVER);
+
+    for (i = 0; i < fusion->source_num; i++)
+    {
+        if (fusion->source[i].dev == dev)
+        {
+            src = &fusion->source[i];
+            break;
+        }
+    }
+    if (src == RT_NULL)
+    {
+        rt_mutex_release(&fusion->lock);
+        return -RT_EINVAL;
+    }
+
+    /* a cold receiver's time 0 would pass for an epoch half a day ahead */
+    if (!(fix->flags & GPS_FIX_FLAG_TIMED))
+    {
+        src->untimed++;
+        rt_mutex_release(&fusion->lock);
+        return -RT_EEMPTY;
+    }
+
+    /* fusion->time is the pending or the last fused epoch */
+    if (fusion->pending || fusion->epochs)
+    {
+        rt_uint32_t diff = (fix->time + MS_PER_DAY - fusion->time) % MS_PER_DAY;
+
+        if ((diff == 0 && !fusion->pending) || diff > MS_PER_DAY / 2)
+        {
+            src->late++;
+            rt_mutex_release(&fusion->lock);
+            return -RT_ERROR;
+        }
+
+        /* a newer epoch, the sources that missed the pending one are late */
+        if (diff && fusion->pending && fusion_emit(fusion, &out[n], &diag[n]))
+            n++;
+    }
+
+    if (!fusion->pending)
+    {
+        fusion->time = fix->time;
+        fusion->pending = RT_TRUE;
+    }
+
+    src->fix = *fix;
+    src->has_fix = RT_TRUE;
+    src->last_tick = now;
+    src->fixes++;
+
+    if (fusion_complete(fusion, now) && fusion_emit(fusion, &out[n], &diag[n]))
+        n++;
+
+    rt_mutex_release(&fusion->lock);
+
+    for (i = 0; i < n; i++)
+        fusion->handler(fusion, &out[i], &diag[i], fusion->user_data);
+
+    return RT_EOK;
+}
+
+/**
+ * This function fuses the pending epoch now, e.g. from a timer when all
+ * receivers may have stopped
+ */
+void gps_fusion_flush(gps_fusion_t fusion)
+{
+    RT_ASSERT(fusion);
+
+    gps_fix_t out;
+    struct gps_fusion_diag diag;
+    rt_bool_t ready = RT_FALSE;
+
+    rt_mutex_take(&fusion->lock, RT_WAITING_FOREVER);
+    if (fusion->pending)
+        ready = fusion_emit(fusion, &out, &diag);
+    rt_mutex_release(&fusion->lock);
+
+    if (ready)
+        fusion->handler(fusion, &out, &diag, fusion->user_data);
+}
+
+/**
+ * This function is the subscriber adapter that gps_fusion_add() registers
+ */
+void gps_fusion_subscriber(gps_device_t dev, const gps_fix_t *fix, void *user_data)
+{
+    gps_fusion_t fusion = (gps_fusion_t)user_data;
+
+    RT_ASSERT(fusion);
+
+    gps_fusion_input(fusion, dev, fix);
+}
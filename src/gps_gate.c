@@ -0,0 +1,173 @@
+/*
+ * Copyright (c) 2020, RudyLo <luhuadong@163.com>
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ *
+ * Change Logs:
+ * Date           Author       Notes
+ * 2026-10-19     luhuadong    the first version
+ */
+
+#include <rtthread.h>
+#include <math.h>
+#include "gps_gate.h"
+
+#define MS_PER_DAY           86400000UL
+
+#define GATE_MOTION_MASK     (GPS_GATE_BIT(GPS_GATE_SPEED) | GPS_GATE_BIT(GPS_GATE_ACCEL))
+
+static const struct gps_gate_config gate_default =
+{
+    .hdop_max    = 5.0f,
+    .pdop_max    = 8.0f,
+    .speed_max   = 70.0f,
+    .accel_max   = 15.0f,
+    .sats_min    = 4,
+    .quality_min = 1,
+    .mode_min    = 2,
+    .reseed      = 5,
+    .flag_only   = RT_FALSE,
+};
+
+/**
+ * This function initializes a quality gate
+ *
+ * @param gate the gate
+ * @param cfg  the rules, RT_NULL for defaults suited to road vehicles
+ */
+void gps_gate_init(gps_gate_t gate, const struct gps_gate_config *cfg)
+{
+    RT_ASSERT(gate);
+
+    rt_memset(gate, 0, sizeof(struct gps_gate));
+    gate->cfg = cfg ? *cfg : gate_default;
+}
+
+/**
+ * This function forgets the reference fix, the counters are kept
+ */
+void gps_gate_reset(gps_gate_t gate)
+{
+    RT_ASSERT(gate);
+
+    gate->has_ref = RT_FALSE;
+    gate->motion_run = 0;
+}
+
+static void gate_set_ref(gps_gate_t gate, const gps_fix_t *fix, float speed)
+{
+    gate->ref_lat = fix->lat;
+    gate->ref_lon = fix->lon;
+    gate->ref_time = fix->time;
+    gate->ref_speed = speed;
+    gate->has_ref = RT_TRUE;
+    gate->motion_run = 0;
+}
+
+/**
+ * This function checks a fix against every rule. Quality fields the
+ * receiver did not report (zero) are not checked.
+ *
+ * @param gate the gate
+ * @param fix  the fix
+ *
+ * @return the mask of failed rules, GPS_GATE_BIT(rule); 0 if it passed
+ */
+rt_uint32_t gps_gate_check(gps_gate_t gate, const gps_fix_t *fix)
+{
+    RT_ASSERT(gate);
+    RT_ASSERT(fix);
+
+    const struct gps_gate_config *cfg = &gate->cfg;
+    rt_uint32_t mask = 0;
+    float speed = -1.0f;
+    int rule;
+
+    if (!fix->status)
+        mask |= GPS_GATE_BIT(GPS_GATE_STATUS);
+    if (cfg->quality_min && fix->quality && fix->quality < cfg->quality_min)
+        mask |= GPS_GATE_BIT(GPS_GATE_QUALITY);
+    if (cfg->mode_min && fix->mode && fix->mode < cfg->mode_min)
+        mask |= GPS_GATE_BIT(GPS_GATE_MODE);
+    if (cfg->hdop_max > 0.0f && fix->hdop > cfg->hdop_max)
+        mask |= GPS_GATE_BIT(GPS_GATE_HDOP);
+    if (cfg->pdop_max > 0.0f && fix->pdop > cfg->pdop_max)
+        mask |= GPS_GATE_BIT(GPS_GATE_PDOP);
+    if (cfg->sats_min && fix->sats && fix->sats < cfg->sats_min)
+        mask |= GPS_GATE_BIT(GPS_GATE_SATS);
+
+    /* the motion rules only make sense for an otherwise good fix */
+    if (mask == 0 && gate->has_ref)
+    {
+        rt_uint32_t dt_ms = (fix->time + MS_PER_DAY - gate->ref_time) % MS_PER_DAY;
+
+        if (dt_ms)
+        {
+            double dlon = fix->lon - gate->ref_lon;
+            if (dlon > 180.0) dlon -= 360.0;
+            else if (dlon < -180.0) dlon += 360.0;
+
+            double x = dlon * GPS_M_PER_DEG * cos(gate->ref_lat * GPS_DEG2RAD);
+            double y = (fix->lat - gate->ref_lat) * GPS_M_PER_DEG;
+            float dt = dt_ms * 0.001f;
+
+            speed = (float)sqrt(x * x + y * y) / dt;
+
+            if (cfg->speed_max > 0.0f && speed > cfg->speed_max)
+                mask |= GPS_GATE_BIT(GPS_GATE_SPEED);
+            if (cfg->accel_max > 0.0f && gate->ref_speed >= 0.0f &&
+                fabsf(speed - gate->ref_speed) > cfg->accel_max * dt)
+                mask |= GPS_GATE_BIT(GPS_GATE_ACCEL);
+        }
+    }
+
+    if (mask & GATE_MOTION_MASK)
+    {
+        /* the receiver may really be somewhere else, e.g. after a tunnel */
+        if (++gate->motion_run >= cfg->reseed && cfg->reseed)
+        {
+            gate_set_ref(gate, fix, -1.0f);
+            mask &= ~GATE_MOTION_MASK;
+        }
+    }
+    else if (mask == 0)
+    {
+        gate_set_ref(gate, fix, speed);
+    }
+
+    for (rule = 0; rule < GPS_GATE_RULE_NUM; rule++)
+    {
+        if (mask & GPS_GATE_BIT(rule))
+            gate->count[rule]++;
+    }
+
+    if (mask)
+        gate->failed++;
+    else
+        gate->passed++;
+    gate->last_mask = mask;
+
+    return mask;
+}
+
+/**
+ * This function is the publish stage adapter, register it with
+ * gps_add_stage(dev, gps_gate_stage, gate)
+ */
+rt_err_t gps_gate_stage(gps_device_t dev, gps_fix_t *fix, void *user_data)
+{
+    gps_gate_t gate = (gps_gate_t)user_data;
+
+    RT_ASSERT(gate);
+
+    if (gps_gate_check(gate, fix) == 0)
+        return RT_EOK;
+
+    if (gate->cfg.flag_only)
+    {
+        fix->flags |= GPS_FIX_FLAG_SUSPECT;
+        return RT_EOK;
+    }
+
+    return -RT_ERROR;
+}
@@ -0,0 +1,469 @@
+/*
+ * Copyright (c) 2020, RudyLo <luhuadong@163.com>
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ *
+ * Change Logs:
+ * Date           Author       Notes
+ * 2026-10-19     luhuadong    the first version
+ */
+
+#include <rtthread.h>
+#include <math.h>
+#include "gps_geodesic.h"
+#include "gps_proj.h"
+
+#define VINCENTY_MAX_ITER    100
+#define VINCENTY_EPSILON     1e-12
+
+/* centimetres per 1e-7 degree on the mean sphere, Q16 */
+#define FIXED_CM_Q16         72873
+#define FIXED_SHORT_HOP      (1 << 20)   /* ~115 km */
+
+/* cos(0 ~ 90 degree), Q15 */
+static const rt_uint16_t cos_q15[91] =
+{
+    32768, 32763, 32748, 32723, 32688, 32643, 32588, 32524, 32449, 32365,
+    32270, 32166, 32052, 31928, 31795, 31651, 31499, 31336, 31164, 30983,
+    30792, 30592, 30382, 30163, 29935, 29698, 29452, 29197, 28932, 28660,
+    28378, 28088, 27789, 27482, 27166, 26842, 26510, 26170, 25822, 25466,
+    25102, 24730, 24351, 23965, 23571, 23170, 22763, 22348, 21926, 21498,
+    21063, 20622, 20174, 19720, 19261, 18795, 18324, 17847, 17364, 16877,
+    16384, 15886, 15384, 14876, 14365, 13848, 13328, 12803, 12275, 11743,
+    11207, 10668, 10126,  9580,  9032,  8481,  7927,  7371,  6813,  6252,
+     5690,  5126,  4560,  3993,  3425,  2856,  2286,  1715,  1144,   572,
+        0
+};
+
+static double wrap180(double deg)
+{
+    if (deg > 180.0)
+        deg -= 360.0;
+    else if (deg < -180.0)
+        deg += 360.0;
+
+    return deg;
+}
+
+static double normalize_bearing(double rad)
+{
+    double deg = rad * GPS_RAD2DEG;
+
+    return (deg < 0.0) ? deg + 360.0 : deg;
+}
+
+static void equirect_inverse(const coord_t *from, const coord_t *to, double *distance, double *bearing)
+{
+    double x = wrap180(to->lon - from->lon) * cos((from->lat + to->lat) * 0.5 * GPS_DEG2RAD);
+    double y = to->lat - from->lat;
+
+    if (distance) *distance = sqrt(x * x + y * y) * GPS_DEG2RAD * GPS_EARTH_RADIUS;
+    if (bearing)  *bearing = normalize_bearing(atan2(x, y));
+}
+
+static void haversine_inverse(const coord_t *from, const coord_t *to, double *distance, double *bearing)
+{
+    double lat1 = from->lat * GPS_DEG2RAD;
+    double lat2 = to->lat * GPS_DEG2RAD;
+    double dlon = wrap180(to->lon - from->lon) * GPS_DEG2RAD;
+    double cos_lat1 = cos(lat1);
+    double cos_lat2 = cos(lat2);
+
+    if (distance)
+    {
+        double s_lat = sin((lat2 - lat1) * 0.5);
+        double s_lon = sin(dlon * 0.5);
+        double h = s_lat * s_lat + cos_lat1 * cos_lat2 * s_lon * s_lon;
+
+        if (h > 1.0) h = 1.0;
+        *distance = 2.0 * GPS_EARTH_RADIUS * asin(sqrt(h));
+    }
+
+    if (bearing)
+    {
+        double y = sin(dlon) * cos_lat2;
+        double x = cos_lat1 * sin(lat2) - sin(lat1) * cos_lat2 * cos(dlon);
+
+        *bearing = normalize_bearing(atan2(y, x));
+    }
+}
+
+static rt_err_t vincenty_inverse(const coord_t *from, const coord_t *to, double *distance, double *bearing)
+{
+    double L = wrap180(to->lon - from->lon) * GPS_DEG2RAD;
+    double U1 = atan((1.0 - GPS_WGS84_F) * tan(from->lat * GPS_DEG2RAD));
+    double U2 = atan((1.0 - GPS_WGS84_F) * tan(to->lat * GPS_DEG2RAD));
+    double sin_u1 = sin(U1), cos_u1 = cos(U1);
+    double sin_u2 = sin(U2), cos_u2 = cos(U2);
+    double lambda = L, lambda_prev;
+    double sin_sigma, cos_sigma, sigma, cos2_alpha, cos_2sm;
+    double sin_lambda, cos_lambda;
+    int iter = 0;
+
+    do
+    {
+        sin_lambda = sin(lambda);
+        cos_lambda = cos(lambda);
+
+        double t1 = cos_u2 * sin_lambda;
+        double t2 = cos_u1 * sin_u2 - sin_u1 * cos_u2 * cos_lambda;
+
+        sin_sigma = sqrt(t1 * t1 + t2 * t2);
+        if (sin_sigma == 0.0)
+        {
+            /* coincident points */
+            if (distance) *distance = 0.0;
+            if (bearing)  *bearing = 0.0;
+            return RT_EOK;
+        }
+
+        cos_sigma = sin_u1 * sin_u2 + cos_u1 * cos_u2 * cos_lambda;
+        sigma = atan2(sin_sigma, cos_sigma);
+
+        double sin_alpha = cos_u1 * cos_u2 * sin_lambda / sin_sigma;
+        cos2_alpha = 1.0 - sin_alpha * sin_alpha;
+        /* on the equator cos2_alpha is 0 and cos_2sm is undefined */
+        cos_2sm = (cos2_alpha != 0.0) ? cos_sigma - 2.0 * sin_u1 * sin_u2 / cos2_alpha : 0.0;
+
+        double C = GPS_WGS84_F / 16.0 * cos2_alpha * (4.0 + GPS_WGS84_F * (4.0 - 3.0 * cos2_alpha));
+        lambda_prev = lambda;
+        lambda = L + (1.0 - C) * GPS_WGS84_F * sin_alpha *
+                 (sigma + C * sin_sigma * (cos_2sm + C * cos_sigma * (-1.0 + 2.0 * cos_2sm * cos_2sm)));
+    }
+    while (fabs(lambda - lambda_prev) > VINCENTY_EPSILON && ++iter < VINCENTY_MAX_ITER);
+
+    if (iter >= VINCENTY_MAX_ITER)
+    {
+        /* nearly antipodal, the series does not converge */
+        haversine_inverse(from, to, distance, bearing);
+        return -RT_ERROR;
+    }
+
+    if (distance)
+    {
+        double u2 = cos2_alpha * (GPS_WGS84_A * GPS_WGS84_A - GPS_WGS84_B * GPS_WGS84_B) / (GPS_WGS84_B * GPS_WGS84_B);
+        double A = 1.0 + u2 / 16384.0 * (4096.0 + u2 * (-768.0 + u2 * (320.0 - 175.0 * u2)));
+        double B = u2 / 1024.0 * (256.0 + u2 * (-128.0 + u2 * (74.0 - 47.0 * u2)));
+        double d_sigma = B * sin_sigma * (cos_2sm + B / 4.0 *
+                         (cos_sigma * (-1.0 + 2.0 * cos_2sm * cos_2sm) -
+                          B / 6.0 * cos_2sm * (-3.0 + 4.0 * sin_sigma * sin_sigma) *
+                          (-3.0 + 4.0 * cos_2sm * cos_2sm)));
+
+        *distance = GPS_WGS84_B * A * (sigma - d_sigma);
+    }
+
+    if (bearing)
+    {
+        *bearing = normalize_bearing(atan2(cos_u2 * sin_lambda,
+                                           cos_u1 * sin_u2 - sin_u1 * cos_u2 * cos_lambda));
+    }
+
+    return RT_EOK;
+}
+
+/**
+ * This function computes the distance and the initial bearing between
+ * two fixes
+ *
+ * @param from     the start point, decimal degrees
+ * @param to       the end point, decimal degrees
+ * @param method   the accuracy tier
+ * @param distance metres, may be RT_NULL
+ * @param bearing  initial bearing in degrees 0 ~ 360, clockwise from north, may be RT_NULL
+ *
+ * @return RT_EOK on success, -RT_ERROR if Vincenty did not converge and the
+ *         haversine result was returned instead
+ */
+rt_err_t gps_geodesic_inverse(const coord_t *from, const coord_t *to, enum gps_geodesic_method method,
+                              double *distance, double *bearing)
+{
+    RT_ASSERT(from);
+    RT_ASSERT(to);
+
+    switch (method)
+    {
+    case GPS_GEODESIC_EQUIRECT:
+        equirect_inverse(from, to, distance, bearing);
+        break;
+    case GPS_GEODESIC_HAVERSINE:
+        haversine_inverse(from, to, distance, bearing);
+        break;
+    case GPS_GEODESIC_VINCENTY:
+        return vincenty_inverse(from, to, distance, bearing);
+    default:
+        return -RT_EINVAL;
+    }
+
+    return RT_EOK;
+}
+
+/**
+ * This function returns the distance between two fixes in metres
+ */
+double gps_distance(const coord_t *from, const coord_t *to, enum gps_geodesic_method method)
+{
+    double distance = 0.0;
+
+    gps_geodesic_inverse(from, to, method, &distance, RT_NULL);
+
+    return distance;
+}
+
+/**
+ * This function returns the initial bearing from one fix to another in
+ * degrees
+ */
+double gps_bearing(const coord_t *from, const coord_t *to, enum gps_geodesic_method method)
+{
+    double bearing = 0.0;
+
+    gps_geodesic_inverse(from, to, method, RT_NULL, &bearing);
+
+    return bearing;
+}
+
+/**
+ * This function sums the distance between consecutive fixes of a track.
+ * The equirectangular and haversine tiers reuse the trigonometry of the
+ * shared point, so each point costs one cos() instead of two.
+ *
+ * @param track      the fixes in time order
+ * @param count      the number of fixes
+ * @param method     the accuracy tier
+ * @param cumulative the running length at each fix, may be RT_NULL
+ *
+ * @return the track length in metres
+ */
+double gps_track_length(const coord_t *track, rt_size_t count, enum gps_geodesic_method method,
+                        double *cumulative)
+{
+    RT_ASSERT(track || count == 0);
+
+    double total = 0.0;
+    rt_size_t i;
+
+    if (count == 0)
+        return 0.0;
+
+    if (cumulative)
+        cumulative[0] = 0.0;
+
+    if (method == GPS_GEODESIC_EQUIRECT)
+    {
+        for (i = 1; i < count; i++)
+        {
+            double x = wrap180(track[i].lon - track[i - 1].lon) *
+                       cos((track[i].lat + track[i - 1].lat) * 0.5 * GPS_DEG2RAD);
+            double y = track[i].lat - track[i - 1].lat;
+
+            total += sqrt(x * x + y * y) * GPS_DEG2RAD * GPS_EARTH_RADIUS;
+            if (cumulative) cumulative[i] = total;
+        }
+    }
+    else if (method == GPS_GEODESIC_HAVERSINE)
+    {
+        double cos_prev = cos(track[0].lat * GPS_DEG2RAD);
+
+        for (i = 1; i < count; i++)
+        {
+            double cos_cur = cos(track[i].lat * GPS_DEG2RAD);
+            double s_lat = sin((track[i].lat - track[i - 1].lat) * 0.5 * GPS_DEG2RAD);
+            double s_lon = sin(wrap180(track[i].lon - track[i - 1].lon) * 0.5 * GPS_DEG2RAD);
+            double h = s_lat * s_lat + cos_prev * cos_cur * s_lon * s_lon;
+
+            if (h > 1.0) h = 1.0;
+            total += 2.0 * GPS_EARTH_RADIUS * asin(sqrt(h));
+            if (cumulative) cumulative[i] = total;
+            cos_prev = cos_cur;
+        }
+    }
+    else
+    {
+        for (i = 1; i < count; i++)
+        {
+            double d = 0.0;
+
+            gps_geodesic_inverse(&track[i - 1], &track[i], method, &d, RT_NULL);
+            total += d;
+            if (cumulative) cumulative[i] = total;
+        }
+    }
+
+    return total;
+}
+
+/**
+ * This function computes the distance, and optionally the bearing, from
+ * one fix to many. The loops carry no dependency between iterations so the
+ * host compiler can vectorize them.
+ *
+ * @param from     the common start point
+ * @param to       the end points
+ * @param count    the number of end points
+ * @param method   the accuracy tier
+ * @param distance metres, count elements
+ * @param bearing  degrees, count elements, may be RT_NULL
+ *
+ * @return the number of results written
+ */
+rt_size_t gps_distance_batch(const coord_t *from, const coord_t *to, rt_size_t count,
+                             enum gps_geodesic_method method, double *distance, double *bearing)
+{
+    RT_ASSERT(from);
+    RT_ASSERT(to || count == 0);
+    RT_ASSERT(distance);
+
+    const double lat1 = from->lat * GPS_DEG2RAD;
+    const double sin_lat1 = sin(lat1);
+    const double cos_lat1 = cos(lat1);
+    rt_size_t i;
+
+    if (method == GPS_GEODESIC_EQUIRECT)
+    {
+        for (i = 0; i < count; i++)
+        {
+            double x = wrap180(to[i].lon - from->lon) * cos((from->lat + to[i].lat) * 0.5 * GPS_DEG2RAD);
+            double y = to[i].lat - from->lat;
+
+            distance[i] = sqrt(x * x + y * y) * GPS_DEG2RAD * GPS_EARTH_RADIUS;
+            if (bearing) bearing[i] = normalize_bearing(atan2(x, y));
+        }
+    }
+    else if (method == GPS_GEODESIC_HAVERSINE)
+    {
+        for (i = 0; i < count; i++)
+        {
+            double lat2 = to[i].lat * GPS_DEG2RAD;
+            double dlon = wrap180(to[i].lon - from->lon) * GPS_DEG2RAD;
+            double cos_lat2 = cos(lat2);
+            double s_lat = sin((lat2 - lat1) * 0.5);
+            double s_lon = sin(dlon * 0.5);
+            double h = s_lat * s_lat + cos_lat1 * cos_lat2 * s_lon * s_lon;
+
+            distance[i] = 2.0 * GPS_EARTH_RADIUS * asin(sqrt(h < 1.0 ? h : 1.0));
+            if (bearing)
+            {
+                bearing[i] = normalize_bearing(atan2(sin(dlon) * cos_lat2,
+                                                     cos_lat1 * sin(lat2) - sin_lat1 * cos_lat2 * cos(dlon)));
+            }
+        }
+    }
+    else
+    {
+        for (i = 0; i < count; i++)
+        {
+            gps_geodesic_inverse(from, &to[i], method, &distance[i], bearing ? &bearing[i] : RT_NULL);
+        }
+    }
+
+    return count;
+}
+
+static rt_uint32_t isqrt64(rt_uint64_t x)
+{
+    rt_uint64_t res = 0;
+    rt_uint64_t bit = (rt_uint64_t)1 << 62;
+
+    while (bit > x)
+        bit >>= 2;
+
+    while (bit)
+    {
+        if (x >= res + bit)
+        {
+            x -= res + bit;
+            res = (res >> 1) + bit;
+        }
+        else
+        {
+            res >>= 1;
+        }
+        bit >>= 2;
+    }
+
+    return (rt_uint32_t)res;
+}
+
+/* cos of a latitude in 1e-7 degree, Q15, linear interpolation */
+static rt_int32_t cos_fixed(rt_int32_t lat)
+{
+    rt_uint32_t a = (lat < 0) ? (rt_uint32_t)(-(rt_int64_t)lat) : (rt_uint32_t)lat;
+    rt_uint32_t idx = a / 10000000;
+    rt_uint32_t frac = a % 10000000;
+
+    if (idx >= 90)
+        return 0;
+
+    rt_int32_t c0 = cos_q15[idx];
+    rt_int32_t c1 = cos_q15[idx + 1];
+
+    return c0 - (rt_int32_t)(((rt_int64_t)(c0 - c1) * frac) / 10000000);
+}
+
+/* equirectangular distance in centimetres, Q8 */
+static rt_uint64_t distance_fixed_q8(const coord_fixed_t *from, const coord_fixed_t *to)
+{
+    rt_int64_t dlon = (rt_int64_t)to->lon - from->lon;
+    rt_int64_t dlat = (rt_int64_t)to->lat - from->lat;
+
+    if (dlon > 1800000000)
+        dlon -= 3600000000LL;
+    else if (dlon < -1800000000)
+        dlon += 3600000000LL;
+
+    /* short hops keep 8 fractional bits through the square root */
+    int q = (dlon > -FIXED_SHORT_HOP && dlon < FIXED_SHORT_HOP &&
+             dlat > -FIXED_SHORT_HOP && dlat < FIXED_SHORT_HOP) ? 8 : 0;
+    rt_int64_t x = (dlon * cos_fixed((rt_int32_t)(((rt_int64_t)from->lat + to->lat) / 2)) +
+                    (1 << (14 - q))) >> (15 - q);
+    rt_int64_t y = dlat * (1 << q);
+    rt_uint64_t d = isqrt64((rt_uint64_t)(x * x + y * y));
+
+    return (d * FIXED_CM_Q16) >> (8 + q);
+}
+
+/**
+ * This function returns the equirectangular distance between two fixed
+ * point coordinates using integer arithmetic only, for MCUs without FPU.
+ *
+ * @return the distance in centimetres
+ */
+rt_uint32_t gps_distance_fixed(const coord_fixed_t *from, const coord_fixed_t *to)
+{
+    RT_ASSERT(from);
+    RT_ASSERT(to);
+
+    return (rt_uint32_t)((distance_fixed_q8(from, to) + 128) >> 8);
+}
+
+/**
+ * This function sums gps_distance_fixed() over consecutive fixes
+ *
+ * @param cumulative the running length at each fix, may be RT_NULL
+ *
+ * @return the track length in centimetres, saturated on overflow
+ */
+rt_uint32_t gps_track_length_fixed(const coord_fixed_t *track, rt_size_t count, rt_uint32_t *cumulative)
+{
+    RT_ASSERT(track || count == 0);
+
+    /* accumulate sub-centimetre so rounding does not bias long tracks */
+    rt_uint64_t total = 0;
+    rt_size_t i;
+
+    if (count == 0)
+        return 0;
+
+    if (cumulative)
+        cumulative[0] = 0;
+
+    for (i = 1; i < count; i++)
+    {
+        total += distance_fixed_q8(&track[i - 1], &track[i]);
+        if (total > ((rt_uint64_t)0xFFFFFFFFUL << 8))
+            total = (rt_uint64_t)0xFFFFFFFFUL << 8;
+        if (cumulative) cumulative[i] = (rt_uint32_t)((total + 128) >> 8);
+    }
+
+    return (rt_uint32_t)((total + 128) >> 8);
+}
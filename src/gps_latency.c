@@ -0,0 +1,218 @@
+/*
+ * Copyright (c) 2020, RudyLo <luhuadong@163.com>
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ *
+ * Change Logs:
+ * Date           Author       Notes
+ * 2026-10-19     luhuadong    the first version
+ */
+
+#include <rtthread.h>
+#include <string.h>
+#include "gps_latency.h"
+#include "gps_barrier.h"
+
+#define DBG_TAG "sensor.gps"
+#define DBG_LVL DBG_INFO
+#include <rtdbg.h>
+
+#ifdef PKG_USING_GPS_LATENCY
+
+/*
+ * Dispatchers record concurrently and the shell resets, so every field is
+ * updated atomically. The sum is kept as two words, a reader may see the
+ * low word wrap before the carry.
+ */
+struct latency_table
+{
+    volatile rt_uint32_t bucket[GPS_LATENCY_BUCKETS];
+    volatile rt_uint32_t count;
+    volatile rt_uint32_t min_inv;      /* ~min, so that zero is the empty state */
+    volatile rt_uint32_t max;
+    volatile rt_uint32_t sum_lo;
+    volatile rt_uint32_t sum_hi;
+};
+
+static struct latency_table hist_table[GPS_LATENCY_POINT_NUM];
+
+static const char *point_name[GPS_LATENCY_POINT_NUM] =
+{
+    "rx", "sentence", "epoch", "filter", "deliver"
+};
+
+static rt_uint8_t bucket_of(rt_uint32_t us)
+{
+    rt_uint8_t i = 0;
+
+    while (us && i < GPS_LATENCY_BUCKETS - 1)
+    {
+        us >>= 1;
+        i++;
+    }
+
+    return i;
+}
+
+/**
+ * This function records the latency from a gps_time_us() stamp to now.
+ * Use the GPS_LATENCY() macro, which compiles out without
+ * PKG_USING_GPS_LATENCY and skips unstamped data.
+ *
+ * @param point the trace point
+ * @param since the gps_time_us() stamp the latency is measured from
+ */
+void gps_latency_record(enum gps_latency_point point, rt_uint64_t since)
+{
+    struct latency_table *hist = &hist_table[point];
+    rt_uint64_t now = gps_time_us();
+    rt_uint32_t us;
+
+    RT_ASSERT(point < GPS_LATENCY_POINT_NUM);
+
+    us = (now > since) ? (rt_uint32_t)(now - since) : 0;
+
+    gps_atomic_add(&hist->bucket[bucket_of(us)], 1);
+    gps_atomic_max(&hist->min_inv, ~us);
+    gps_atomic_max(&hist->max, us);
+    if (gps_atomic_add(&hist->sum_lo, us) < us)
+        gps_atomic_add(&hist->sum_hi, 1);
+    gps_atomic_add(&hist->count, 1);
+}
+
+/**
+ * This function copies the histogram of a trace point. Records made during
+ * the copy may show in some fields only.
+ *
+ * @param point the trace point
+ * @param hist  the copy
+ *
+ * @return RT_EOK on success, -RT_EINVAL for an unknown trace point
+ */
+rt_err_t gps_latency_get(enum gps_latency_point point, struct gps_latency_hist *hist)
+{
+    RT_ASSERT(hist);
+
+    struct latency_table *table = &hist_table[point];
+    int i;
+
+    if (point >= GPS_LATENCY_POINT_NUM)
+        return -RT_EINVAL;
+
+    for (i = 0; i < GPS_LATENCY_BUCKETS; i++)
+        hist->bucket[i] = table->bucket[i];
+    hist->count = table->count;
+    hist->min = hist->count ? ~table->min_inv : 0;
+    hist->max = table->max;
+    hist->sum = ((rt_uint64_t)table->sum_hi << 32) | table->sum_lo;
+
+    return RT_EOK;
+}
+
+/**
+ * This function estimates a percentile from the buckets
+ *
+ * @return the upper bound in us of the bucket holding the percentile
+ */
+rt_uint32_t gps_latency_percentile(const struct gps_latency_hist *hist, rt_uint8_t percent)
+{
+    RT_ASSERT(hist);
+
+    rt_uint64_t rank = ((rt_uint64_t)hist->count * percent + 99) / 100;
+    rt_uint64_t seen = 0;
+    int i;
+
+    if (hist->count == 0)
+        return 0;
+
+    for (i = 0; i < GPS_LATENCY_BUCKETS - 1; i++)
+    {
+        seen += hist->bucket[i];
+        if (seen >= rank)
+        {
+            rt_uint32_t bound = ((rt_uint32_t)1 << i) - 1;
+
+            return (bound < hist->max) ? bound : hist->max;
+        }
+    }
+
+    return hist->max;
+}
+
+/**
+ * This function clears all histograms. A record racing the reset may be
+ * left counted in some fields.
+ */
+void gps_latency_reset(void)
+{
+    int i, j;
+
+    for (i = 0; i < GPS_LATENCY_POINT_NUM; i++)
+    {
+        struct latency_table *table = &hist_table[i];
+
+        table->count = 0;
+        for (j = 0; j < GPS_LATENCY_BUCKETS; j++)
+            table->bucket[j] = 0;
+        table->min_inv = 0;
+        table->max = 0;
+        table->sum_lo = 0;
+        table->sum_hi = 0;
+    }
+}
+
+/**
+ * This function prints all histograms
+ */
+void gps_latency_dump(void)
+{
+    struct gps_latency_hist hist;
+    int i, j;
+
+    rt_kprintf("point        count     min     avg     p50     p99     max (us)\n");
+    for (i = 0; i < GPS_LATENCY_POINT_NUM; i++)
+    {
+        gps_latency_get((enum gps_latency_point)i, &hist);
+        rt_kprintf("%-8s  %8d  %6d  %6d  %6d  %6d  %6d\n", point_name[i], (int)hist.count,
+                   (int)hist.min, (int)(hist.count ? hist.sum / hist.count : 0),
+                   (int)gps_latency_percentile(&hist, 50), (int)gps_latency_percentile(&hist, 99),
+                   (int)hist.max);
+    }
+
+    for (i = 0; i < GPS_LATENCY_POINT_NUM; i++)
+    {
+        gps_latency_get((enum gps_latency_point)i, &hist);
+        if (hist.count == 0)
+            continue;
+
+        rt_kprintf("%s:", point_name[i]);
+        for (j = 0; j < GPS_LATENCY_BUCKETS; j++)
+        {
+            if (hist.bucket[j] == 0)
+                continue;
+
+            if (j < GPS_LATENCY_BUCKETS - 1)
+                rt_kprintf(" <%d:%d", (int)((rt_uint32_t)1 << j), (int)hist.bucket[j]);
+            else
+                rt_kprintf(" >=%d:%d", (int)((rt_uint32_t)1 << (j - 1)), (int)hist.bucket[j]);
+        }
+        rt_kprintf("\n");
+    }
+}
+
+/* gps_latency [reset] */
+static void gps_latency(int argc, char **argv)
+{
+    if (argc > 1 && strcmp(argv[1], "reset") == 0)
+    {
+        gps_latency_reset();
+        return;
+    }
+
+    gps_latency_dump();
+}
+#ifdef FINSH_USING_MSH
+MSH_CMD_EXPORT(gps_latency, gps latency histograms: gps_latency [reset]);
+#endif
+
+#endif /* PKG_USING_GPS_LATENCY */
@@ -0,0 +1,242 @@
+/*
+ * Copyright (c) 2020, RudyLo <luhuadong@163.com>
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ *
+ * Change Logs:
+ * Date           Author       Notes
+ * 2026-10-19     luhuadong    the first version
+ */
+
+#include <rtthread.h>
+#include "gps_line.h"
+#include "gps_barrier.h"
+
+#define DBG_TAG "sensor.gps"
+#define DBG_LVL DBG_INFO
+#include <rtdbg.h>
+
+/**
+ * This function initializes a receive ring
+ *
+ * @param buf  the ring
+ * @param data the storage
+ * @param size the storage size, a power of two
+ */
+void gps_line_init(gps_line_buf_t buf, char *data, rt_uint32_t size)
+{
+    RT_ASSERT(buf);
+    RT_ASSERT(data);
+    RT_ASSERT(size && (size & (size - 1)) == 0);
+
+    rt_memset(buf, 0, sizeof(struct gps_line_buf));
+    buf->data = data;
+    buf->size = size;
+}
+
+/**
+ * This function returns the contiguous space at the head for the writer.
+ * Readers treat it as overwritten from now on.
+ *
+ * @param buf the ring
+ * @param ptr the space
+ * @param max the most bytes the writer wants
+ *
+ * @return the bytes available at ptr
+ */
+rt_size_t gps_line_write_begin(gps_line_buf_t buf, char **ptr, rt_size_t max)
+{
+    RT_ASSERT(buf);
+    RT_ASSERT(ptr);
+
+    rt_uint32_t offset = buf->head & (buf->size - 1);
+    rt_size_t room = buf->size - offset;
+
+    if (room > max)
+        room = max;
+
+    /* readers see the reservation before any byte of it changes */
+    buf->reserve = buf->head + room;
+    gps_wmb();
+    *ptr = buf->data + offset;
+
+    return room;
+}
+
+/**
+ * This function publishes len bytes written at the head and wakes waiting
+ * readers
+ */
+void gps_line_write_end(gps_line_buf_t buf, rt_size_t len)
+{
+    RT_ASSERT(buf);
+
+    rt_uint8_t i;
+
+    gps_wmb();
+    buf->head += len;
+    buf->reserve = buf->head;
+
+    if (len == 0)
+        return;
+
+    /* pairs with gps_line_peek(): head is stored before waiting is loaded */
+    gps_mb();
+
+    /* gps_line_close() unhooks a reader under the same lock before detaching it */
+    rt_enter_critical();
+    for (i = 0; i < GPS_LINE_READER_MAX; i++)
+    {
+        gps_line_reader_t reader = buf->reader[i];
+
+        if (reader && reader->waiting)
+        {
+            reader->waiting = RT_FALSE;
+            rt_sem_release(&reader->notice);
+        }
+    }
+    rt_exit_critical();
+}
+
+/**
+ * This function attaches a reader, it sees the bytes received from now on
+ *
+ * @return RT_EOK on success, -RT_EFULL if GPS_LINE_READER_MAX readers exist
+ */
+rt_err_t gps_line_open(gps_line_buf_t buf, gps_line_reader_t reader)
+{
+    RT_ASSERT(buf);
+    RT_ASSERT(reader);
+
+    rt_err_t ret = -RT_EFULL;
+    rt_uint8_t i;
+
+    rt_memset(reader, 0, sizeof(struct gps_line_reader));
+    reader->buf = buf;
+    rt_sem_init(&reader->notice, "gps_line", 0, RT_IPC_FLAG_FIFO);
+
+    rt_enter_critical();
+    for (i = 0; i < GPS_LINE_READER_MAX; i++)
+    {
+        if (buf->reader[i] == RT_NULL)
+        {
+            reader->cursor = buf->head;
+            buf->reader[i] = reader;
+            ret = RT_EOK;
+            break;
+        }
+    }
+    rt_exit_critical();
+
+    if (ret != RT_EOK)
+        rt_sem_detach(&reader->notice);
+
+    return ret;
+}
+
+/**
+ * This function detaches a reader. Once it returns the writer no longer
+ * touches the reader, which may live on the caller's stack.
+ */
+void gps_line_close(gps_line_reader_t reader)
+{
+    RT_ASSERT(reader);
+
+    gps_line_buf_t buf = reader->buf;
+    rt_uint8_t i;
+
+    rt_enter_critical();
+    for (i = 0; i < GPS_LINE_READER_MAX; i++)
+    {
+        if (buf->reader[i] == reader)
+            buf->reader[i] = RT_NULL;
+    }
+    rt_exit_critical();
+
+    rt_sem_detach(&reader->notice);
+}
+
+/**
+ * This function returns the unread bytes in place, without copying. A
+ * reader that fell behind skips to the oldest intact byte first.
+ *
+ * @param reader  the reader
+ * @param data    the bytes, valid until gps_line_advance()
+ * @param timeout ticks to wait for data
+ *
+ * @return the contiguous bytes at data, 0 on timeout
+ */
+rt_size_t gps_line_peek(gps_line_reader_t reader, const char **data, rt_int32_t timeout)
+{
+    RT_ASSERT(reader);
+    RT_ASSERT(data);
+
+    gps_line_buf_t buf = reader->buf;
+    rt_uint32_t head, offset;
+    rt_size_t len;
+
+    while ((head = buf->head) == reader->cursor)
+    {
+        reader->waiting = RT_TRUE;
+        gps_mb();
+        if (buf->head != reader->cursor)
+        {
+            reader->waiting = RT_FALSE;
+            break;
+        }
+
+        if (rt_sem_take(&reader->notice, timeout) != RT_EOK)
+        {
+            reader->waiting = RT_FALSE;
+            return 0;
+        }
+    }
+
+    head = buf->head;
+    gps_rmb();
+
+    if (buf->reserve - reader->cursor > buf->size)
+    {
+        rt_uint32_t oldest = buf->reserve - buf->size;
+
+        reader->lost += oldest - reader->cursor;
+        reader->overruns++;
+        reader->cursor = oldest;
+    }
+
+    offset = reader->cursor & (buf->size - 1);
+    len = head - reader->cursor;
+    if (len > buf->size - offset)
+        len = buf->size - offset;
+
+    *data = buf->data + offset;
+
+    return len;
+}
+
+/**
+ * This function consumes bytes returned by gps_line_peek()
+ *
+ * @return RT_EOK if the bytes were intact while the reader used them,
+ *         -RT_EFULL if the writer overwrote them meanwhile
+ */
+rt_err_t gps_line_advance(gps_line_reader_t reader, rt_size_t len)
+{
+    RT_ASSERT(reader);
+
+    gps_line_buf_t buf = reader->buf;
+    rt_uint32_t start = reader->cursor;
+
+    /* the bytes were read before the reservation is checked */
+    gps_rmb();
+    reader->cursor += len;
+
+    if (buf->reserve - start > buf->size)
+    {
+        reader->lost += len;
+        reader->overruns++;
+        return -RT_EFULL;
+    }
+
+    return RT_EOK;
+}
@@ -0,0 +1,668 @@
+/*
+ * Copyright (c) 2020, RudyLo <luhuadong@163.com>
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ *
+ * Change Logs:
+ * Date           Author       Notes
+ * 2026-10-19     luhuadong    the first version
+ */
+
+#include <rtthread.h>
+#include "gps_log.h"
+
+#if defined(RT_USING_DFS) || defined(__linux__)
+#include <fcntl.h>
+#include <unistd.h>
+#endif
+#ifdef PKG_USING_FAL
+#include <fal.h>
+#endif
+
+#define DBG_TAG "sensor.gps"
+#define DBG_LVL DBG_INFO
+#include <rtdbg.h>
+
+#define LOG_JUMP_MAX         (1L << 26)   /* 1e-7 deg off the prediction that forces a keyframe */
+#define COURSE_FULL          3600
+
+static const struct gps_log_config log_default =
+{
+    .blocks     = 2048,
+    .velocity   = RT_TRUE,
+    .state_hdop = 5,
+};
+
+static const rt_uint32_t crc32_nibble[16] =
+{
+    0x00000000, 0x1DB71064, 0x3B6E20C8, 0x26D930AC, 0x76DC4190, 0x6B6B51F4, 0x4DB26158, 0x5005713C,
+    0xEDB88320, 0xF00F9344, 0xD6D6A3E8, 0xCB61B38C, 0x9B64C2B0, 0x86D3D2D4, 0xA00AE278, 0xBDBDF21C,
+};
+
+static rt_uint32_t crc32_update(rt_uint32_t crc, const rt_uint8_t *p, rt_size_t len)
+{
+    while (len--)
+    {
+        crc ^= *p++;
+        crc = (crc >> 4) ^ crc32_nibble[crc & 0x0F];
+        crc = (crc >> 4) ^ crc32_nibble[crc & 0x0F];
+    }
+
+    return crc;
+}
+
+/* crc32 of a block with its crc field taken as zero */
+static rt_uint32_t log_crc(const rt_uint8_t *block, rt_size_t size)
+{
+    static const rt_uint8_t zero[4] = { 0 };
+    rt_uint32_t crc = 0xFFFFFFFF;
+
+    crc = crc32_update(crc, block, 12);
+    crc = crc32_update(crc, zero, 4);
+    crc = crc32_update(crc, block + GPS_LOG_HEADER_SIZE, size - GPS_LOG_HEADER_SIZE);
+
+    return ~crc;
+}
+
+static rt_uint8_t *put_uvarint(rt_uint8_t *p, rt_uint32_t v)
+{
+    while (v >= 0x80)
+    {
+        *p++ = (rt_uint8_t)(v | 0x80);
+        v >>= 7;
+    }
+    *p++ = (rt_uint8_t)v;
+
+    return p;
+}
+
+static rt_uint8_t *put_svarint(rt_uint8_t *p, rt_int32_t v)
+{
+    return put_uvarint(p, ((rt_uint32_t)v << 1) ^ (rt_uint32_t)(v >> 31));
+}
+
+static const rt_uint8_t *get_uvarint(const rt_uint8_t *p, const rt_uint8_t *end, rt_uint32_t *v)
+{
+    rt_uint32_t val = 0;
+    int shift;
+
+    for (shift = 0; shift < 35 && p < end; shift += 7)
+    {
+        val |= (rt_uint32_t)(*p & 0x7F) << shift;
+        if ((*p++ & 0x80) == 0)
+        {
+            *v = val;
+            return p;
+        }
+    }
+
+    return RT_NULL;
+}
+
+static const rt_uint8_t *get_svarint(const rt_uint8_t *p, const rt_uint8_t *end, rt_int32_t *v)
+{
+    rt_uint32_t u = 0;
+
+    p = get_uvarint(p, end, &u);
+    *v = (rt_int32_t)((u >> 1) ^ (0U - (u & 1)));
+
+    return p;
+}
+
+static rt_int32_t log_round(float v)
+{
+    return (rt_int32_t)(v + (v < 0 ? -0.5f : 0.5f));
+}
+
+static rt_bool_t log_far(rt_int64_t v, rt_int64_t pred)
+{
+    return v - pred > LOG_JUMP_MAX || pred - v > LOG_JUMP_MAX;
+}
+
+/* encode a fix against log->last into buf, the new state goes to st */
+static rt_size_t log_encode(gps_log_t log, const gps_fix_t *fix, rt_bool_t key,
+                            rt_uint8_t *buf, struct gps_log_state *st)
+{
+    const struct gps_log_state *last = &log->last;
+    rt_uint8_t *p = buf + 1;
+    rt_uint8_t hdr = 0;
+    rt_int32_t lat = GPS_DEG2FIXED(fix->lat);
+    rt_int32_t lon = GPS_DEG2FIXED(fix->lon);
+    rt_int64_t plat = 2 * (rt_int64_t)last->lat[0] - last->lat[1];
+    rt_int64_t plon = 2 * (rt_int64_t)last->lon[0] - last->lon[1];
+    rt_int32_t hdop = log_round(fix->hdop * 10.0f);
+
+    if (fix->date != last->date || fix->time < last->time || log_far(lat, plat) || log_far(lon, plon))
+        key = RT_TRUE;
+
+    *st = *last;
+    st->date = fix->date;
+    st->time = fix->time;
+    st->dt = key ? 0 : (rt_int32_t)(fix->time - last->time);
+    st->lat[1] = key ? lat : last->lat[0];
+    st->lat[0] = lat;
+    st->lon[1] = key ? lon : last->lon[0];
+    st->lon[0] = lon;
+    st->alt = log_round(fix->alt * 10.0f);
+
+    if (key)
+    {
+        hdr |= GPS_LOG_REC_KEY;
+        p = put_uvarint(p, st->date);
+        p = put_uvarint(p, st->time);
+        p = put_svarint(p, lat);
+        p = put_svarint(p, lon);
+        p = put_svarint(p, st->alt);
+    }
+    else
+    {
+        p = put_svarint(p, st->dt - last->dt);
+        p = put_svarint(p, (rt_int32_t)(lat - plat));
+        p = put_svarint(p, (rt_int32_t)(lon - plon));
+        p = put_svarint(p, st->alt - last->alt);
+    }
+
+    if (hdop < 0)
+        hdop = 0;
+    if (hdop > 0xFFFF)
+        hdop = 0xFFFF;
+
+    if (key || fix->sats != last->sats || fix->quality != last->quality || fix->mode != last->mode ||
+        fix->status != last->status || fix->flags != last->flags ||
+        hdop - last->hdop >= log->cfg.state_hdop || last->hdop - hdop >= log->cfg.state_hdop)
+    {
+        hdr |= GPS_LOG_REC_STATE;
+        st->hdop = (rt_uint16_t)hdop;
+        st->sats = fix->sats;
+        st->quality = fix->quality & 0x0F;
+        st->mode = fix->mode & 0x03;
+        st->status = fix->status & 0x01;
+        st->flags = fix->flags;
+
+        *p++ = st->quality | (st->mode << 4) | (st->status << 6);
+        *p++ = st->flags;
+        *p++ = st->sats;
+        p = put_uvarint(p, st->hdop);
+    }
+
+    if (log->cfg.velocity)
+    {
+        rt_int32_t speed = log_round(fix->speed * 100.0f);
+        rt_int32_t course = log_round(fix->course * 10.0f) % COURSE_FULL;
+
+        if (speed < 0)
+            speed = 0;
+        if (course < 0)
+            course += COURSE_FULL;
+
+        hdr |= GPS_LOG_REC_VEL;
+        if (key)
+        {
+            p = put_uvarint(p, speed);
+            p = put_uvarint(p, course);
+        }
+        else
+        {
+            rt_int32_t dc = course - last->course;
+
+            if (dc >= COURSE_FULL / 2)
+                dc -= COURSE_FULL;
+            else if (dc < -COURSE_FULL / 2)
+                dc += COURSE_FULL;
+
+            p = put_svarint(p, speed - last->speed);
+            p = put_svarint(p, dc);
+        }
+        st->speed = speed;
+        st->course = course;
+    }
+
+    buf[0] = hdr;
+
+    return p - buf;
+}
+
+/* decode one record into st, RT_NULL if it is truncated */
+static const rt_uint8_t *log_decode(const rt_uint8_t *p, const rt_uint8_t *end, struct gps_log_state *st)
+{
+    rt_uint8_t hdr;
+    rt_int32_t d;
+
+    if (p >= end)
+        return RT_NULL;
+    hdr = *p++;
+
+    if (hdr & GPS_LOG_REC_KEY)
+    {
+        rt_int32_t lat = 0, lon = 0;
+
+        p = get_uvarint(p, end, &st->date);
+        if (p) p = get_uvarint(p, end, &st->time);
+        if (p) p = get_svarint(p, end, &lat);
+        if (p) p = get_svarint(p, end, &lon);
+        if (p) p = get_svarint(p, end, &st->alt);
+        st->dt = 0;
+        st->lat[0] = st->lat[1] = lat;
+        st->lon[0] = st->lon[1] = lon;
+    }
+    else
+    {
+        rt_int64_t plat = 2 * (rt_int64_t)st->lat[0] - st->lat[1];
+        rt_int64_t plon = 2 * (rt_int64_t)st->lon[0] - st->lon[1];
+
+        p = get_svarint(p, end, &d);
+        st->dt += d;
+        st->time += st->dt;
+        if (p) p = get_svarint(p, end, &d);
+        st->lat[1] = st->lat[0];
+        st->lat[0] = (rt_int32_t)(plat + d);
+        if (p) p = get_svarint(p, end, &d);
+        st->lon[1] = st->lon[0];
+        st->lon[0] = (rt_int32_t)(plon + d);
+        if (p) p = get_svarint(p, end, &d);
+        st->alt += d;
+    }
+
+    if (p && (hdr & GPS_LOG_REC_STATE))
+    {
+        rt_uint32_t hdop = 0;
+
+        if (end - p < 3)
+            return RT_NULL;
+        st->quality = p[0] & 0x0F;
+        st->mode = (p[0] >> 4) & 0x03;
+        st->status = (p[0] >> 6) & 0x01;
+        st->flags = p[1];
+        st->sats = p[2];
+        p = get_uvarint(p + 3, end, &hdop);
+        st->hdop = (rt_uint16_t)hdop;
+    }
+
+    if (p && (hdr & GPS_LOG_REC_VEL))
+    {
+        if (hdr & GPS_LOG_REC_KEY)
+        {
+            rt_uint32_t speed = 0, course = 0;
+
+            p = get_uvarint(p, end, &speed);
+            if (p) p = get_uvarint(p, end, &course);
+            st->speed = speed;
+            st->course = course;
+        }
+        else
+        {
+            p = get_svarint(p, end, &d);
+            st->speed += d;
+            if (p) p = get_svarint(p, end, &d);
+            st->course = (st->course + d + COURSE_FULL) % COURSE_FULL;
+        }
+    }
+
+    return p;
+}
+
+static void log_write(void *ctx, const rt_uint8_t *block, rt_size_t len)
+{
+    gps_log_t log = (gps_log_t)ctx;
+    rt_uint32_t seq = gps_get_u32(block + 4);
+
+    if (log->io.write(log->io.ctx, seq % log->cfg.blocks, block, GPS_LOG_BLOCK_SIZE) != RT_EOK)
+        log->errors++;
+    else
+        log->blocks++;
+}
+
+static void log_begin(gps_log_t log)
+{
+    rt_memset(log->out.buf[log->out.fill], 0, GPS_LOG_BLOCK_SIZE);
+    log->used = 0;
+    log->count = 0;
+}
+
+/* seal the block being filled and hand it to the writer */
+static void log_submit(gps_log_t log)
+{
+    rt_uint8_t *block = log->out.buf[log->out.fill];
+
+    gps_put_u16(block, GPS_LOG_MAGIC);
+    block[2] = GPS_LOG_VERSION;
+    block[3] = 0;
+    gps_put_u32(block + 4, log->seq);
+    gps_put_u16(block + 8, log->count);
+    gps_put_u16(block + 10, log->used);
+    gps_put_u32(block + 12, log_crc(block, GPS_LOG_BLOCK_SIZE));
+    log->out.len[log->out.fill] = GPS_LOG_BLOCK_SIZE;
+
+    /* a dropped block's sequence number is used again */
+    if (gps_dbuf_submit(&log->out) == RT_EOK)
+        log->seq++;
+
+    log_begin(log);
+}
+
+static rt_bool_t log_valid(gps_log_t log, rt_uint32_t block, rt_uint32_t *seq)
+{
+    rt_uint8_t hdr[GPS_LOG_HEADER_SIZE];
+
+    if (log->io.read(log->io.ctx, block, hdr, sizeof(hdr)) != RT_EOK)
+        return RT_FALSE;
+    if (gps_get_u16(hdr) != GPS_LOG_MAGIC || hdr[2] != GPS_LOG_VERSION)
+        return RT_FALSE;
+
+    *seq = gps_get_u32(hdr + 4);
+
+    return RT_TRUE;
+}
+
+/*
+ * Block i of a ring holds sequence seq0 + i up to the newest block and
+ * older or erased blocks after it, so the newest is found by bisection
+ * in O(log blocks) header reads.
+ */
+static void log_recover(gps_log_t log)
+{
+    rt_uint32_t lo = 0, hi = log->cfg.blocks, mid;
+    rt_uint32_t seq0, seq;
+
+    log->seq = 0;
+    if (log->io.read == RT_NULL || !log_valid(log, 0, &seq0))
+        return;
+
+    while (hi - lo > 1)
+    {
+        mid = lo + (hi - lo) / 2;
+        if (log_valid(log, mid, &seq) && seq == seq0 + mid)
+            lo = mid;
+        else
+            hi = mid;
+    }
+
+    log->seq = seq0 + lo + 1;
+}
+
+static rt_err_t log_setup(gps_log_t log, const struct gps_log_config *cfg, const struct gps_log_io *io)
+{
+    RT_ASSERT(io);
+    RT_ASSERT(io->write);
+
+    if (cfg)
+        log->cfg = *cfg;
+    else if (log->cfg.blocks == 0)
+        log->cfg = log_default;
+    log->io = *io;
+
+    if (log->cfg.blocks == 0)
+        return -RT_EINVAL;
+
+    log_recover(log);
+    gps_dbuf_init(&log->out, log->block, GPS_LOG_BLOCK_SIZE, log_write, log);
+    log_begin(log);
+
+    return RT_EOK;
+}
+
+/**
+ * This function initializes a track log on a block storage backend and
+ * resumes after its newest block
+ *
+ * @param log the log
+ * @param cfg the parameters, RT_NULL for defaults
+ * @param io  the backend, read may be RT_NULL to start a new ring
+ *
+ * @return RT_EOK on success
+ */
+rt_err_t gps_log_init(gps_log_t log, const struct gps_log_config *cfg, const struct gps_log_io *io)
+{
+    RT_ASSERT(log);
+
+    rt_memset(log, 0, sizeof(struct gps_log));
+
+    return log_setup(log, cfg, io);
+}
+
+#if defined(RT_USING_DFS) || defined(__linux__)
+static rt_err_t log_file_read(void *ctx, rt_uint32_t block, void *buf, rt_size_t size)
+{
+    gps_log_t log = (gps_log_t)ctx;
+
+    if (lseek(log->backend.fd, (off_t)block * GPS_LOG_BLOCK_SIZE, SEEK_SET) < 0)
+        return -RT_EIO;
+
+    return read(log->backend.fd, buf, size) == (int)size ? RT_EOK : -RT_EIO;
+}
+
+static rt_err_t log_file_write(void *ctx, rt_uint32_t block, const void *buf, rt_size_t size)
+{
+    gps_log_t log = (gps_log_t)ctx;
+
+    if (lseek(log->backend.fd, (off_t)block * GPS_LOG_BLOCK_SIZE, SEEK_SET) < 0)
+        return -RT_EIO;
+
+    return write(log->backend.fd, buf, size) == (int)size ? RT_EOK : -RT_EIO;
+}
+
+/**
+ * This function opens a track log in a file, cfg->blocks blocks long
+ */
+rt_err_t gps_log_open_file(gps_log_t log, const struct gps_log_config *cfg, const char *path)
+{
+    RT_ASSERT(log);
+    RT_ASSERT(path);
+
+    struct gps_log_io io = { log_file_read, log_file_write, log };
+    rt_err_t ret;
+
+    rt_memset(log, 0, sizeof(struct gps_log));
+    log->backend.fd = open(path, O_RDWR | O_CREAT, 0644);
+    if (log->backend.fd < 0)
+    {
+        LOG_E("Can't open '%s'", path);
+        return -RT_EIO;
+    }
+
+    ret = log_setup(log, cfg, &io);
+    if (ret != RT_EOK)
+        close(log->backend.fd);
+
+    return ret;
+}
+#endif
+
+#ifdef PKG_USING_FAL
+static rt_err_t log_fal_read(void *ctx, rt_uint32_t block, void *buf, rt_size_t size)
+{
+    gps_log_t log = (gps_log_t)ctx;
+
+    return fal_partition_read(log->backend.part, block * GPS_LOG_BLOCK_SIZE, buf, size) == (int)size ?
+           RT_EOK : -RT_EIO;
+}
+
+/* a block at a sector start erases the sector, the blocks after it follow into it */
+static rt_err_t log_fal_write(void *ctx, rt_uint32_t block, const void *buf, rt_size_t size)
+{
+    gps_log_t log = (gps_log_t)ctx;
+    rt_uint32_t addr = block * GPS_LOG_BLOCK_SIZE;
+
+    if (addr % GPS_LOG_ERASE_SIZE == 0 &&
+        fal_partition_erase(log->backend.part, addr, GPS_LOG_ERASE_SIZE) < 0)
+        return -RT_EIO;
+
+    return fal_partition_write(log->backend.part, addr, buf, size) == (int)size ? RT_EOK : -RT_EIO;
+}
+
+/**
+ * This function opens a track log in a flash partition. With cfg->blocks
+ * 0 the log takes the whole partition.
+ */
+rt_err_t gps_log_open_fal(gps_log_t log, const struct gps_log_config *cfg, const char *part_name)
+{
+    RT_ASSERT(log);
+    RT_ASSERT(part_name);
+
+    const struct fal_partition *part = fal_partition_find(part_name);
+    struct gps_log_io io = { log_fal_read, log_fal_write, log };
+
+    if (part == RT_NULL)
+    {
+        LOG_E("Can't find '%s' partition", part_name);
+        return -RT_EIO;
+    }
+
+    rt_memset(log, 0, sizeof(struct gps_log));
+    log->backend.part = part;
+    log->cfg = cfg ? *cfg : log_default;
+    if (cfg == RT_NULL || cfg->blocks == 0)
+        log->cfg.blocks = (part->len / GPS_LOG_ERASE_SIZE) * (GPS_LOG_ERASE_SIZE / GPS_LOG_BLOCK_SIZE);
+
+    return log_setup(log, RT_NULL, &io);
+}
+#endif
+
+/**
+ * This function moves block writes to a thread of their own, after it
+ * gps_log_append() only encodes into RAM
+ */
+rt_err_t gps_log_start(gps_log_t log)
+{
+    RT_ASSERT(log);
+
+    return gps_dbuf_start(&log->out, "gps_log", RT_THREAD_PRIORITY_MAX / 2 + 2);
+}
+
+/**
+ * This function appends a fix, the block is written when it is full.
+ * Appending is for one thread at a time.
+ *
+ * @return RT_EOK on success
+ */
+rt_err_t gps_log_append(gps_log_t log, const gps_fix_t *fix)
+{
+    RT_ASSERT(log);
+    RT_ASSERT(fix);
+
+    rt_uint8_t rec[GPS_LOG_RECORD_MAX];
+    struct gps_log_state st;
+    rt_size_t len;
+
+    len = log_encode(log, fix, log->count == 0, rec, &st);
+    if (log->used + len > GPS_LOG_BLOCK_SIZE - GPS_LOG_HEADER_SIZE)
+    {
+        log_submit(log);
+        len = log_encode(log, fix, RT_TRUE, rec, &st);
+    }
+
+    rt_memcpy(log->out.buf[log->out.fill] + GPS_LOG_HEADER_SIZE + log->used, rec, len);
+    log->used += len;
+    log->count++;
+    log->last = st;
+
+    log->fixes++;
+    log->bytes += len;
+
+    return RT_EOK;
+}
+
+/**
+ * This function writes the partly filled block out, the next fix starts a
+ * new block. Call it before power-down; each call costs the rest of a block.
+ */
+rt_err_t gps_log_sync(gps_log_t log)
+{
+    RT_ASSERT(log);
+
+    if (log->count)
+        log_submit(log);
+
+    return RT_EOK;
+}
+
+/**
+ * This function syncs the log, stops its writer and closes the backend
+ */
+void gps_log_close(gps_log_t log)
+{
+    RT_ASSERT(log);
+
+    /* make room for the last block rather than drop it */
+    gps_dbuf_flush(&log->out);
+    gps_log_sync(log);
+    gps_dbuf_detach(&log->out);
+
+#if defined(RT_USING_DFS) || defined(__linux__)
+    if (log->io.write == log_file_write)
+        close(log->backend.fd);
+#endif
+}
+
+/**
+ * This function is the subscriber adapter, register it with
+ * gps_subscribe(dev, gps_log_subscriber, log). Fixes without a position
+ * are not logged.
+ */
+void gps_log_subscriber(gps_device_t dev, const gps_fix_t *fix, void *user_data)
+{
+    gps_log_t log = (gps_log_t)user_data;
+
+    RT_ASSERT(log);
+
+    if (fix->status || fix->quality)
+        gps_log_append(log, fix);
+}
+
+/**
+ * This function decodes a block read back from the log
+ *
+ * @param block     the block
+ * @param size      GPS_LOG_BLOCK_SIZE of the writer
+ * @param handler   called with every fix in the block
+ * @param user_data passed to the handler
+ *
+ * @return the number of fixes, -RT_ERROR if the block is not valid
+ */
+int gps_log_decode(const void *block, rt_size_t size, gps_log_handler_t handler, void *user_data)
+{
+    RT_ASSERT(block);
+    RT_ASSERT(handler);
+
+    const rt_uint8_t *b = (const rt_uint8_t *)block;
+    const rt_uint8_t *p, *end;
+    struct gps_log_state st;
+    gps_fix_t fix;
+    rt_uint16_t count, i;
+
+    if (size < GPS_LOG_HEADER_SIZE || gps_get_u16(b) != GPS_LOG_MAGIC || b[2] != GPS_LOG_VERSION)
+        return -RT_ERROR;
+    if (gps_get_u16(b + 10) > size - GPS_LOG_HEADER_SIZE || gps_get_u32(b + 12) != log_crc(b, size))
+        return -RT_ERROR;
+
+    count = gps_get_u16(b + 8);
+    p = b + GPS_LOG_HEADER_SIZE;
+    end = p + gps_get_u16(b + 10);
+    rt_memset(&st, 0, sizeof(st));
+
+    for (i = 0; i < count; i++)
+    {
+        p = log_decode(p, end, &st);
+        if (p == RT_NULL)
+            return -RT_ERROR;
+
+        rt_memset(&fix, 0, sizeof(fix));
+        fix.lat = GPS_FIXED2DEG(st.lat[0]);
+        fix.lon = GPS_FIXED2DEG(st.lon[0]);
+        fix.alt = st.alt / 10.0f;
+        fix.speed = st.speed / 100.0f;
+        fix.course = st.course / 10.0f;
+        fix.hdop = st.hdop / 10.0f;
+        fix.sats = st.sats;
+        fix.quality = st.quality;
+        fix.mode = st.mode;
+        fix.status = st.status;
+        fix.flags = st.flags;
+        fix.date = st.date;
+        fix.time = st.time;
+
+        handler(&fix, user_data);
+    }
+
+    return count;
+}
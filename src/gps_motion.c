@@ -0,0 +1,306 @@
+/*
+ * Copyright (c) 2020, RudyLo <luhuadong@163.com>
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ *
+ * Change Logs:
+ * Date           Author       Notes
+ * 2026-10-19     luhuadong    the first version
+ */
+
+#include <rtthread.h>
+#include <math.h>
+#include "gps_motion.h"
+
+#define DBG_TAG "sensor.gps"
+#define DBG_LVL DBG_INFO
+#include <rtdbg.h>
+
+#define WINDOW_RANGE         1000.0f     /* metres from the origin before the window restarts */
+
+static const struct gps_motion_config motion_default =
+{
+    .speed_still     = 0.5f,
+    .speed_moving    = 1.5f,
+    .spread_still    = 5.0f,
+    .deadband        = 10.0f,
+    .accel_threshold = 0.0f,
+    .accel_hold      = 2000,
+    .heartbeat       = 60000,
+    .idle            = 300000,
+    .window          = 10,
+    .standby_cmd     = RT_NULL,
+    .wake_cmd        = RT_NULL,
+};
+
+/**
+ * This function initializes a motion detector
+ *
+ * @param motion the motion detector
+ * @param cfg    the thresholds, RT_NULL for defaults suited to vehicles
+ */
+void gps_motion_init(gps_motion_t motion, const struct gps_motion_config *cfg)
+{
+    RT_ASSERT(motion);
+
+    rt_memset(motion, 0, sizeof(struct gps_motion));
+    motion->cfg = cfg ? *cfg : motion_default;
+
+    if (motion->cfg.window == 0 || motion->cfg.window > GPS_MOTION_WINDOW_MAX)
+        motion->cfg.window = GPS_MOTION_WINDOW_MAX;
+}
+
+void gps_motion_set_handler(gps_motion_t motion, gps_motion_handler_t handler, void *user_data)
+{
+    RT_ASSERT(motion);
+
+    motion->handler = handler;
+    motion->user_data = user_data;
+}
+
+/*
+ * The accelerometer fields, idle and power_pending are shared by the
+ * dispatcher and the thread calling gps_motion_accel(). They change with
+ * interrupts disabled, the commands are sent outside.
+ */
+
+/* set the wanted power state, RT_FALSE if it already was */
+static rt_bool_t motion_want(gps_motion_t motion, rt_bool_t idle)
+{
+    rt_base_t level;
+    rt_bool_t change;
+
+    level = rt_hw_interrupt_disable();
+    change = (motion->idle != idle);
+    if (change)
+    {
+        motion->idle = idle;
+        motion->power_pending = RT_TRUE;
+    }
+    rt_hw_interrupt_enable(level);
+
+    return change;
+}
+
+/*
+ * Send the command of the wanted power state. In the dispatcher the
+ * command lock is only tried, a busy lock leaves it for the next fix. A
+ * command the other thread overtook with a new wanted state stays
+ * pending, so the next fix sends the state that holds.
+ */
+static void motion_power(gps_motion_t motion)
+{
+    rt_base_t level;
+    rt_bool_t idle;
+    rt_err_t ret = RT_EOK;
+    const char *cmd;
+
+    idle = motion->idle;
+    cmd = idle ? motion->cfg.standby_cmd : motion->cfg.wake_cmd;
+    if (cmd && motion->dev)
+        ret = gps_send_command(motion->dev, cmd);
+
+    level = rt_hw_interrupt_disable();
+    if (ret != RT_EOK)
+        motion->power_retries++;
+    motion->power_pending = (ret != RT_EOK || motion->idle != idle);
+    rt_hw_interrupt_enable(level);
+}
+
+/**
+ * This function reports accelerometer activity, e.g. the deviation of the
+ * acceleration magnitude from 1 g. Activity above the threshold keeps the
+ * state moving and wakes an idle receiver.
+ */
+void gps_motion_accel(gps_motion_t motion, float activity)
+{
+    RT_ASSERT(motion);
+
+    rt_base_t level;
+
+    if (motion->cfg.accel_threshold <= 0.0f || activity < motion->cfg.accel_threshold)
+        return;
+
+    level = rt_hw_interrupt_disable();
+    motion->accel_tick = rt_tick_get();
+    motion->accel_active = RT_TRUE;
+    rt_hw_interrupt_enable(level);
+
+    /* a receiver in standby sends no fixes that could wake it */
+    if (motion->dev && motion->cfg.wake_cmd && motion_want(motion, RT_FALSE))
+        motion_power(motion);
+}
+
+static void motion_event(gps_motion_t motion, enum gps_motion_event event)
+{
+    if (event == GPS_MOTION_IDLE && motion_want(motion, RT_TRUE))
+        motion_power(motion);
+    else if (event == GPS_MOTION_START && motion_want(motion, RT_FALSE))
+        motion_power(motion);
+
+    if (motion->handler)
+        motion->handler(motion, event, motion->user_data);
+}
+
+/* standard deviation of the window positions, -1 until the window is full */
+static float motion_spread(gps_motion_t motion)
+{
+    float mx = 0.0f, my = 0.0f, var = 0.0f;
+    rt_uint8_t i, n = motion->count;
+
+    if (n < motion->cfg.window)
+        return -1.0f;
+
+    for (i = 0; i < n; i++)
+    {
+        mx += motion->x[i];
+        my += motion->y[i];
+    }
+    mx /= n;
+    my /= n;
+
+    for (i = 0; i < n; i++)
+    {
+        float dx = motion->x[i] - mx, dy = motion->y[i] - my;
+        var += dx * dx + dy * dy;
+    }
+
+    return sqrtf(var / n);
+}
+
+static void motion_push(gps_motion_t motion, const gps_fix_t *fix)
+{
+    float x = 0.0f, y = 0.0f;
+
+    if (motion->count)
+    {
+        x = (float)((fix->lon - motion->origin_lon) * motion->m_per_lon);
+        y = (float)((fix->lat - motion->origin_lat) * GPS_M_PER_DEG);
+    }
+
+    if (motion->count == 0 || fabsf(x) > WINDOW_RANGE || fabsf(y) > WINDOW_RANGE)
+    {
+        motion->origin_lat = fix->lat;
+        motion->origin_lon = fix->lon;
+        motion->m_per_lon = (float)(GPS_M_PER_DEG * cos(fix->lat * GPS_DEG2RAD));
+        motion->count = 0;
+        motion->head = 0;
+        x = y = 0.0f;
+    }
+
+    motion->x[motion->head] = x;
+    motion->y[motion->head] = y;
+    motion->head = (motion->head + 1) % motion->cfg.window;
+    if (motion->count < motion->cfg.window)
+        motion->count++;
+}
+
+static float motion_distance(double lat1, double lon1, double lat2, double lon2)
+{
+    double x = (lon2 - lon1) * GPS_M_PER_DEG * cos(lat1 * GPS_DEG2RAD);
+    double y = (lat2 - lat1) * GPS_M_PER_DEG;
+
+    return (float)sqrt(x * x + y * y);
+}
+
+/**
+ * This function updates the motion state with a fix
+ *
+ * @param motion the motion detector
+ * @param fix    a valid fix
+ *
+ * @return RT_TRUE if the fix should be reported, RT_FALSE if it only
+ *         repeats a stationary position
+ */
+rt_bool_t gps_motion_update(gps_motion_t motion, const gps_fix_t *fix)
+{
+    RT_ASSERT(motion);
+    RT_ASSERT(fix);
+
+    const struct gps_motion_config *cfg = &motion->cfg;
+    rt_bool_t report = RT_TRUE;
+    rt_bool_t accel;
+    rt_base_t level;
+    float spread;
+
+    if (motion->power_pending)
+        motion_power(motion);
+
+    motion_push(motion, fix);
+    spread = motion_spread(motion);
+
+    /* the activity may be newer than the fix */
+    level = rt_hw_interrupt_disable();
+    if (motion->accel_active &&
+        (rt_int32_t)(fix->tick - motion->accel_tick) >= (rt_int32_t)rt_tick_from_millisecond(cfg->accel_hold))
+        motion->accel_active = RT_FALSE;
+    accel = motion->accel_active;
+    rt_hw_interrupt_enable(level);
+
+    rt_bool_t moving = accel ||
+                       (cfg->speed_moving > 0.0f && fix->speed > cfg->speed_moving) ||
+                       (cfg->spread_still > 0.0f && spread > 2.0f * cfg->spread_still);
+    rt_bool_t still = !accel &&
+                      (cfg->speed_still <= 0.0f || fix->speed < cfg->speed_still) &&
+                      (cfg->spread_still <= 0.0f || (spread >= 0.0f && spread < cfg->spread_still));
+
+    if (motion->state != GPS_MOTION_STATIONARY && still)
+    {
+        motion->state = GPS_MOTION_STATIONARY;
+        motion->still_tick = fix->tick;
+        motion->stops++;
+        motion_event(motion, GPS_MOTION_STOP);
+    }
+    else if (motion->state != GPS_MOTION_MOVING && moving)
+    {
+        motion->state = GPS_MOTION_MOVING;
+        motion_event(motion, GPS_MOTION_START);
+    }
+    else if (motion->state == GPS_MOTION_STATIONARY)
+    {
+        report = RT_FALSE;
+
+        if (cfg->deadband > 0.0f && motion->reported &&
+            motion_distance(motion->report_lat, motion->report_lon, fix->lat, fix->lon) > cfg->deadband)
+            report = RT_TRUE;
+        if (cfg->heartbeat && fix->tick - motion->report_tick >= rt_tick_from_millisecond(cfg->heartbeat))
+            report = RT_TRUE;
+
+        if (cfg->idle && !motion->idle && fix->tick - motion->still_tick >= rt_tick_from_millisecond(cfg->idle))
+            motion_event(motion, GPS_MOTION_IDLE);
+    }
+
+    if (report)
+    {
+        motion->report_lat = fix->lat;
+        motion->report_lon = fix->lon;
+        motion->report_tick = fix->tick;
+        motion->reported = RT_TRUE;
+        motion->passed++;
+    }
+    else
+    {
+        motion->suppressed++;
+    }
+
+    return report;
+}
+
+/**
+ * This function is the publish stage adapter. Register it first with
+ * gps_add_stage(dev, gps_motion_stage, motion) so the later stages are
+ * skipped for suppressed fixes; those still become the device's last fix.
+ */
+rt_err_t gps_motion_stage(gps_device_t dev, gps_fix_t *fix, void *user_data)
+{
+    gps_motion_t motion = (gps_motion_t)user_data;
+
+    RT_ASSERT(motion);
+
+    motion->dev = dev;
+
+    if (!fix->status)
+        return RT_EOK;
+
+    return gps_motion_update(motion, fix) ? RT_EOK : GPS_STAGE_SUPPRESS;
+}
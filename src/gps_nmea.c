@@ -0,0 +1,452 @@
+/*
+ * Copyright (c) 2020, RudyLo <luhuadong@163.com>
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ *
+ * Change Logs:
+ * Date           Author       Notes
+ * 2026-10-19     luhuadong    the first version
+ */
+
+#include <rtthread.h>
+#include <string.h>
+#include "gps_nmea.h"
+
+#define KNOT2MPS             0.514444f
+#define KMH2MPS              (1.0f / 3.6f)
+
+static const char hex[16] = "0123456789ABCDEF";
+
+static int hex2int(char c)
+{
+    if (c >= '0' && c <= '9') return c - '0';
+    if (c >= 'A' && c <= 'F') return c - 'A' + 10;
+    if (c >= 'a' && c <= 'f') return c - 'a' + 10;
+
+    return -1;
+}
+
+/**
+ * This function verifies the checksum of a sentence
+ *
+ * @param line the sentence starting with '$', with or without CR/LF
+ * @param len  the length of the sentence
+ *
+ * @return RT_TRUE if the sentence has a valid "*hh" checksum
+ */
+rt_bool_t gps_nmea_check(const char *line, rt_size_t len)
+{
+    rt_uint8_t sum = 0;
+    rt_size_t i;
+
+    if (len < 4 || line[0] != '$')
+        return RT_FALSE;
+
+    for (i = 1; i < len && line[i] != '*'; i++)
+        sum ^= (rt_uint8_t)line[i];
+
+    if (i + 2 >= len)
+        return RT_FALSE;
+
+    int hi = hex2int(line[i + 1]);
+    int lo = hex2int(line[i + 2]);
+
+    return (hi >= 0 && lo >= 0 && sum == ((hi << 4) | lo)) ? RT_TRUE : RT_FALSE;
+}
+
+static enum gps_nmea_type nmea_type(const char *addr)
+{
+    /* "GPRMC", "GNRMC", "BDGSV", ..., "PMTK001" */
+    if (addr[0] == 'P')
+        return (strncmp(addr, "PMTK", 4) == 0) ? GPS_NMEA_PMTK : GPS_NMEA_UNKNOWN;
+
+    if (strlen(addr) != 5)
+        return GPS_NMEA_UNKNOWN;
+
+    switch (addr[2])
+    {
+    case 'R':
+        if (addr[3] == 'M' && addr[4] == 'C') return GPS_NMEA_RMC;
+        break;
+    case 'G':
+        if (addr[3] == 'G' && addr[4] == 'A') return GPS_NMEA_GGA;
+        if (addr[3] == 'S' && addr[4] == 'A') return GPS_NMEA_GSA;
+        if (addr[3] == 'S' && addr[4] == 'V') return GPS_NMEA_GSV;
+        if (addr[3] == 'L' && addr[4] == 'L') return GPS_NMEA_GLL;
+        break;
+    case 'V':
+        if (addr[3] == 'T' && addr[4] == 'G') return GPS_NMEA_VTG;
+        break;
+    case 'Z':
+        if (addr[3] == 'D' && addr[4] == 'A') return GPS_NMEA_ZDA;
+        break;
+    case 'T':
+        if (addr[3] == 'X' && addr[4] == 'T') return GPS_NMEA_TXT;
+        break;
+    default:
+        break;
+    }
+
+    return GPS_NMEA_UNKNOWN;
+}
+
+/**
+ * This function splits a checked sentence into fields. argv[0] is the
+ * address ("GNRMC"), the checksum is not part of the fields.
+ *
+ * @param line the sentence starting with '$'
+ * @param len  the length of the sentence
+ * @param tok  the token to fill
+ *
+ * @return RT_EOK on success, -RT_EFULL if the sentence is too long
+ */
+rt_err_t gps_nmea_tokenize(const char *line, rt_size_t len, struct gps_nmea_token *tok)
+{
+    RT_ASSERT(line);
+    RT_ASSERT(tok);
+
+    rt_size_t i;
+    char *p;
+
+    if (len == 0 || line[0] != '$')
+        return -RT_ERROR;
+    if (len > GPS_NMEA_LINE_SIZE)
+        return -RT_EFULL;
+
+    /* skip '$', stop at '*' or the line end */
+    for (i = 1; i < len && line[i] != '*' && line[i] != '\r' && line[i] != '\n'; i++)
+        tok->buf[i - 1] = line[i];
+    tok->buf[i - 1] = '\0';
+
+    tok->argc = 0;
+    tok->argv[tok->argc++] = tok->buf;
+    for (p = tok->buf; *p; p++)
+    {
+        if (*p == ',')
+        {
+            *p = '\0';
+            if (tok->argc < GPS_NMEA_FIELD_MAX)
+                tok->argv[tok->argc++] = p + 1;
+        }
+    }
+
+    tok->type = nmea_type(tok->argv[0]);
+
+    return RT_EOK;
+}
+
+/**
+ * This function parses a decimal number without the C library, "" gives 0
+ */
+double gps_nmea_atof(const char *s)
+{
+    rt_int32_t ipart = 0;
+    rt_uint32_t fpart = 0, scale = 1;
+    int neg = 0;
+
+    if (*s == '-')
+    {
+        neg = 1;
+        s++;
+    }
+
+    while (*s >= '0' && *s <= '9')
+        ipart = ipart * 10 + (*s++ - '0');
+
+    if (*s == '.')
+    {
+        s++;
+        /* 9 fraction digits keep the 32-bit accumulator exact */
+        while (*s >= '0' && *s <= '9' && scale < 1000000000UL)
+        {
+            fpart = fpart * 10 + (*s++ - '0');
+            scale *= 10;
+        }
+    }
+
+    double v = ipart + (double)fpart / scale;
+
+    return neg ? -v : v;
+}
+
+/**
+ * This function parses a decimal integer, "" gives 0
+ */
+rt_int32_t gps_nmea_atoi(const char *s)
+{
+    rt_int32_t v = 0;
+    int neg = 0;
+
+    if (*s == '-')
+    {
+        neg = 1;
+        s++;
+    }
+
+    while (*s >= '0' && *s <= '9')
+        v = v * 10 + (*s++ - '0');
+
+    return neg ? -v : v;
+}
+
+/* "ddmm.mmmm" or "dddmm.mmmm" and hemisphere to decimal degrees */
+static double nmea_coord(const char *s, const char *hemi)
+{
+    double v = gps_nmea_atof(s);
+    int deg = (int)(v / 100);
+    double deg_dec = deg + (v - deg * 100) / 60.0;
+
+    return (*hemi == 'S' || *hemi == 'W') ? -deg_dec : deg_dec;
+}
+
+/* "hhmmss.sss" to milliseconds of day */
+static rt_bool_t nmea_parse_time(const char *s, rt_uint32_t *time)
+{
+    rt_uint32_t ms = 0, scale = 100;
+    int i;
+
+    for (i = 0; i < 6; i++)
+    {
+        if (s[i] < '0' || s[i] > '9')
+            return RT_FALSE;
+    }
+
+    rt_uint32_t hh = (s[0] - '0') * 10 + (s[1] - '0');
+    rt_uint32_t mm = (s[2] - '0') * 10 + (s[3] - '0');
+    rt_uint32_t ss = (s[4] - '0') * 10 + (s[5] - '0');
+
+    if (s[6] == '.')
+    {
+        for (i = 7; s[i] >= '0' && s[i] <= '9' && scale; i++)
+        {
+            ms += (s[i] - '0') * scale;
+            scale /= 10;
+        }
+    }
+
+    *time = ((hh * 60 + mm) * 60 + ss) * 1000 + ms;
+
+    return RT_TRUE;
+}
+
+#define ARG(n)   ((n) < tok->argc ? tok->argv[n] : "")
+
+/**
+ * This function extracts the UTC time of a sentence, if it has one
+ */
+rt_bool_t gps_nmea_time(const struct gps_nmea_token *tok, rt_uint32_t *time)
+{
+    RT_ASSERT(tok);
+
+    switch (tok->type)
+    {
+    case GPS_NMEA_RMC:
+    case GPS_NMEA_GGA:
+    case GPS_NMEA_ZDA:
+        return nmea_parse_time(ARG(1), time);
+    case GPS_NMEA_GLL:
+        return nmea_parse_time(ARG(5), time);
+    default:
+        return RT_FALSE;
+    }
+}
+
+/**
+ * This function merges the fields of one sentence into a fix. Empty
+ * fields leave the fix untouched.
+ */
+void gps_nmea_apply(const struct gps_nmea_token *tok, gps_fix_t *fix)
+{
+    RT_ASSERT(tok);
+    RT_ASSERT(fix);
+
+    switch (tok->type)
+    {
+    case GPS_NMEA_RMC:
+        nmea_parse_time(ARG(1), &fix->time);
+        fix->status = (*ARG(2) == 'A') ? 1 : 0;
+        if (*ARG(3)) fix->lat = nmea_coord(ARG(3), ARG(4));
+        if (*ARG(5)) fix->lon = nmea_coord(ARG(5), ARG(6));
+        if (*ARG(7)) fix->speed = (float)gps_nmea_atof(ARG(7)) * KNOT2MPS;
+        if (*ARG(8)) fix->course = (float)gps_nmea_atof(ARG(8));
+        if (*ARG(9)) fix->date = (rt_uint32_t)gps_nmea_atoi(ARG(9));
+        break;
+
+    case GPS_NMEA_GGA:
+        nmea_parse_time(ARG(1), &fix->time);
+        if (*ARG(2)) fix->lat = nmea_coord(ARG(2), ARG(3));
+        if (*ARG(4)) fix->lon = nmea_coord(ARG(4), ARG(5));
+        fix->quality = (rt_uint8_t)gps_nmea_atoi(ARG(6));
+        fix->sats = (rt_uint8_t)gps_nmea_atoi(ARG(7));
+        if (*ARG(8)) fix->hdop = (float)gps_nmea_atof(ARG(8));
+        if (*ARG(9)) fix->alt = (float)gps_nmea_atof(ARG(9));
+        break;
+
+    case GPS_NMEA_GSA:
+        fix->mode = (rt_uint8_t)gps_nmea_atoi(ARG(2));
+        if (*ARG(15)) fix->pdop = (float)gps_nmea_atof(ARG(15));
+        if (*ARG(16)) fix->hdop = (float)gps_nmea_atof(ARG(16));
+        break;
+
+    case GPS_NMEA_VTG:
+        if (*ARG(1)) fix->course = (float)gps_nmea_atof(ARG(1));
+        if (*ARG(7))
+            fix->speed = (float)gps_nmea_atof(ARG(7)) * KMH2MPS;
+        else if (*ARG(5))
+            fix->speed = (float)gps_nmea_atof(ARG(5)) * KNOT2MPS;
+        break;
+
+    case GPS_NMEA_GLL:
+        if (*ARG(1)) fix->lat = nmea_coord(ARG(1), ARG(2));
+        if (*ARG(3)) fix->lon = nmea_coord(ARG(3), ARG(4));
+        nmea_parse_time(ARG(5), &fix->time);
+        fix->status = (*ARG(6) == 'A') ? 1 : 0;
+        break;
+
+    case GPS_NMEA_ZDA:
+        nmea_parse_time(ARG(1), &fix->time);
+        if (*ARG(2) && *ARG(3) && *ARG(4))
+        {
+            fix->date = (rt_uint32_t)gps_nmea_atoi(ARG(2)) * 10000 +
+                        (rt_uint32_t)gps_nmea_atoi(ARG(3)) * 100 +
+                        (rt_uint32_t)gps_nmea_atoi(ARG(4)) % 100;
+        }
+        break;
+
+    default:
+        break;
+    }
+}
+
+/**
+ * This function completes a command with checksum and CR/LF, the same
+ * framing the module expects from L76X_Send_Command()
+ *
+ * @param buf  the output buffer
+ * @param size the size of the output buffer
+ * @param cmd  the command, e.g. "$PMTK220,100"
+ *
+ * @return the length of the sentence, 0 if it does not fit
+ */
+rt_size_t gps_nmea_build(char *buf, rt_size_t size, const char *cmd)
+{
+    RT_ASSERT(buf);
+    RT_ASSERT(cmd);
+
+    rt_size_t len = strlen(cmd);
+    rt_uint8_t sum = 0;
+    rt_size_t i;
+
+    if (len < 2 || cmd[0] != '$' || len + 5 > size)
+        return 0;
+
+    for (i = 1; i < len; i++)
+        sum ^= (rt_uint8_t)cmd[i];
+
+    rt_memcpy(buf, cmd, len);
+    buf[len++] = '*';
+    buf[len++] = hex[sum >> 4];
+    buf[len++] = hex[sum & 0x0F];
+    buf[len++] = '\r';
+    buf[len++] = '\n';
+    if (len < size)
+        buf[len] = '\0';
+
+    return len;
+}
+
+/**
+ * This function initializes an epoch assembler
+ *
+ * @param epoch     the epoch assembler
+ * @param handler   called with every completed epoch
+ * @param user_data passed to the handler
+ */
+void gps_epoch_init(gps_epoch_t epoch, gps_epoch_handler_t handler, void *user_data)
+{
+    RT_ASSERT(epoch);
+
+    rt_memset(epoch, 0, sizeof(struct gps_epoch));
+    epoch->handler = handler;
+    epoch->user_data = user_data;
+}
+
+static void epoch_complete(gps_epoch_t epoch)
+{
+    gps_fix_t *fix = &epoch->fix;
+    rt_uint32_t date = fix->date;
+
+    if (epoch->timed)
+        fix->flags |= GPS_FIX_FLAG_TIMED;
+
+    /* without RMC/GLL the GGA quality is the only validity flag */
+    if (!(epoch->mask & (GPS_NMEA_BIT(GPS_NMEA_RMC) | GPS_NMEA_BIT(GPS_NMEA_GLL))))
+        fix->status = (fix->quality > 0) ? 1 : 0;
+
+    /* learn types of both epochs, forget those missing from both */
+    epoch->learned = (epoch->last_mask & epoch->mask) |
+                     (epoch->learned & (epoch->last_mask | epoch->mask));
+    epoch->last_mask = epoch->mask;
+
+    /* an epoch goes out once, whatever arrives after it */
+    if (!epoch->timed || !epoch->published || fix->time != epoch->last_time)
+    {
+        if (epoch->timed)
+        {
+            epoch->last_time = fix->time;
+            epoch->published = RT_TRUE;
+        }
+        epoch->epochs++;
+
+        if (epoch->handler)
+            epoch->handler(epoch, fix, epoch->user_data);
+    }
+
+    rt_memset(fix, 0, sizeof(gps_fix_t));
+    fix->date = date;
+    epoch->mask = 0;
+    epoch->timed = RT_FALSE;
+}
+
+/**
+ * This function feeds one sentence to the epoch assembler
+ */
+void gps_epoch_feed(gps_epoch_t epoch, const struct gps_nmea_token *tok)
+{
+    RT_ASSERT(epoch);
+    RT_ASSERT(tok);
+
+    rt_uint32_t time;
+
+    if (tok->type == GPS_NMEA_UNKNOWN || tok->type == GPS_NMEA_TXT || tok->type == GPS_NMEA_PMTK)
+        return;
+
+    if (gps_nmea_time(tok, &time))
+    {
+        /* the rest of an epoch that completed early */
+        if (epoch->published && time == epoch->last_time)
+        {
+            epoch->learned |= GPS_NMEA_BIT(tok->type);
+            epoch->last_mask |= GPS_NMEA_BIT(tok->type);
+            epoch->late++;
+            return;
+        }
+
+        if (epoch->mask && epoch->timed && time != epoch->fix.time)
+            epoch_complete(epoch);
+
+        epoch->timed = RT_TRUE;
+    }
+
+    if (epoch->mask == 0)
+        epoch->fix.rx_us = epoch->line_us;
+
+    gps_nmea_apply(tok, &epoch->fix);
+
+    /* a GSV group counts once its last part has arrived */
+    if (tok->type != GPS_NMEA_GSV || gps_nmea_atoi(ARG(1)) == gps_nmea_atoi(ARG(2)))
+        epoch->mask |= GPS_NMEA_BIT(tok->type);
+
+    if (epoch->learned && (epoch->mask & epoch->learned) == epoch->learned)
+        epoch_complete(epoch);
+}
@@ -0,0 +1,212 @@
+/*
+ * Copyright (c) 2020, RudyLo <luhuadong@163.com>
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ *
+ * Change Logs:
+ * Date           Author       Notes
+ * 2026-10-19     luhuadong    the first version
+ */
+
+#include <rtthread.h>
+#include "gps_pool.h"
+
+#define DBG_TAG "sensor.gps"
+#define DBG_LVL DBG_INFO
+#include <rtdbg.h>
+
+#define HEAD_INDEX(h)        ((rt_uint16_t)((h) & 0xFFFF))
+#define HEAD_MAKE(tag, i)    ((((rt_uint32_t)(tag) & 0xFFFF) << 16) | (i))
+
+/* ARMv6-M has no exclusive access, there the interrupt lock is cheaper */
+#if (defined(__GNUC__) || defined(__clang__)) && !defined(__ARM_ARCH_6M__)
+rt_inline rt_bool_t pool_cas(volatile rt_uint32_t *ptr, rt_uint32_t old, rt_uint32_t val)
+{
+    return __atomic_compare_exchange_n(ptr, &old, val, 0, __ATOMIC_ACQ_REL, __ATOMIC_ACQUIRE);
+}
+
+rt_inline rt_uint32_t pool_add(volatile rt_uint32_t *ptr, rt_int32_t v)
+{
+    return __atomic_add_fetch(ptr, v, __ATOMIC_ACQ_REL);
+}
+#else
+rt_inline rt_bool_t pool_cas(volatile rt_uint32_t *ptr, rt_uint32_t old, rt_uint32_t val)
+{
+    rt_base_t level = rt_hw_interrupt_disable();
+    rt_bool_t ret = (*ptr == old);
+
+    if (ret)
+        *ptr = val;
+    rt_hw_interrupt_enable(level);
+
+    return ret;
+}
+
+rt_inline rt_uint32_t pool_add(volatile rt_uint32_t *ptr, rt_int32_t v)
+{
+    rt_base_t level = rt_hw_interrupt_disable();
+    rt_uint32_t ret = (*ptr += v);
+
+    rt_hw_interrupt_enable(level);
+
+    return ret;
+}
+#endif
+
+/**
+ * This function initializes a pool on caller-provided records
+ *
+ * @param pool   the pool
+ * @param record the records, e.g. a static array
+ * @param num    the number of records, less than GPS_POOL_NONE
+ */
+void gps_pool_init(gps_pool_t pool, struct gps_fix_record *record, rt_uint16_t num)
+{
+    RT_ASSERT(pool);
+    RT_ASSERT(record);
+    RT_ASSERT(num > 0 && num < GPS_POOL_NONE);
+
+    rt_uint16_t i;
+
+    rt_memset(pool, 0, sizeof(struct gps_pool));
+    pool->record = record;
+    pool->num = num;
+
+    for (i = 0; i < num; i++)
+    {
+        record[i].pool = pool;
+        record[i].ref = 0;
+        record[i].next = (i + 1 < num) ? i + 1 : GPS_POOL_NONE;
+    }
+    pool->head = HEAD_MAKE(0, 0);
+}
+
+/**
+ * This function takes a free record, its reference count is one
+ *
+ * @return the record, RT_NULL if the pool is exhausted
+ */
+gps_fix_record_t gps_pool_alloc(gps_pool_t pool)
+{
+    RT_ASSERT(pool);
+
+    rt_uint32_t head, in_use, high;
+    rt_uint16_t i;
+
+    do
+    {
+        head = pool->head;
+        i = HEAD_INDEX(head);
+        if (i == GPS_POOL_NONE)
+        {
+            pool_add(&pool->exhausted, 1);
+            return RT_NULL;
+        }
+    } while (!pool_cas(&pool->head, head, HEAD_MAKE((head >> 16) + 1, pool->record[i].next)));
+
+    pool->record[i].ref = 1;
+    pool_add(&pool->allocs, 1);
+
+    in_use = pool_add(&pool->in_use, 1);
+    do
+    {
+        high = pool->high_water;
+    } while (in_use > high && !pool_cas(&pool->high_water, high, in_use));
+
+    return &pool->record[i];
+}
+
+/**
+ * This function takes another reference to a record
+ */
+void gps_pool_ref(gps_fix_record_t rec)
+{
+    RT_ASSERT(rec);
+    RT_ASSERT(rec->ref > 0);
+
+    pool_add(&rec->ref, 1);
+}
+
+/**
+ * This function drops a reference, the last one returns the record
+ */
+void gps_pool_put(gps_fix_record_t rec)
+{
+    RT_ASSERT(rec);
+    RT_ASSERT(rec->ref > 0);
+
+    gps_pool_t pool = rec->pool;
+    rt_uint16_t i = (rt_uint16_t)(rec - pool->record);
+    rt_uint32_t head;
+
+    if (pool_add(&rec->ref, -1) != 0)
+        return;
+
+    pool_add(&pool->in_use, -1);
+    do
+    {
+        head = pool->head;
+        rec->next = HEAD_INDEX(head);
+    } while (!pool_cas(&pool->head, head, HEAD_MAKE((head >> 16) + 1, i)));
+}
+
+/**
+ * This function registers a consumer of published records. Consumers are
+ * registered once at start-up, before fixes arrive.
+ *
+ * @return RT_EOK on success, -RT_EFULL if GPS_POOL_CONSUMER_MAX consumers exist
+ */
+rt_err_t gps_pool_add_consumer(gps_pool_t pool, gps_pool_consumer_t consumer, void *user_data)
+{
+    RT_ASSERT(pool);
+    RT_ASSERT(consumer);
+
+    if (pool->consumer_num >= GPS_POOL_CONSUMER_MAX)
+        return -RT_EFULL;
+
+    pool->consumer[pool->consumer_num].consumer = consumer;
+    pool->consumer[pool->consumer_num].user_data = user_data;
+    pool->consumer_num++;
+
+    return RT_EOK;
+}
+
+/**
+ * This function copies a fix into one record and hands that record to
+ * every consumer
+ *
+ * @return RT_EOK on success, -RT_EFULL if the pool is exhausted
+ */
+rt_err_t gps_pool_publish(gps_pool_t pool, const gps_fix_t *fix)
+{
+    RT_ASSERT(pool);
+    RT_ASSERT(fix);
+
+    gps_fix_record_t rec = gps_pool_alloc(pool);
+    rt_uint8_t i;
+
+    if (rec == RT_NULL)
+        return -RT_EFULL;
+
+    rec->fix = *fix;
+
+    for (i = 0; i < pool->consumer_num; i++)
+        pool->consumer[i].consumer(rec, pool->consumer[i].user_data);
+
+    gps_pool_put(rec);
+
+    return RT_EOK;
+}
+
+/**
+ * This function is the subscriber adapter, register it with
+ * gps_subscribe(dev, gps_pool_subscriber, pool)
+ */
+void gps_pool_subscriber(gps_device_t dev, const gps_fix_t *fix, void *user_data)
+{
+    gps_pool_t pool = (gps_pool_t)user_data;
+
+    RT_ASSERT(pool);
+
+    gps_pool_publish(pool, fix);
+}
@@ -0,0 +1,323 @@
+/*
+ * Copyright (c) 2020, RudyLo <luhuadong@163.com>
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ *
+ * Change Logs:
+ * Date           Author       Notes
+ * 2026-10-19     luhuadong    the first version
+ */
+
+#include <rtthread.h>
+#include <rtdevice.h>
+#include "gps_pps.h"
+#include "gps_barrier.h"
+
+#if defined(__linux__)
+#include <errno.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <time.h>
+#include <sys/ioctl.h>
+#include <linux/pps.h>
+#endif
+
+#define DBG_TAG "sensor.gps"
+#define DBG_LVL DBG_INFO
+#include <rtdbg.h>
+
+#define US_PER_SEC           1000000UL
+#define SEC_PER_DAY          86400UL
+
+/**
+ * This function initializes a PPS capture
+ */
+void gps_pps_init(gps_pps_t pps)
+{
+    RT_ASSERT(pps);
+
+    rt_memset(pps, 0, sizeof(struct gps_pps));
+    pps->pin = -1;
+    pps->latency_min = (rt_uint32_t)-1;
+#if defined(__linux__)
+    pps->fd = -1;
+#endif
+}
+
+/**
+ * This function records a PPS edge. Input capture interrupts call it with
+ * the captured time converted to the gps_time_us() base.
+ *
+ * @param pps the PPS capture
+ * @param us  the edge time
+ */
+void gps_pps_capture(gps_pps_t pps, rt_uint64_t us)
+{
+    if (pps->count)
+    {
+        rt_uint64_t period = us - pps->edge[(pps->count - 1) & 1];
+
+        if (period < GPS_PPS_PERIOD_MIN)
+        {
+            pps->glitches++;
+            return;
+        }
+        pps->period = (period <= GPS_PPS_PERIOD_MAX) ? (rt_uint32_t)period : 0;
+    }
+
+    gps_seq_write_begin(&pps->seq);
+
+    /* a missed edge breaks the count from edge to UTC second */
+    if (pps->count == 0 || pps->period == 0)
+        pps->chain = pps->count;
+
+    pps->edge[pps->count & 1] = us;
+    pps->count++;
+
+    gps_seq_write_end(&pps->seq);
+}
+
+static void pps_pin_isr(void *args)
+{
+    gps_pps_capture((gps_pps_t)args, gps_time_us());
+}
+
+/**
+ * This function captures PPS edges with a GPIO interrupt
+ *
+ * @param pps the PPS capture
+ * @param pin the pin connected to the module's 1PPS output
+ */
+rt_err_t gps_pps_attach_pin(gps_pps_t pps, rt_base_t pin)
+{
+    RT_ASSERT(pps);
+
+    rt_err_t ret;
+
+    rt_pin_mode(pin, PIN_MODE_INPUT);
+    ret = rt_pin_attach_irq(pin, PIN_IRQ_MODE_RISING, pps_pin_isr, pps);
+    if (ret != RT_EOK)
+    {
+        LOG_E("Can't attach PPS interrupt on pin %d", (int)pin);
+        return ret;
+    }
+
+    pps->pin = pin;
+
+    return rt_pin_irq_enable(pin, PIN_IRQ_ENABLE);
+}
+
+#if defined(__linux__)
+static void pps_linux_entry(void *parameter)
+{
+    gps_pps_t pps = (gps_pps_t)parameter;
+    struct pps_fdata fdata;
+    struct timespec now;
+    rt_uint32_t sequence = 0;
+
+    while (!pps->stop)
+    {
+        /* wait for the next edge, a second at most to see gps_pps_close() */
+        rt_memset(&fdata, 0, sizeof(fdata));
+        fdata.timeout.sec = 1;
+
+        if (ioctl(pps->fd, PPS_FETCH, &fdata) < 0)
+        {
+            if (errno != ETIMEDOUT && errno != EINTR)
+            {
+                LOG_E("PPS fetch failed");
+                rt_thread_mdelay(1000);
+            }
+            continue;
+        }
+
+        if (fdata.info.assert_sequence == sequence)
+            continue;
+        sequence = fdata.info.assert_sequence;
+
+        /* the kernel stamps CLOCK_REALTIME, move it to the gps_time_us() base */
+        clock_gettime(CLOCK_REALTIME, &now);
+        rt_int64_t edge = (rt_int64_t)fdata.info.assert_tu.sec * US_PER_SEC + fdata.info.assert_tu.nsec / 1000;
+        rt_int64_t real = (rt_int64_t)now.tv_sec * US_PER_SEC + now.tv_nsec / 1000;
+
+        gps_pps_capture(pps, gps_time_us() - (rt_uint64_t)(real - edge));
+    }
+
+    rt_sem_release(&pps->exited);
+}
+
+/**
+ * This function captures PPS edges from a Linux PPS device
+ *
+ * @param pps  the PPS capture
+ * @param path the device, e.g. "/dev/pps0"
+ */
+rt_err_t gps_pps_open(gps_pps_t pps, const char *path)
+{
+    RT_ASSERT(pps);
+    RT_ASSERT(path);
+
+    pps->fd = open(path, O_RDONLY);
+    if (pps->fd < 0)
+    {
+        LOG_E("Can't open '%s'", path);
+        return -RT_EIO;
+    }
+
+    pps->stop = RT_FALSE;
+    rt_sem_init(&pps->exited, "gps_ppx", 0, RT_IPC_FLAG_FIFO);
+
+    pps->tid = rt_thread_create("gps_pps", pps_linux_entry, pps, 2048, RT_THREAD_PRIORITY_MAX / 2 - 1, 10);
+    if (pps->tid == RT_NULL)
+    {
+        rt_sem_detach(&pps->exited);
+        close(pps->fd);
+        pps->fd = -1;
+        return -RT_ENOMEM;
+    }
+
+    return rt_thread_startup(pps->tid);
+}
+
+/**
+ * This function stops capturing from the Linux PPS device, it returns
+ * within a second when no edges come
+ *
+ * @param pps the PPS capture
+ */
+void gps_pps_close(gps_pps_t pps)
+{
+    RT_ASSERT(pps);
+
+    if (pps->tid == RT_NULL)
+        return;
+
+    pps->stop = RT_TRUE;
+    rt_sem_take(&pps->exited, RT_WAITING_FOREVER);
+    pps->tid = RT_NULL;
+
+    rt_sem_detach(&pps->exited);
+    close(pps->fd);
+    pps->fd = -1;
+}
+#endif /* __linux__ */
+
+/* UTC second of the day that edge n of the labelled chain started */
+static rt_uint32_t pps_edge_sec(gps_pps_t pps, rt_uint32_t n)
+{
+    return (pps->label_sec + (n - pps->label_edge)) % SEC_PER_DAY;
+}
+
+/**
+ * This function pairs a fix with the PPS edge of its UTC second and sets
+ * its epoch_us and latency
+ *
+ * @param pps the PPS capture
+ * @param fix a fix with rx_us and time set
+ *
+ * @return RT_EOK if the fix was stamped, -RT_EEMPTY if no edge matches
+ */
+rt_err_t gps_pps_stamp(gps_pps_t pps, gps_fix_t *fix)
+{
+    RT_ASSERT(pps);
+    RT_ASSERT(fix);
+
+    rt_uint64_t edge[2];
+    rt_uint32_t count, chain, n, seq;
+    rt_uint32_t sec = (fix->time / 1000) % SEC_PER_DAY;
+    rt_uint64_t offset = (fix->time % 1000) * 1000ULL;
+    rt_uint64_t epoch = 0;
+    int i;
+
+    do
+    {
+        seq = gps_seq_read_begin(&pps->seq);
+        count = pps->count;
+        chain = pps->chain;
+        edge[0] = pps->edge[0];
+        edge[1] = pps->edge[1];
+    } while (gps_seq_read_retry(&pps->seq, seq));
+
+    if (count == 0 || fix->rx_us == 0)
+        goto __unpaired;
+
+    /* the label only holds within the chain it was made in */
+    if (pps->labelled && (rt_int32_t)(pps->label_edge - chain) < 0)
+        pps->labelled = RT_FALSE;
+
+    /* edges count - 1 and count - 2, the second only if in the same chain */
+    for (i = 1; i <= 2 && pps->labelled; i++)
+    {
+        n = count - i;
+        if ((rt_int32_t)(n - chain) < 0)
+            break;
+
+        if (pps_edge_sec(pps, n) == sec)
+        {
+            epoch = edge[n & 1] + offset;
+            break;
+        }
+    }
+
+    /*
+     * rx_us can lag by a receive block, so a labelled match may be more
+     * than a second old; no match, one after the fix arrived or two
+     * seconds before it means the label is wrong.
+     */
+    if (pps->labelled && (epoch == 0 || epoch > fix->rx_us || fix->rx_us - epoch >= 2 * US_PER_SEC))
+    {
+        pps->labelled = RT_FALSE;
+        pps->relabels++;
+        epoch = 0;
+    }
+
+    /* label the chain with the newest edge preceding the fix by less than a second */
+    if (!pps->labelled)
+    {
+        for (i = 1; i <= 2 && (rt_uint32_t)i <= count; i++)
+        {
+            n = count - i;
+            if (edge[n & 1] + offset <= fix->rx_us && fix->rx_us - (edge[n & 1] + offset) < US_PER_SEC)
+            {
+                epoch = edge[n & 1] + offset;
+                pps->label_edge = n;
+                pps->label_sec = sec;
+                pps->labelled = ((rt_int32_t)(n - chain) >= 0) ? RT_TRUE : RT_FALSE;
+                break;
+            }
+        }
+    }
+
+    if (epoch)
+    {
+        fix->epoch_us = epoch;
+        fix->latency = (rt_uint32_t)(fix->rx_us - epoch);
+
+        if (fix->latency < pps->latency_min) pps->latency_min = fix->latency;
+        if (fix->latency > pps->latency_max) pps->latency_max = fix->latency;
+        pps->paired++;
+
+        return RT_EOK;
+    }
+
+__unpaired:
+    fix->epoch_us = 0;
+    pps->unpaired++;
+
+    return -RT_EEMPTY;
+}
+
+/**
+ * This function is the publish stage adapter, register it with
+ * gps_add_stage(dev, gps_pps_stage, pps). Unpaired fixes pass unstamped.
+ */
+rt_err_t gps_pps_stage(gps_device_t dev, gps_fix_t *fix, void *user_data)
+{
+    gps_pps_t pps = (gps_pps_t)user_data;
+
+    RT_ASSERT(pps);
+
+    gps_pps_stamp(pps, fix);
+
+    return RT_EOK;
+}
@@ -0,0 +1,479 @@
+/*
+ * Copyright (c) 2020, RudyLo <luhuadong@163.com>
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ *
+ * Change Logs:
+ * Date           Author       Notes
+ * 2026-10-19     luhuadong    the first version
+ */
+
+#include <rtthread.h>
+#include <math.h>
+#include "gps_proj.h"
+
+#define WGS84_EP2            (GPS_WGS84_E2 / (1.0 - GPS_WGS84_E2))
+#define WGS84_E              0.0818191908426214957   /* sqrt(E2) */
+
+/* Transverse mercator, Krueger series to third order in n */
+#define UTM_K0               0.9996
+#define UTM_FALSE_EASTING    500000.0
+#define UTM_FALSE_NORTHING   10000000.0
+#define UTM_N                (GPS_WGS84_F / (2.0 - GPS_WGS84_F))
+#define UTM_N2               (UTM_N * UTM_N)
+#define UTM_N3               (UTM_N2 * UTM_N)
+#define UTM_KA               (UTM_K0 * GPS_WGS84_A / (1.0 + UTM_N) * (1.0 + UTM_N2 / 4.0))
+
+static const double utm_alpha[3] =
+{
+    UTM_N / 2.0 - 2.0 / 3.0 * UTM_N2 + 5.0 / 16.0 * UTM_N3,
+    13.0 / 48.0 * UTM_N2 - 3.0 / 5.0 * UTM_N3,
+    61.0 / 240.0 * UTM_N3,
+};
+
+static const double utm_beta[3] =
+{
+    UTM_N / 2.0 - 2.0 / 3.0 * UTM_N2 + 37.0 / 96.0 * UTM_N3,
+    1.0 / 48.0 * UTM_N2 + 1.0 / 15.0 * UTM_N3,
+    17.0 / 480.0 * UTM_N3,
+};
+
+static const double utm_delta[3] =
+{
+    2.0 * UTM_N - 2.0 / 3.0 * UTM_N2 - 2.0 * UTM_N3,
+    7.0 / 3.0 * UTM_N2 - 8.0 / 5.0 * UTM_N3,
+    56.0 / 15.0 * UTM_N3,
+};
+
+static double wrap180(double deg)
+{
+    if (deg > 180.0)
+        deg -= 360.0;
+    else if (deg < -180.0)
+        deg += 360.0;
+
+    return deg;
+}
+
+/**
+ * This function converts geodetic coordinates to ECEF
+ *
+ * @param geo  latitude and longitude in decimal degrees
+ * @param alt  height above the ellipsoid in metres
+ * @param ecef the converted coordinates
+ */
+void gps_geo2ecef(const coord_t *geo, double alt, struct gps_ecef *ecef)
+{
+    RT_ASSERT(geo);
+    RT_ASSERT(ecef);
+
+    double sin_lat = sin(geo->lat * GPS_DEG2RAD);
+    double cos_lat = cos(geo->lat * GPS_DEG2RAD);
+    double sin_lon = sin(geo->lon * GPS_DEG2RAD);
+    double cos_lon = cos(geo->lon * GPS_DEG2RAD);
+    double rn = GPS_WGS84_A / sqrt(1.0 - GPS_WGS84_E2 * sin_lat * sin_lat);
+
+    ecef->x = (rn + alt) * cos_lat * cos_lon;
+    ecef->y = (rn + alt) * cos_lat * sin_lon;
+    ecef->z = (rn * (1.0 - GPS_WGS84_E2) + alt) * sin_lat;
+}
+
+/**
+ * This function converts ECEF to geodetic coordinates, closed form
+ * (Heikkinen), no iteration.
+ *
+ * @param ecef the cartesian coordinates
+ * @param geo  latitude and longitude in decimal degrees
+ * @param alt  height above the ellipsoid in metres, may be RT_NULL
+ */
+void gps_ecef2geo(const struct gps_ecef *ecef, coord_t *geo, double *alt)
+{
+    RT_ASSERT(ecef);
+    RT_ASSERT(geo);
+
+    const double a2 = GPS_WGS84_A * GPS_WGS84_A;
+    const double b2 = GPS_WGS84_B * GPS_WGS84_B;
+    const double e2 = GPS_WGS84_E2;
+    double z = ecef->z;
+    double z2 = z * z;
+    double p2 = ecef->x * ecef->x + ecef->y * ecef->y;
+    double p = sqrt(p2);
+
+    if (p < 1e-9)
+    {
+        /* on the polar axis */
+        geo->lat = (z >= 0.0) ? 90.0 : -90.0;
+        geo->lon = 0.0;
+        if (alt) *alt = fabs(z) - GPS_WGS84_B;
+        return;
+    }
+
+    double F = 54.0 * b2 * z2;
+    double G = p2 + (1.0 - e2) * z2 - e2 * (a2 - b2);
+    double c = e2 * e2 * F * p2 / (G * G * G);
+    double s = cbrt(1.0 + c + sqrt(c * c + 2.0 * c));
+    double k = s + 1.0 + 1.0 / s;
+    double P = F / (3.0 * k * k * G * G);
+    double Q = sqrt(1.0 + 2.0 * e2 * e2 * P);
+    double r0 = -P * e2 * p / (1.0 + Q)
+                + sqrt(a2 / 2.0 * (1.0 + 1.0 / Q)
+                       - P * (1.0 - e2) * z2 / (Q * (1.0 + Q))
+                       - P * p2 / 2.0);
+    double t = p - e2 * r0;
+    double U = sqrt(t * t + z2);
+    double V = sqrt(t * t + (1.0 - e2) * z2);
+    double z0 = b2 * z / (GPS_WGS84_A * V);
+
+    geo->lat = atan((z + WGS84_EP2 * z0) / p) * GPS_RAD2DEG;
+    geo->lon = atan2(ecef->y, ecef->x) * GPS_RAD2DEG;
+    if (alt) *alt = U * (1.0 - b2 / (GPS_WGS84_A * V));
+}
+
+/**
+ * This function sets the origin of a local tangent plane and caches every
+ * origin dependent constant.
+ *
+ * @param proj   the projection
+ * @param origin latitude and longitude of the origin in decimal degrees
+ * @param alt    height of the origin in metres
+ */
+void gps_proj_set_origin(gps_proj_t proj, const coord_t *origin, double alt)
+{
+    RT_ASSERT(proj);
+    RT_ASSERT(origin);
+
+    proj->origin = *origin;
+    proj->origin_alt = alt;
+    gps_geo2ecef(origin, alt, &proj->origin_ecef);
+
+    proj->sin_lat = sin(origin->lat * GPS_DEG2RAD);
+    proj->cos_lat = cos(origin->lat * GPS_DEG2RAD);
+    proj->sin_lon = sin(origin->lon * GPS_DEG2RAD);
+    proj->cos_lon = cos(origin->lon * GPS_DEG2RAD);
+
+    double w2 = 1.0 - GPS_WGS84_E2 * proj->sin_lat * proj->sin_lat;
+    proj->rn = GPS_WGS84_A / sqrt(w2);
+    proj->rm = proj->rn * (1.0 - GPS_WGS84_E2) / w2;
+
+    proj->k_east  = (proj->rn + alt) * proj->cos_lat * GPS_DEG2RAD;
+    proj->k_north = (proj->rm + alt) * GPS_DEG2RAD;
+    proj->k_up = 0.5 / (sqrt(proj->rn * proj->rm) + alt);
+
+    /* second order terms: d(k_east)/dlat, d(k_north)/dlat, east-north coupling */
+    double drn = proj->rn * GPS_WGS84_E2 * proj->sin_lat * proj->cos_lat / w2;
+    proj->k_east_lat = (drn * proj->cos_lat - (proj->rn + alt) * proj->sin_lat) * GPS_DEG2RAD * GPS_DEG2RAD;
+    proj->k_north_lat = 1.5 * proj->rm * GPS_WGS84_E2 * proj->sin_lat * proj->cos_lat / w2 * GPS_DEG2RAD * GPS_DEG2RAD;
+    proj->k_north_east = (fabs(proj->cos_lat) > 1e-9) ?
+                         0.5 * proj->sin_lat / (proj->cos_lat * (proj->rn + alt)) : 0.0;
+
+    proj->k_north_inv = 1.0 / proj->k_north;
+}
+
+/**
+ * This function rotates ECEF coordinates into the local ENU frame
+ */
+void gps_proj_ecef2enu(gps_proj_t proj, const struct gps_ecef *ecef, struct gps_enu *enu)
+{
+    RT_ASSERT(proj);
+    RT_ASSERT(ecef);
+    RT_ASSERT(enu);
+
+    double dx = ecef->x - proj->origin_ecef.x;
+    double dy = ecef->y - proj->origin_ecef.y;
+    double dz = ecef->z - proj->origin_ecef.z;
+    double t  = proj->cos_lon * dx + proj->sin_lon * dy;
+
+    enu->e = -proj->sin_lon * dx + proj->cos_lon * dy;
+    enu->n = -proj->sin_lat * t + proj->cos_lat * dz;
+    enu->u =  proj->cos_lat * t + proj->sin_lat * dz;
+}
+
+/**
+ * This function rotates local ENU coordinates back into ECEF
+ */
+void gps_proj_enu2ecef(gps_proj_t proj, const struct gps_enu *enu, struct gps_ecef *ecef)
+{
+    RT_ASSERT(proj);
+    RT_ASSERT(enu);
+    RT_ASSERT(ecef);
+
+    double t = -proj->sin_lat * enu->n + proj->cos_lat * enu->u;
+
+    ecef->x = proj->origin_ecef.x - proj->sin_lon * enu->e + proj->cos_lon * t;
+    ecef->y = proj->origin_ecef.y + proj->cos_lon * enu->e + proj->sin_lon * t;
+    ecef->z = proj->origin_ecef.z + proj->cos_lat * enu->n + proj->sin_lat * enu->u;
+}
+
+/**
+ * This function converts a geodetic fix to ENU, exact at any range
+ */
+void gps_proj_geo2enu(gps_proj_t proj, const coord_t *geo, double alt, struct gps_enu *enu)
+{
+    struct gps_ecef ecef;
+
+    gps_geo2ecef(geo, alt, &ecef);
+    gps_proj_ecef2enu(proj, &ecef, enu);
+}
+
+/**
+ * This function converts ENU back to a geodetic fix, exact at any range
+ */
+void gps_proj_enu2geo(gps_proj_t proj, const struct gps_enu *enu, coord_t *geo, double *alt)
+{
+    struct gps_ecef ecef;
+
+    gps_proj_enu2ecef(proj, enu, &ecef);
+    gps_ecef2geo(&ecef, geo, alt);
+}
+
+/**
+ * This function converts a geodetic fix to ENU with a second order tangent
+ * plane expansion around the origin. It uses no transcendental functions;
+ * the error is below 1 cm within 5 km of the origin.
+ */
+void gps_proj_geo2enu_fast(gps_proj_t proj, const coord_t *geo, double alt, struct gps_enu *enu)
+{
+    RT_ASSERT(proj);
+    RT_ASSERT(geo);
+    RT_ASSERT(enu);
+
+    double dlat = geo->lat - proj->origin.lat;
+    double dlon = wrap180(geo->lon - proj->origin.lon);
+    double e = dlon * (proj->k_east + proj->k_east_lat * dlat);
+    double n = dlat * (proj->k_north + proj->k_north_lat * dlat);
+
+    enu->e = e;
+    enu->n = n + e * e * proj->k_north_east;
+    enu->u = (alt - proj->origin_alt) - (e * e + n * n) * proj->k_up;
+}
+
+/**
+ * This function is the inverse of gps_proj_geo2enu_fast()
+ */
+void gps_proj_enu2geo_fast(gps_proj_t proj, const struct gps_enu *enu, coord_t *geo, double *alt)
+{
+    RT_ASSERT(proj);
+    RT_ASSERT(enu);
+    RT_ASSERT(geo);
+
+    double n = enu->n - enu->e * enu->e * proj->k_north_east;
+    double dlat = n * proj->k_north_inv;
+
+    /* one correction step for the quadratic meridian term */
+    dlat = n / (proj->k_north + proj->k_north_lat * dlat);
+    double k_east = proj->k_east + proj->k_east_lat * dlat;
+
+    geo->lat = proj->origin.lat + dlat;
+    geo->lon = wrap180(proj->origin.lon + ((k_east != 0.0) ? enu->e / k_east : 0.0));
+    if (alt) *alt = proj->origin_alt + enu->u + (enu->e * enu->e + n * n) * proj->k_up;
+}
+
+/**
+ * This function converts an array of fixes with gps_proj_geo2enu_fast()
+ *
+ * @param proj  the projection
+ * @param geo   the input fixes
+ * @param alt   the input heights, RT_NULL treats every fix as origin height
+ * @param enu   the output array, at least count elements
+ * @param count the number of fixes
+ *
+ * @return the number of converted fixes
+ */
+rt_size_t gps_proj_geo2enu_batch(gps_proj_t proj, const coord_t *geo, const double *alt,
+                                 struct gps_enu *enu, rt_size_t count)
+{
+    RT_ASSERT(proj);
+    RT_ASSERT(geo);
+    RT_ASSERT(enu);
+
+    const double lat0 = proj->origin.lat;
+    const double lon0 = proj->origin.lon;
+    const double k_e = proj->k_east;
+    const double k_el = proj->k_east_lat;
+    const double k_n = proj->k_north;
+    const double k_nl = proj->k_north_lat;
+    const double k_ne = proj->k_north_east;
+    const double k_u = proj->k_up;
+    rt_size_t i;
+
+    for (i = 0; i < count; i++)
+    {
+        double dlat = geo[i].lat - lat0;
+        double dlon = wrap180(geo[i].lon - lon0);
+        double e = dlon * (k_e + k_el * dlat);
+        double n = dlat * (k_n + k_nl * dlat);
+        double h = alt ? alt[i] - proj->origin_alt : 0.0;
+
+        enu[i].e = e;
+        enu[i].n = n + e * e * k_ne;
+        enu[i].u = h - (e * e + n * n) * k_u;
+    }
+
+    return count;
+}
+
+/**
+ * This function converts an array of ENU points with gps_proj_enu2geo_fast()
+ *
+ * @param alt the output heights, may be RT_NULL
+ *
+ * @return the number of converted points
+ */
+rt_size_t gps_proj_enu2geo_batch(gps_proj_t proj, const struct gps_enu *enu,
+                                 coord_t *geo, double *alt, rt_size_t count)
+{
+    rt_size_t i;
+
+    for (i = 0; i < count; i++)
+    {
+        gps_proj_enu2geo_fast(proj, &enu[i], &geo[i], alt ? &alt[i] : RT_NULL);
+    }
+
+    return count;
+}
+
+/**
+ * This function returns the standard UTM zone of a fix, including the
+ * Norway and Svalbard exceptions.
+ */
+rt_uint8_t gps_utm_zone(const coord_t *geo)
+{
+    RT_ASSERT(geo);
+
+    double lon = wrap180(geo->lon);
+    int zone = (int)floor((lon + 180.0) / 6.0) + 1;
+
+    if (zone > 60)
+        zone = 60;
+
+    if (geo->lat >= 56.0 && geo->lat < 64.0 && lon >= 3.0 && lon < 12.0)
+        zone = 32;
+
+    if (geo->lat >= 72.0 && geo->lat < 84.0)
+    {
+        if      (lon >= 0.0  && lon <  9.0) zone = 31;
+        else if (lon >= 9.0  && lon < 21.0) zone = 33;
+        else if (lon >= 21.0 && lon < 33.0) zone = 35;
+        else if (lon >= 33.0 && lon < 42.0) zone = 37;
+    }
+
+    return (rt_uint8_t)zone;
+}
+
+/**
+ * This function projects a fix into a given UTM zone. Forcing the zone
+ * keeps a track continuous when it crosses a zone boundary.
+ *
+ * @param geo  latitude and longitude in decimal degrees
+ * @param zone the UTM zone, 1 ~ 60
+ * @param utm  the grid coordinates
+ *
+ * @return RT_EOK on success, -RT_EINVAL if the fix is outside UTM coverage
+ */
+rt_err_t gps_geo2utm_zone(const coord_t *geo, rt_uint8_t zone, struct gps_utm *utm)
+{
+    RT_ASSERT(geo);
+    RT_ASSERT(utm);
+
+    if (zone < 1 || zone > 60 || geo->lat < -80.0 || geo->lat > 84.0)
+        return -RT_EINVAL;
+
+    double lon0 = zone * 6.0 - 183.0;
+    double dlon = wrap180(geo->lon - lon0) * GPS_DEG2RAD;
+    double sin_lat = sin(geo->lat * GPS_DEG2RAD);
+    double t = sinh(atanh(sin_lat) - WGS84_E * atanh(WGS84_E * sin_lat));
+    double xi = atan2(t, cos(dlon));
+    double eta = atanh(sin(dlon) / sqrt(1.0 + t * t));
+    double x = eta, y = xi;
+    int j;
+
+    for (j = 0; j < 3; j++)
+    {
+        double k = 2.0 * (j + 1);
+        x += utm_alpha[j] * cos(k * xi) * sinh(k * eta);
+        y += utm_alpha[j] * sin(k * xi) * cosh(k * eta);
+    }
+
+    utm->zone = zone;
+    utm->hemisphere = (geo->lat < 0.0) ? 'S' : 'N';
+    utm->easting = UTM_FALSE_EASTING + UTM_KA * x;
+    utm->northing = UTM_KA * y + ((geo->lat < 0.0) ? UTM_FALSE_NORTHING : 0.0);
+
+    return RT_EOK;
+}
+
+/**
+ * This function projects a fix into its own UTM zone
+ */
+rt_err_t gps_geo2utm(const coord_t *geo, struct gps_utm *utm)
+{
+    return gps_geo2utm_zone(geo, gps_utm_zone(geo), utm);
+}
+
+/**
+ * This function converts UTM grid coordinates back to a geodetic fix
+ *
+ * @return RT_EOK on success, -RT_EINVAL on an invalid zone or hemisphere
+ */
+rt_err_t gps_utm2geo(const struct gps_utm *utm, coord_t *geo)
+{
+    RT_ASSERT(utm);
+    RT_ASSERT(geo);
+
+    if (utm->zone < 1 || utm->zone > 60)
+        return -RT_EINVAL;
+    if (utm->hemisphere != 'N' && utm->hemisphere != 'S')
+        return -RT_EINVAL;
+
+    double northing = utm->northing - ((utm->hemisphere == 'S') ? UTM_FALSE_NORTHING : 0.0);
+    double xi = northing / UTM_KA;
+    double eta = (utm->easting - UTM_FALSE_EASTING) / UTM_KA;
+    double xi1 = xi, eta1 = eta;
+    int j;
+
+    for (j = 0; j < 3; j++)
+    {
+        double k = 2.0 * (j + 1);
+        xi1  -= utm_beta[j] * sin(k * xi) * cosh(k * eta);
+        eta1 -= utm_beta[j] * cos(k * xi) * sinh(k * eta);
+    }
+
+    double chi = asin(sin(xi1) / cosh(eta1));
+    double lat = chi;
+
+    for (j = 0; j < 3; j++)
+    {
+        lat += utm_delta[j] * sin(2.0 * (j + 1) * chi);
+    }
+
+    geo->lat = lat * GPS_RAD2DEG;
+    geo->lon = wrap180(utm->zone * 6.0 - 183.0 + atan2(sinh(eta1), cos(xi1)) * GPS_RAD2DEG);
+
+    return RT_EOK;
+}
+
+/**
+ * This function projects an array of fixes into one UTM zone
+ *
+ * @param zone the UTM zone, 0 uses the zone of the first fix
+ *
+ * @return the number of converted fixes, stops at the first invalid one
+ */
+rt_size_t gps_geo2utm_batch(const coord_t *geo, rt_uint8_t zone, struct gps_utm *utm, rt_size_t count)
+{
+    rt_size_t i;
+
+    if (count == 0)
+        return 0;
+
+    if (zone == 0)
+        zone = gps_utm_zone(&geo[0]);
+
+    for (i = 0; i < count; i++)
+    {
+        if (gps_geo2utm_zone(&geo[i], zone, &utm[i]) != RT_EOK)
+            break;
+    }
+
+    return i;
+}
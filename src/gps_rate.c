@@ -0,0 +1,386 @@
+/*
+ * Copyright (c) 2020, RudyLo <luhuadong@163.com>
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ *
+ * Change Logs:
+ * Date           Author       Notes
+ * 2026-10-19     luhuadong    the first version
+ */
+
+#include <rtthread.h>
+#include <math.h>
+#include "gps_rate.h"
+
+#define DBG_TAG "sensor.gps"
+#define DBG_LVL DBG_INFO
+#include <rtdbg.h>
+
+#define SPEED_COURSE_MIN     1.0f    /* m/s, below it the course is noise */
+
+#define OUTPUT_DEFAULT       "$PMTK314,-1"
+#define OUTPUT_RMC_GGA_GSA   "$PMTK314,0,1,0,1,1,0,0,0,0,0,0,0,0,0,0,0,0,0,0"
+
+#define RATE_WORKER_PRIORITY (RT_THREAD_PRIORITY_MAX / 2 + 1)
+
+/*
+ * 10 Hz with RMC, GGA and GSA is about 2.2 KB/s, beyond 9600 baud, so the
+ * dynamic level also raises the baud rate and the others lower it again.
+ */
+static const struct gps_rate_config rate_default =
+{
+    .plan =
+    {
+        [GPS_RATE_STOPPED] = { 10000, 9600,  OUTPUT_DEFAULT },
+        [GPS_RATE_CRUISE]  = { 1000,  9600,  OUTPUT_DEFAULT },
+        [GPS_RATE_DYNAMIC] = { 100,   38400, OUTPUT_RMC_GGA_GSA },
+    },
+    .stop_speed = 0.5f,
+    .fast_speed = 20.0f,
+    .turn_rate  = 10.0f,
+    .hysteresis = 0.2f,
+    .hold       = 5000,
+    .min_gap    = 3000,
+};
+
+static const char *level_name[GPS_RATE_LEVEL_NUM] = { "stopped", "cruise", "dynamic" };
+
+/**
+ * This function initializes a rate controller. The receiver is assumed to
+ * run the cruise plan; call gps_rate_apply() to make sure it does.
+ *
+ * @param rate the rate controller
+ * @param cfg  the plans and thresholds, RT_NULL for defaults
+ */
+void gps_rate_init(gps_rate_t rate, const struct gps_rate_config *cfg)
+{
+    RT_ASSERT(rate);
+
+    int i;
+
+    rt_memset(rate, 0, sizeof(struct gps_rate));
+    rate->cfg = cfg ? *cfg : rate_default;
+    rate->level = GPS_RATE_CRUISE;
+
+    for (i = 0; i < GPS_RATE_LEVEL_NUM; i++)
+        RT_ASSERT(rate->cfg.plan[i].baudrate);
+    rate->baudrate = rate->cfg.plan[GPS_RATE_CRUISE].baudrate;
+}
+
+static rt_err_t rate_set_baudrate(gps_rate_t rate, gps_device_t dev, rt_uint32_t baudrate)
+{
+    rt_err_t ret;
+
+    if (baudrate == rate->baudrate)
+        return RT_EOK;
+
+    rate->commands++;
+    ret = gps_set_baudrate(dev, baudrate);
+    if (ret == RT_EOK)
+        rate->baudrate = baudrate;
+
+    return ret;
+}
+
+static rt_err_t rate_set_output(gps_rate_t rate, gps_device_t dev, const char *output)
+{
+    if (output == RT_NULL)
+        return RT_EOK;
+
+    rate->commands++;
+    return gps_set_output(dev, output);
+}
+
+/**
+ * This function switches the receiver to the plan of a level. When the
+ * rate goes up the link is widened first, when it goes down it is
+ * narrowed last, so the UART never carries more than it can. It waits
+ * for each acknowledge, so call it from a thread, never from a stage or
+ * subscriber; gps_rate_start() runs it in a worker.
+ *
+ * @return RT_EOK if every command succeeded and the level was taken,
+ *         otherwise the error of the failed command and the level is kept
+ */
+rt_err_t gps_rate_apply(gps_rate_t rate, gps_device_t dev, enum gps_rate_level level)
+{
+    RT_ASSERT(rate);
+    RT_ASSERT(dev);
+    RT_ASSERT(level < GPS_RATE_LEVEL_NUM);
+
+    const struct gps_rate_plan *plan = &rate->cfg.plan[level];
+    rt_bool_t faster = (plan->interval < rate->cfg.plan[rate->level].interval) ? RT_TRUE : RT_FALSE;
+    rt_err_t ret;
+
+    if (faster)
+    {
+        ret = rate_set_baudrate(rate, dev, plan->baudrate);
+        if (ret == RT_EOK)
+            ret = rate_set_output(rate, dev, plan->output);
+        if (ret == RT_EOK)
+        {
+            rate->commands++;
+            ret = gps_set_rate(dev, plan->interval);
+        }
+    }
+    else
+    {
+        rate->commands++;
+        ret = gps_set_rate(dev, plan->interval);
+        if (ret == RT_EOK)
+            ret = rate_set_output(rate, dev, plan->output);
+        if (ret == RT_EOK)
+            ret = rate_set_baudrate(rate, dev, plan->baudrate);
+    }
+
+    /* a failed change is retried after the minimum gap */
+    rt_enter_critical();
+    if (ret == RT_EOK)
+    {
+        if (level != rate->level)
+            rate->changes++;
+        rate->level = level;
+        rate->wanting = RT_FALSE;
+    }
+    else
+    {
+        rate->failures++;
+    }
+    rate->change_tick = rt_tick_get();
+    rt_exit_critical();
+
+    if (ret != RT_EOK)
+        LOG_W("fix rate %s -> %s failed (%d)", level_name[rate->level], level_name[level], (int)ret);
+
+    return ret;
+}
+
+static enum gps_rate_level rate_wanted(gps_rate_t rate, float speed, float turn)
+{
+    const struct gps_rate_config *cfg = &rate->cfg;
+    float fast = cfg->fast_speed, turning = cfg->turn_rate, stop = cfg->stop_speed;
+
+    /* thresholds move away from the current level */
+    if (rate->level == GPS_RATE_DYNAMIC)
+    {
+        fast *= 1.0f - cfg->hysteresis;
+        turning *= 1.0f - cfg->hysteresis;
+    }
+    else if (rate->level == GPS_RATE_STOPPED)
+    {
+        stop *= 1.0f + cfg->hysteresis;
+    }
+
+    if ((fast > 0.0f && speed > fast) || (turning > 0.0f && turn > turning))
+        return GPS_RATE_DYNAMIC;
+    if (speed < stop)
+        return GPS_RATE_STOPPED;
+
+    return GPS_RATE_CRUISE;
+}
+
+/**
+ * This function accounts a fix and decides the level
+ *
+ * @param rate the rate controller
+ * @param fix  a valid fix
+ *
+ * @return the level the receiver should run at, apply it with
+ *         gps_rate_apply() if it differs from rate->level
+ */
+enum gps_rate_level gps_rate_update(gps_rate_t rate, const gps_fix_t *fix)
+{
+    RT_ASSERT(rate);
+    RT_ASSERT(fix);
+
+    const struct gps_rate_config *cfg = &rate->cfg;
+    float turn = 0.0f;
+    enum gps_rate_level wanted;
+
+    if (rate->started)
+    {
+        rt_uint32_t dt = (fix->tick - rate->last_tick) * 1000 / RT_TICK_PER_SECOND;
+
+        rate->time[rate->level] += dt;
+
+        if (dt && fix->speed > SPEED_COURSE_MIN)
+        {
+            float dc = fix->course - rate->last_course;
+
+            if (dc > 180.0f) dc -= 360.0f;
+            else if (dc < -180.0f) dc += 360.0f;
+            turn = fabsf(dc) * 1000.0f / dt;
+        }
+    }
+
+    rate->fixes[rate->level]++;
+    rate->last_course = fix->course;
+    rate->last_tick = fix->tick;
+    rate->started = RT_TRUE;
+
+    wanted = rate_wanted(rate, fix->speed, turn);
+
+    if (wanted == rate->level)
+    {
+        rate->wanting = RT_FALSE;
+        return wanted;
+    }
+
+    if (fix->tick - rate->change_tick < rt_tick_from_millisecond(cfg->min_gap))
+        return rate->level;
+
+    if (wanted > rate->level)
+        return wanted;
+
+    if (!rate->wanting)
+    {
+        rate->wanting = RT_TRUE;
+        rate->want_tick = fix->tick;
+    }
+
+    if (fix->tick - rate->want_tick >= rt_tick_from_millisecond(cfg->hold))
+        return wanted;
+
+    return rate->level;
+}
+
+static void rate_subscriber(gps_device_t dev, const gps_fix_t *fix, void *user_data)
+{
+    gps_rate_t rate = (gps_rate_t)user_data;
+    enum gps_rate_level level;
+    rt_bool_t post = RT_FALSE;
+
+    if (!fix->status)
+        return;
+
+    /* decide here, the commands wait for acknowledges the dispatcher parses */
+    rt_enter_critical();
+    level = gps_rate_update(rate, fix);
+    if (level != rate->level && !rate->applying)
+    {
+        rate->target = level;
+        rate->applying = RT_TRUE;
+        post = RT_TRUE;
+    }
+    rt_exit_critical();
+
+    if (post)
+        rt_sem_release(&rate->request);
+}
+
+static void rate_worker_entry(void *parameter)
+{
+    gps_rate_t rate = (gps_rate_t)parameter;
+
+    while (1)
+    {
+        rt_sem_take(&rate->request, RT_WAITING_FOREVER);
+        if (rate->quit)
+            break;
+
+        LOG_D("fix rate %s -> %s", level_name[rate->level], level_name[rate->target]);
+        gps_rate_apply(rate, rate->dev, rate->target);
+
+        rt_enter_critical();
+        rate->applying = RT_FALSE;
+        rt_exit_critical();
+    }
+
+    rt_sem_release(&rate->exited);
+}
+
+/**
+ * This function starts the worker thread and subscribes the controller to
+ * the device's fixes
+ *
+ * @param rate the rate controller, initialized by gps_rate_init()
+ * @param dev  the gps device
+ *
+ * @return RT_EOK on success
+ */
+rt_err_t gps_rate_start(gps_rate_t rate, gps_device_t dev)
+{
+    RT_ASSERT(rate);
+    RT_ASSERT(dev);
+
+    rt_err_t ret;
+
+    rate->dev = dev;
+    rate->quit = RT_FALSE;
+    rate->applying = RT_FALSE;
+    rt_sem_init(&rate->request, "gps_rate", 0, RT_IPC_FLAG_FIFO);
+    rt_sem_init(&rate->exited, "gps_rtx", 0, RT_IPC_FLAG_FIFO);
+
+    rate->worker = rt_thread_create("gps_rate", rate_worker_entry, rate, 1024, RATE_WORKER_PRIORITY, 10);
+    if (rate->worker == RT_NULL)
+    {
+        ret = -RT_ENOMEM;
+        goto __detach;
+    }
+    rt_thread_startup(rate->worker);
+
+    ret = gps_subscribe(dev, rate_subscriber, rate);
+    if (ret != RT_EOK)
+    {
+        rate->quit = RT_TRUE;
+        rt_sem_release(&rate->request);
+        rt_sem_take(&rate->exited, RT_WAITING_FOREVER);
+        goto __detach;
+    }
+
+    return RT_EOK;
+
+__detach:
+    rate->worker = RT_NULL;
+    rt_sem_detach(&rate->request);
+    rt_sem_detach(&rate->exited);
+
+    return ret;
+}
+
+/**
+ * This function unsubscribes the controller and stops its worker after a
+ * transition in progress. The receiver keeps the plan it runs.
+ */
+void gps_rate_stop(gps_rate_t rate)
+{
+    RT_ASSERT(rate);
+
+    if (rate->worker == RT_NULL)
+        return;
+
+    gps_unsubscribe(rate->dev, rate_subscriber, rate);
+
+    rate->quit = RT_TRUE;
+    rt_sem_release(&rate->request);
+    rt_sem_take(&rate->exited, RT_WAITING_FOREVER);
+
+    rate->worker = RT_NULL;
+    rt_sem_detach(&rate->request);
+    rt_sem_detach(&rate->exited);
+}
+
+/**
+ * This function prints the time spent at each level
+ */
+void gps_rate_dump(gps_rate_t rate)
+{
+    RT_ASSERT(rate);
+
+    rt_uint64_t total = 0;
+    int i;
+
+    for (i = 0; i < GPS_RATE_LEVEL_NUM; i++)
+        total += rate->time[i];
+    if (total == 0)
+        total = 1;
+
+    rt_kprintf("level     interval      fixes      time(s)  share\n");
+    for (i = 0; i < GPS_RATE_LEVEL_NUM; i++)
+    {
+        rt_kprintf("%-8s  %6d ms  %9d  %11d  %3d%%\n", level_name[i],
+                   (int)rate->cfg.plan[i].interval, (int)rate->fixes[i],
+                   (int)(rate->time[i] / 1000), (int)(rate->time[i] * 100 / total));
+    }
+    rt_kprintf("level changes %d, commands %d, failed changes %d\n",
+               (int)rate->changes, (int)rate->commands, (int)rate->failures);
+}
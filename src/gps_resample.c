@@ -0,0 +1,262 @@
+/*
+ * Copyright (c) 2020, RudyLo <luhuadong@163.com>
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ *
+ * Change Logs:
+ * Date           Author       Notes
+ * 2026-10-19     luhuadong    the first version
+ */
+
+#include <rtthread.h>
+#include <math.h>
+#include "gps_resample.h"
+#include "gps_barrier.h"
+
+static rt_int32_t tick2ms(rt_int32_t tick)
+{
+    return (rt_int32_t)((rt_int64_t)tick * 1000 / RT_TICK_PER_SECOND);
+}
+
+/**
+ * This function initializes a resampler
+ *
+ * @param rs      the resampler
+ * @param latency the milliseconds between a fix's epoch and its
+ *                publication, subtracted from the fix tick
+ */
+void gps_resample_init(gps_resample_t rs, rt_uint32_t latency)
+{
+    RT_ASSERT(rs);
+
+    rt_memset(rs, 0, sizeof(struct gps_resample));
+    rs->latency = latency;
+    rs->extrapolate_max = GPS_RESAMPLE_EXTRAPOLATE_MAX;
+}
+
+/**
+ * This function publishes a new fix to the readers. There must be only
+ * one writer, normally the gps receive thread.
+ */
+void gps_resample_update(gps_resample_t rs, const gps_fix_t *fix)
+{
+    RT_ASSERT(rs);
+    RT_ASSERT(fix);
+
+    const struct gps_resample_slot *cur = &rs->slot[rs->index];
+    struct gps_resample_slot *next = &rs->slot[rs->index ^ 1];
+    double course = fix->course * GPS_DEG2RAD;
+
+    gps_seq_write_begin(&next->seq);
+
+    next->has_prev = (cur->seq != 0) ? RT_TRUE : RT_FALSE;
+    next->lat[0] = cur->lat[1];
+    next->lon[0] = cur->lon[1];
+    next->tick[0] = cur->tick[1];
+    next->lat[1] = fix->lat;
+    next->lon[1] = fix->lon;
+    next->tick[1] = fix->tick - rt_tick_from_millisecond(rs->latency);
+    next->ve = fix->speed * (float)sin(course);
+    next->vn = fix->speed * (float)cos(course);
+    next->sigma = gps_fix_sigma(fix, GPS_UERE);
+    next->m_per_lon = (float)(GPS_M_PER_DEG * cos(fix->lat * GPS_DEG2RAD));
+
+    gps_seq_write_end(&next->seq);
+
+    /* the slot is complete before readers can pick it */
+    gps_wmb();
+    rs->index ^= 1;
+    rs->updates++;
+}
+
+/**
+ * This function gives the position at any time, interpolated between the
+ * last two fixes or dead reckoned from the newest. It never blocks.
+ *
+ * @param rs     the resampler
+ * @param tick   the requested time, rt_tick_get() base
+ * @param sample the result
+ *
+ * @return RT_EOK on success, -RT_ETIMEOUT if the sample is stale,
+ *         -RT_EEMPTY if no fix has been received yet
+ */
+rt_err_t gps_resample_at(gps_resample_t rs, rt_tick_t tick, struct gps_resample_sample *sample)
+{
+    RT_ASSERT(rs);
+    RT_ASSERT(sample);
+
+    struct gps_resample_slot s;
+    rt_uint32_t seq;
+
+    while (1)
+    {
+        const struct gps_resample_slot *slot = &rs->slot[rs->index];
+
+        seq = gps_seq_read_begin(&slot->seq);
+        s = *slot;
+        if (!gps_seq_read_retry(&slot->seq, seq))
+            break;
+
+        /* the writer overtook us, it has finished by now */
+        gps_atomic_add(&rs->retries, 1);
+    }
+
+    rt_memset(sample, 0, sizeof(struct gps_resample_sample));
+    sample->tick = tick;
+
+    if (seq == 0)
+        return -RT_EEMPTY;
+
+    rt_int32_t dt = tick2ms((rt_int32_t)(tick - s.tick[1]));
+    rt_int32_t span = tick2ms((rt_int32_t)(s.tick[1] - s.tick[0]));
+    double lat, lon;
+    float ve = s.ve, vn = s.vn;
+
+    if (dt < 0 && s.has_prev && span > 0 && -dt <= span)
+    {
+        double f = (double)(span + dt) / span;
+
+        lat = s.lat[0] + (s.lat[1] - s.lat[0]) * f;
+        lon = s.lon[0] + (s.lon[1] - s.lon[0]) * f;
+        sample->sigma = s.sigma;
+        sample->mode = GPS_RESAMPLE_INTERPOLATED;
+    }
+    else
+    {
+        float t = dt * 0.001f;
+
+        lat = s.lat[1] + vn * t / GPS_M_PER_DEG;
+        lon = s.lon[1] + ((s.m_per_lon > 0.0f) ? ve * t / s.m_per_lon : 0.0);
+        if (lon > 180.0) lon -= 360.0;
+        else if (lon < -180.0) lon += 360.0;
+
+        sample->sigma = s.sigma + 0.5f * GPS_RESAMPLE_ACCEL * t * t;
+        sample->age = (dt < 0) ? -dt : dt;
+        sample->mode = (sample->age > rs->extrapolate_max) ? GPS_RESAMPLE_STALE : GPS_RESAMPLE_EXTRAPOLATED;
+    }
+
+    sample->lat = lat;
+    sample->lon = lon;
+    sample->speed = sqrtf(ve * ve + vn * vn);
+    sample->course = (float)(atan2(ve, vn) * GPS_RAD2DEG);
+    if (sample->course < 0.0f)
+        sample->course += 360.0f;
+
+    return (sample->mode == GPS_RESAMPLE_STALE) ? -RT_ETIMEOUT : RT_EOK;
+}
+
+static void resample_timeout(void *parameter)
+{
+    gps_resample_t rs = (gps_resample_t)parameter;
+    struct gps_resample_sample sample;
+    gps_resample_handler_t handler;
+    void *user_data;
+    rt_base_t level;
+    rt_bool_t wake;
+
+    /* gps_resample_stop() may be clearing the handler meanwhile */
+    level = rt_hw_interrupt_disable();
+    handler = rs->handler;
+    user_data = rs->user_data;
+    rs->running = (handler != RT_NULL) ? RT_TRUE : RT_FALSE;
+    rt_hw_interrupt_enable(level);
+
+    if (handler == RT_NULL)
+        return;
+
+    gps_resample_at(rs, rt_tick_get(), &sample);
+    handler(rs, &sample, user_data);
+
+    level = rt_hw_interrupt_disable();
+    rs->running = RT_FALSE;
+    wake = rs->stop_wait;
+    rs->stop_wait = RT_FALSE;
+    rt_hw_interrupt_enable(level);
+
+    if (wake)
+        rt_sem_release(&rs->idle);
+}
+
+/**
+ * This function serves samples at a fixed rate. The handler runs in the
+ * soft timer thread and must not block, it delays the other soft timers.
+ *
+ * @param rs        the resampler
+ * @param period    the sample period in milliseconds, e.g. 20 for 50 Hz
+ * @param handler   called with every sample
+ * @param user_data passed to the handler
+ *
+ * @return RT_EOK on success, -RT_ENOSYS without RT_USING_TIMER_SOFT, where
+ *         the handler would run in the tick interrupt
+ */
+rt_err_t gps_resample_start(gps_resample_t rs, rt_uint32_t period, gps_resample_handler_t handler, void *user_data)
+{
+    RT_ASSERT(rs);
+    RT_ASSERT(handler);
+
+#ifndef RT_USING_TIMER_SOFT
+    return -RT_ENOSYS;
+#else
+    rt_tick_t ticks = rt_tick_from_millisecond(period);
+
+    if (ticks == 0)
+        return -RT_EINVAL;
+
+    rs->running = RT_FALSE;
+    rs->stop_wait = RT_FALSE;
+    rs->user_data = user_data;
+    rs->handler = handler;
+    rt_sem_init(&rs->idle, "gps_rs", 0, RT_IPC_FLAG_FIFO);
+    rt_timer_init(&rs->timer, "gps_rs", resample_timeout, rs, ticks,
+                  RT_TIMER_FLAG_PERIODIC | RT_TIMER_FLAG_SOFT_TIMER);
+
+    return rt_timer_start(&rs->timer);
+#endif
+}
+
+/**
+ * This function stops the samples. A handler already running is waited
+ * for, so do not call it from the handler.
+ */
+void gps_resample_stop(gps_resample_t rs)
+{
+    RT_ASSERT(rs);
+
+    gps_resample_handler_t handler;
+    rt_base_t level;
+    rt_bool_t wait = RT_FALSE;
+
+    level = rt_hw_interrupt_disable();
+    handler = rs->handler;
+    rs->handler = RT_NULL;
+    if (handler && rs->running)
+    {
+        rs->stop_wait = RT_TRUE;
+        wait = RT_TRUE;
+    }
+    rt_hw_interrupt_enable(level);
+
+    if (handler == RT_NULL)
+        return;
+
+    rt_timer_stop(&rs->timer);
+    if (wait)
+        rt_sem_take(&rs->idle, RT_WAITING_FOREVER);
+    rt_timer_detach(&rs->timer);
+    rt_sem_detach(&rs->idle);
+}
+
+/**
+ * This function is the subscriber adapter, register it with
+ * gps_subscribe(dev, gps_resample_subscriber, rs). Behind
+ * gps_filter_stage the resampler works from the filter state.
+ */
+void gps_resample_subscriber(gps_device_t dev, const gps_fix_t *fix, void *user_data)
+{
+    gps_resample_t rs = (gps_resample_t)user_data;
+
+    RT_ASSERT(rs);
+
+    if (fix->status)
+        gps_resample_update(rs, fix);
+}
@@ -0,0 +1,238 @@
+/*
+ * Copyright (c) 2020, RudyLo <luhuadong@163.com>
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ *
+ * Change Logs:
+ * Date           Author       Notes
+ * 2026-10-19     luhuadong    the first version
+ */
+
+#include <rtthread.h>
+#include <math.h>
+#include "gps_simplify.h"
+
+#define DBG_TAG "sensor.gps"
+#define DBG_LVL DBG_INFO
+#include <rtdbg.h>
+
+/* squared distance from (x, y) to the segment from the origin to (sx, sy) */
+static float segment_dist2(float x, float y, float sx, float sy)
+{
+    float len2 = sx * sx + sy * sy;
+    float t = 0.0f;
+
+    if (len2 > 0.0f)
+    {
+        t = (x * sx + y * sy) / len2;
+        if (t < 0.0f) t = 0.0f;
+        else if (t > 1.0f) t = 1.0f;
+    }
+
+    x -= t * sx;
+    y -= t * sy;
+
+    return x * x + y * y;
+}
+
+static void simplify_emit(gps_simplify_t simplify, const gps_fix_t *fix)
+{
+    simplify->out++;
+
+    if (simplify->handler)
+        simplify->handler(simplify, fix, simplify->user_data);
+}
+
+static void simplify_set_anchor(gps_simplify_t simplify, const gps_fix_t *fix)
+{
+    simplify->anchor = *fix;
+    simplify->m_per_lon = GPS_M_PER_DEG * cos(fix->lat * GPS_DEG2RAD);
+    simplify->window_num = 0;
+}
+
+static void simplify_project(gps_simplify_t simplify, const gps_fix_t *fix, struct gps_simplify_point *p)
+{
+    double dlon = fix->lon - simplify->anchor.lon;
+
+    if (dlon > 180.0) dlon -= 360.0;
+    else if (dlon < -180.0) dlon += 360.0;
+
+    p->x = (float)(dlon * simplify->m_per_lon);
+    p->y = (float)((fix->lat - simplify->anchor.lat) * GPS_M_PER_DEG);
+}
+
+/**
+ * This function initializes a streaming track simplifier
+ *
+ * @param simplify   the simplifier
+ * @param tolerance  the maximum cross-track error in metres
+ * @param window     window buffer, bounds the memory and the run length
+ * @param window_max the number of points in the window buffer
+ * @param handler    called with every retained fix, timestamps untouched
+ * @param user_data  passed to the handler
+ */
+void gps_simplify_init(gps_simplify_t simplify, float tolerance,
+                       struct gps_simplify_point *window, rt_uint16_t window_max,
+                       gps_simplify_handler_t handler, void *user_data)
+{
+    RT_ASSERT(simplify);
+    RT_ASSERT(window);
+    RT_ASSERT(window_max > 0);
+
+    rt_memset(simplify, 0, sizeof(struct gps_simplify));
+    simplify->tolerance2 = tolerance * tolerance;
+    simplify->window = window;
+    simplify->window_max = window_max;
+    simplify->handler = handler;
+    simplify->user_data = user_data;
+}
+
+/**
+ * This function feeds one fix to the simplifier. The fix extends the
+ * current run while every point of the run stays within the tolerance of
+ * the straight line from the anchor; otherwise the previous fix is
+ * emitted and becomes the new anchor.
+ */
+void gps_simplify_push(gps_simplify_t simplify, const gps_fix_t *fix)
+{
+    RT_ASSERT(simplify);
+    RT_ASSERT(fix);
+
+    struct gps_simplify_point p;
+    rt_uint16_t i;
+
+    simplify->in++;
+
+    if (!simplify->started)
+    {
+        simplify->started = RT_TRUE;
+        simplify_set_anchor(simplify, fix);
+        simplify_emit(simplify, fix);
+        return;
+    }
+
+    simplify_project(simplify, fix, &p);
+
+    for (i = 0; i < simplify->window_num; i++)
+    {
+        if (segment_dist2(simplify->window[i].x, simplify->window[i].y, p.x, p.y) > simplify->tolerance2)
+            break;
+    }
+
+    if (i < simplify->window_num || simplify->window_num == simplify->window_max)
+    {
+        if (i == simplify->window_num)
+            simplify->forced++;
+
+        /* close the run at the previous fix and restart from there */
+        simplify_emit(simplify, &simplify->last);
+        simplify_set_anchor(simplify, &simplify->last);
+        simplify_project(simplify, fix, &p);
+    }
+
+    simplify->window[simplify->window_num++] = p;
+    simplify->last = *fix;
+}
+
+/**
+ * This function emits the last pending fix, call it when the track ends
+ */
+void gps_simplify_flush(gps_simplify_t simplify)
+{
+    RT_ASSERT(simplify);
+
+    if (simplify->started && simplify->window_num)
+    {
+        simplify_emit(simplify, &simplify->last);
+        simplify_set_anchor(simplify, &simplify->last);
+    }
+}
+
+/**
+ * This function simplifies a whole track with Douglas-Peucker, for host
+ * tools and offline processing. Recursion is replaced by an explicit
+ * stack so deep tracks do not exhaust the thread stack.
+ *
+ * @param track     the fixes in time order
+ * @param count     the number of fixes
+ * @param tolerance the maximum cross-track error in metres
+ * @param keep      set to 1 for every retained fix, count elements
+ *
+ * @return the number of retained fixes, 0 if out of memory
+ */
+rt_size_t gps_simplify_dp(const gps_fix_t *track, rt_size_t count, float tolerance, rt_uint8_t *keep)
+{
+    RT_ASSERT(track || count == 0);
+    RT_ASSERT(keep || count == 0);
+
+    rt_size_t *stack;
+    rt_size_t top = 0, kept = 0, i;
+    double tol2 = (double)tolerance * tolerance;
+
+    if (count == 0)
+        return 0;
+
+    rt_memset(keep, 0, count);
+    keep[0] = keep[count - 1] = 1;
+    if (count < 3)
+        return count;
+
+    stack = rt_malloc(count * sizeof(rt_size_t));
+    if (stack == RT_NULL)
+    {
+        LOG_E("Can't allocate memory for track simplification");
+        return 0;
+    }
+
+    stack[top++] = 0;
+    stack[top++] = count - 1;
+
+    while (top)
+    {
+        rt_size_t last = stack[--top];
+        rt_size_t first = stack[--top];
+        rt_size_t index = 0;
+        double max2 = tol2;
+
+        /* project around the segment start, the scale error stays local */
+        double m_per_lon = GPS_M_PER_DEG * cos(track[first].lat * GPS_DEG2RAD);
+        double sx = (track[last].lon - track[first].lon) * m_per_lon;
+        double sy = (track[last].lat - track[first].lat) * GPS_M_PER_DEG;
+
+        for (i = first + 1; i < last; i++)
+        {
+            double x = (track[i].lon - track[first].lon) * m_per_lon;
+            double y = (track[i].lat - track[first].lat) * GPS_M_PER_DEG;
+            double d2 = segment_dist2((float)x, (float)y, (float)sx, (float)sy);
+
+            if (d2 > max2)
+            {
+                max2 = d2;
+                index = i;
+            }
+        }
+
+        if (index)
+        {
+            keep[index] = 1;
+            /* pending ranges are disjoint and span at least 2, count entries suffice */
+            if (index - first > 1)
+            {
+                stack[top++] = first;
+                stack[top++] = index;
+            }
+            if (last - index > 1)
+            {
+                stack[top++] = index;
+                stack[top++] = last;
+            }
+        }
+    }
+
+    rt_free(stack);
+
+    for (i = 0; i < count; i++)
+        kept += keep[i];
+
+    return kept;
+}
@@ -0,0 +1,266 @@
+/*
+ * Copyright (c) 2020, RudyLo <luhuadong@163.com>
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ *
+ * Change Logs:
+ * Date           Author       Notes
+ * 2026-10-19     luhuadong    the first version
+ */
+
+#include <rtthread.h>
+#include "gps_telemetry.h"
+
+#define DBG_TAG "sensor.gps"
+#define DBG_LVL DBG_INFO
+#include <rtdbg.h>
+
+#define MS_PER_DAY           86400000UL
+
+/* exp-Golomb orders, POS adds pos_digits - 5 */
+#define ORDER_TIME           0
+#define ORDER_POS            1
+#define ORDER_ALT            1
+#define ORDER_SPEED          1
+#define ORDER_COURSE         1
+#define ORDER_SATS           0
+#define ORDER_HDOP           1
+
+static const struct gps_telemetry_config telemetry_default =
+{
+    .fields     = GPS_TELEMETRY_TIME | GPS_TELEMETRY_POS | GPS_TELEMETRY_ALT,
+    .pos_digits = 6,
+    .time_res   = 1000,
+    .alt_res    = 100,
+};
+
+static const double pos_scale[] = { 1e5, 1e6, 1e7 };
+
+static rt_int32_t tlm_round(double v)
+{
+    return (rt_int32_t)(v + (v < 0 ? -0.5 : 0.5));
+}
+
+/* append n bits of v, MSB first, clearing what a rolled-back add left */
+static rt_bool_t put_bits(gps_telemetry_t tlm, rt_uint64_t v, rt_uint8_t n)
+{
+    if (tlm->bits + n > tlm->size * 8)
+        return RT_FALSE;
+
+    while (n > 0)
+    {
+        rt_uint8_t *byte = &tlm->buf[tlm->bits >> 3];
+        rt_uint8_t room = 8 - (tlm->bits & 7);
+        rt_uint8_t take = n < room ? n : room;
+        rt_uint8_t shift = room - take;
+        rt_uint8_t mask = (rt_uint8_t)(((1U << take) - 1) << shift);
+
+        n -= take;
+        *byte = (*byte & ~mask) | (rt_uint8_t)(((v >> n) << shift) & mask);
+        tlm->bits += take;
+    }
+
+    return RT_TRUE;
+}
+
+static rt_bool_t put_le(gps_telemetry_t tlm, rt_uint32_t v, rt_uint8_t bytes)
+{
+    rt_uint8_t i;
+
+    for (i = 0; i < bytes; i++)
+    {
+        if (!put_bits(tlm, (v >> (8 * i)) & 0xFF, 8))
+            return RT_FALSE;
+    }
+
+    return RT_TRUE;
+}
+
+/* zigzag, then exp-Golomb of order k */
+static rt_bool_t put_value(gps_telemetry_t tlm, rt_int64_t v, rt_uint8_t k)
+{
+    rt_uint64_t w = (((rt_uint64_t)v << 1) ^ (rt_uint64_t)(v >> 63)) + ((rt_uint64_t)1 << k);
+    rt_uint8_t n = 0;
+
+    while (n < 64 && (w >> n) > 1)
+        n++;
+
+    /* n + 1 significant bits, n - k leading zeros */
+    return put_bits(tlm, 0, n - k) && put_bits(tlm, w, n + 1);
+}
+
+/**
+ * This function starts a frame in the caller's buffer
+ *
+ * @param tlm  the frame builder
+ * @param cfg  the fields and precision, RT_NULL for defaults
+ * @param buf  the frame, built in place
+ * @param size the size of buf
+ *
+ * @return RT_EOK on success, -RT_EINVAL for a bad config or a buffer
+ *         smaller than the header
+ */
+rt_err_t gps_telemetry_begin(gps_telemetry_t tlm, const struct gps_telemetry_config *cfg,
+                             void *buf, rt_size_t size)
+{
+    RT_ASSERT(tlm);
+    RT_ASSERT(buf);
+
+    rt_memset(tlm, 0, sizeof(struct gps_telemetry));
+    tlm->cfg = cfg ? *cfg : telemetry_default;
+    tlm->buf = (rt_uint8_t *)buf;
+    tlm->size = size;
+
+    if (tlm->cfg.pos_digits < 5 || tlm->cfg.pos_digits > 7 ||
+        tlm->cfg.time_res == 0 || tlm->cfg.alt_res == 0 || size < GPS_TELEMETRY_HEADER_SIZE)
+        return -RT_EINVAL;
+
+    put_le(tlm, GPS_TELEMETRY_VERSION, 1);
+    put_le(tlm, tlm->cfg.fields, 1);
+    put_le(tlm, 0, 1);
+    put_le(tlm, tlm->cfg.pos_digits, 1);
+    put_le(tlm, tlm->cfg.time_res, 2);
+    put_le(tlm, tlm->cfg.alt_res, 2);
+
+    return RT_EOK;
+}
+
+static rt_bool_t telemetry_encode(gps_telemetry_t tlm, const gps_fix_t *fix)
+{
+    rt_uint8_t fields = tlm->cfg.fields;
+    rt_int32_t lat = tlm_round(fix->lat * pos_scale[tlm->cfg.pos_digits - 5]);
+    rt_int32_t lon = tlm_round(fix->lon * pos_scale[tlm->cfg.pos_digits - 5]);
+    rt_int32_t alt = tlm_round(fix->alt * 1000.0 / tlm->cfg.alt_res);
+
+    if (tlm->count == 0)
+    {
+        tlm->base_time = fix->time;
+        tlm->lat[0] = tlm->lat[1] = lat;
+        tlm->lon[0] = tlm->lon[1] = lon;
+        tlm->alt = alt;
+
+        if ((fields & GPS_TELEMETRY_TIME) && !(put_le(tlm, fix->date, 4) && put_le(tlm, fix->time, 4)))
+            return RT_FALSE;
+        if ((fields & GPS_TELEMETRY_POS) && !(put_le(tlm, lat, 4) && put_le(tlm, lon, 4)))
+            return RT_FALSE;
+        if ((fields & GPS_TELEMETRY_ALT) && !put_le(tlm, alt, 4))
+            return RT_FALSE;
+    }
+
+    if (fields & GPS_TELEMETRY_TIME)
+    {
+        rt_uint32_t rel = fix->time >= tlm->base_time ? fix->time - tlm->base_time
+                                                       : fix->time + MS_PER_DAY - tlm->base_time;
+        rt_int32_t t = (rt_int32_t)((rel + tlm->cfg.time_res / 2) / tlm->cfg.time_res);
+        rt_int32_t dt = t - tlm->time;
+
+        if (!put_value(tlm, (rt_int64_t)dt - tlm->dt, ORDER_TIME))
+            return RT_FALSE;
+        tlm->dt = dt;
+        tlm->time = t;
+    }
+
+    if (fields & GPS_TELEMETRY_POS)
+    {
+        rt_uint8_t k = ORDER_POS + tlm->cfg.pos_digits - 5;
+
+        if (!put_value(tlm, (rt_int64_t)lat - (2 * (rt_int64_t)tlm->lat[0] - tlm->lat[1]), k) ||
+            !put_value(tlm, (rt_int64_t)lon - (2 * (rt_int64_t)tlm->lon[0] - tlm->lon[1]), k))
+            return RT_FALSE;
+        tlm->lat[1] = tlm->lat[0];
+        tlm->lat[0] = lat;
+        tlm->lon[1] = tlm->lon[0];
+        tlm->lon[0] = lon;
+    }
+
+    if (fields & GPS_TELEMETRY_ALT)
+    {
+        if (!put_value(tlm, (rt_int64_t)alt - tlm->alt, ORDER_ALT))
+            return RT_FALSE;
+        tlm->alt = alt;
+    }
+
+    if (fields & GPS_TELEMETRY_SPEED)
+    {
+        rt_int32_t speed = tlm_round(fix->speed * 10.0);
+
+        if (!put_value(tlm, (rt_int64_t)speed - tlm->speed, ORDER_SPEED))
+            return RT_FALSE;
+        tlm->speed = speed;
+    }
+
+    if (fields & GPS_TELEMETRY_COURSE)
+    {
+        rt_int32_t course = tlm_round(fix->course) % 360;
+        rt_int32_t turn;
+
+        if (course < 0)
+            course += 360;
+        turn = course - tlm->course;
+        if (turn > 180)
+            turn -= 360;
+        else if (turn <= -180)
+            turn += 360;
+
+        if (!put_value(tlm, turn, ORDER_COURSE))
+            return RT_FALSE;
+        tlm->course = course;
+    }
+
+    if (fields & GPS_TELEMETRY_QUALITY)
+    {
+        rt_int32_t hdop = tlm_round(fix->hdop * 10.0);
+
+        if (!put_value(tlm, (rt_int64_t)fix->sats - tlm->sats, ORDER_SATS) ||
+            !put_value(tlm, (rt_int64_t)hdop - tlm->hdop, ORDER_HDOP))
+            return RT_FALSE;
+        tlm->sats = fix->sats;
+        tlm->hdop = hdop;
+    }
+
+    return RT_TRUE;
+}
+
+/**
+ * This function appends a fix to the frame
+ *
+ * @return RT_EOK on success, -RT_EFULL if it does not fit; the frame is
+ *         unchanged then, finish and send it and begin the next one
+ */
+rt_err_t gps_telemetry_add(gps_telemetry_t tlm, const gps_fix_t *fix)
+{
+    RT_ASSERT(tlm);
+    RT_ASSERT(fix);
+
+    struct gps_telemetry save;
+
+    if (tlm->count >= GPS_TELEMETRY_COUNT_MAX)
+        return -RT_EFULL;
+
+    save = *tlm;
+    if (!telemetry_encode(tlm, fix))
+    {
+        *tlm = save;
+        return -RT_EFULL;
+    }
+    tlm->count++;
+
+    return RT_EOK;
+}
+
+/**
+ * This function completes the frame
+ *
+ * @return the frame length in bytes, 0 if it holds no fix
+ */
+rt_size_t gps_telemetry_finish(gps_telemetry_t tlm)
+{
+    RT_ASSERT(tlm);
+
+    if (tlm->count == 0)
+        return 0;
+
+    tlm->buf[2] = tlm->count;
+
+    return (tlm->bits + 7) / 8;
+}
@@ -0,0 +1,290 @@
+/*
+ * Copyright (c) 2020, RudyLo <luhuadong@163.com>
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ *
+ * Change Logs:
+ * Date           Author       Notes
+ * 2026-10-19     luhuadong    the first version
+ */
+
+#include <rtthread.h>
+#include <rtdevice.h>
+#include "gps_time.h"
+#include "gps_barrier.h"
+
+#if defined(__linux__)
+#include <time.h>
+#include <sys/timex.h>
+#elif defined(RT_USING_RTC)
+#include <time.h>
+#endif
+
+#define DBG_TAG "sensor.gps"
+#define DBG_LVL DBG_INFO
+#include <rtdbg.h>
+
+#define US_PER_SEC           1000000LL
+#define PPB                  1000000000LL
+
+/* days since 1970-01-01 of a proleptic Gregorian date */
+static rt_int32_t days_from_civil(rt_int32_t y, rt_uint32_t m, rt_uint32_t d)
+{
+    y -= (m <= 2);
+    rt_int32_t era = (y >= 0 ? y : y - 399) / 400;
+    rt_uint32_t yoe = (rt_uint32_t)(y - era * 400);
+    rt_uint32_t doy = (153 * (m + (m > 2 ? -3 : 9)) + 2) / 5 + d - 1;
+    rt_uint32_t doe = yoe * 365 + yoe / 4 - yoe / 100 + doy;
+
+    return era * 146097 + (rt_int32_t)doe - 719468;
+}
+
+/**
+ * This function converts an RMC/ZDA date and time to UTC
+ *
+ * @param date ddmmyy, years 80 ~ 99 are 1980 ~ 1999
+ * @param time milliseconds of day
+ *
+ * @return microseconds since 1970-01-01 UTC, -1 if the date is invalid
+ */
+rt_int64_t gps_time_utc(rt_uint32_t date, rt_uint32_t time)
+{
+    rt_uint32_t day = date / 10000;
+    rt_uint32_t month = date / 100 % 100;
+    rt_uint32_t year = date % 100;
+
+    if (day < 1 || day > 31 || month < 1 || month > 12)
+        return -1;
+
+    year += (year >= 80) ? 1900 : 2000;
+
+    return ((rt_int64_t)days_from_civil(year, month, day) * 86400000LL + time) * 1000;
+}
+
+/**
+ * This function initializes a time service
+ *
+ * @param t          the time service
+ * @param latency    us from epoch to first byte, assumed when fixes are
+ *                   not PPS stamped
+ * @param set_system also keep the RTC (RT_USING_RTC) or, on host builds,
+ *                   the system clock in step
+ */
+void gps_time_init(gps_time_t t, rt_uint32_t latency, rt_bool_t set_system)
+{
+    RT_ASSERT(t);
+
+    rt_memset(t, 0, sizeof(struct gps_time));
+    t->latency = latency;
+    t->set_system = set_system;
+}
+
+static void time_publish(gps_time_t t, rt_uint64_t local, rt_int64_t utc, rt_int32_t rate)
+{
+    struct gps_time_slot *next = &t->slot[t->index ^ 1];
+
+    gps_seq_write_begin(&next->seq);
+    next->base_local = local;
+    next->base_utc = utc;
+    next->rate = rate;
+    gps_seq_write_end(&next->seq);
+
+    /* the slot is complete before readers can pick it */
+    gps_wmb();
+    t->index ^= 1;
+}
+
+/**
+ * This function maps a local gps_time_us() value to disciplined UTC
+ *
+ * @return microseconds since 1970-01-01 UTC, 0 before the first sync
+ */
+rt_int64_t gps_time_at(gps_time_t t, rt_uint64_t local)
+{
+    RT_ASSERT(t);
+
+    struct gps_time_slot s;
+    rt_uint32_t seq;
+
+    while (1)
+    {
+        const struct gps_time_slot *slot = &t->slot[t->index];
+
+        seq = gps_seq_read_begin(&slot->seq);
+        s = *slot;
+        if (!gps_seq_read_retry(&slot->seq, seq))
+            break;
+    }
+
+    if (seq == 0)
+        return 0;
+
+    rt_int64_t dl = (rt_int64_t)(local - s.base_local);
+
+    return s.base_utc + dl + dl * s.rate / PPB;
+}
+
+/**
+ * This function reads the disciplined UTC, it never touches the parser
+ *
+ * @param t   the time service
+ * @param utc microseconds since 1970-01-01 UTC
+ *
+ * @return RT_EOK on success, -RT_EEMPTY before the first sync
+ */
+rt_err_t gps_time_now(gps_time_t t, rt_int64_t *utc)
+{
+    RT_ASSERT(t);
+    RT_ASSERT(utc);
+
+    *utc = gps_time_at(t, gps_time_us());
+
+    return t->locked ? RT_EOK : -RT_EEMPTY;
+}
+
+static rt_int32_t clamp(rt_int64_t v, rt_int32_t limit)
+{
+    if (v > limit) return limit;
+    if (v < -limit) return -limit;
+
+    return (rt_int32_t)v;
+}
+
+/**
+ * This function feeds one UTC reference to the loop
+ *
+ * @param t     the time service
+ * @param utc   the reference, us since 1970-01-01 UTC
+ * @param local gps_time_us() at the reference
+ * @param pps   RT_TRUE if the reference is PPS accurate, the frequency
+ *              loop then trusts it more
+ *
+ * @return RT_EOK on success
+ */
+rt_err_t gps_time_sync(gps_time_t t, rt_int64_t utc, rt_uint64_t local, rt_bool_t pps)
+{
+    RT_ASSERT(t);
+
+    if (!t->locked)
+    {
+        time_publish(t, local, utc, t->freq);
+        t->locked = RT_TRUE;
+        t->last_local = local;
+        t->steps++;
+        t->syncs++;
+        return RT_EOK;
+    }
+
+    rt_int64_t dt = (rt_int64_t)(local - t->last_local);
+
+    if (dt < GPS_TIME_SYNC_INTERVAL * 9 / 10)
+        return RT_EOK;
+
+    rt_int64_t predicted = gps_time_at(t, local);
+    rt_int64_t error = utc - predicted;
+
+    t->offset = error;
+
+    if (error > GPS_TIME_STEP_LIMIT || error < -GPS_TIME_STEP_LIMIT)
+    {
+        LOG_D("clock step %d us", (int)error);
+        time_publish(t, local, utc, t->freq);
+        t->steps++;
+    }
+    else
+    {
+        /* FLL: integrate the frequency error, slew half the phase next interval */
+        rt_int64_t ferr = error * PPB / dt;
+
+        t->freq = clamp(t->freq + (pps ? ferr / 4 : ferr / 16), GPS_TIME_SLEW_MAX);
+        time_publish(t, local, predicted, clamp(t->freq + ferr / 2, GPS_TIME_SLEW_MAX));
+    }
+
+    t->last_local = local;
+    t->syncs++;
+
+    return RT_EOK;
+}
+
+/**
+ * This function feeds a fix, PPS stamped or not, to the loop
+ */
+rt_err_t gps_time_update(gps_time_t t, const gps_fix_t *fix)
+{
+    RT_ASSERT(t);
+    RT_ASSERT(fix);
+
+    rt_int64_t utc = gps_time_utc(fix->date, fix->time);
+    rt_uint64_t local;
+
+    if (!fix->status || utc < 0)
+        return -RT_EINVAL;
+
+    if (fix->epoch_us)
+        return gps_time_sync(t, utc, fix->epoch_us, RT_TRUE);
+
+    local = fix->rx_us ? fix->rx_us : (rt_uint64_t)fix->tick * US_PER_SEC / RT_TICK_PER_SECOND;
+
+    return gps_time_sync(t, utc, local - t->latency, RT_FALSE);
+}
+
+static void time_set_system(gps_time_t t)
+{
+    rt_int64_t utc;
+
+    if (gps_time_now(t, &utc) != RT_EOK)
+        return;
+
+#if defined(__linux__)
+    struct timespec now;
+    struct timex tx;
+
+    clock_gettime(CLOCK_REALTIME, &now);
+    rt_int64_t offset = utc - ((rt_int64_t)now.tv_sec * US_PER_SEC + now.tv_nsec / 1000);
+
+    if (offset > -GPS_TIME_STEP_LIMIT && offset < GPS_TIME_STEP_LIMIT)
+    {
+        rt_memset(&tx, 0, sizeof(tx));
+        tx.modes = ADJ_OFFSET_SINGLESHOT;
+        tx.offset = (long)offset;
+        if (adjtimex(&tx) < 0)
+            LOG_E("Can't slew the system clock");
+    }
+    else
+    {
+        now.tv_sec = (time_t)(utc / US_PER_SEC);
+        now.tv_nsec = (long)(utc % US_PER_SEC) * 1000;
+        if (clock_settime(CLOCK_REALTIME, &now) < 0)
+            LOG_E("Can't set the system clock");
+    }
+#elif defined(RT_USING_RTC)
+    rt_device_t rtc = rt_device_find("rtc");
+    time_t now = (time_t)(utc / US_PER_SEC);
+
+    if (rtc)
+        rt_device_control(rtc, RT_DEVICE_CTRL_RTC_SET_TIME, &now);
+#endif
+}
+
+/**
+ * This function is the subscriber adapter, register it with
+ * gps_subscribe(dev, gps_time_subscriber, t). Behind gps_pps_stage it
+ * uses the PPS epoch times.
+ */
+void gps_time_subscriber(gps_device_t dev, const gps_fix_t *fix, void *user_data)
+{
+    gps_time_t t = (gps_time_t)user_data;
+    rt_uint32_t steps;
+
+    RT_ASSERT(t);
+
+    steps = t->steps;
+    if (gps_time_update(t, fix) != RT_EOK || !t->set_system)
+        return;
+
+    if (steps != t->steps || t->last_local - t->system_local >= GPS_TIME_SYSTEM_INTERVAL * US_PER_SEC)
+    {
+        time_set_system(t);
+        t->system_local = t->last_local;
+    }
+}
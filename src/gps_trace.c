@@ -0,0 +1,166 @@
+/*
+ * Copyright (c) 2020, RudyLo <luhuadong@163.com>
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ *
+ * Change Logs:
+ * Date           Author       Notes
+ * 2026-10-19     luhuadong    the first version
+ */
+
+#include <rtthread.h>
+#include <stdlib.h>
+#include <string.h>
+#include "gps_trace.h"
+
+#define DBG_TAG "sensor.gps"
+#define DBG_LVL DBG_INFO
+#include <rtdbg.h>
+
+#ifdef PKG_USING_GPS_TRACE
+
+#if (GPS_TRACE_SIZE & (GPS_TRACE_SIZE - 1)) != 0
+#error "GPS_TRACE_SIZE must be a power of two"
+#endif
+
+struct gps_trace gps_trace_ring;
+static struct rt_timer trace_sync;
+static rt_bool_t trace_sync_init = RT_FALSE;
+
+static void trace_sync_timeout(void *parameter)
+{
+    GPS_TRACE_MARK(GPS_TRACE_SYNC, gps_time_us() / 1000);
+}
+
+/**
+ * This function starts recording, the ring keeps the newest events. A
+ * timer adds a GPS_TRACE_SYNC event every GPS_TRACE_SYNC_MS.
+ *
+ * @param hz the gps_cycles_get() frequency, 0 for GPS_TRACE_CLOCK_HZ
+ */
+void gps_trace_start(rt_uint32_t hz)
+{
+#if defined(__ARM_ARCH_7M__) || defined(__ARM_ARCH_7EM__)
+    /* DEMCR.TRCENA, then DWT_CTRL.CYCCNTENA */
+    *(volatile rt_uint32_t *)0xE000EDFC |= (1UL << 24);
+    *(volatile rt_uint32_t *)0xE0001000 |= 1UL;
+#endif
+
+    gps_trace_ring.hz = hz ? hz : GPS_TRACE_CLOCK_HZ;
+    gps_trace_ring.enable = RT_TRUE;
+    trace_sync_timeout(RT_NULL);
+
+    if (!trace_sync_init)
+    {
+        rt_timer_init(&trace_sync, "gps_trs", trace_sync_timeout, RT_NULL,
+                      rt_tick_from_millisecond(GPS_TRACE_SYNC_MS), RT_TIMER_FLAG_PERIODIC);
+        trace_sync_init = RT_TRUE;
+    }
+    rt_timer_start(&trace_sync);
+}
+
+/**
+ * This function stops recording, the ring is kept for reading
+ */
+void gps_trace_stop(void)
+{
+    if (trace_sync_init)
+        rt_timer_stop(&trace_sync);
+    gps_trace_ring.enable = RT_FALSE;
+}
+
+/**
+ * This function drops all recorded events
+ */
+void gps_trace_clear(void)
+{
+    rt_bool_t enable = gps_trace_ring.enable;
+
+    gps_trace_ring.enable = RT_FALSE;
+    gps_trace_ring.head = 0;
+    gps_trace_ring.enable = enable;
+}
+
+/**
+ * This function copies the recorded events, oldest first. Stop the trace
+ * first, events written during the copy may be torn.
+ *
+ * @param buf the buffer
+ * @param num the buffer size in events
+ *
+ * @return the number of events copied
+ */
+rt_size_t gps_trace_read(struct gps_trace_event *buf, rt_size_t num)
+{
+    RT_ASSERT(buf || num == 0);
+
+    rt_uint32_t head = gps_trace_ring.head;
+    rt_uint32_t count = (head < GPS_TRACE_SIZE) ? head : GPS_TRACE_SIZE;
+    rt_uint32_t i;
+
+    if (num > count)
+        num = count;
+
+    for (i = 0; i < num; i++)
+        buf[i] = gps_trace_ring.event[(head - count + i) & (GPS_TRACE_SIZE - 1)];
+
+    return num;
+}
+
+/**
+ * This function prints the ring for tools/gps_trace.py. Lines start with
+ * '@' so the dump can be cut out of any console log.
+ */
+void gps_trace_dump(void)
+{
+    rt_bool_t enable = gps_trace_ring.enable;
+    rt_uint32_t head, count, i;
+
+    gps_trace_ring.enable = RT_FALSE;
+
+    head = gps_trace_ring.head;
+    count = (head < GPS_TRACE_SIZE) ? head : GPS_TRACE_SIZE;
+
+    rt_kprintf("@gpstrace 1 %d %d %d\n", (int)gps_trace_ring.hz, (int)count, (int)(head - count));
+    for (i = head - count; i != head; i++)
+    {
+        struct gps_trace_event *e = &gps_trace_ring.event[i & (GPS_TRACE_SIZE - 1)];
+
+        rt_kprintf("@%08x %04x %04x\n", (int)e->cycles, (int)e->id, (int)e->arg);
+    }
+    rt_kprintf("@end\n");
+
+    gps_trace_ring.enable = enable;
+}
+
+/* gps_trace <start [hz]|stop|clear|dump> */
+static void gps_trace(int argc, char **argv)
+{
+    if (argc > 1 && strcmp(argv[1], "start") == 0)
+    {
+        gps_trace_start((argc > 2) ? (rt_uint32_t)strtoul(argv[2], RT_NULL, 0) : 0);
+    }
+    else if (argc > 1 && strcmp(argv[1], "stop") == 0)
+    {
+        gps_trace_stop();
+    }
+    else if (argc > 1 && strcmp(argv[1], "clear") == 0)
+    {
+        gps_trace_clear();
+    }
+    else if (argc > 1 && strcmp(argv[1], "dump") == 0)
+    {
+        gps_trace_dump();
+    }
+    else
+    {
+        rt_kprintf("Usage: gps_trace <start [hz]|stop|clear|dump>\n");
+        rt_kprintf("%s, %d events recorded\n", gps_trace_ring.enable ? "running" : "stopped",
+                   (int)gps_trace_ring.head);
+    }
+}
+#ifdef FINSH_USING_MSH
+MSH_CMD_EXPORT(gps_trace, gps event trace: gps_trace <start [hz]|stop|clear|dump>);
+#endif
+
+#endif /* PKG_USING_GPS_TRACE */
@@ -6,55 +6,57 @@
  * Change Logs:
  * Date           Author       Notes
  * 2020-08-20     luhuadong    the first version
+ * 2026-10-19     luhuadong    register as a GNSS sensor on the gps driver
  */
 
 #include <board.h>
 #include "gps.h"
 
-#define DBG_TAG "sensor.plantower.pms"
+#define DBG_TAG "sensor.nmea.gps"
 #define DBG_LVL DBG_INFO
 #include <rtdbg.h>
 
-/* range */
-#define SENSOR_DUST_RANGE_MIN             (0)
-#define SENSOR_DUST_RANGE_MAX             (1000)
+/* range, degrees */
+#define SENSOR_GNSS_RANGE_MIN             (-180)
+#define SENSOR_GNSS_RANGE_MAX             (180)
 
 /* minial period (ms) */
-#define SENSOR_DUST_PERIOD_MIN            (200)
+#define SENSOR_GNSS_PERIOD_MIN            (100)
 
 
-static rt_size_t _pmsxx_polling_get_data(struct rt_sensor_device *sensor, void *buf)
+static rt_size_t _gps_polling_get_data(struct rt_sensor_device *sensor, void *buf)
 {
     struct rt_sensor_data *sensor_data = buf;
-    pms_device_t dev = (pms_device_t)sensor->config.intf.user_data;
-    struct pms_response resp;
+    gps_device_t dev = (gps_device_t)sensor->config.intf.user_data;
+    gps_fix_t fix;
     rt_uint16_t ret;
 
-    ret = pms_read(dev, &resp, sizeof(resp), rt_tick_from_millisecond(PMS_READ_WAIT_TIME));
-    if (ret != sizeof(resp))
+    ret = gps_read(dev, &fix, sizeof(fix), rt_tick_from_millisecond(GPS_READ_WAIT_TIME));
+    if (ret != sizeof(fix) || !fix.status)
         return 0;
 
-    sensor_data->type = RT_SENSOR_CLASS_DUST;
-    sensor_data->data.dust = dev->resp.PM2_5_atm;
+    sensor_data->type = RT_SENSOR_CLASS_GNSS;
+    sensor_data->data.coord.latitude  = fix.lat;
+    sensor_data->data.coord.longitude = fix.lon;
     sensor_data->timestamp = rt_sensor_get_ts();
 
     return 1;
 }
 
-static rt_size_t pmsxx_fetch_data(struct rt_sensor_device *sensor, void *buf, rt_size_t len)
+static rt_size_t gps_fetch_data(struct rt_sensor_device *sensor, void *buf, rt_size_t len)
 {
     if (sensor->config.mode == RT_SENSOR_MODE_POLLING)
     {
-        return _pmsxx_polling_get_data(sensor, buf);
+        return _gps_polling_get_data(sensor, buf);
     }
     else
         return 0;
 }
 
-static rt_err_t pmsxx_control(struct rt_sensor_device *sensor, int cmd, void *args)
+static rt_err_t gps_control(struct rt_sensor_device *sensor, int cmd, void *args)
 {
     rt_err_t result = RT_EOK;
-    pms_device_t dev = (pms_device_t)sensor->config.intf.user_data;
+    gps_device_t dev = (gps_device_t)sensor->config.intf.user_data;
 
     switch (cmd)
     {
@@ -67,41 +69,20 @@ static rt_err_t pmsxx_control(struct rt_sensor_device *sensor, int cmd, void *ar
         }
         break;
     case RT_SENSOR_CTRL_SET_MODE:
-        sensor->config.mode = (rt_uint32_t)args & 0xFF;
+        sensor->config.mode = (rt_uint32_t)(rt_ubase_t)args & 0xFF;
         break;
     case RT_SENSOR_CTRL_SET_RANGE:
         break;
     case RT_SENSOR_CTRL_SET_ODR:
+        /* output data rate in Hz */
+        if ((rt_ubase_t)args == 0)
+            return -RT_EINVAL;
+        result = gps_set_rate(dev, 1000 / (rt_uint32_t)(rt_ubase_t)args);
         break;
     case RT_SENSOR_CTRL_SET_POWER:
         break;
     case RT_SENSOR_CTRL_SELF_TEST:
         break;
-    case RT_SENSOR_CTRL_PMS_STANDBY:
-        LOG_D("Custom command : Set standby mode");
-        result = pms_set_mode(dev, PMS_MODE_STANDBY);
-        break;
-    case RT_SENSOR_CTRL_PMS_NORMAL:
-        LOG_D("Custom command : Set normal mode");
-        result = pms_set_mode(dev, PMS_MODE_NORMAL);
-        break;
-    case RT_SENSOR_CTRL_PMS_ACTIVE:
-        LOG_D("Custom command : Set active output mode");
-        result = pms_set_mode(dev, PMS_MODE_ACTIVE);
-        break;
-    case RT_SENSOR_CTRL_PMS_PASSIVE:
-        LOG_D("Custom command : Set passive output mode");
-        result = pms_set_mode(dev, PMS_MODE_PASSIVE);
-        break;
-    case RT_SENSOR_CTRL_PMS_DUMP:
-        LOG_D("Custom command : Dump response");
-        if (args)
-        {
-            rt_uint16_t ret = pms_read(dev, args, sizeof(struct pms_response), rt_tick_from_millisecond(PMS_READ_WAIT_TIME));
-            if (ret != sizeof(struct pms_response))
-                result = -RT_ERROR;
-        }
-        break;
     default:
         break;
     }
@@ -111,25 +92,25 @@ static rt_err_t pmsxx_control(struct rt_sensor_device *sensor, int cmd, void *ar
 
 static struct rt_sensor_ops sensor_ops =
 {
-    pmsxx_fetch_data,
-    pmsxx_control
+    gps_fetch_data,
+    gps_control
 };
 
 /**
- * This function will init dhtxx sensor device.
+ * This function will init the gps receiver behind a sensor device.
  *
- * @param intf  interface 
+ * @param intf  interface
  *
  * @return RT_EOK
  */
-static rt_err_t _pmsxx_init(struct rt_sensor_intf *intf)
+static rt_err_t _gps_init(struct rt_sensor_intf *intf)
 {
     if (intf->type == RT_SENSOR_INTF_UART)
     {
-        pms_device_t dev = pms_create(intf->dev_name);
+        gps_device_t dev = gps_create(intf->dev_name);
         if (!dev)
         {
-            LOG_E("PMSxx sensor init failed");
+            LOG_E("GPS sensor init failed");
             return -RT_ERROR;
         }
         intf->user_data = (void *)dev;
@@ -138,24 +119,24 @@ static rt_err_t _pmsxx_init(struct rt_sensor_intf *intf)
 }
 
 /**
- * Call function rt_hw_pms_init for initial and register a pmsxx sensor.
+ * Call function rt_hw_gps_init for initial and register a gps sensor.
  *
  * @param name  the name will be register into device framework
  * @param cfg   sensor config
  *
  * @return the result
  */
-rt_err_t rt_hw_pms_init(const char *name, struct rt_sensor_config *cfg)
+rt_err_t rt_hw_gps_init(const char *name, struct rt_sensor_config *cfg)
 {
     int result;
     rt_sensor_t sensor = RT_NULL;
 
-    if (_pmsxx_init(&cfg->intf) != RT_EOK)
+    if (_gps_init(&cfg->intf) != RT_EOK)
     {
         return -RT_ERROR;
     }
 
-    /* pms sensor register */
+    /* gps sensor register */
     {
         sensor = rt_calloc(1, sizeof(struct rt_sensor_device));
         if (sensor == RT_NULL)
@@ -165,18 +146,18 @@ rt_err_t rt_hw_pms_init(const char *name, struct rt_sensor_config *cfg)
             goto __exit;
         }
 
-        sensor->info.type       = RT_SENSOR_CLASS_DUST;
-        sensor->info.vendor     = RT_SENSOR_VENDOR_PLANTOWER;
-        sensor->info.model      = "pmsxx";
-        sensor->info.unit       = RT_SENSOR_UNIT_NONE;
+        sensor->info.type       = RT_SENSOR_CLASS_GNSS;
+        sensor->info.vendor     = RT_SENSOR_VENDOR_UNKNOWN;
+        sensor->info.model      = "nmea";
+        sensor->info.unit       = RT_SENSOR_UNIT_DD;
         sensor->info.intf_type  = RT_SENSOR_INTF_UART;
-        sensor->info.range_max  = SENSOR_DUST_RANGE_MAX;
-        sensor->info.range_min  = SENSOR_DUST_RANGE_MIN;
-        sensor->info.period_min = SENSOR_DUST_PERIOD_MIN;
+        sensor->info.range_max  = SENSOR_GNSS_RANGE_MAX;
+        sensor->info.range_min  = SENSOR_GNSS_RANGE_MIN;
+        sensor->info.period_min = SENSOR_GNSS_PERIOD_MIN;
 
         rt_memcpy(&sensor->config, cfg, sizeof(struct rt_sensor_config));
         sensor->ops = &sensor_ops;
-        
+
         result = rt_hw_sensor_register(sensor, name, RT_DEVICE_FLAG_RDWR, RT_NULL);
         if (result != RT_EOK)
         {
@@ -192,6 +173,8 @@ rt_err_t rt_hw_pms_init(const char *name, struct rt_sensor_config *cfg)
 __exit:
     if (sensor)
         rt_free(sensor);
+    if (cfg->intf.user_data)
+        gps_delete((gps_device_t)cfg->intf.user_data);
 
     return result;
 }
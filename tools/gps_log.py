@@ -0,0 +1,152 @@
+#!/usr/bin/env python3
+#
+# Copyright (c) 2020, RudyLo <luhuadong@163.com>
+#
+# SPDX-License-Identifier: Apache-2.0
+#
+# Change Logs:
+# Date           Author       Notes
+# 2026-10-19     luhuadong    the first version
+#
+# Decode a gps_log track log into CSV. The input is the log file or a dump
+# of its flash partition; blocks are put in sequence order, so the ring
+# may have wrapped. The format is described in inc/gps_log.h.
+#
+#   python3 tools/gps_log.py track.bin -o track.csv
+#
+
+import argparse
+import struct
+import sys
+import zlib
+
+MAGIC = 0x4C47
+VERSION = 1
+HEADER_SIZE = 16
+
+REC_KEY = 0x01
+REC_STATE = 0x02
+REC_VEL = 0x04
+
+COURSE_FULL = 3600
+
+FIELDS = ("date", "time", "lat", "lon", "alt", "speed", "course", "hdop",
+          "sats", "quality", "mode", "status", "flags")
+
+
+class Reader:
+    def __init__(self, data):
+        self.data = data
+        self.pos = 0
+
+    def byte(self):
+        b = self.data[self.pos]
+        self.pos += 1
+        return b
+
+    def uvarint(self):
+        val = shift = 0
+        while True:
+            b = self.byte()
+            val |= (b & 0x7F) << shift
+            if not b & 0x80:
+                return val & 0xFFFFFFFF
+            shift += 7
+
+    def svarint(self):
+        u = self.uvarint()
+        return (u >> 1) ^ -(u & 1)
+
+
+def wrap32(v):
+    v &= 0xFFFFFFFF
+    return v - 0x100000000 if v >= 0x80000000 else v
+
+
+def blocks(image, size):
+    """Yield (seq, count, records) of the valid blocks."""
+    for off in range(0, len(image) - size + 1, size):
+        block = image[off:off + size]
+        magic, version, _, seq, count, used, crc = struct.unpack_from("<HBBIHHI", block)
+        if magic != MAGIC or version != VERSION or used > size - HEADER_SIZE:
+            continue
+        if zlib.crc32(block[:12] + b"\0\0\0\0" + block[HEADER_SIZE:]) != crc:
+            sys.stderr.write("block %d: bad crc\n" % (off // size))
+            continue
+        yield seq, count, block[HEADER_SIZE:HEADER_SIZE + used]
+
+
+def decode(count, records):
+    """Yield the fixes of one block as dicts."""
+    r = Reader(records)
+    st = dict(date=0, time=0, dt=0, lat=[0, 0], lon=[0, 0], alt=0, speed=0, course=0,
+              hdop=0, sats=0, quality=0, mode=0, status=0, flags=0)
+
+    for _ in range(count):
+        hdr = r.byte()
+        if hdr & REC_KEY:
+            st["date"] = r.uvarint()
+            st["time"] = r.uvarint()
+            lat, lon = r.svarint(), r.svarint()
+            st["alt"] = r.svarint()
+            st["dt"] = 0
+            st["lat"] = [lat, lat]
+            st["lon"] = [lon, lon]
+        else:
+            st["dt"] += r.svarint()
+            st["time"] += st["dt"]
+            for k in ("lat", "lon"):
+                pred = 2 * st[k][0] - st[k][1]
+                st[k] = [wrap32(pred + r.svarint()), st[k][0]]
+            st["alt"] += r.svarint()
+
+        if hdr & REC_STATE:
+            packed, st["flags"], st["sats"] = r.byte(), r.byte(), r.byte()
+            st["quality"] = packed & 0x0F
+            st["mode"] = (packed >> 4) & 0x03
+            st["status"] = (packed >> 6) & 0x01
+            st["hdop"] = r.uvarint()
+
+        if hdr & REC_VEL:
+            if hdr & REC_KEY:
+                st["speed"], st["course"] = r.uvarint(), r.uvarint()
+            else:
+                st["speed"] += r.svarint()
+                st["course"] = (st["course"] + r.svarint()) % COURSE_FULL
+
+        yield dict(date="%06d" % st["date"], time=st["time"],
+                   lat="%.7f" % (st["lat"][0] * 1e-7), lon="%.7f" % (st["lon"][0] * 1e-7),
+                   alt="%.1f" % (st["alt"] / 10.0), speed="%.2f" % (st["speed"] / 100.0),
+                   course="%.1f" % (st["course"] / 10.0), hdop="%.1f" % (st["hdop"] / 10.0),
+                   sats=st["sats"], quality=st["quality"], mode=st["mode"],
+                   status=st["status"], flags=st["flags"])
+
+
+def main():
+    parser = argparse.ArgumentParser(description="gps_log track log to CSV")
+    parser.add_argument("input", help="log file or partition dump")
+    parser.add_argument("-o", "--output", help="CSV file, default stdout")
+    parser.add_argument("-b", "--block-size", type=int, default=512, help="GPS_LOG_BLOCK_SIZE")
+    args = parser.parse_args()
+
+    with open(args.input, "rb") as f:
+        image = f.read()
+
+    dst = open(args.output, "w") if args.output else sys.stdout
+    dst.write(",".join(FIELDS) + "\n")
+
+    nblocks = nfixes = nbytes = 0
+    for seq, count, records in sorted(blocks(image, args.block_size)):
+        for fix in decode(count, records):
+            dst.write(",".join(str(fix[k]) for k in FIELDS) + "\n")
+        nblocks += 1
+        nfixes += count
+        nbytes += len(records)
+
+    if nfixes:
+        sys.stderr.write("%d blocks, %d fixes, %.2f bytes per fix in records, %.2f with block overhead\n" %
+                         (nblocks, nfixes, nbytes / nfixes, nblocks * args.block_size / nfixes))
+
+
+if __name__ == "__main__":
+    main()
@@ -0,0 +1,141 @@
+#!/usr/bin/env python3
+#
+# Copyright (c) 2020, RudyLo <luhuadong@163.com>
+#
+# SPDX-License-Identifier: Apache-2.0
+#
+# Change Logs:
+# Date           Author       Notes
+# 2026-10-19     luhuadong    the first version
+#
+# Reference decoder of gps_telemetry frames, the format is described in
+# inc/gps_telemetry.h. Frames are read as binary files or as hex text,
+# one frame per line, and decoded to CSV.
+#
+#   python3 tools/gps_telemetry.py frame.bin
+#   python3 tools/gps_telemetry.py --hex uplink.log -o fixes.csv
+#
+
+import argparse
+import struct
+import sys
+
+VERSION = 1
+HEADER_SIZE = 8
+MS_PER_DAY = 86400000
+
+TIME, POS, ALT, SPEED, COURSE, QUALITY = 0x01, 0x02, 0x04, 0x08, 0x10, 0x20
+
+ORDER_TIME, ORDER_POS, ORDER_ALT, ORDER_SPEED, ORDER_COURSE, ORDER_SATS, ORDER_HDOP = 0, 1, 1, 1, 1, 0, 1
+
+
+class Bits:
+    def __init__(self, data, pos=0):
+        self.data = data
+        self.pos = pos * 8
+
+    def bit(self):
+        b = (self.data[self.pos >> 3] >> (7 - (self.pos & 7))) & 1
+        self.pos += 1
+        return b
+
+    def bits(self, n):
+        v = 0
+        for _ in range(n):
+            v = (v << 1) | self.bit()
+        return v
+
+    def value(self, k):
+        """An exp-Golomb code of order k, unzigzagged."""
+        zeros = 0
+        while self.bit() == 0:
+            zeros += 1
+        n = zeros + k
+        w = (1 << n) | self.bits(n)
+        u = w - (1 << k)
+        return (u >> 1) ^ -(u & 1)
+
+
+def decode(frame):
+    """Return the fixes of a frame as a list of dicts."""
+    version, fields, count, digits, time_res, alt_res = struct.unpack_from("<BBBBHH", frame)
+    if version != VERSION:
+        raise ValueError("unknown version %d" % version)
+
+    off = HEADER_SIZE
+    date = base_time = 0
+    lat = lon = alt = 0
+    if fields & TIME:
+        date, base_time = struct.unpack_from("<II", frame, off)
+        off += 8
+    if fields & POS:
+        lat, lon = struct.unpack_from("<ii", frame, off)
+        off += 8
+    if fields & ALT:
+        (alt,) = struct.unpack_from("<i", frame, off)
+        off += 4
+
+    scale = 10.0 ** -digits
+    b = Bits(frame, off)
+    t = dt = speed = course = sats = hdop = 0
+    lat1, lon1 = lat, lon
+    fixes = []
+
+    for _ in range(count):
+        fix = {}
+        if fields & TIME:
+            dt += b.value(ORDER_TIME)
+            t += dt
+            fix["date"] = "%06d" % date
+            fix["time"] = (base_time + t * time_res) % MS_PER_DAY
+        if fields & POS:
+            k = ORDER_POS + digits - 5
+            lat, lat1 = 2 * lat - lat1 + b.value(k), lat
+            lon, lon1 = 2 * lon - lon1 + b.value(k), lon
+            fix["lat"] = "%.*f" % (digits, lat * scale)
+            fix["lon"] = "%.*f" % (digits, lon * scale)
+        if fields & ALT:
+            alt += b.value(ORDER_ALT)
+            fix["alt"] = "%.3f" % (alt * alt_res / 1000.0)
+        if fields & SPEED:
+            speed += b.value(ORDER_SPEED)
+            fix["speed"] = "%.1f" % (speed / 10.0)
+        if fields & COURSE:
+            course = (course + b.value(ORDER_COURSE)) % 360
+            fix["course"] = course
+        if fields & QUALITY:
+            sats += b.value(ORDER_SATS)
+            hdop += b.value(ORDER_HDOP)
+            fix["sats"] = sats
+            fix["hdop"] = "%.1f" % (hdop / 10.0)
+        fixes.append(fix)
+
+    return fixes
+
+
+def main():
+    parser = argparse.ArgumentParser(description="gps_telemetry frames to CSV")
+    parser.add_argument("input", nargs="?", help="frame file, default stdin")
+    parser.add_argument("--hex", action="store_true", help="input is hex text, one frame per line")
+    parser.add_argument("-o", "--output", help="CSV file, default stdout")
+    args = parser.parse_args()
+
+    if args.hex:
+        src = open(args.input) if args.input else sys.stdin
+        frames = [bytes.fromhex(line.strip()) for line in src if line.strip()]
+    else:
+        src = open(args.input, "rb") if args.input else sys.stdin.buffer
+        frames = [src.read()]
+
+    dst = open(args.output, "w") if args.output else sys.stdout
+    header = None
+    for frame in frames:
+        for fix in decode(frame):
+            if header is None:
+                header = list(fix.keys())
+                dst.write(",".join(header) + "\n")
+            dst.write(",".join(str(fix[k]) for k in header) + "\n")
+
+
+if __name__ == "__main__":
+    main()
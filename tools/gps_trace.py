@@ -0,0 +1,131 @@
+#!/usr/bin/env python3
+#
+# Copyright (c) 2020, RudyLo <luhuadong@163.com>
+#
+# SPDX-License-Identifier: Apache-2.0
+#
+# Change Logs:
+# Date           Author       Notes
+# 2026-10-19     luhuadong    the first version
+#
+# Convert a `gps_trace dump` into Chrome trace JSON, which chrome://tracing
+# and ui.perfetto.dev open directly. The input is any log holding the dump:
+# a serial console capture or the stdout of a host build.
+#
+#   python3 tools/gps_trace.py console.log -o trace.json
+#
+
+import argparse
+import json
+import sys
+
+ENTER_FLAG = 0x4000
+LEAVE_FLAG = 0x8000
+ID_MASK = 0x3fff
+
+# id: (name, track), see enum gps_trace_id
+EVENTS = {
+    1: ("rx_isr", "uart isr"),
+    2: ("rx_thread", "gps_rx"),
+    3: ("sentence", "gps_rx"),
+    4: ("publish", "gps_rx"),
+    5: ("stage", "gps_rx"),
+    6: ("subscriber", "gps_rx"),
+    7: ("command", "command"),
+    8: ("sync", "trace"),
+}
+SYNC_ID = 8
+USER_BASE = 0x100
+WRAP = 0x100000000
+
+
+def parse(lines):
+    """Return (hz, dropped, events) of the last dump in the log."""
+    dump = None
+    result = None
+    for line in lines:
+        line = line.strip()
+        if line.startswith("@gpstrace"):
+            field = line.split()
+            dump = (int(field[2]), int(field[4]), [])
+        elif line == "@end":
+            if dump:
+                result = dump
+        elif dump and line.startswith("@"):
+            field = line[1:].split()
+            if len(field) == 3:
+                dump[2].append(tuple(int(f, 16) for f in field))
+    if result is None:
+        sys.exit("no complete '@gpstrace' dump found")
+    return result
+
+
+def convert(hz, events):
+    """Unwrap the 32-bit counter and emit Chrome trace events."""
+    out = []
+    tids = {}
+    now = 0
+    last = None
+    sync = None     # (now, ms) of the last sync event
+
+    for cycles, eid, arg in events:
+        if last is not None:
+            delta = (cycles - last) & 0xffffffff
+            if delta >= 0x80000000:     # an interrupt reserved its slot first
+                delta -= WRAP
+            now += delta
+        last = cycles
+
+        ident = eid & ID_MASK
+        if ident == SYNC_ID:
+            # sync events keep gaps below half a wrap while recording; after
+            # a longer stall or a restart the millisecond arg (mod 65.5 s)
+            # tells how many whole wraps the counter lost
+            if sync is not None:
+                elapsed = ((arg - sync[1]) & 0xffff) * hz / 1000.0
+                now += round((elapsed - (now - sync[0])) / WRAP) * WRAP
+            sync = (now, arg)
+        if ident >= USER_BASE:
+            name, track = "user%d" % (ident - USER_BASE), "application"
+        else:
+            name, track = EVENTS.get(ident, ("event%d" % ident, "gps"))
+
+        if track not in tids:
+            tids[track] = len(tids) + 1
+            out.append({"name": "thread_name", "ph": "M", "pid": 1, "tid": tids[track],
+                        "args": {"name": track}})
+
+        if eid & ENTER_FLAG:
+            ph = "B"
+        elif eid & LEAVE_FLAG:
+            ph = "E"
+        else:
+            ph = "i"
+
+        ev = {"name": name, "ph": ph, "ts": now * 1e6 / hz, "pid": 1, "tid": tids[track],
+              "args": {"arg": arg}}
+        if ph == "i":
+            ev["s"] = "t"
+        out.append(ev)
+
+    return out
+
+
+def main():
+    parser = argparse.ArgumentParser(description="gps_trace dump to Chrome/Perfetto trace JSON")
+    parser.add_argument("input", nargs="?", help="log holding the dump, default stdin")
+    parser.add_argument("-o", "--output", help="JSON file, default stdout")
+    args = parser.parse_args()
+
+    src = open(args.input, errors="replace") if args.input else sys.stdin
+    hz, dropped, events = parse(src)
+    if dropped:
+        sys.stderr.write("%d older events were overwritten\n" % dropped)
+
+    trace = {"traceEvents": convert(hz, events), "displayTimeUnit": "ns"}
+    dst = open(args.output, "w") if args.output else sys.stdout
+    json.dump(trace, dst)
+
+
+if __name__ == "__main__":
+    main()